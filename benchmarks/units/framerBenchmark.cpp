@@ -0,0 +1,73 @@
+/******************************************************************************
+ * Copyright (C) 2023 by Gschwind, Weber, Schoch, Niederberger                *
+ *                                                                            *
+ * This file is part of linescaleGUI.                                         *
+ *                                                                            *
+ * LinescaleGUI is free software: you can redistribute it and/or modify       *
+ * it under the terms of the GNU General Public License as published by       *
+ * the Free Software Foundation, either version 3 of the License, or          *
+ * (at your option) any later version.                                        *
+ *                                                                            *
+ * LinescaleGUI is distributed in the hope that it will be useful,            *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of             *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the               *
+ * GNU General Public License for more details.                               *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License          *
+ * along with linescaleGUI. If not, see <http://www.gnu.org/licenses/>.       *
+ ******************************************************************************/
+/**
+ * @file framerBenchmark.cpp
+ * @authors Gschwind, Weber, Schoch, Niederberger
+ *
+ * @brief Benchmarks of the receive path of `comm::CommUSB::readData`
+ *
+ * Frames a byte stream as it arrives from the serial port and parses the
+ * frames, on clean and on noisy streams.
+ *
+ */
+
+#include <benchmark/benchmark.h>
+#include <array>
+#include "../../src/deviceCommunication/framer.h"
+#include "../../src/parser/parser.h"
+#include "../../src/simulator/frameGenerator.h"
+
+namespace {
+
+/**
+ * @brief Frame and parse a stream delivered in chunks
+ *
+ * @param state range(0): chunk size in bytes, range(1): corrupted frames in percent
+ */
+void BM_FrameAndParse(benchmark::State& state) {
+    sim::SimulatorConfig config;
+    config.corruptionRate = double(state.range(1)) / 100.0;
+    sim::FrameGenerator generator(config);
+    QByteArray stream = generator.nextFrames(4096);
+    int chunk = int(state.range(0));
+
+    constexpr size_t BATCH_CAPACITY = 256;
+    std::array<char, BATCH_CAPACITY * Parser::PACKET_EXPECTED_LEN> frameBuffer;
+    std::array<Sample, BATCH_CAPACITY> samples;
+    Parser parser;
+    comm::Framer framer(Parser::PACKET_EXPECTED_LEN);
+
+    for (auto _ : state) {
+        for (int offset = 0; offset < stream.size(); offset += chunk) {
+            framer.write(stream.constData() + offset, size_t(qMin(chunk, stream.size() - offset)));
+            size_t frames;
+            while ((frames = framer.extractFrames(frameBuffer.data(), BATCH_CAPACITY)) > 0) {
+                size_t parsed = parser.parseBatch(frameBuffer.data(), frames * Parser::PACKET_EXPECTED_LEN,
+                                                  samples.data());
+                framer.reportRejected(frames - parsed);
+                benchmark::DoNotOptimize(parsed);
+            }
+        }
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * stream.size());
+    state.counters["resyncs"] = double(framer.getStatistics().resyncEvents);
+}
+BENCHMARK(BM_FrameAndParse)->ArgsProduct({{20, 512, 4096}, {0, 1, 10}})->ArgNames({"chunk", "corrupt%"});
+
+}  // namespace
@@ -0,0 +1,195 @@
+/******************************************************************************
+ * Copyright (C) 2023 by Gschwind, Weber, Schoch, Niederberger                *
+ *                                                                            *
+ * This file is part of linescaleGUI.                                         *
+ *                                                                            *
+ * LinescaleGUI is free software: you can redistribute it and/or modify       *
+ * it under the terms of the GNU General Public License as published by       *
+ * the Free Software Foundation, either version 3 of the License, or          *
+ * (at your option) any later version.                                        *
+ *                                                                            *
+ * LinescaleGUI is distributed in the hope that it will be useful,            *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of             *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the               *
+ * GNU General Public License for more details.                               *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License          *
+ * along with linescaleGUI. If not, see <http://www.gnu.org/licenses/>.       *
+ ******************************************************************************/
+/**
+ * @file logfileBenchmark.cpp
+ * @authors Gschwind, Weber, Schoch, Niederberger
+ *
+ * @brief Benchmarks of loading and writing logfiles
+ *
+ */
+
+#include <benchmark/benchmark.h>
+#include <QDir>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include "../../src/logfile/logfile.h"
+
+namespace {
+
+const QString LONG_LOGFILE = QStringLiteral(LINESCALE_INPUT_FILES "/logfile_long.csv");
+
+/**
+ * @brief Create a logfile with the header of `logfile_long.csv` and `samples` forces
+ *
+ * The file is only created once per size and removed at the end of the run.
+ *
+ * @param samples Number of forces
+ * @return QString Path of the logfile
+ */
+QString syntheticLogfile(int64_t samples) {
+    static QTemporaryDir directory;
+    QString path = directory.filePath(QString("synthetic%1.csv").arg(samples));
+    if (QFile::exists(path)) {
+        return path;
+    }
+
+    QFile source(LONG_LOGFILE);
+    QFile file(path);
+    if (!source.open(QIODevice::ReadOnly | QIODevice::Text) || !file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        return QString();
+    }
+    for (int line = 0; line < 13; ++line) {
+        file.write(source.readLine());
+    }
+    QByteArray block;
+    for (int64_t i = 0; i < samples; ++i) {
+        block.append(QByteArray::number(double(i % 2000) / 100.0 - 5.0, 'f', 2)).append('\n');
+        if (block.size() > (1 << 20)) {
+            file.write(block);
+            block.clear();
+        }
+    }
+    file.write(block);
+    return path;
+}
+
+void BM_LogfileLoadLong(benchmark::State& state) {
+    for (auto _ : state) {
+        Logfile logfile;
+        logfile.setPath(LONG_LOGFILE);
+        if (logfile.load() != 0) {
+            state.SkipWithError("Unable to load logfile_long.csv");
+            break;
+        }
+        benchmark::DoNotOptimize(logfile.getMaxForce());
+    }
+}
+BENCHMARK(BM_LogfileLoadLong)->Unit(benchmark::kMillisecond);
+
+void BM_LogfileLoadSynthetic(benchmark::State& state) {
+    QString path = syntheticLogfile(state.range(0));
+    for (auto _ : state) {
+        Logfile logfile;
+        logfile.setPath(path);
+        if (logfile.load() != 0) {
+            state.SkipWithError("Unable to load the synthetic logfile");
+            break;
+        }
+        benchmark::DoNotOptimize(logfile.getMaxForce());
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * state.range(0));
+}
+BENCHMARK(BM_LogfileLoadSynthetic)->Arg(100000)->Arg(10000000)->Unit(benchmark::kMillisecond);
+
+void BM_LogfileWrite(benchmark::State& state) {
+    Logfile source;
+    source.setPath(syntheticLogfile(state.range(0)));
+    if (source.load() != 0) {
+        state.SkipWithError("Unable to load the synthetic logfile");
+        return;
+    }
+    QTemporaryDir directory;
+    Logfile logfile;
+    logfile.setMetadata(source.getMetadata());
+    logfile.setForce(source.getForce());
+    logfile.setPath(directory.filePath("written.csv"));
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(logfile.write());
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * state.range(0));
+}
+BENCHMARK(BM_LogfileWrite)->Arg(100000)->Arg(10000000)->Unit(benchmark::kMillisecond)->Iterations(1);
+
+/**
+ * @brief Convert a synthetic logfile to the binary format
+ *
+ * @param samples Number of forces
+ * @return QString Path of the binary logfile
+ */
+QString syntheticBinaryLogfile(int64_t samples) {
+    QString path = syntheticLogfile(samples);
+    path.replace(".csv", ".lscb");
+    if (QFile::exists(path)) {
+        return path;
+    }
+    Logfile logfile;
+    logfile.setPath(syntheticLogfile(samples));
+    if (logfile.load() != 0) {
+        return QString();
+    }
+    logfile.setFormat(LogfileFormat::BINARY);
+    logfile.setPath(path);
+    return logfile.write() ? path : QString();
+}
+
+void BM_LogfileLoadBinary(benchmark::State& state) {
+    QString path = syntheticBinaryLogfile(state.range(0));
+    for (auto _ : state) {
+        Logfile logfile;
+        logfile.setPath(path);
+        if (logfile.load() != 0) {
+            state.SkipWithError("Unable to load the binary logfile");
+            break;
+        }
+        benchmark::DoNotOptimize(logfile.getMaxForce());
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * state.range(0));
+}
+BENCHMARK(BM_LogfileLoadBinary)->Arg(100000)->Arg(10000000)->Unit(benchmark::kMillisecond);
+
+void BM_LogfileWriteBinary(benchmark::State& state) {
+    Logfile logfile;
+    logfile.setPath(syntheticLogfile(state.range(0)));
+    if (logfile.load() != 0) {
+        state.SkipWithError("Unable to load the synthetic logfile");
+        return;
+    }
+    QTemporaryDir directory;
+    logfile.setFormat(LogfileFormat::BINARY);
+    logfile.setPath(directory.filePath("written.lscb"));
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(logfile.write());
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * state.range(0));
+}
+BENCHMARK(BM_LogfileWriteBinary)->Arg(100000)->Arg(10000000)->Unit(benchmark::kMillisecond);
+
+/**
+ * @brief Peak of one second at a random position, only the index of a binary logfile is loaded
+ */
+void BM_LogfileFindPeaks(benchmark::State& state) {
+    Logfile logfile;
+    logfile.setPath(syntheticBinaryLogfile(10000000));
+    if (logfile.loadIndex() != 0) {
+        state.SkipWithError("Unable to load the binary logfile");
+        return;
+    }
+    qint64 first = 0;
+    float min, max;
+    for (auto _ : state) {
+        first = (first + 7654321) % (logfile.getSampleCount() - state.range(0));
+        benchmark::DoNotOptimize(logfile.findPeaks(first, state.range(0), min, max));
+    }
+}
+BENCHMARK(BM_LogfileFindPeaks)->Arg(1280)->Arg(1280 * 3600);
+
+}  // namespace
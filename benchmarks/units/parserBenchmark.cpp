@@ -0,0 +1,62 @@
+/******************************************************************************
+ * Copyright (C) 2023 by Gschwind, Weber, Schoch, Niederberger                *
+ *                                                                            *
+ * This file is part of linescaleGUI.                                         *
+ *                                                                            *
+ * LinescaleGUI is free software: you can redistribute it and/or modify       *
+ * it under the terms of the GNU General Public License as published by       *
+ * the Free Software Foundation, either version 3 of the License, or          *
+ * (at your option) any later version.                                        *
+ *                                                                            *
+ * LinescaleGUI is distributed in the hope that it will be useful,            *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of             *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the               *
+ * GNU General Public License for more details.                               *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License          *
+ * along with linescaleGUI. If not, see <http://www.gnu.org/licenses/>.       *
+ ******************************************************************************/
+/**
+ * @file parserBenchmark.cpp
+ * @authors Gschwind, Weber, Schoch, Niederberger
+ *
+ * @brief Benchmarks of the parser
+ *
+ */
+
+#include <benchmark/benchmark.h>
+#include <vector>
+#include "../../src/parser/parser.h"
+#include "../../src/simulator/frameGenerator.h"
+
+namespace {
+
+void BM_ParsePackage(benchmark::State& state) {
+    Parser parser;
+    QByteArray package("R000.63Z-32.84RNS10\r");
+    Sample sample;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(parser.parsePackage(package, sample));
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()));
+}
+BENCHMARK(BM_ParsePackage);
+
+void BM_ParseBatch(benchmark::State& state) {
+    sim::SimulatorConfig config;
+    config.corruptionRate = double(state.range(1)) / 100.0;
+    sim::FrameGenerator generator(config);
+    int frames = int(state.range(0));
+    QByteArray burst = generator.nextFrames(frames);
+
+    Parser parser;
+    std::vector<Sample> samples(size_t(frames));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(parser.parseBatch(burst.constData(), size_t(burst.size()), samples.data()));
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * frames);
+    state.SetBytesProcessed(int64_t(state.iterations()) * burst.size());
+}
+BENCHMARK(BM_ParseBatch)->ArgsProduct({{64, 256}, {0, 5}})->ArgNames({"frames", "corrupt%"});
+
+}  // namespace
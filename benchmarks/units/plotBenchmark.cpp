@@ -0,0 +1,110 @@
+/******************************************************************************
+ * Copyright (C) 2023 by Gschwind, Weber, Schoch, Niederberger                *
+ *                                                                            *
+ * This file is part of linescaleGUI.                                         *
+ *                                                                            *
+ * LinescaleGUI is free software: you can redistribute it and/or modify       *
+ * it under the terms of the GNU General Public License as published by       *
+ * the Free Software Foundation, either version 3 of the License, or          *
+ * (at your option) any later version.                                        *
+ *                                                                            *
+ * LinescaleGUI is distributed in the hope that it will be useful,            *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of             *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the               *
+ * GNU General Public License for more details.                               *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License          *
+ * along with linescaleGUI. If not, see <http://www.gnu.org/licenses/>.       *
+ ******************************************************************************/
+/**
+ * @file plotBenchmark.cpp
+ * @authors Gschwind, Weber, Schoch, Niederberger
+ *
+ * @brief Benchmarks of adding data to the plot
+ *
+ */
+
+#include <benchmark/benchmark.h>
+#include <QVector>
+#include "../../src/gui/minMaxPyramid.h"
+#include "../../src/gui/plotWidget.h"
+
+namespace {
+
+/**
+ * @brief Create consecutive samples
+ *
+ * @param count Number of samples
+ * @param unit Unit of all samples
+ * @return QVector<Sample> Samples at 1280 Hz
+ */
+QVector<Sample> makeSamples(int count, UnitValue unit) {
+    QVector<Sample> samples(count);
+    for (int i = 0; i < count; ++i) {
+        samples[i].measuredValue = double(i % 500) / 100.0;
+        samples[i].unitValue = unit;
+        samples[i].frequency = 1280;
+    }
+    return samples;
+}
+
+void BM_PlotAddData(benchmark::State& state) {
+    Plot plot;
+    double time = 0.0;
+    for (auto _ : state) {
+        for (int i = 0; i < 1280; ++i) {
+            time += 1.0 / 1280.0;
+            plot.addData(time, double(i % 500) / 100.0);
+        }
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * 1280);
+}
+BENCHMARK(BM_PlotAddData);
+
+void BM_PlotAddSamples(benchmark::State& state) {
+    Plot plot;
+    QVector<Sample> samples = makeSamples(int(state.range(0)), UnitValue::KN);
+    for (auto _ : state) {
+        plot.addConsecutiveSamples(samples);
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * state.range(0));
+}
+BENCHMARK(BM_PlotAddSamples)->Arg(21)->Arg(1280);
+
+/**
+ * @brief Switch the unit of a plot with `state.range(0)` points back and forth; the points stay in kN
+ */
+void BM_PlotConvertUnit(benchmark::State& state) {
+    Plot plot;
+    plot.addConsecutiveSamples(makeSamples(int(state.range(0)), UnitValue::KN));
+    QVector<Sample> kgf = makeSamples(1, UnitValue::KGF);
+    QVector<Sample> kn = makeSamples(1, UnitValue::KN);
+    for (auto _ : state) {
+        plot.addConsecutiveSamples(kgf);
+        plot.addConsecutiveSamples(kn);
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * 2);  // Unit switches
+}
+BENCHMARK(BM_PlotConvertUnit)->Arg(100000)->Arg(1000000)->Unit(benchmark::kMillisecond);
+
+/**
+ * @brief Pan over a pyramid of `state.range(0)` points, showing all of them in 1000 pixels
+ */
+void BM_PyramidSample(benchmark::State& state) {
+    MinMaxPyramid pyramid;
+    for (int64_t i = 0; i < state.range(0); ++i) {
+        pyramid.append(double(i) / 1280.0, double(i % 500) / 100.0);
+    }
+    double width = double(state.range(0)) / 1280.0;
+    QVector<double> times, forces;
+    double offset = 0.0;
+    for (auto _ : state) {
+        offset = offset > width ? 0.0 : offset + width / 100.0;
+        pyramid.sample(offset - width / 2, offset + width / 2, 1000, times, forces);
+        benchmark::DoNotOptimize(times.data());
+    }
+    state.counters["points"] = double(times.size());
+}
+BENCHMARK(BM_PyramidSample)->Arg(100000)->Arg(10000000)->Unit(benchmark::kMicrosecond);
+
+}  // namespace
@@ -0,0 +1,433 @@
+/******************************************************************************
+ * Copyright (C) 2023 by Gschwind, Weber, Schoch, Niederberger                *
+ *                                                                            *
+ * This file is part of linescaleGUI.                                         *
+ *                                                                            *
+ * LinescaleGUI is free software: you can redistribute it and/or modify       *
+ * it under the terms of the GNU General Public License as published by       *
+ * the Free Software Foundation, either version 3 of the License, or          *
+ * (at your option) any later version.                                        *
+ *                                                                            *
+ * LinescaleGUI is distributed in the hope that it will be useful,            *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of             *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the               *
+ * GNU General Public License for more details.                               *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License          *
+ * along with linescaleGUI. If not, see <http://www.gnu.org/licenses/>.       *
+ ******************************************************************************/
+/**
+ * @file linescaleRecord.cpp
+ * @authors Gschwind, Weber, Schoch, Niederberger
+ *
+ * @brief Entry point of `linescale-record`, a recorder without GUI
+ *
+ * Connects to a LineScale, requests the online stream and records it into a
+ * binary logfile, e.g. with
+ * `linescale-record --port /dev/ttyUSB0 --frequency 1280 --output run.lscb`.
+ * Only a `QCoreApplication` is created, so no display server is needed.
+ * Stops after `--duration` or on SIGINT / SIGTERM.
+ *
+ * With `--replay` a logfile is played through the live path instead, e.g.
+ * `linescale-record --replay run.lscb --speed 0` as end to end load test.
+ *
+ */
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDate>
+#include <QFile>
+#include <QTextStream>
+#include <QTime>
+#include <QTimer>
+#include <chrono>
+#include <cmath>
+#include <csignal>
+#include <ctime>
+#include "../deviceCommunication/command.h"
+#include "../deviceCommunication/commMaster.h"
+#include "../logfile/recorder.h"
+#include "../streaming/samplePublisher.h"
+#include "../streaming/sampleServer.h"
+#if defined(Q_OS_WIN)
+#include <windows.h>
+#endif
+
+namespace {
+
+volatile std::sig_atomic_t stopRequested = 0;  ///< Set by `requestStop`
+
+/**
+ * @brief Signal handler, the event loop polls the flag
+ *
+ */
+void requestStop(int) {
+    stopRequested = 1;
+}
+
+/**
+ * @brief CPU time used by the process so far
+ *
+ * `std::clock` is only CPU time on POSIX, on Windows it is wall time.
+ *
+ * @return double CPU time of all threads in s
+ */
+double cpuSeconds() {
+#if defined(Q_OS_WIN)
+    FILETIME creation, exit, kernel, user;
+    if (!GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user)) {
+        return 0.0;
+    }
+    auto ticks = [](const FILETIME& time) {
+        return double((quint64(time.dwHighDateTime) << 32) | time.dwLowDateTime) * 1e-7;  // 100 ns ticks
+    };
+    return ticks(kernel) + ticks(user);
+#else
+    return double(std::clock()) / CLOCKS_PER_SEC;
+#endif
+}
+
+/**
+ * @brief Parse the unit given on the command line
+ *
+ * @param name One of kN, kgf or lbf, case insensitive
+ * @param unit Parsed unit
+ * @return true if the name is valid
+ */
+bool parseUnit(const QString& name, UnitValue& unit) {
+    if (name.compare("kN", Qt::CaseInsensitive) == 0) {
+        unit = UnitValue::KN;
+    } else if (name.compare("kgf", Qt::CaseInsensitive) == 0) {
+        unit = UnitValue::KGF;
+    } else if (name.compare("lbf", Qt::CaseInsensitive) == 0) {
+        unit = UnitValue::LBF;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Parse the interpolation of the merge stage given on the command line
+ *
+ * @param name One of linear or hold, case insensitive
+ * @param mode Parsed interpolation
+ * @return true if the name is valid
+ */
+bool parseInterpolation(const QString& name, comm::Interpolation& mode) {
+    if (name.compare("linear", Qt::CaseInsensitive) == 0) {
+        mode = comm::Interpolation::LINEAR;
+    } else if (name.compare("hold", Qt::CaseInsensitive) == 0) {
+        mode = comm::Interpolation::ZERO_ORDER_HOLD;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Write frames of the shared clock as CSV rows
+ *
+ * @param out Stream of the CSV file
+ * @param frames Frames of the shared clock
+ * @param columns Number of devices per frame
+ * @param forces Force of every device in kN, NaN is written as empty field
+ */
+void writeAlignedFrames(QTextStream& out, const QVector<comm::AlignedFrame>& frames, int columns,
+                        const QVector<double>& forces) {
+    for (int i = 0; i < frames.size(); ++i) {
+        out << frames[i].timestamp << ',' << frames[i].total;
+        for (int column = 0; column < columns; ++column) {
+            double force = forces[i * columns + column];
+            out << ',';
+            if (!std::isnan(force)) {
+                out << force;
+            }
+        }
+        out << '\n';
+    }
+}
+
+}  // namespace
+
+/** @brief Entry point of `linescale-record` */
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("linescale-record");
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Record a LineScale into a binary logfile without GUI.");
+    parser.addHelpOption();
+    parser.addOptions({
+        {"port", "Serial port of a LineScale; repeat for several, the first one is recorded. The first one found "
+                 "if not set.", "name"},
+        {"output", "Binary logfile to write (.lscb); an existing file is replaced.", "file"},
+        {"frequency", "Device frequency: 10, 40, 640 or 1280 Hz.", "hz", "1280"},
+        {"unit", "Device unit: kN, kgf or lbf.", "unit", "kN"},
+        {"duration", "Stop after this time in s, 0 to record until interrupted.", "s", "0"},
+        {"stats", "Print the throughput every n s, 0 to disable.", "s", "1"},
+        {"sync", "Sync the logfile to the disk at most every n ms, negative to never sync.", "ms",
+         QString::number(Recorder::DEFAULT_SYNC_INTERVAL)},
+        {"publish", "Also share the samples in this shared memory ring, e.g. /linescale-samples.", "name"},
+        {"serve", "Also stream the samples to clients of this local socket, e.g. linescale.", "name"},
+        {"merge", "Also write the forces of all devices on a shared clock into this CSV file.", "file"},
+        {"merge-rate", "Frequency of the shared clock of --merge in Hz; --frequency if not set.", "hz"},
+        {"interpolation", "Resampling of --merge: linear or hold.", "mode", "linear"},
+        {"capture", "Also capture the raw bytes of the port into this file, see linescale-reparse.", "file"},
+        {"replay", "Play this logfile instead of reading a device, see --speed.", "file"},
+        {"speed", "Replay speed as multiple of real time, 0 for as fast as possible.", "factor", "1"},
+        {"recover", "Close a logfile whose recording was interrupted and exit.", "file"},
+    });
+    parser.process(app);
+
+    if (parser.isSet("recover")) {
+        if (!Recorder::recover(parser.value("recover"))) {
+            err << "Unable to recover " << parser.value("recover") << Qt::endl;
+            return 1;
+        }
+        return 0;
+    }
+    bool replay = parser.isSet("replay");
+    bool recording = parser.isSet("output");
+    if (!recording && !replay) {
+        err << "No output file, see --help" << Qt::endl;
+        return 1;
+    }
+    int frequency = parser.value("frequency").toInt();
+    if (frequency != 10 && frequency != 40 && frequency != 640 && frequency != 1280) {
+        err << "Unsupported frequency " << frequency << Qt::endl;
+        return 1;
+    }
+    UnitValue unit;
+    if (!parseUnit(parser.value("unit"), unit)) {
+        err << "Unknown unit " << parser.value("unit") << Qt::endl;
+        return 1;
+    }
+
+    comm::CommMaster comm;
+    comm::DeviceInfo device;
+    Metadata metadata{};
+    if (replay) {
+        Logfile logfile;
+        logfile.setPath(parser.value("replay"));
+        if (logfile.loadIndex() != 0) {
+            err << "Unable to load " << parser.value("replay") << Qt::endl;
+            return 1;
+        }
+        metadata = logfile.getMetadata();
+        device.type = comm::ConnType::REPLAY;
+        device.ID = parser.value("replay");
+        device.replaySpeed = parser.value("speed").toDouble();
+    } else if (parser.isSet("port")) {
+        device.type = comm::ConnType::USB;
+        device.ID = parser.values("port").first();
+        device.baudRate = 230400;
+    } else {
+        const QList<comm::DeviceInfo>& available = comm.getAvailableDevices();
+        if (available.isEmpty()) {
+            err << "No LineScale found" << Qt::endl;
+            return 1;
+        }
+        device = available.first();
+    }
+    if (parser.isSet("capture") && !replay) {
+        device.capturePath = parser.value("capture");
+    }
+    QObject::connect(&comm, &comm::CommMaster::errorMaster, [&err](const QString& deviceId, const QString& message) {
+        err << deviceId << ": " << message << Qt::endl;
+    });
+    if (!comm.addConnection(device)) {
+        err << "Unable to connect to " << device.ID << Qt::endl;
+        return 1;
+    }
+    QStringList devices = {device.ID};
+    for (const QString& port : parser.values("port").mid(1)) {
+        if (replay || !comm.addConnection({comm::ConnType::USB, port, 230400})) {
+            err << "Unable to connect to " << port << Qt::endl;
+            return 1;
+        }
+        devices << port;
+    }
+    comm.setActiveDevice(device.ID);
+
+    Recorder recorder;
+    recorder.setSyncInterval(parser.value("sync").toInt());
+    metadata.deviceID = device.ID;
+    metadata.date = QDate::currentDate().toString("dd.MM.yy");
+    metadata.time = QTime::currentTime().toString("HH:mm:ss");
+    if (!replay) {
+        metadata.unit = unit;
+        metadata.speed = frequency;
+    }
+    if (recording) {
+        if (!recorder.start(parser.value("output"), metadata, comm.getDeviceNumber(device.ID))) {
+            err << "Unable to create " << parser.value("output") << Qt::endl;
+            return 1;
+        }
+        QObject::connect(&comm, &comm::CommMaster::newSamplesMaster, &recorder, &Recorder::addSamples);
+    }
+    qint64 received = 0;
+    QObject::connect(&comm, &comm::CommMaster::newSamplesMaster,
+                     [&](const QVector<Sample>& readings) { received += readings.size(); });
+    stream::SamplePublisher publisher;
+    if (parser.isSet("publish")) {
+        if (!publisher.open(parser.value("publish"))) {
+            err << "Unable to share the samples in " << parser.value("publish")
+                << (stream::SamplePublisher::isPublished(parser.value("publish")) ? ", used by another process" : "")
+                << Qt::endl;
+            return 1;
+        }
+        QObject::connect(&comm, &comm::CommMaster::newSamplesMaster, &publisher, &stream::SamplePublisher::publish);
+    }
+    stream::SampleServer server;
+    if (parser.isSet("serve")) {
+        if (!server.listen(parser.value("serve"))) {
+            err << "Unable to serve the samples on " << parser.value("serve") << Qt::endl;
+            return 1;
+        }
+        QObject::connect(&comm, &comm::CommMaster::newSamplesMaster, &server, &stream::SampleServer::publish);
+        QObject::connect(&server, &stream::SampleServer::commandReceived, [&](quint16, const QByteArray& command) {
+            comm.sendData(device.ID, command);
+        });
+        out << "Serving the samples on " << server.getSocketPath() << Qt::endl;
+    }
+    QFile mergeFile(parser.value("merge"));
+    QTextStream merged(&mergeFile);
+    QVector<quint16> mergeColumns;
+    qint64 mergedFrames = 0;
+    if (parser.isSet("merge")) {
+        comm::Interpolation mode;
+        if (!parseInterpolation(parser.value("interpolation"), mode)) {
+            err << "Unknown interpolation " << parser.value("interpolation") << Qt::endl;
+            return 1;
+        }
+        if (!mergeFile.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+            err << "Unable to create " << parser.value("merge") << Qt::endl;
+            return 1;
+        }
+        int rate = parser.isSet("merge-rate") ? parser.value("merge-rate").toInt() : frequency;
+        comm.setMerging(true, mode, rate);
+        QObject::connect(&comm, &comm::CommMaster::newAlignedFrames,
+                         [&](const QVector<comm::AlignedFrame>& frames, const QVector<quint16>& columns,
+                             const QVector<double>& forces) {
+                             if (columns != mergeColumns) {
+                                 // A new header whenever a device joins or leaves
+                                 mergeColumns = columns;
+                                 merged << "timestamp_ns,total_kN";
+                                 for (quint16 number : columns) {
+                                     merged << ',' << comm.getDeviceId(number) << "_kN";
+                                 }
+                                 merged << '\n';
+                             }
+                             writeAlignedFrames(merged, frames, columns.size(), forces);
+                             mergedFrames += frames.size();
+                         });
+    }
+    QObject::connect(&recorder, &Recorder::recordingFailed, [] { QCoreApplication::exit(1); });
+    // The signal only tells if any device is connected, the recorded one is checked on its own
+    QObject::connect(&comm, &comm::CommMaster::changedStateMaster, [&](bool) {
+        if (comm.isConnected(device.ID)) {
+            return;
+        }
+        if (replay) {
+            // Either all samples of the logfile were delivered or it failed, see `errorMaster`
+            QCoreApplication::exit(comm.getReplayStatistics(device.ID).finished ? 0 : 1);
+        } else {
+            err << "Lost the connection to " << device.ID << Qt::endl;
+            QCoreApplication::exit(1);
+        }
+    });
+
+    // Same order as the connect dialog and the start button of the GUI
+    for (const QString& deviceId : devices) {
+        comm.setNewFreq(deviceId, frequency);
+        comm.setNewUnit(deviceId, unit);
+        comm.sendData(deviceId, command::REQUESTONLINE);
+    }
+
+    std::signal(SIGINT, requestStop);
+    std::signal(SIGTERM, requestStop);
+
+    const std::chrono::steady_clock::time_point started = std::chrono::steady_clock::now();
+    qint64 duration = qint64(parser.value("duration").toDouble() * 1000.0);
+    qint64 statsInterval = qint64(parser.value("stats").toDouble() * 1000.0);
+    qint64 lastStats = 0;
+    qint64 lastCount = 0;
+    double lastCpu = cpuSeconds();
+
+    // Polling is cheap compared to the samples and keeps the signal handler trivial
+    QTimer poll;
+    poll.setInterval(100);
+    QObject::connect(&poll, &QTimer::timeout, [&] {
+        qint64 now =
+            std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - started).count();
+        if (stopRequested || (duration > 0 && now >= duration)) {
+            QCoreApplication::quit();
+            return;
+        }
+        if (statsInterval <= 0 || now - lastStats < statsInterval) {
+            return;
+        }
+        double seconds = double(now - lastStats) / 1000.0;
+        double cpuNow = cpuSeconds();
+        double cpu = (cpuNow - lastCpu) / seconds;
+        qint64 count = received;
+        out << QString("%1 s: %2 samples, %3 Hz, %4 missing, %5 % CPU")
+                   .arg(double(now) / 1000.0, 0, 'f', 1)
+                   .arg(count)
+                   .arg(double(count - lastCount) / seconds, 0, 'f', 1)
+                   .arg(comm.getGapStatistics(device.ID).missingSamples)
+                   .arg(cpu * 100.0, 0, 'f', 1)
+            << Qt::endl;
+        lastStats = now;
+        lastCount = count;
+        lastCpu = cpuNow;
+    });
+    poll.start();
+
+    int result = app.exec();
+
+    for (const QString& deviceId : devices) {
+        comm.sendData(deviceId, command::DISCONNECTONLINE);
+    }
+    if (replay) {
+        comm::ReplayStatistics statistics = comm.getReplayStatistics(device.ID);
+        out << QString("Replayed %1 of %2 samples in %3 s: %4 Hz, %5 x real time, %6 ms max lag")
+                   .arg(statistics.samples)
+                   .arg(statistics.total)
+                   .arg(statistics.elapsed, 0, 'f', 3)
+                   .arg(statistics.sampleRate, 0, 'f', 0)
+                   .arg(statistics.speed, 0, 'f', 2)
+                   .arg(statistics.maxLag * 1000.0, 0, 'f', 1)
+            << Qt::endl;
+        if (statistics.bytesLost > 0) {
+            out << QString("%1 bytes of the capture were dropped while capturing").arg(statistics.bytesLost)
+                << Qt::endl;
+        }
+    }
+    if (!device.capturePath.isEmpty()) {
+        comm::CaptureStatistics capture = comm.getCaptureStatistics(device.ID);
+        out << QString("Captured %1 bytes to %2, %3 bytes dropped")
+                   .arg(capture.bytesCaptured)
+                   .arg(device.capturePath)
+                   .arg(capture.bytesDropped)
+            << Qt::endl;
+    }
+    if (mergeFile.isOpen()) {
+        merged.flush();
+        out << "Merged " << mergedFrames << " frames of " << mergeColumns.size() << " devices to "
+            << parser.value("merge") << Qt::endl;
+    }
+    qint64 count = recorder.getSampleCount();
+    if (recording && !recorder.stop()) {
+        err << "Writing to " << parser.value("output") << " failed" << Qt::endl;
+        result = 1;
+    }
+    comm.removeAllConnections();
+    if (recording) {
+        out << "Recorded " << count << " samples to " << parser.value("output") << Qt::endl;
+    }
+    return result;
+}
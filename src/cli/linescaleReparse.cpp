@@ -0,0 +1,216 @@
+/******************************************************************************
+ * Copyright (C) 2023 by Gschwind, Weber, Schoch, Niederberger                *
+ *                                                                            *
+ * This file is part of linescaleGUI.                                         *
+ *                                                                            *
+ * LinescaleGUI is free software: you can redistribute it and/or modify       *
+ * it under the terms of the GNU General Public License as published by       *
+ * the Free Software Foundation, either version 3 of the License, or          *
+ * (at your option) any later version.                                        *
+ *                                                                            *
+ * LinescaleGUI is distributed in the hope that it will be useful,            *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of             *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the               *
+ * GNU General Public License for more details.                               *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License          *
+ * along with linescaleGUI. If not, see <http://www.gnu.org/licenses/>.       *
+ ******************************************************************************/
+/**
+ * @file linescaleReparse.cpp
+ * @authors Gschwind, Weber, Schoch, Niederberger
+ *
+ * @brief Entry point of `linescale-reparse`, the offline analysis of raw captures
+ *
+ * Runs framer and parser over captures written with `DeviceInfo::capturePath`,
+ * e.g. `linescale-reparse /tmp/ttyUSB0-20230512-161425.lsraw`, and reports the
+ * statistics of the frames. Every read is decoded with its recorded arrival
+ * time, so the result, including the timestamps written with `--samples`,
+ * is the same as during the recording. Reads the capture writer had to drop
+ * are reported, the decoder restarts behind them.
+ *
+ */
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QStringList>
+#include <QTextStream>
+#include <algorithm>
+#include "../deviceCommunication/captureReader.h"
+#include "../deviceCommunication/packetDecoder.h"
+
+namespace {
+
+/**
+ * @brief Name of a check of the parser
+ *
+ * @param status Failed check
+ * @return const char* Name as in the source
+ */
+const char* statusName(ParseStatus status) {
+    switch (status) {
+        case ParseStatus::OK:
+            return "OK";
+        case ParseStatus::INVALID_TERMINATOR:
+            return "INVALID_TERMINATOR";
+        case ParseStatus::INVALID_CHECKSUM:
+            return "INVALID_CHECKSUM";
+        case ParseStatus::INVALID_WORKING_MODE:
+            return "INVALID_WORKING_MODE";
+        case ParseStatus::INVALID_MEASURED_VALUE:
+            return "INVALID_MEASURED_VALUE";
+        case ParseStatus::INVALID_MEASURE_MODE:
+            return "INVALID_MEASURE_MODE";
+        case ParseStatus::INVALID_REFERENCE_ZERO:
+            return "INVALID_REFERENCE_ZERO";
+        case ParseStatus::INVALID_UNIT_VALUE:
+            return "INVALID_UNIT_VALUE";
+        case ParseStatus::INVALID_FREQUENCY:
+            return "INVALID_FREQUENCY";
+    }
+    return "UNKNOWN";
+}
+
+/**
+ * @brief Decode one capture and print its statistics
+ *
+ * @param path Path of the capture
+ * @param out Stream of the report
+ * @param samples Stream for the decoded samples, `nullptr` to skip them
+ * @return true if the capture could be read
+ */
+bool reparse(const QString& path, QTextStream& out, QTextStream* samples) {
+    comm::CaptureReader capture;
+    if (!capture.open(path)) {
+        return false;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    comm::PacketDecoder decoder;
+    comm::CaptureRecord record;
+    quint64 reads = 0, parsed = 0, bytesLost = 0, readsLost = 0, drops = 0;
+    quint32 largestRead = 0;
+    qint64 firstArrival = 0, lastArrival = 0, longestPause = 0;
+    while (capture.next(record)) {
+        if (record.isDrop()) {
+            // The stream continues after a hole, the buffered bytes do not belong to the next read
+            bytesLost += record.bytesLost;
+            readsLost += record.readsLost;
+            ++drops;
+            decoder.reset();
+            continue;
+        }
+        if (reads == 0) {
+            firstArrival = record.arrival;
+        } else {
+            longestPause = std::max(longestPause, qint64(record.arrival - lastArrival));
+        }
+        lastArrival = record.arrival;
+        largestRead = std::max(largestRead, record.length);
+        ++reads;
+
+        decoder.write(record.data, record.length);
+        decoder.decode(record.arrival, 1, [&](const Sample* batch, size_t count) {
+            parsed += count;
+            for (size_t i = 0; samples != nullptr && i < count; ++i) {
+                *samples << batch[i].sequence << ' ' << batch[i].timestamp << ' ' << batch[i].measuredValue << ' '
+                         << batch[i].unitValue << ' ' << batch[i].measureMode << ' ' << batch[i].frequency << '\n';
+            }
+        });
+    }
+    double seconds = double(timer.nsecsElapsed()) / 1e9;
+
+    const comm::FramerStatistics& statistics = decoder.getStatistics();
+    out << path << " (" << capture.getDeviceId() << ")" << Qt::endl;
+    out << QString("  capture  %1 s, %2 reads, %3 bytes, largest read %4 bytes, longest pause %5 ms")
+               .arg(double(lastArrival - firstArrival) / 1e9, 0, 'f', 3)
+               .arg(reads)
+               .arg(statistics.bytesReceived)
+               .arg(largestRead)
+               .arg(double(longestPause) / 1e6, 0, 'f', 1)
+        << Qt::endl;
+    out << QString("  frames   %1 extracted, %2 parsed, %3 rejected")
+               .arg(statistics.framesExtracted)
+               .arg(parsed)
+               .arg(statistics.framesRejected)
+        << Qt::endl;
+    QStringList rejections;
+    for (size_t status = 1; status < comm::PacketDecoder::STATUS_COUNT; ++status) {
+        quint64 count = decoder.getRejected(ParseStatus(status));
+        if (count > 0) {
+            rejections << QString("%1 %2").arg(statusName(ParseStatus(status))).arg(count);
+        }
+    }
+    if (!rejections.isEmpty()) {
+        out << "  rejected " << rejections.join(", ") << Qt::endl;
+    }
+    out << QString("  stream   %1 bytes dropped, %2 resyncs")
+               .arg(statistics.bytesDropped)
+               .arg(statistics.resyncEvents)
+        << Qt::endl;
+    if (drops > 0) {
+        out << QString("  lost     %1 bytes in %2 reads, dropped by the capture writer at %3 places")
+                   .arg(bytesLost)
+                   .arg(readsLost)
+                   .arg(drops)
+            << Qt::endl;
+    }
+    if (capture.isTruncated()) {
+        out << "  truncated after " << capture.getOffset() << " of " << capture.getSize() << " bytes" << Qt::endl;
+    }
+    out << QString("  parsed in %1 s, %2 MB/s")
+               .arg(seconds, 0, 'f', 3)
+               .arg(seconds > 0.0 ? double(capture.getSize()) / seconds / 1e6 : 0.0, 0, 'f', 1)
+        << Qt::endl;
+    return true;
+}
+
+}  // namespace
+
+/** @brief Entry point of `linescale-reparse` */
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("linescale-reparse");
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Run framer and parser over raw captures and report the frame statistics.");
+    parser.addHelpOption();
+    parser.addOptions({
+        {"samples", "Write the parsed samples to this file, one line each: sequence, timestamp, force, unit, mode and "
+                    "frequency.",
+         "file"},
+    });
+    parser.addPositionalArgument("captures", "Raw captures (.lsraw) to parse.", "capture...");
+    parser.process(app);
+
+    const QStringList captures = parser.positionalArguments();
+    if (captures.isEmpty()) {
+        err << "No capture, see --help" << Qt::endl;
+        return 1;
+    }
+    QFile samplesFile;
+    QTextStream samples;
+    if (parser.isSet("samples")) {
+        samplesFile.setFileName(parser.value("samples"));
+        if (!samplesFile.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            err << "Unable to create " << samplesFile.fileName() << Qt::endl;
+            return 1;
+        }
+        samples.setDevice(&samplesFile);
+    }
+
+    int result = 0;
+    for (const QString& path : captures) {
+        if (!reparse(path, out, samplesFile.isOpen() ? &samples : nullptr)) {
+            err << "Unable to read the capture " << path << Qt::endl;
+            result = 1;
+        }
+    }
+    samples.flush();
+    return result;
+}
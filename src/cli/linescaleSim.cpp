@@ -0,0 +1,246 @@
+/******************************************************************************
+ * Copyright (C) 2023 by Gschwind, Weber, Schoch, Niederberger                *
+ *                                                                            *
+ * This file is part of linescaleGUI.                                         *
+ *                                                                            *
+ * LinescaleGUI is free software: you can redistribute it and/or modify       *
+ * it under the terms of the GNU General Public License as published by       *
+ * the Free Software Foundation, either version 3 of the License, or          *
+ * (at your option) any later version.                                        *
+ *                                                                            *
+ * LinescaleGUI is distributed in the hope that it will be useful,            *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of             *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the               *
+ * GNU General Public License for more details.                               *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License          *
+ * along with linescaleGUI. If not, see <http://www.gnu.org/licenses/>.       *
+ ******************************************************************************/
+/**
+ * @file linescaleSim.cpp
+ * @authors Gschwind, Weber, Schoch, Niederberger
+ *
+ * @brief Entry point of `linescale-sim`, a LineScale simulated on a pseudo terminal
+ *
+ * Creates a pseudo terminal which behaves like the serial port of a LineScale.
+ * Connect the GUI to the printed port, e.g. with
+ * `LINESCALE_DEBUG_PORTS=/dev/pts/5 linescaleGUI`.
+ *
+ */
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QHash>
+#include <QTextStream>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include "../deviceCommunication/command.h"
+#include "../logfile/logfile.h"
+#include "../simulator/frameGenerator.h"
+
+#if defined(Q_OS_UNIX)
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdlib>
+#endif
+
+namespace {
+
+/**
+ * @brief Parse the waveform name given on the command line
+ *
+ * @param name One of constant, sine, ramp or noise
+ * @param waveform Parsed waveform
+ * @return true if the name is valid
+ */
+bool parseWaveform(const QString& name, sim::Waveform& waveform) {
+    if (name == "constant") {
+        waveform = sim::Waveform::CONSTANT;
+    } else if (name == "sine") {
+        waveform = sim::Waveform::SINE;
+    } else if (name == "ramp") {
+        waveform = sim::Waveform::RAMP;
+    } else if (name == "noise") {
+        waveform = sim::Waveform::NOISE;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+#if defined(Q_OS_UNIX)
+/**
+ * @brief Write all bytes, waiting if the pseudo terminal is full
+ *
+ * @return false if the pseudo terminal was closed
+ */
+bool writeAll(int fd, const QByteArray& data) {
+    const char* begin = data.constData();
+    qint64 remaining = data.size();
+    while (remaining > 0) {
+        ssize_t written = ::write(fd, begin, size_t(remaining));
+        if (written < 0) {
+            if (errno == EAGAIN || errno == EINTR) {
+                std::this_thread::sleep_for(std::chrono::microseconds(200));
+                continue;
+            }
+            return false;
+        }
+        begin += written;
+        remaining -= written;
+    }
+    return true;
+}
+#endif
+
+}  // namespace
+
+/** @brief Entry point of `linescale-sim` */
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("linescale-sim");
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Simulate a LineScale on a pseudo terminal.");
+    parser.addHelpOption();
+    parser.addOptions({
+        {"frequency", "Initial device frequency: 10, 40, 640 or 1280 Hz.", "hz", "10"},
+        {"rate", "Send frames at this rate in Hz instead of the device frequency, for stress tests.", "hz", "0"},
+        {"waveform", "Signal: constant, sine, ramp or noise.", "name", "sine"},
+        {"offset", "Offset of the signal in kN.", "kN", "0"},
+        {"amplitude", "Amplitude of the signal in kN.", "kN", "1"},
+        {"period", "Period of the signal in s.", "s", "2"},
+        {"replay", "Replay the forces of a logfile instead of a signal.", "file"},
+        {"corrupt", "Probability of a corrupted frame, 0 to 1.", "rate", "0"},
+        {"split", "Write random chunks of 1 to n bytes.", "n", "0"},
+        {"burst", "Send n frames at once.", "n", "1"},
+        {"seed", "Seed of the random generator.", "n", "1"},
+        {"online", "Stream without waiting for the online request of the host."},
+        {"link", "Create a symlink to the pseudo terminal.", "path"},
+    });
+    parser.process(app);
+
+    sim::SimulatorConfig config;
+    if (!parseWaveform(parser.value("waveform"), config.waveform)) {
+        err << "Unknown waveform " << parser.value("waveform") << Qt::endl;
+        return 1;
+    }
+    config.offset = parser.value("offset").toDouble();
+    config.amplitude = parser.value("amplitude").toDouble();
+    config.period = parser.value("period").toDouble();
+    config.corruptionRate = parser.value("corrupt").toDouble();
+    config.maxChunk = parser.value("split").toInt();
+    config.burstFrames = qMax(1, parser.value("burst").toInt());
+    config.seed = parser.value("seed").toUInt();
+    sim::FrameGenerator generator(config);
+
+    if (parser.isSet("replay")) {
+        Logfile logfile;
+        logfile.setPath(parser.value("replay"));
+        int result = logfile.load();
+        if (result != 0) {
+            err << "Unable to load " << parser.value("replay") << " (line " << result << ")" << Qt::endl;
+            return 1;
+        }
+        generator.setReplay(logfile.getForce(), logfile.getMetadata().unit);
+    }
+
+    // Apply the initial settings the same way the host would
+    const QHash<int, QByteArray> speedCommands = {{10, command::SETSPEED10},
+                                                  {40, command::SETSPEED40},
+                                                  {640, command::SETSPEED640},
+                                                  {1280, command::SETSPEED1280}};
+    int frequency = parser.value("frequency").toInt();
+    if (!speedCommands.contains(frequency)) {
+        err << "Unsupported frequency " << frequency << Qt::endl;
+        return 1;
+    }
+    generator.receive(speedCommands.value(frequency));
+    if (parser.isSet("online")) {
+        generator.receive(command::REQUESTONLINE);
+    }
+
+#if defined(Q_OS_UNIX)
+    int master = posix_openpt(O_RDWR | O_NOCTTY);
+    if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0) {
+        err << "Unable to create a pseudo terminal" << Qt::endl;
+        return 1;
+    }
+    QString portName = QString::fromLocal8Bit(ptsname(master));
+
+    // Keep the slave open in raw mode, so the line discipline does not alter the frames
+    // and the master does not see a hang-up while no host is connected
+    int slave = ::open(ptsname(master), O_RDWR | O_NOCTTY);
+    termios settings;
+    if (slave < 0 || tcgetattr(slave, &settings) != 0) {
+        err << "Unable to open " << portName << Qt::endl;
+        return 1;
+    }
+    cfmakeraw(&settings);
+    tcsetattr(slave, TCSANOW, &settings);
+    fcntl(master, F_SETFL, fcntl(master, F_GETFL) | O_NONBLOCK);
+
+    if (parser.isSet("link")) {
+        QByteArray link = parser.value("link").toLocal8Bit();
+        ::unlink(link.constData());
+        if (::symlink(ptsname(master), link.constData()) != 0) {
+            err << "Unable to create the link " << parser.value("link") << Qt::endl;
+        }
+    }
+    out << portName << Qt::endl;
+
+    using clock = std::chrono::steady_clock;
+    double rate = parser.value("rate").toDouble();
+    auto start = clock::now();
+    uint64_t sent = 0;
+    bool wasOnline = generator.isOnline();
+    char input[256];
+
+    while (!generator.isPoweredOff()) {
+        pollfd descriptor{master, POLLIN, 0};
+        if (poll(&descriptor, 1, 1) > 0 && (descriptor.revents & POLLIN)) {
+            ssize_t received = ::read(master, input, sizeof(input));
+            if (received > 0) {
+                generator.receive(QByteArray(input, int(received)));
+            }
+        }
+
+        if (!generator.isOnline()) {
+            wasOnline = false;
+            continue;
+        }
+        if (!wasOnline) {
+            // Restart the schedule, otherwise the paused time would be sent at once
+            wasOnline = true;
+            start = clock::now();
+            sent = 0;
+        }
+
+        double frameRate = rate > 0.0 ? rate : double(generator.getFrequency());
+        double elapsed = std::chrono::duration<double>(clock::now() - start).count();
+        uint64_t due = uint64_t(elapsed * frameRate);
+        while (due - sent >= uint64_t(config.burstFrames)) {
+            QByteArray frames = generator.nextFrames(config.burstFrames);
+            for (const QByteArray& chunk : generator.split(frames)) {
+                if (!writeAll(master, chunk)) {
+                    return 0;
+                }
+            }
+            sent += uint64_t(config.burstFrames);
+        }
+    }
+
+    ::close(slave);
+    ::close(master);
+    return 0;
+#else
+    err << "Pseudo terminals are only available on Unix" << Qt::endl;
+    return 1;
+#endif
+}
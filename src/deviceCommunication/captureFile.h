@@ -0,0 +1,91 @@
+/******************************************************************************
+ * Copyright (C) 2023 by Gschwind, Weber, Schoch, Niederberger                *
+ *                                                                            *
+ * This file is part of linescaleGUI.                                         *
+ *                                                                            *
+ * LinescaleGUI is free software: you can redistribute it and/or modify       *
+ * it under the terms of the GNU General Public License as published by       *
+ * the Free Software Foundation, either version 3 of the License, or          *
+ * (at your option) any later version.                                        *
+ *                                                                            *
+ * LinescaleGUI is distributed in the hope that it will be useful,            *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of             *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the               *
+ * GNU General Public License for more details.                               *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License          *
+ * along with linescaleGUI. If not, see <http://www.gnu.org/licenses/>.       *
+ ******************************************************************************/
+/**
+ * @file captureFile.h
+ * @authors Gschwind, Weber, Schoch, Niederberger
+ *
+ * @brief Layout of the raw capture files written by `CaptureWriter`
+ *
+ * A capture holds every byte read from a serial port together with the time
+ * it was read, so the framing and parsing can be repeated offline exactly as
+ * they happened. All values are little endian:
+ *
+ * | Size | Content                                               |
+ * |------|-------------------------------------------------------|
+ * | 4    | `CAPTURE_MAGIC`                                       |
+ * | 2    | `CAPTURE_VERSION`                                     |
+ * | 2    | Length n of the device ID                             |
+ * | n    | `DeviceInfo::ID` of the captured device, UTF-8        |
+ *
+ * followed by one record per read until the end of the file:
+ *
+ * | Size | Content                                               |
+ * |------|-------------------------------------------------------|
+ * | 8    | Arrival time in ns, see `SampleClock::now`            |
+ * | 4    | Length m of the read                                  |
+ * | m    | Bytes as read from the port                           |
+ *
+ * Reads the writer had to drop are replaced by a single drop record in front
+ * of the next read which was written again:
+ *
+ * | Size | Content                                               |
+ * |------|-------------------------------------------------------|
+ * | 8    | Arrival time of the first dropped read in ns          |
+ * | 4    | `CAPTURE_DROP_LENGTH`                                 |
+ * | 8    | Number of dropped bytes                               |
+ * | 4    | Number of dropped reads                               |
+ *
+ * A capture that was not closed ends with at most one incomplete record.
+ *
+ */
+
+#pragma once
+#ifndef CAPTUREFILE_H_
+#define CAPTUREFILE_H_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace comm {
+
+constexpr uint32_t CAPTURE_MAGIC = 0x5752534c;        ///< "LSRW" in little endian
+constexpr uint16_t CAPTURE_VERSION = 1;               ///< Incremented with every change of the layout
+constexpr size_t CAPTURE_HEADER_SIZE = 8;             ///< Bytes in front of the device ID
+constexpr size_t CAPTURE_RECORD_HEADER_SIZE = 12;     ///< Bytes in front of the data of a record
+constexpr uint32_t CAPTURE_DROP_LENGTH = 0xffffffff;  ///< Length of a drop record, never the length of a read
+constexpr size_t CAPTURE_DROP_SIZE = 12;              ///< Bytes of a drop record behind its record header
+constexpr char CAPTURE_SUFFIX[] = "lsraw";            ///< Suffix of capture files
+
+/**
+ * @brief One read of a capture, or the reads dropped in front of the next one
+ *
+ */
+struct CaptureRecord {
+    int64_t arrival = 0;         ///< Time of the read in ns, see `SampleClock::now`
+    const char* data = nullptr;  ///< Bytes of the read, valid while the capture is open
+    uint32_t length = 0;         ///< Number of bytes, 0 for a drop record
+    uint64_t bytesLost = 0;      ///< Dropped bytes of a drop record, 0 for a read
+    uint32_t readsLost = 0;      ///< Dropped reads of a drop record, 0 for a read
+
+    bool isDrop() const { return readsLost > 0; }  ///< True for a drop record
+};
+
+}  // namespace comm
+
+#endif  // CAPTUREFILE_H_
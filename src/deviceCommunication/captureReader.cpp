@@ -0,0 +1,110 @@
+/******************************************************************************
+ * Copyright (C) 2023 by Gschwind, Weber, Schoch, Niederberger                *
+ *                                                                            *
+ * This file is part of linescaleGUI.                                         *
+ *                                                                            *
+ * LinescaleGUI is free software: you can redistribute it and/or modify       *
+ * it under the terms of the GNU General Public License as published by       *
+ * the Free Software Foundation, either version 3 of the License, or          *
+ * (at your option) any later version.                                        *
+ *                                                                            *
+ * LinescaleGUI is distributed in the hope that it will be useful,            *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of             *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the               *
+ * GNU General Public License for more details.                               *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License          *
+ * along with linescaleGUI. If not, see <http://www.gnu.org/licenses/>.       *
+ ******************************************************************************/
+/**
+ * @file captureReader.cpp
+ * @authors Gschwind, Weber, Schoch, Niederberger
+ *
+ * @brief `comm::CaptureReader` implementation
+ */
+
+#include "captureReader.h"
+#include <QtEndian>
+
+namespace comm {
+
+CaptureReader::~CaptureReader() {
+    close();
+}
+
+bool CaptureReader::open(const QString& path) {
+    close();
+    file.setFileName(path);
+    if (!file.open(QIODevice::ReadOnly) || file.size() < qint64(CAPTURE_HEADER_SIZE)) {
+        file.close();
+        return false;
+    }
+    const char* mapped = reinterpret_cast<const char*>(file.map(0, file.size()));
+    if (mapped == nullptr) {
+        file.close();
+        return false;
+    }
+    const char* mappedEnd = mapped + file.size();
+    size_t idLength = qFromLittleEndian<quint16>(mapped + 6);
+    if (qFromLittleEndian<quint32>(mapped) != CAPTURE_MAGIC ||
+        qFromLittleEndian<quint16>(mapped + 4) != CAPTURE_VERSION ||
+        size_t(mappedEnd - mapped) < CAPTURE_HEADER_SIZE + idLength) {
+        file.close();  // Also unmaps
+        return false;
+    }
+
+    deviceId = QString::fromUtf8(mapped + CAPTURE_HEADER_SIZE, int(idLength));
+    begin = mapped;
+    end = mappedEnd;
+    first = mapped + CAPTURE_HEADER_SIZE + idLength;
+    cursor = first;
+    hasNext = true;
+    return true;
+}
+
+void CaptureReader::close() {
+    file.close();
+    begin = end = cursor = first = nullptr;
+    deviceId.clear();
+}
+
+bool CaptureReader::next(CaptureRecord& record) {
+    if (cursor == nullptr || size_t(end - cursor) < CAPTURE_RECORD_HEADER_SIZE) {
+        hasNext = false;
+        return false;
+    }
+    quint32 length = qFromLittleEndian<quint32>(cursor + 8);
+    if (size_t(end - cursor) - CAPTURE_RECORD_HEADER_SIZE < length) {
+        hasNext = false;
+        return false;
+    }
+    record.arrival = qFromLittleEndian<qint64>(cursor);
+    if (length == CAPTURE_DROP_LENGTH) {
+        const char* drop = cursor + CAPTURE_RECORD_HEADER_SIZE;
+        if (size_t(end - drop) < CAPTURE_DROP_SIZE) {
+            hasNext = false;
+            return false;
+        }
+        record.data = nullptr;
+        record.length = 0;
+        record.bytesLost = qFromLittleEndian<quint64>(drop);
+        record.readsLost = qFromLittleEndian<quint32>(drop + 8);
+        cursor = drop + CAPTURE_DROP_SIZE;
+        return true;
+    }
+    record.length = length;
+    record.data = cursor + CAPTURE_RECORD_HEADER_SIZE;
+    record.bytesLost = 0;
+    record.readsLost = 0;
+    cursor = record.data + length;
+    return true;
+}
+
+void CaptureReader::setOffset(qint64 offset) {
+    if (begin != nullptr) {
+        cursor = begin + qBound(qint64(first - begin), offset, getSize());
+        hasNext = true;
+    }
+}
+
+}  // namespace comm
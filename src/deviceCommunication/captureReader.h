@@ -0,0 +1,109 @@
+/******************************************************************************
+ * Copyright (C) 2023 by Gschwind, Weber, Schoch, Niederberger                *
+ *                                                                            *
+ * This file is part of linescaleGUI.                                         *
+ *                                                                            *
+ * LinescaleGUI is free software: you can redistribute it and/or modify       *
+ * it under the terms of the GNU General Public License as published by       *
+ * the Free Software Foundation, either version 3 of the License, or          *
+ * (at your option) any later version.                                        *
+ *                                                                            *
+ * LinescaleGUI is distributed in the hope that it will be useful,            *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of             *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the               *
+ * GNU General Public License for more details.                               *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License          *
+ * along with linescaleGUI. If not, see <http://www.gnu.org/licenses/>.       *
+ ******************************************************************************/
+/**
+ * @file captureReader.h
+ * @authors Gschwind, Weber, Schoch, Niederberger
+ *
+ * @brief `comm::CaptureReader` declaration
+ *
+ */
+
+#pragma once
+#ifndef CAPTUREREADER_H_
+#define CAPTUREREADER_H_
+
+#include <QFile>
+#include <QString>
+#include "captureFile.h"
+
+namespace comm {
+
+/**
+ * @brief Read the records of a capture file written by `CaptureWriter`
+ *
+ * The file is memory mapped, the records point straight into the mapping.
+ */
+class CaptureReader {
+   public:
+    CaptureReader() = default;
+    CaptureReader(const CaptureReader&) = delete;
+    CaptureReader& operator=(const CaptureReader&) = delete;
+
+    /**
+     * @brief Unmap the file
+     *
+     */
+    ~CaptureReader();
+
+    /**
+     * @brief Map a capture and check its header
+     *
+     * @param path Path of the capture
+     * @return true if the file is a capture of `CAPTURE_VERSION`
+     */
+    bool open(const QString& path);
+
+    /**
+     * @brief Unmap the file
+     *
+     */
+    void close();
+
+    /**
+     * @brief Read the next record
+     *
+     * Drop records are returned like reads, see `CaptureRecord::isDrop`.
+     *
+     * @param record Next record, its data points into the mapping
+     * @return true if a complete record was read; false at the end
+     */
+    bool next(CaptureRecord& record);
+
+    bool isOpen() const { return begin != nullptr; }  ///< True between `open` and `close`
+    QString getDeviceId() const { return deviceId; }  ///< `DeviceInfo::ID` of the captured device
+    qint64 getSize() const { return end - begin; }    ///< Size of the file in bytes
+    qint64 getOffset() const { return cursor - begin; }  ///< Position of the next record in bytes
+
+    /**
+     * @brief Continue reading at a record
+     *
+     * @param offset Position of a record, see `getOffset`
+     */
+    void setOffset(qint64 offset);
+
+    /**
+     * @brief Check if the capture ends with an incomplete record, e.g. after a crash
+     *
+     * @return true if `next` stopped in front of bytes which do not form a record
+     */
+    bool isTruncated() const { return cursor != end && !hasNext; }
+
+   private:
+    QFile file;
+    QString deviceId;
+    const char* begin = nullptr;   ///< Start of the mapping
+    const char* end = nullptr;     ///< End of the mapping
+    const char* cursor = nullptr;  ///< Next record
+    const char* first = nullptr;   ///< First record, behind the header
+    bool hasNext = true;           ///< False after `next` found no further record
+};
+
+}  // namespace comm
+
+#endif  // CAPTUREREADER_H_
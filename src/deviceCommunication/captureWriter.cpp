@@ -0,0 +1,154 @@
+/******************************************************************************
+ * Copyright (C) 2023 by Gschwind, Weber, Schoch, Niederberger                *
+ *                                                                            *
+ * This file is part of linescaleGUI.                                         *
+ *                                                                            *
+ * LinescaleGUI is free software: you can redistribute it and/or modify       *
+ * it under the terms of the GNU General Public License as published by       *
+ * the Free Software Foundation, either version 3 of the License, or          *
+ * (at your option) any later version.                                        *
+ *                                                                            *
+ * LinescaleGUI is distributed in the hope that it will be useful,            *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of             *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the               *
+ * GNU General Public License for more details.                               *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License          *
+ * along with linescaleGUI. If not, see <http://www.gnu.org/licenses/>.       *
+ ******************************************************************************/
+/**
+ * @file captureWriter.cpp
+ * @authors Gschwind, Weber, Schoch, Niederberger
+ *
+ * @brief `comm::CaptureWriter` implementation
+ */
+
+#include "captureWriter.h"
+#include <QtEndian>
+#include <array>
+
+namespace comm {
+
+CaptureWriter::~CaptureWriter() {
+    close();
+}
+
+bool CaptureWriter::open(const QString& path, const QString& deviceId) {
+    close();
+    file.setFileName(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return false;
+    }
+
+    QByteArray id = deviceId.toUtf8().left(0xffff);
+    std::array<uchar, CAPTURE_HEADER_SIZE> header;
+    qToLittleEndian<quint32>(CAPTURE_MAGIC, header.data());
+    qToLittleEndian<quint16>(CAPTURE_VERSION, header.data() + 4);
+    qToLittleEndian<quint16>(quint16(id.size()), header.data() + 6);
+    if (file.write(reinterpret_cast<const char*>(header.data()), qint64(header.size())) != qint64(header.size()) ||
+        file.write(id) != id.size()) {
+        file.close();
+        return false;
+    }
+
+    bytesCaptured = 0;
+    bytesDropped = 0;
+    readsDropped = 0;
+    lostBytes = 0;
+    lostReads = 0;
+    failed = false;
+    stopRequested = false;
+    writeBuffer.resize(64 * 1024);
+    thread = QThread::create([this] { run(); });
+    thread->setObjectName("capture " + deviceId);
+    thread->start(QThread::LowPriority);
+    return true;
+}
+
+void CaptureWriter::close() {
+    if (thread == nullptr) {
+        return;
+    }
+    stopRequested = true;
+    thread->wait();
+    delete thread;
+    thread = nullptr;
+    if (lostReads > 0) {
+        // Dropped at the end, the queue is empty now
+        std::array<char, CAPTURE_RECORD_HEADER_SIZE + CAPTURE_DROP_SIZE> record;
+        encodeDrop(record);
+        if (file.write(record.data(), qint64(record.size())) != qint64(record.size())) {
+            failed = true;
+        }
+        lostReads = 0;
+        lostBytes = 0;
+    }
+    file.close();
+}
+
+void CaptureWriter::append(int64_t arrival, const char* data, size_t length) {
+    if (thread == nullptr || length == 0) {
+        return;
+    }
+    // Whole records only, a partial record would corrupt the rest of the file
+    std::array<char, CAPTURE_RECORD_HEADER_SIZE + CAPTURE_DROP_SIZE> drop;
+    size_t needed = CAPTURE_RECORD_HEADER_SIZE + length + (lostReads > 0 ? drop.size() : 0);
+    if (queue.capacity() - queue.size() < needed) {
+        if (lostReads == 0) {
+            lostArrival = arrival;
+        }
+        lostBytes += length;
+        ++lostReads;
+        bytesDropped.fetch_add(length, std::memory_order_relaxed);
+        readsDropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    if (lostReads > 0) {
+        encodeDrop(drop);
+        queue.push(drop.data(), drop.size());
+        lostBytes = 0;
+        lostReads = 0;
+    }
+    std::array<char, CAPTURE_RECORD_HEADER_SIZE> header;
+    qToLittleEndian<qint64>(arrival, header.data());
+    qToLittleEndian<quint32>(quint32(length), header.data() + 8);
+    queue.push(header.data(), header.size());
+    queue.push(data, length);
+    bytesCaptured.fetch_add(length, std::memory_order_relaxed);
+}
+
+void CaptureWriter::encodeDrop(std::array<char, CAPTURE_RECORD_HEADER_SIZE + CAPTURE_DROP_SIZE>& record) const {
+    qToLittleEndian<qint64>(lostArrival, record.data());
+    qToLittleEndian<quint32>(CAPTURE_DROP_LENGTH, record.data() + 8);
+    qToLittleEndian<quint64>(lostBytes, record.data() + CAPTURE_RECORD_HEADER_SIZE);
+    qToLittleEndian<quint32>(lostReads, record.data() + CAPTURE_RECORD_HEADER_SIZE + 8);
+}
+
+CaptureStatistics CaptureWriter::getStatistics() const {
+    CaptureStatistics statistics;
+    statistics.bytesCaptured = bytesCaptured.load(std::memory_order_relaxed);
+    statistics.bytesDropped = bytesDropped.load(std::memory_order_relaxed);
+    statistics.readsDropped = readsDropped.load(std::memory_order_relaxed);
+    statistics.failed = failed;
+    return statistics;
+}
+
+void CaptureWriter::run() {
+    while (!stopRequested) {
+        writeQueued();
+        QThread::msleep(WRITE_INTERVAL_MS);
+    }
+    writeQueued();  // Everything appended before `close`
+}
+
+void CaptureWriter::writeQueued() {
+    size_t taken;
+    while ((taken = queue.pop(writeBuffer.data(), writeBuffer.size())) > 0) {
+        if (!failed && file.write(writeBuffer.data(), qint64(taken)) != qint64(taken)) {
+            failed = true;
+        }
+    }
+    file.flush();
+}
+
+}  // namespace comm
@@ -0,0 +1,162 @@
+/******************************************************************************
+ * Copyright (C) 2023 by Gschwind, Weber, Schoch, Niederberger                *
+ *                                                                            *
+ * This file is part of linescaleGUI.                                         *
+ *                                                                            *
+ * LinescaleGUI is free software: you can redistribute it and/or modify       *
+ * it under the terms of the GNU General Public License as published by       *
+ * the Free Software Foundation, either version 3 of the License, or          *
+ * (at your option) any later version.                                        *
+ *                                                                            *
+ * LinescaleGUI is distributed in the hope that it will be useful,            *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of             *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the               *
+ * GNU General Public License for more details.                               *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License          *
+ * along with linescaleGUI. If not, see <http://www.gnu.org/licenses/>.       *
+ ******************************************************************************/
+/**
+ * @file captureWriter.h
+ * @authors Gschwind, Weber, Schoch, Niederberger
+ *
+ * @brief `comm::CaptureWriter` declaration
+ *
+ */
+
+#pragma once
+#ifndef CAPTUREWRITER_H_
+#define CAPTUREWRITER_H_
+
+#include <QFile>
+#include <QString>
+#include <QThread>
+#include <array>
+#include <atomic>
+#include <vector>
+#include "captureFile.h"
+#include "spscQueue.h"
+
+namespace comm {
+
+/**
+ * @brief Counters of a raw capture
+ *
+ */
+struct CaptureStatistics {
+    uint64_t bytesCaptured = 0;   ///< Bytes of the reads handed to the writer
+    uint64_t bytesDropped = 0;    ///< Bytes of the reads dropped because the writer fell behind
+    uint64_t readsDropped = 0;    ///< Reads dropped because the writer fell behind
+    bool failed = false;          ///< True if writing to the file failed
+};
+
+/**
+ * @brief Write every byte read from a device into a capture file
+ *
+ * `append` is called by the I/O thread right after each read. It copies the
+ * read once into a preallocated lock-free queue and returns; it never
+ * allocates, locks or touches the disk. A thread of the writer moves the
+ * queued bytes into the file, see `captureFile.h` for the layout.
+ *
+ * If the disk cannot keep up, whole reads are dropped and counted; the
+ * acquisition itself is never slowed down. Once the queue has space again, a
+ * drop record with the lost bytes is written in front of the next read, so
+ * a reparse of the capture knows where the stream is incomplete.
+ */
+class CaptureWriter {
+   public:
+    static constexpr size_t QUEUE_CAPACITY = 4 << 20;  ///< Bytes queued for the writer, about 160 s at 1280 Hz
+    static constexpr int WRITE_INTERVAL_MS = 50;       ///< Time between two writes to the file
+
+    CaptureWriter() = default;
+    CaptureWriter(const CaptureWriter&) = delete;
+    CaptureWriter& operator=(const CaptureWriter&) = delete;
+
+    /**
+     * @brief Write the queued bytes and close the file
+     *
+     */
+    ~CaptureWriter();
+
+    /**
+     * @brief Create the capture file and start the writer thread
+     *
+     * An existing file is replaced.
+     *
+     * @param path Path of the capture, usually with `CAPTURE_SUFFIX`
+     * @param deviceId `DeviceInfo::ID` of the captured device
+     * @return true if the file was created
+     */
+    bool open(const QString& path, const QString& deviceId);
+
+    /**
+     * @brief Write the queued bytes and close the file
+     *
+     * Reads dropped after the last queued one get their drop record here.
+     * Must not be called while `append` runs.
+     */
+    void close();
+
+    bool isOpen() const { return thread != nullptr; }  ///< True between `open` and `close`
+    QString getPath() const { return file.fileName(); }  ///< Path of the capture
+
+    /**
+     * @brief Queue one read for the file
+     *
+     * Called from a single thread, usually the I/O thread of the device.
+     * Ignored if not open.
+     *
+     * @param arrival Time of the read, see `SampleClock::now`
+     * @param data Bytes as read from the device
+     * @param length Number of bytes
+     */
+    void append(int64_t arrival, const char* data, size_t length);
+
+    /**
+     * @brief Get the counters of the capture
+     *
+     * Safe to call from any thread.
+     *
+     * @return CaptureStatistics Counters since `open`
+     */
+    CaptureStatistics getStatistics() const;
+
+   private:
+    /**
+     * @brief Body of the writer thread, writes until `stopRequested`
+     *
+     */
+    void run();
+
+    /**
+     * @brief Move all queued bytes into the file
+     *
+     */
+    void writeQueued();
+
+    /**
+     * @brief Encode the drop record of the reads dropped since the last queued read
+     *
+     * @param record Record header and drop record
+     */
+    void encodeDrop(std::array<char, CAPTURE_RECORD_HEADER_SIZE + CAPTURE_DROP_SIZE>& record) const;
+
+    QFile file;                   ///< Only used by the writer thread while open
+    QThread* thread = nullptr;    ///< Runs `run` while open
+    std::atomic<bool> stopRequested{false};
+    SpscQueue<char> queue{QUEUE_CAPACITY};  ///< Records from `append` to the writer thread
+    std::vector<char> writeBuffer;          ///< Bytes taken from `queue`, reused for every write
+
+    std::atomic<uint64_t> bytesCaptured{0};  ///< Written by `append`
+    std::atomic<uint64_t> bytesDropped{0};   ///< Written by `append`
+    std::atomic<uint64_t> readsDropped{0};   ///< Written by `append`
+    std::atomic<bool> failed{false};         ///< Written by the writer thread
+
+    int64_t lostArrival = 0;  ///< Arrival of the first read without drop record, only used by `append`
+    uint64_t lostBytes = 0;   ///< Bytes dropped without drop record, only used by `append`
+    uint32_t lostReads = 0;   ///< Reads dropped without drop record, only used by `append`
+};
+
+}  // namespace comm
+
+#endif  // CAPTUREWRITER_H_
@@ -30,7 +30,9 @@
 
 #include <QDebug>
 #include <QObject>
+#include <QVector>
 #include "../parser/parser.h"
+#include "spscQueue.h"
 
 /**
  * @brief Namespace for everything related to the communication.
@@ -43,8 +45,18 @@ namespace comm {
  *
  */
 enum class ConnType {
-    BLE,  ///< Bluetooth low energy
-    USB,  ///< Serial port via USB-mini
+    BLE,     ///< Bluetooth low energy
+    USB,     ///< Serial port via USB-mini
+    REPLAY,  ///< Logfile played through the live path, see `ReplayDevice`
+};
+
+/**
+ * @brief Enum to describe in which thread a connection reads its data
+ *
+ */
+enum class AcquisitionMode {
+    MAIN_THREAD,  ///< Read on the main thread, every read is emitted as one batch
+    IO_THREAD,    ///< Read on a dedicated thread, samples are queued for `CommDevice::takeSamples`
 };
 
 /**
@@ -54,8 +66,11 @@ enum class ConnType {
  */
 struct DeviceInfo {
     ConnType type;  ///< Type of connection
-    QString ID;     ///< Identifier of a given connection; e.g. COM101
+    QString ID;     ///< Identifier of a given connection; e.g. COM101, or the path of a replayed logfile
     int baudRate;   ///< Baudrate, used by USB connection
+    AcquisitionMode mode = AcquisitionMode::IO_THREAD;  ///< Thread used to read the data
+    double replaySpeed = 1.0;  ///< Multiple of real time of a `ConnType::REPLAY`, 0 for as fast as possible
+    QString capturePath;       ///< Capture every byte read from a `ConnType::USB` into this file; empty to disable
 };
 
 /**
@@ -132,13 +147,57 @@ class CommDevice : public QObject {
      */
     bool getStatus() const { return connected; };
 
+    /**
+     * @brief Get the thread in which the connection reads its data
+     *
+     * @return AcquisitionMode of this connection
+     */
+    AcquisitionMode getAcquisitionMode() const { return mode; };
+
+    /**
+     * @brief Take the samples queued by the I/O thread
+     *
+     * Only used in `AcquisitionMode::IO_THREAD`; must always be called from the
+     * same thread, usually the GUI thread.
+     *
+     * @param samples Caller provided array for the samples
+     * @param maxCount Maximum number of samples to take
+     * @return size_t Number of samples written to `samples`
+     */
+    size_t takeSamples(Sample* samples, size_t maxCount) { return sampleQueue.pop(samples, maxCount); };
+
+    /**
+     * @brief Get the number of samples lost because the consumer did not keep up
+     *
+     * @return size_t Number of samples dropped by the queue
+     */
+    size_t getLostSamples() const { return sampleQueue.dropped(); };
+
+    /**
+     * @brief Set the number written to `Sample::deviceId` of every sample
+     *
+     * Must be set before `connectDevice` is called.
+     *
+     * @param number Device number assigned by the `CommMaster`
+     */
+    void setDeviceNumber(uint16_t number) { deviceNumber = number; };
+
+    /**
+     * @brief Get the number written to `Sample::deviceId`
+     *
+     * @return uint16_t Device number assigned by the `CommMaster`
+     */
+    uint16_t getDeviceNumber() const { return deviceNumber; };
+
    signals:
     /**
-     * @brief Emit after a package was received and parsed
+     * @brief Emit after one read of the device was parsed
+     *
+     * Only emitted in `AcquisitionMode::MAIN_THREAD`.
      *
-     * @param reading A new `Parser::Sample` from the device
+     * @param readings All samples parsed from the read, oldest first
      */
-    void newSampleDevice(Sample reading);
+    void newSamplesDevice(const QVector<Sample>& readings);
 
     /**
      * @brief Emit after connection / disconnection to trigger UI changes
@@ -147,13 +206,43 @@ class CommDevice : public QObject {
      */
     void changedStateDevice(bool connected);
 
+    /**
+     * @brief Emit if the device failed in a way the user has to know about
+     *
+     * @param message Description for the user
+     */
+    void errorDevice(const QString& message);
+
    protected:
-    int freq = 10;                  ///< Sample frequency of the connection
-    QString identifier;             ///< Unique identifier
-    ConnType type = ConnType::USB;  ///< USB or BLE
-    bool connected;
-    Parser parser;
+    /**
+     * @brief Hand parsed samples to the consumer
+     *
+     * Emits all samples as one `newSamplesDevice` in `AcquisitionMode::MAIN_THREAD`,
+     * otherwise the samples are queued without any locking or signal dispatch.
+     *
+     * @param samples Parsed samples
+     * @param count Number of samples
+     */
+    void deliverSamples(const Sample* samples, size_t count) {
+        if (mode == AcquisitionMode::IO_THREAD) {
+            sampleQueue.push(samples, count);
+            return;
+        }
+        if (count > 0) {
+            emit newSamplesDevice(QVector<Sample>(samples, samples + count));
+        }
+    };
+
+    int freq = 10;                                        ///< Sample frequency of the connection
+    QString identifier;                                   ///< Unique identifier
+    ConnType type = ConnType::USB;                        ///< USB, BLE or REPLAY
+    AcquisitionMode mode = AcquisitionMode::MAIN_THREAD;  ///< Thread used to read the data
+    bool connected = false;
+    uint16_t deviceNumber = 0;  ///< Written to `Sample::deviceId`
     Sample receivedData;
+
+    static constexpr size_t SAMPLE_QUEUE_CAPACITY = 16384;  ///< About 12 s at 1280 Hz
+    SpscQueue<Sample> sampleQueue{SAMPLE_QUEUE_CAPACITY};   ///< Hand-off from the I/O thread
 };
 
 }  // namespace comm
@@ -25,51 +25,156 @@
  */
 
 #include "commMaster.h"
+#include <QDateTime>
 #include <QDebug>
+#include <QDir>
+#include <QFileInfo>
 #include <QSerialPortInfo>
+#include <algorithm>
 #include "commUSB.h"
 #include "command.h"
 
 namespace comm {
 
+CommMaster::CommMaster() {
+    drainTimer.setInterval(DRAIN_INTERVAL_MS);
+    connect(&drainTimer, &QTimer::timeout, this, &CommMaster::drainSamples);
+}
+
 CommMaster::~CommMaster() {
-    delete singleDevice;
+    removeAllConnections();
 }
 
 bool CommMaster::addConnection(DeviceInfo identifier) {
-    if (singleDevice != nullptr) {
-        removeConnection();
+    if (connections.contains(identifier.ID)) {
+        removeConnection(identifier.ID);
     }
+
+    if (identifier.type == ConnType::USB && identifier.capturePath.isEmpty() && !captureDirectory.isEmpty()) {
+        QString name = QString("%1-%2.%3")
+                           .arg(QFileInfo(identifier.ID).fileName(),
+                                QDateTime::currentDateTime().toString("yyyyMMdd-HHmmss"), CAPTURE_SUFFIX);
+        identifier.capturePath = QDir(captureDirectory).filePath(name);
+    }
+
+    CommDevice* device = nullptr;
     switch (identifier.type) {
         case ConnType::USB:
-            singleDevice = new CommUSB(identifier);
+            device = new CommUSB(identifier);
             break;
 
         case ConnType::BLE:
             /// @todo add BLE ctor
             break;
 
+        case ConnType::REPLAY:
+            device = new ReplayDevice(identifier);
+            break;
+
         default:
             break;
     }
 
-    if (singleDevice != nullptr) {
-        connect(singleDevice, &CommDevice::newSampleDevice, this, &CommMaster::receiveSampleMaster);
-        connect(singleDevice, &CommDevice::changedStateDevice, this, &CommMaster::getChangedState);
-        return singleDevice->connectDevice();
+    if (device == nullptr) {
+        return false;
+    }
 
-    } else {
+    if (!deviceNumbers.contains(identifier.ID)) {
+        deviceNumbers.insert(identifier.ID, static_cast<quint16>(deviceNumbers.size() + 1));
+    }
+    device->setDeviceNumber(deviceNumbers.value(identifier.ID));
+    connect(device, &CommDevice::newSamplesDevice, this, &CommMaster::receiveSamplesMaster);
+    connect(device, &CommDevice::changedStateDevice, this, &CommMaster::getChangedState);
+    connect(device, &CommDevice::errorDevice, this,
+            [this, deviceId = identifier.ID](const QString& message) { emit errorMaster(deviceId, message); });
+
+    Connection connection;
+    connection.device = device;
+    connections.insert(identifier.ID, connection);
+    if (device->getAcquisitionMode() == AcquisitionMode::IO_THREAD && !drainTimer.isActive()) {
+        drainTimer.start();
+    }
+
+    if (!device->connectDevice()) {
+        removeConnection(identifier.ID);
         return false;
     }
+    setActiveDevice(identifier.ID);
+    return true;
+}
+
+void CommMaster::removeConnection(const QString& deviceId) {
+    auto connection = connections.find(deviceId);
+    if (connection == connections.end()) {
+        return;
+    }
+    CommDevice* device = connection->device;
+    connections.erase(connection);
+
+    if (connections.isEmpty()) {
+        drainTimer.stop();
+    }
+    device->disconnectDevice();
+    disconnect(device);
+    merger.removeDevice(device->getDeviceNumber());
+    delete device;
+
+    if (activeDevice == deviceId) {
+        QStringList remaining = getConnectedDevices();
+        setActiveDevice(remaining.isEmpty() ? QString() : remaining.first());
+    }
+    emit changedStateMaster(!connections.isEmpty());
+}
+
+void CommMaster::removeAllConnections() {
+    const QStringList devices = connections.keys();
+    for (const QString& deviceId : devices) {
+        removeConnection(deviceId);
+    }
+}
+
+QStringList CommMaster::getConnectedDevices() const {
+    QStringList devices = connections.keys();
+    std::sort(devices.begin(), devices.end(), [this](const QString& a, const QString& b) {
+        return getDeviceNumber(a) < getDeviceNumber(b);
+    });
+    return devices;
+}
+
+void CommMaster::setActiveDevice(const QString& deviceId) {
+    if (deviceId == activeDevice || (!deviceId.isEmpty() && !connections.contains(deviceId))) {
+        return;
+    }
+    activeDevice = deviceId;
+    emit changedActiveDevice(activeDevice);
+}
+
+bool CommMaster::isConnected(const QString& deviceId) const {
+    auto connection = connections.constFind(deviceId);
+    return connection != connections.constEnd() && connection->device->getStatus();
+}
+
+GapStatistics CommMaster::getGapStatistics(const QString& deviceId) const {
+    auto connection = connections.constFind(deviceId);
+    return connection == connections.constEnd() ? GapStatistics{} : connection->gapDetector.getStatistics();
+}
+
+CaptureStatistics CommMaster::getCaptureStatistics(const QString& deviceId) const {
+    auto connection = connections.constFind(deviceId);
+    if (connection == connections.constEnd()) {
+        return CaptureStatistics{};
+    }
+    auto usb = qobject_cast<const CommUSB*>(connection->device);
+    return usb == nullptr ? CaptureStatistics{} : usb->getCaptureStatistics();
 }
 
-void CommMaster::removeConnection() {
-    if (singleDevice != nullptr) {
-        singleDevice->disconnectDevice();
-        disconnect(singleDevice);
+ReplayStatistics CommMaster::getReplayStatistics(const QString& deviceId) const {
+    auto connection = connections.constFind(deviceId);
+    if (connection == connections.constEnd()) {
+        return ReplayStatistics{};
     }
-    delete singleDevice;
-    singleDevice = nullptr;
+    auto replay = qobject_cast<const ReplayDevice*>(connection->device);
+    return replay == nullptr ? ReplayStatistics{} : replay->getStatistics();
 }
 
 QList<DeviceInfo>& CommMaster::getAvailableDevices() {
@@ -79,6 +184,9 @@ QList<DeviceInfo>& CommMaster::getAvailableDevices() {
     for (int i = 0; i < listOfCOMPorts.length(); ++i) {
         // Check vendorID for LineScales or COM101 for debug
         /// @todo Check vendorID on multiple devices/batches
+        if (connections.contains(listOfCOMPorts[i].portName())) {
+            continue;
+        }
         if (listOfCOMPorts[i].vendorIdentifier() == 0x1a86 ||
             listOfCOMPorts[i].portName() == "COM101") {
             DeviceInfo tmp;
@@ -89,19 +197,32 @@ QList<DeviceInfo>& CommMaster::getAvailableDevices() {
         }
     }
 
-    /// @todo remove already connected devices from this list
+    // Additional ports for debugging, e.g. the pseudo terminal of `linescale-sim`
+    const QStringList debugPorts =
+        qEnvironmentVariable("LINESCALE_DEBUG_PORTS").split(QDir::listSeparator(), Qt::SkipEmptyParts);
+    for (const QString& port : debugPorts) {
+        if (!connections.contains(port)) {
+            DeviceInfo tmp;
+            tmp.ID = port;
+            tmp.type = ConnType::USB;
+            tmp.baudRate = 230400;
+            availableDevice.append(tmp);
+        }
+    }
+
     /// @todo Add code for BLE pull
 
     return availableDevice;
 }
 
-void CommMaster::sendData(const QByteArray& rawData) {
-    if (singleDevice != nullptr && rawData.length() > 0) {
-        singleDevice->sendData(rawData);
+void CommMaster::sendData(const QString& deviceId, const QByteArray& rawData) {
+    auto connection = connections.constFind(deviceId);
+    if (connection != connections.constEnd() && rawData.length() > 0) {
+        connection->device->sendData(rawData);
     }
 }
 
-void CommMaster::sendData(const QString& rawData) {
+void CommMaster::sendData(const QString& deviceId, const QString& rawData) {
     bool bStatus;
     QString payload4Bit = rawData.leftJustified(8, '0');
     uint32_t nHex = payload4Bit.toULong(&bStatus, 16);
@@ -111,47 +232,145 @@ void CommMaster::sendData(const QString& rawData) {
     rawHexData.append(uchar(nHex >> 16));
     rawHexData.append(uchar(nHex >> 8));
     rawHexData.append(uchar(nHex));
-    sendData(rawHexData);
+    sendData(deviceId, rawHexData);
+}
+
+void CommMaster::receiveSamplesMaster(const QVector<Sample>& readings) {
+    checkGaps(readings);
+    emit newSamplesMaster(readings);
+    mergeSamples(readings);
 }
 
-void CommMaster::receiveSampleMaster(Sample reading) {
-    emit newSampleMaster(reading);
+void CommMaster::setMerging(bool enabled, Interpolation mode, int frequency) {
+    mergingEnabled = enabled;
+    merger.clear();
+    merger.setResampling(mode, frequency);
 }
 
-void CommMaster::getChangedState(bool connected) {
-    emit changedStateMaster(connected);
+void CommMaster::mergeSamples(const QVector<Sample>& readings) {
+    if (!mergingEnabled) {
+        return;
+    }
+    merger.push(readings.constData(), static_cast<size_t>(readings.size()));
+
+    int used = 0;
+    size_t count;
+    if (merger.getInterpolation() == Interpolation::NONE) {
+        do {
+            mergedSamples.resize(used + static_cast<int>(DRAIN_CAPACITY));
+            count = merger.takeMerged(mergedSamples.data() + used, DRAIN_CAPACITY);
+            used += static_cast<int>(count);
+        } while (count == DRAIN_CAPACITY);
+        mergedSamples.resize(used);
+        if (used > 0) {
+            emit newMergedSamples(mergedSamples);
+        }
+        return;
+    }
+
+    int devices = static_cast<int>(merger.deviceCount());
+    do {
+        alignedFrames.resize(used + static_cast<int>(DRAIN_CAPACITY));
+        alignedForces.resize((used + static_cast<int>(DRAIN_CAPACITY)) * devices);
+        count = merger.takeAligned(alignedFrames.data() + used, alignedForces.data() + used * devices,
+                                   DRAIN_CAPACITY);
+        used += static_cast<int>(count);
+    } while (count == DRAIN_CAPACITY);
+    alignedFrames.resize(used);
+    alignedForces.resize(used * devices);
+    if (used > 0) {
+        const std::vector<uint16_t> order = merger.getDevices();
+        alignedDevices.resize(static_cast<int>(order.size()));
+        std::copy(order.begin(), order.end(), alignedDevices.begin());
+        emit newAlignedFrames(alignedFrames, alignedDevices, alignedForces);
+    }
+}
+
+void CommMaster::checkGaps(const QVector<Sample>& readings) {
+    // The samples of one device are always consecutive within a batch
+    int end = 0;
+    while (end < readings.size()) {
+        int begin = end;
+        quint16 deviceNumber = readings[begin].deviceId;
+        while (end < readings.size() && readings[end].deviceId == deviceNumber) {
+            ++end;
+        }
+        for (auto connection = connections.begin(); connection != connections.end(); ++connection) {
+            if (connection->device->getDeviceNumber() != deviceNumber) {
+                continue;
+            }
+            uint64_t missing = connection->gapDetector.check(readings.constData() + begin,
+                                                             static_cast<size_t>(end - begin));
+            if (missing > 0) {
+                emit samplesMissing(connection.key(), missing);
+            }
+            break;
+        }
+    }
+}
+
+void CommMaster::drainSamples() {
+    // Take the samples of all devices directly into the vector which is emitted
+    int used = 0;
+    for (auto connection = connections.begin(); connection != connections.end(); ++connection) {
+        CommDevice* device = connection->device;
+        if (device->getAcquisitionMode() != AcquisitionMode::IO_THREAD) {
+            continue;
+        }
+        size_t count;
+        do {
+            drainedSamples.resize(used + static_cast<int>(DRAIN_CAPACITY));
+            count = device->takeSamples(drainedSamples.data() + used, DRAIN_CAPACITY);
+            used += static_cast<int>(count);
+        } while (count == DRAIN_CAPACITY);
+    }
+    drainedSamples.resize(used);
+
+    if (used > 0) {
+        checkGaps(drainedSamples);
+        emit newSamplesMaster(drainedSamples);
+        mergeSamples(drainedSamples);
+    }
+}
+
+void CommMaster::getChangedState() {
+    bool anyConnected = false;
+    for (const Connection& connection : qAsConst(connections)) {
+        anyConnected = anyConnected || connection.device->getStatus();
+    }
+    emit changedStateMaster(anyConnected);
 }
 
-void CommMaster::setNewFreq(int newFreq) {
+void CommMaster::setNewFreq(const QString& deviceId, int newFreq) {
     switch (newFreq) {
         case 10:
-            sendData(command::SETSPEED10);
+            sendData(deviceId, command::SETSPEED10);
             break;
         case 40:
-            sendData(command::SETSPEED40);
+            sendData(deviceId, command::SETSPEED40);
             break;
         case 640:
-            sendData(command::SETSPEED640);
+            sendData(deviceId, command::SETSPEED640);
             break;
         case 1280:
-            sendData(command::SETSPEED1280);
+            sendData(deviceId, command::SETSPEED1280);
             break;
         default:
             break;
     }
 }
-void CommMaster::setNewUnit(UnitValue unit) {
+void CommMaster::setNewUnit(const QString& deviceId, UnitValue unit) {
     switch (unit) {
         case UnitValue::KN:
-            sendData(command::SWITCHTOKN);
+            sendData(deviceId, command::SWITCHTOKN);
             break;
 
         case UnitValue::KGF:
-            sendData(command::SWITCHTOKGF);
+            sendData(deviceId, command::SWITCHTOKGF);
             break;
 
         case UnitValue::LBF:
-            sendData(command::SWITCHTOLBF);
+            sendData(deviceId, command::SWITCHTOLBF);
             break;
 
         default:
@@ -28,8 +28,16 @@
 #ifndef COMMMASTER_H_
 #define COMMMASTER_H_
 
+#include <QHash>
 #include <QObject>
+#include <QStringList>
+#include <QTimer>
+#include <QVector>
+#include "captureWriter.h"
 #include "commDevice.h"
+#include "gapDetector.h"
+#include "replayDevice.h"
+#include "streamMerger.h"
 
 namespace comm {
 
@@ -43,11 +51,28 @@ namespace comm {
  * Each device gets a label which is used as an identifier inside the entire code:
  * USB: Port name
  * BLE: tbd
+ *
+ * Any number of devices can be connected at once, each one reading on its own
+ * I/O thread. Every device additionally gets a small number which is written
+ * to `Sample::deviceId`, so the samples of all devices can be forwarded as one
+ * merged stream. Commands are always routed to a single device.
+ *
+ * Devices reading on their own I/O thread queue their samples; the master
+ * drains these queues on a timer in the GUI thread and forwards the samples.
+ *
+ * Optionally the streams of all devices are merged by a `StreamMerger` onto a
+ * common time base, see `setMerging`.
  */
 class CommMaster : public QObject {
     Q_OBJECT
 
    public:
+    /**
+     * @brief Construct a new Comm Master object
+     *
+     */
+    CommMaster();
+
     /**
      * @brief Destroy the Comm Master object
      *
@@ -57,27 +82,36 @@ class CommMaster : public QObject {
     /**
      * @brief Search all possible devices on either USB or BLE
      *
+     * Devices which are already connected are not listed. Additional ports, e.g.
+     * of `linescale-sim`, can be listed in the environment variable
+     * `LINESCALE_DEBUG_PORTS`, separated by `QDir::listSeparator()`.
+     *
      * @return QList<QString>& Reference to a list with all devices
      */
     QList<DeviceInfo>& getAvailableDevices();
 
     /**
-     * @brief Send data to the connected devices
+     * @brief Send data to one connected device
      *
+     * @param deviceId `DeviceInfo::ID` of the device
      * @param rawData QByteArray with the data to send (including CRC)
      */
-    void sendData(const QByteArray& rawData);
+    void sendData(const QString& deviceId, const QByteArray& rawData);
 
     /**
-     * @brief Send data to the connected devices
+     * @brief Send data to one connected device
      *
+     * @param deviceId `DeviceInfo::ID` of the device
      * @param rawData QString with the msg as HEX characters
      */
-    void sendData(const QString& rawData);
+    void sendData(const QString& deviceId, const QString& rawData);
 
     /**
      * @brief Create connection
      *
+     * An existing connection with the same `DeviceInfo::ID` is replaced. The new
+     * device becomes the active device.
+     *
      * @param identifier Struct with the device info
      * @return true Connection established
      * @return false Connection failed
@@ -85,58 +119,252 @@ class CommMaster : public QObject {
     bool addConnection(const DeviceInfo identifier);
 
     /**
-     * @brief Terminate the connection and remove all references with the class
+     * @brief Terminate one connection and remove all references with the class
+     *
+     * @param deviceId `DeviceInfo::ID` of the device
+     */
+    void removeConnection(const QString& deviceId);
+
+    /**
+     * @brief Terminate all connections
      *
      */
-    void removeConnection();
+    void removeAllConnections();
 
     /**
-     * @brief Set a new frequency on the device
+     * @brief Set a new frequency on a device
      *
+     * @param deviceId `DeviceInfo::ID` of the device
      * @param newFreq Frequency in Hz (10, 40, 640, 1280)
      */
-    void setNewFreq(int newFreq);
+    void setNewFreq(const QString& deviceId, int newFreq);
 
     /**
-     * @brief Set a new unit on the device
+     * @brief Set a new unit on a device
      * 
+     * @param deviceId `DeviceInfo::ID` of the device
      * @param unit `UnitValue` to switch to
      */
-    void setNewUnit(UnitValue unit);
+    void setNewUnit(const QString& deviceId, UnitValue unit);
+
+    /**
+     * @brief Get the IDs of all connected devices
+     *
+     * @return QStringList `DeviceInfo::ID` of every connection, ordered by device number
+     */
+    QStringList getConnectedDevices() const;
+
+    /**
+     * @brief Get the device the GUI currently shows and controls
+     *
+     * @return QString `DeviceInfo::ID` of the active device; empty if none is connected
+     */
+    QString getActiveDevice() const { return activeDevice; }
+
+    /**
+     * @brief Select the device the GUI shows and controls
+     *
+     * @param deviceId `DeviceInfo::ID` of a connected device
+     */
+    void setActiveDevice(const QString& deviceId);
+
+    /**
+     * @brief Get the number written to `Sample::deviceId` for a device
+     *
+     * The number stays the same if a device is reconnected.
+     *
+     * @param deviceId `DeviceInfo::ID` of the device
+     * @return quint16 Device number starting at 1; 0 if the device was never connected
+     */
+    quint16 getDeviceNumber(const QString& deviceId) const { return deviceNumbers.value(deviceId, 0); }
+
+    /**
+     * @brief Get the device of a number written to `Sample::deviceId`
+     *
+     * @param deviceNumber Number of the device, see `getDeviceNumber`
+     * @return QString `DeviceInfo::ID` of the device; empty if the number is unknown
+     */
+    QString getDeviceId(quint16 deviceNumber) const { return deviceNumbers.key(deviceNumber); }
+
+    /**
+     * @brief Check if a single device is still connected
+     *
+     * `changedStateMaster` only tells if any device is connected.
+     *
+     * @param deviceId `DeviceInfo::ID` of the device
+     * @return true if the device has a connection that is open
+     */
+    bool isConnected(const QString& deviceId) const;
+
+    /**
+     * @brief Get the missing samples and timing jitter of a connection
+     *
+     * @param deviceId `DeviceInfo::ID` of the device
+     * @return GapStatistics Statistics since the connection was added
+     */
+    GapStatistics getGapStatistics(const QString& deviceId) const;
+
+    /**
+     * @brief Get the throughput of a replayed logfile
+     *
+     * @param deviceId `DeviceInfo::ID` of a `ConnType::REPLAY` connection
+     * @return ReplayStatistics Statistics since the connection was added; empty for other devices
+     */
+    ReplayStatistics getReplayStatistics(const QString& deviceId) const;
+
+    /**
+     * @brief Merge the streams of all devices onto a common time base
+     *
+     * With `Interpolation::NONE` the merged samples are emitted with
+     * `newMergedSamples`, otherwise the resampled points with `newAlignedFrames`.
+     *
+     * @param enabled Enable or disable the merge stage
+     * @param mode Resampling onto a shared clock
+     * @param frequency Frequency of the shared clock in Hz, ignored for `Interpolation::NONE`
+     */
+    void setMerging(bool enabled, Interpolation mode = Interpolation::NONE, int frequency = 0);
+
+    /**
+     * @brief Capture the raw bytes of every USB connection added from now on
+     *
+     * Each connection writes `<port>-<date>-<time>.lsraw` into the directory,
+     * unless `DeviceInfo::capturePath` is already set.
+     *
+     * @param directory Directory of the captures; empty to disable
+     */
+    void setCaptureDirectory(const QString& directory) { captureDirectory = directory; }
+
+    /**
+     * @brief Get the counters of the raw capture of a connection
+     *
+     * @param deviceId `DeviceInfo::ID` of the device
+     * @return CaptureStatistics Captured and dropped bytes; empty if the device is not captured
+     */
+    CaptureStatistics getCaptureStatistics(const QString& deviceId) const;
 
    signals:
     /**
-     * @brief Emit after new sample was sent by a deviceClass
+     * @brief Emit after new samples were received by the devices
      *
-     * @param reading Sample from device
+     * Emitted at most once per read or drain, so the receivers can update
+     * once per batch instead of once per sample. The samples of different
+     * devices are distinguished by `Sample::deviceId`.
+     *
+     * @param readings Samples from the devices, oldest first per device
      */
-    void newSampleMaster(Sample reading);
+    void newSamplesMaster(const QVector<Sample>& readings);
+
+    /**
+     * @brief Emit if samples are missing in front of or within a batch
+     *
+     * @param deviceId `DeviceInfo::ID` of the device
+     * @param count Estimated number of missing samples
+     */
+    void samplesMissing(const QString& deviceId, quint64 count);
+
+    /**
+     * @brief Emit if a device reports an error, see `CommDevice::errorDevice`
+     *
+     * @param deviceId `DeviceInfo::ID` of the device
+     * @param message Description for the user
+     */
+    void errorMaster(const QString& deviceId, const QString& message);
 
     /**
      * @brief Emit after status change
      *
-     * @param connected true if connected
+     * @param connected true if at least one device is connected
      */
     void changedStateMaster(bool connected);
 
+    /**
+     * @brief Emit after the active device changed
+     *
+     * @param deviceId `DeviceInfo::ID` of the new active device; empty if none
+     */
+    void changedActiveDevice(const QString& deviceId);
+
+    /**
+     * @brief Emit the samples of all devices in timestamp order
+     *
+     * Delayed until all devices delivered their samples, at most by
+     * `StreamMerger::DEFAULT_MAX_LATENCY`.
+     *
+     * @param readings Merged samples, oldest first
+     */
+    void newMergedSamples(const QVector<Sample>& readings);
+
+    /**
+     * @brief Emit the forces of all devices on the shared clock
+     *
+     * @param frames One frame per period of the shared clock, including the total force
+     * @param devices Number of the device of every column of `forces`, see `Sample::deviceId`
+     * @param forces Force of every device in kN, `frames.size()` rows of `devices.size()` columns; NaN if unknown
+     */
+    void newAlignedFrames(const QVector<AlignedFrame>& frames, const QVector<quint16>& devices,
+                          const QVector<double>& forces);
+
    private slots:
     /**
      * @brief Slot to receive the emitted signal from a deviceClass
      *
-     * @param reading Sample from device
+     * @param readings Samples from device
      */
-    void receiveSampleMaster(Sample reading);
+    void receiveSamplesMaster(const QVector<Sample>& readings);
 
     /**
      * @brief Slot to receive the updated state from a deviceClass
      *
-     * @param connected true if connected
      */
-    void getChangedState(bool connected);
+    void getChangedState();
+
+    /**
+     * @brief Take the samples queued by the I/O threads of all devices and forward them
+     *
+     */
+    void drainSamples();
 
    private:
+    /**
+     * @brief State kept for every connected device
+     *
+     */
+    struct Connection {
+        CommDevice* device = nullptr;  ///< Owned by the `CommMaster`
+        GapDetector gapDetector;       ///< Gaps in the stream of this device
+    };
+
+    /**
+     * @brief Check the samples of a batch for gaps
+     *
+     * @param readings Samples from the devices
+     */
+    void checkGaps(const QVector<Sample>& readings);
+
+    /**
+     * @brief Feed a batch to the merge stage and emit its output
+     *
+     * @param readings Samples from the devices
+     */
+    void mergeSamples(const QVector<Sample>& readings);
+
     QList<DeviceInfo> availableDevice;
-    CommDevice* singleDevice = nullptr;
+    QHash<QString, Connection> connections;   ///< Connected devices by `DeviceInfo::ID`
+    QHash<QString, quint16> deviceNumbers;    ///< Stable number of every device ever connected
+    QString activeDevice;
+    QString captureDirectory;  ///< See `setCaptureDirectory`
+
+    static constexpr int DRAIN_INTERVAL_MS = 16;    ///< About one drain per displayed frame
+    static constexpr size_t DRAIN_CAPACITY = 1024;  ///< Samples taken per call of `takeSamples`
+    QTimer drainTimer;
+    QVector<Sample> drainedSamples;  ///< Reused for every drain, keeps its capacity
+
+    bool mergingEnabled = false;
+    StreamMerger merger;
+    QVector<Sample> mergedSamples;        ///< Reused output of `StreamMerger::takeMerged`
+    QVector<AlignedFrame> alignedFrames;  ///< Reused output of `StreamMerger::takeAligned`
+    QVector<double> alignedForces;        ///< Reused output of `StreamMerger::takeAligned`
+    QVector<quint16> alignedDevices;      ///< Reused output of `StreamMerger::getDevices`
 };
 
 }  // namespace comm
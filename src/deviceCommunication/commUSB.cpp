@@ -29,48 +29,79 @@ namespace comm {
 
 CommUSB::CommUSB(DeviceInfo identifier) {
     this->identifier = identifier;
+    mode = identifier.mode;
 
-    connect(&serialPort, &QSerialPort::readyRead, this, &CommUSB::readData);
-    connect(&serialPort, &QSerialPort::errorOccurred, this, &CommUSB::handleError);
+    serialPort = new QSerialPort();
+    if (mode == AcquisitionMode::IO_THREAD) {
+        ioThread = new QThread();
+        ioThread->setObjectName("io " + identifier.ID);
+        serialPort->moveToThread(ioThread);
+        ioThread->start(QThread::TimeCriticalPriority);
+    }
+
+    // The port is the context object, so both run on the thread of the port
+    connect(serialPort, &QSerialPort::readyRead, serialPort, [this] { readData(); });
+    connect(serialPort, &QSerialPort::errorOccurred, serialPort,
+            [this](QSerialPort::SerialPortError error) { handleError(error); });
 };
 
 CommUSB::~CommUSB() {
     CommUSB::disconnectDevice();
+    if (ioThread != nullptr) {
+        serialPort->deleteLater();  // deleted on its own thread before the thread finishes
+        ioThread->quit();
+        ioThread->wait();
+        delete ioThread;
+    } else {
+        delete serialPort;
+    }
 }
 
 void CommUSB::disconnectDevice() {
     if (connected) {
-        serialPort.close();
+        runOnPortThread([this] { serialPort->close(); });
+        capture.close();
         connected = false;
         emit changedStateDevice(connected);
     }
 };
 
 void CommUSB::sendData(const QByteArray& rawData) {
-    serialPort.write(rawData);
-    serialPort.flush();
+    // Queued if the port lives on the I/O thread, the GUI does not wait for the write
+    QMetaObject::invokeMethod(serialPort, [this, rawData] {
+        serialPort->write(rawData);
+        serialPort->flush();
+    });
 };
 
 void CommUSB::readData() {
-    COMbuffer += serialPort.readAll();
-    while (COMbuffer.length() >= Parser::PACKET_EXPECTED_LEN) {
-        if (COMbuffer[static_cast<int>(Parser::PACKET_EXPECTED_LEN) - 1] == '\r') {
-            extractedMessage = COMbuffer.mid(0, Parser::PACKET_EXPECTED_LEN);
-            bool success = parser.parsePackage(extractedMessage, receivedData);
-            if (success) {
-                emit newSampleDevice(receivedData);
-            }
-            COMbuffer.remove(
-                0, Parser::PACKET_EXPECTED_LEN);  // remove parsed package regardless of success
-        } else {
-            COMbuffer.remove(0, 1);  // remove first byte and try again
+    // Read straight into the free part of the ring buffer, no intermediate copy
+    while (serialPort->bytesAvailable() > 0) {
+        int64_t arrival = SampleClock::now();
+        size_t available;
+        char* destination = decoder.writeBuffer(available);
+        qint64 received = serialPort->read(destination, static_cast<qint64>(available));
+        if (received <= 0) {
+            break;
         }
+        decoder.commit(static_cast<size_t>(received));
+        capture.append(arrival, destination, static_cast<size_t>(received));  // Queued, written by another thread
+        decoder.decode(arrival, deviceNumber,
+                       [this](const Sample* samples, size_t count) { deliverSamples(samples, count); });
     }
+
+    QMutexLocker locker(&statisticsMutex);
+    publishedStatistics = decoder.getStatistics();
+}
+
+FramerStatistics CommUSB::getFramerStatistics() const {
+    QMutexLocker locker(&statisticsMutex);
+    return publishedStatistics;
 }
 
 void CommUSB::handleError(QSerialPort::SerialPortError error) {
     if (error == QSerialPort::ResourceError) {
-        qDebug() << serialPort.errorString();
+        qDebug() << serialPort->errorString();
     }
 }
 
@@ -79,9 +110,22 @@ bool CommUSB::connectDevice() {
         disconnectDevice();
     }
 
-    serialPort.setBaudRate(identifier.baudRate);
-    serialPort.setPortName(identifier.ID);
-    connected = serialPort.open(QIODevice::ReadWrite);
+    // Opened before the port, so the first read is already captured
+    if (!identifier.capturePath.isEmpty() && !capture.open(identifier.capturePath, identifier.ID)) {
+        emit errorDevice(QString("Unable to capture into %1, reading without capture").arg(identifier.capturePath));
+    }
+
+    bool opened = false;
+    runOnPortThread([this, &opened] {
+        decoder.reset();
+        serialPort->setBaudRate(identifier.baudRate);
+        serialPort->setPortName(identifier.ID);
+        opened = serialPort->open(QIODevice::ReadWrite);
+    });
+    if (!opened) {
+        capture.close();
+    }
+    connected = opened;
     emit changedStateDevice(connected);
     return connected;
 }
@@ -30,17 +30,28 @@
 
 #include <QDebug>
 #include <QHash>
+#include <QMutex>
 #include <QObject>
 #include <QSerialPort>
 #include <QSerialPortInfo>
+#include <QThread>
 #include "../parser/parser.h"
+#include "captureWriter.h"
 #include "commDevice.h"
+#include "packetDecoder.h"
 
 namespace comm {
 
 /**
  * @brief Class to handle the communication with a USB device
  *
+ * In `AcquisitionMode::IO_THREAD` the serial port lives on its own `QThread`.
+ * Reading, framing and parsing happen on that thread and the samples are
+ * queued for the GUI, so a busy GUI thread can never cause a serial overrun.
+ * All public methods are called from the GUI thread and forwarded to the port.
+ *
+ * If `DeviceInfo::capturePath` is set, every read is additionally written to a
+ * raw capture by a `CaptureWriter`, e.g. to re-parse it with `linescale-reparse`.
  */
 class CommUSB : public CommDevice {
     Q_OBJECT
@@ -83,16 +94,54 @@ class CommUSB : public CommDevice {
     /**
      * @brief Method to read the received data
      *
+     * Runs on the thread of the serial port.
+     *
      */
     void readData() override;
 
+    /**
+     * @brief Get the counters of the framing stage
+     *
+     * Safe to call from any thread; updated once per read.
+     *
+     * @return FramerStatistics Bytes dropped, frames rejected and resync events
+     */
+    FramerStatistics getFramerStatistics() const;
+
+    /**
+     * @brief Get the counters of the raw capture
+     *
+     * Safe to call from any thread.
+     *
+     * @return CaptureStatistics Captured and dropped bytes; empty if not capturing
+     */
+    CaptureStatistics getCaptureStatistics() const { return capture.getStatistics(); }
+
    private:
     void handleError(QSerialPort::SerialPortError error);
 
-    QSerialPort serialPort;
+    /**
+     * @brief Run a function on the thread of the serial port and wait for it
+     *
+     * @param function Function to run
+     */
+    template <typename Function>
+    void runOnPortThread(Function function) {
+        if (ioThread != nullptr) {
+            QMetaObject::invokeMethod(serialPort, function, Qt::BlockingQueuedConnection);
+        } else {
+            function();
+        }
+    }
+
+    QSerialPort* serialPort;      ///< Lives on `ioThread` if set, otherwise on the GUI thread
+    QThread* ioThread = nullptr;  ///< Thread for `AcquisitionMode::IO_THREAD`
     DeviceInfo identifier;
-    QByteArray COMbuffer;
-    QByteArray extractedMessage;
+    PacketDecoder decoder;  ///< Framing, parsing and timestamping of the received bytes
+    CaptureWriter capture;  ///< Raw capture of every read, open if `DeviceInfo::capturePath` is set
+
+    mutable QMutex statisticsMutex;
+    FramerStatistics publishedStatistics;  ///< Copy of the framer statistics for other threads
 };
 
 }  // namespace comm
@@ -0,0 +1,126 @@
+/******************************************************************************
+ * Copyright (C) 2023 by Gschwind, Weber, Schoch, Niederberger                *
+ *                                                                            *
+ * This file is part of linescaleGUI.                                         *
+ *                                                                            *
+ * LinescaleGUI is free software: you can redistribute it and/or modify       *
+ * it under the terms of the GNU General Public License as published by       *
+ * the Free Software Foundation, either version 3 of the License, or          *
+ * (at your option) any later version.                                        *
+ *                                                                            *
+ * LinescaleGUI is distributed in the hope that it will be useful,            *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of             *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the               *
+ * GNU General Public License for more details.                               *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License          *
+ * along with linescaleGUI. If not, see <http://www.gnu.org/licenses/>.       *
+ ******************************************************************************/
+/**
+ * @file framer.cpp
+ * @authors Gschwind, Weber, Schoch, Niederberger
+ *
+ * @brief `comm::Framer` implementation
+ *
+ */
+
+#include "framer.h"
+#include <algorithm>
+#include <cstring>
+
+namespace comm {
+
+Framer::Framer(size_t frameLength, size_t capacity) : frameLength(frameLength) {
+    size_t rounded = 1;
+    while (rounded < capacity || rounded < 2 * frameLength) {
+        rounded <<= 1;
+    }
+    buffer.resize(rounded);
+    mask = rounded - 1;
+}
+
+char* Framer::writeBuffer(size_t& available) {
+    size_t index = writePos & mask;
+    size_t free = capacity() - size();
+    available = std::min(free, capacity() - index);
+    return buffer.data() + index;
+}
+
+void Framer::commit(size_t length) {
+    writePos += length;
+    statistics.bytesReceived += length;
+}
+
+void Framer::write(const char* data, size_t length) {
+    statistics.bytesReceived += length;
+    if (length > capacity()) {
+        // Only the newest bytes fit into the buffer
+        statistics.bytesDropped += size() + length - capacity();
+        data += length - capacity();
+        length = capacity();
+        readPos = writePos;
+    } else if (size() + length > capacity()) {
+        size_t overflow = size() + length - capacity();
+        statistics.bytesDropped += overflow;
+        readPos += overflow;
+    }
+
+    while (length > 0) {
+        size_t index = writePos & mask;
+        size_t chunk = std::min(length, capacity() - index);
+        std::memcpy(buffer.data() + index, data, chunk);
+        writePos += chunk;
+        data += chunk;
+        length -= chunk;
+    }
+}
+
+size_t Framer::extractFrames(char* output, size_t maxFrames) {
+    size_t frames = 0;
+    while (frames < maxFrames && size() >= frameLength) {
+        if (byteAt(readPos + frameLength - 1) == TERMINATOR) {
+            size_t index = readPos & mask;
+            size_t first = std::min(frameLength, capacity() - index);
+            std::memcpy(output, buffer.data() + index, first);
+            std::memcpy(output + first, buffer.data(), frameLength - first);
+            output += frameLength;
+            readPos += frameLength;
+            ++frames;
+            resyncing = false;
+            continue;
+        }
+
+        if (!resyncing) {
+            resyncing = true;
+            ++statistics.resyncEvents;
+        }
+
+        // The next possible frame ends at the next terminator after the current candidate
+        size_t terminator = findTerminator(readPos + frameLength, writePos);
+        size_t nextStart = terminator == writePos ? writePos - (frameLength - 1) : terminator - (frameLength - 1);
+        statistics.bytesDropped += nextStart - readPos;
+        readPos = nextStart;
+    }
+    statistics.framesExtracted += frames;
+    return frames;
+}
+
+void Framer::clear() {
+    readPos = writePos;
+    resyncing = false;
+}
+
+size_t Framer::findTerminator(size_t from, size_t to) const {
+    while (from < to) {
+        size_t index = from & mask;
+        size_t chunk = std::min(to - from, capacity() - index);
+        const void* found = std::memchr(buffer.data() + index, TERMINATOR, chunk);
+        if (found != nullptr) {
+            return from + (static_cast<const char*>(found) - (buffer.data() + index));
+        }
+        from += chunk;
+    }
+    return to;
+}
+
+}  // namespace comm
@@ -0,0 +1,151 @@
+/******************************************************************************
+ * Copyright (C) 2023 by Gschwind, Weber, Schoch, Niederberger                *
+ *                                                                            *
+ * This file is part of linescaleGUI.                                         *
+ *                                                                            *
+ * LinescaleGUI is free software: you can redistribute it and/or modify       *
+ * it under the terms of the GNU General Public License as published by       *
+ * the Free Software Foundation, either version 3 of the License, or          *
+ * (at your option) any later version.                                        *
+ *                                                                            *
+ * LinescaleGUI is distributed in the hope that it will be useful,            *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of             *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the               *
+ * GNU General Public License for more details.                               *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License          *
+ * along with linescaleGUI. If not, see <http://www.gnu.org/licenses/>.       *
+ ******************************************************************************/
+/**
+ * @file framer.h
+ * @authors Gschwind, Weber, Schoch, Niederberger
+ *
+ * @brief `comm::Framer` declaration
+ *
+ */
+
+#pragma once
+#ifndef FRAMER_H_
+#define FRAMER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace comm {
+
+/**
+ * @brief Counters describing the health of a byte stream
+ *
+ */
+struct FramerStatistics {
+    uint64_t bytesReceived = 0;    ///< Bytes written into the framer
+    uint64_t bytesDropped = 0;     ///< Bytes skipped while resynchronising or lost on overflow
+    uint64_t framesExtracted = 0;  ///< Frames with a correct terminator
+    uint64_t framesRejected = 0;   ///< Extracted frames rejected by the parser
+    uint64_t resyncEvents = 0;     ///< Number of times the framer lost the frame boundary
+};
+
+/**
+ * @brief Split a byte stream into `\r`-terminated frames of fixed length
+ *
+ * The received bytes are kept in a circular buffer of fixed capacity, so
+ * consuming a frame only moves the read cursor instead of moving the remaining
+ * data. If the byte at the expected terminator position is not a `\r`, the next
+ * candidate terminator is searched with `memchr` and all bytes in between are
+ * skipped at once. Every byte is scanned at most a constant number of times.
+ *
+ * Data can be written either by copy (`write`) or directly into the free part
+ * of the buffer (`writeBuffer` and `commit`) to avoid an intermediate buffer.
+ */
+class Framer {
+   public:
+    /**
+     * @brief Construct a new framer
+     *
+     * @param frameLength Length of a frame including the terminator
+     * @param capacity Capacity of the buffer in bytes, rounded up to the next power of two
+     */
+    Framer(size_t frameLength, size_t capacity = DEFAULT_CAPACITY);
+
+    /**
+     * @brief Get the contiguous free part of the buffer
+     *
+     * Write up to `available` bytes to the returned pointer and call `commit`.
+     *
+     * @param available Set to the number of bytes which can be written
+     * @return char* Pointer to the first free byte
+     */
+    char* writeBuffer(size_t& available);
+
+    /**
+     * @brief Make bytes written to `writeBuffer` available for framing
+     *
+     * @param length Number of bytes written, at most `available` of `writeBuffer`
+     */
+    void commit(size_t length);
+
+    /**
+     * @brief Copy bytes into the buffer
+     *
+     * If the buffer is full, the oldest bytes are dropped.
+     *
+     * @param data Bytes to append
+     * @param length Number of bytes
+     */
+    void write(const char* data, size_t length);
+
+    /**
+     * @brief Extract complete frames
+     *
+     * Copies up to `maxFrames` frames back-to-back into `output`, as expected by
+     * `Parser::parseBatch`. Garbage in front of a frame is skipped.
+     *
+     * @param output Caller provided buffer with room for `maxFrames * frameLength` bytes
+     * @param maxFrames Maximum number of frames to extract
+     * @return size_t Number of frames written to `output`
+     */
+    size_t extractFrames(char* output, size_t maxFrames);
+
+    /**
+     * @brief Count extracted frames which were rejected by the parser
+     *
+     * @param count Number of rejected frames
+     */
+    void reportRejected(size_t count) { statistics.framesRejected += count; }
+
+    /**
+     * @brief Discard all buffered bytes, the statistics are kept
+     *
+     */
+    void clear();
+
+    size_t size() const { return writePos - readPos; }           ///< Number of buffered bytes
+    size_t capacity() const { return buffer.size(); }             ///< Capacity of the buffer
+    const FramerStatistics& getStatistics() const { return statistics; }  ///< Current counters
+
+    static constexpr size_t DEFAULT_CAPACITY = 64 * 1024;  ///< Default capacity in bytes
+    static constexpr char TERMINATOR = '\r';                ///< Last byte of every frame
+
+   private:
+    /**
+     * @brief Find the first terminator in the absolute range [from, to)
+     *
+     * @return size_t Absolute position of the terminator or `to` if there is none
+     */
+    size_t findTerminator(size_t from, size_t to) const;
+
+    char byteAt(size_t position) const { return buffer[position & mask]; }
+
+    std::vector<char> buffer;
+    size_t mask;
+    size_t frameLength;
+    size_t readPos = 0;   ///< Absolute read cursor, the buffer index is `readPos & mask`
+    size_t writePos = 0;  ///< Absolute write cursor
+    bool resyncing = false;
+    FramerStatistics statistics;
+};
+
+}  // namespace comm
+
+#endif  // FRAMER_H_
@@ -0,0 +1,82 @@
+/******************************************************************************
+ * Copyright (C) 2023 by Gschwind, Weber, Schoch, Niederberger                *
+ *                                                                            *
+ * This file is part of linescaleGUI.                                         *
+ *                                                                            *
+ * LinescaleGUI is free software: you can redistribute it and/or modify       *
+ * it under the terms of the GNU General Public License as published by       *
+ * the Free Software Foundation, either version 3 of the License, or          *
+ * (at your option) any later version.                                        *
+ *                                                                            *
+ * LinescaleGUI is distributed in the hope that it will be useful,            *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of             *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the               *
+ * GNU General Public License for more details.                               *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License          *
+ * along with linescaleGUI. If not, see <http://www.gnu.org/licenses/>.       *
+ ******************************************************************************/
+/**
+ * @file gapDetector.cpp
+ * @authors Gschwind, Weber, Schoch, Niederberger
+ *
+ * @brief `comm::GapDetector` implementation
+ *
+ */
+
+#include "gapDetector.h"
+#include "sampleClock.h"
+
+namespace comm {
+
+uint64_t GapDetector::check(const Sample* samples, size_t count) {
+    uint64_t missing = 0;
+    for (size_t i = 0; i < count; ++i) {
+        const Sample& sample = samples[i];
+        if (sample.timestamp == 0 || sample.sequence == 0 || sample.frequency <= 0) {
+            continue;
+        }
+        ++statistics.samples;
+        if (!hasPrevious || sample.sequence <= previousSequence) {
+            // First sample or the device was reconnected
+            hasPrevious = true;
+            previousTimestamp = sample.timestamp;
+            previousSequence = sample.sequence;
+            continue;
+        }
+
+        int64_t period = SampleClock::NS_PER_SECOND / sample.frequency;
+        uint64_t steps = sample.sequence - previousSequence;
+        int64_t expected = static_cast<int64_t>(steps) * period;
+        int64_t interval = sample.timestamp - previousTimestamp;
+
+        uint64_t lost = steps - 1;  // received but not delivered
+        int64_t late = interval - expected;
+        if (late > lateLimit(period, tolerance)) {
+            int64_t neverReceived = (late + period / 2) / period;
+            lost += static_cast<uint64_t>(neverReceived);
+            late -= neverReceived * period;  // jitter relative to the missing samples
+        }
+
+        int64_t jitter = late < 0 ? -late : late;
+        ++statistics.intervals;
+        statistics.totalJitter += jitter;
+        statistics.maxJitter = jitter > statistics.maxJitter ? jitter : statistics.maxJitter;
+
+        if (lost > 0) {
+            ++statistics.gaps;
+            statistics.missingSamples += lost;
+            missing += lost;
+        }
+        previousTimestamp = sample.timestamp;
+        previousSequence = sample.sequence;
+    }
+    return missing;
+}
+
+void GapDetector::reset() {
+    hasPrevious = false;
+    statistics = GapStatistics{};
+}
+
+}  // namespace comm
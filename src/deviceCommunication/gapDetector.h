@@ -0,0 +1,118 @@
+/******************************************************************************
+ * Copyright (C) 2023 by Gschwind, Weber, Schoch, Niederberger                *
+ *                                                                            *
+ * This file is part of linescaleGUI.                                         *
+ *                                                                            *
+ * LinescaleGUI is free software: you can redistribute it and/or modify       *
+ * it under the terms of the GNU General Public License as published by       *
+ * the Free Software Foundation, either version 3 of the License, or          *
+ * (at your option) any later version.                                        *
+ *                                                                            *
+ * LinescaleGUI is distributed in the hope that it will be useful,            *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of             *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the               *
+ * GNU General Public License for more details.                               *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License          *
+ * along with linescaleGUI. If not, see <http://www.gnu.org/licenses/>.       *
+ ******************************************************************************/
+/**
+ * @file gapDetector.h
+ * @authors Gschwind, Weber, Schoch, Niederberger
+ *
+ * @brief `comm::GapDetector` declaration
+ *
+ */
+
+#pragma once
+#ifndef GAPDETECTOR_H_
+#define GAPDETECTOR_H_
+
+#include <cstddef>
+#include <cstdint>
+#include "../parser/parser.h"
+
+namespace comm {
+
+/**
+ * @brief Counters describing missing samples and the timing of a stream
+ *
+ */
+struct GapStatistics {
+    uint64_t samples = 0;         ///< Samples checked
+    uint64_t intervals = 0;       ///< Intervals between consecutive samples checked
+    uint64_t gaps = 0;            ///< Number of detected gaps
+    uint64_t missingSamples = 0;  ///< Estimated number of samples lost in all gaps
+    int64_t maxJitter = 0;        ///< Largest deviation of an interval from the nominal period in ns
+    int64_t totalJitter = 0;      ///< Sum of the absolute deviations in ns, see `meanJitter`
+
+    /**
+     * @brief Mean absolute deviation of an interval from the nominal period
+     *
+     * @return double Jitter in ns
+     */
+    double meanJitter() const { return intervals > 0 ? double(totalJitter) / double(intervals) : 0.0; }
+};
+
+/**
+ * @brief Detect missing samples in a stream of timestamped samples
+ *
+ * Two kinds of gaps are detected:
+ * - A jump in `Sample::sequence`: frames were received but rejected or dropped on the host.
+ * - An interval longer than expected from the nominal `Sample::frequency`: the
+ *   frames never arrived, e.g. because of bytes lost in a buffer overflow.
+ *
+ * Samples without timestamp or sequence (e.g. from a logfile) are ignored.
+ */
+class GapDetector {
+   public:
+    /**
+     * @brief Construct a new gap detector
+     *
+     * @param tolerance Additional delay in ns accepted before an interval counts as gap
+     */
+    explicit GapDetector(int64_t tolerance = DEFAULT_TOLERANCE) : tolerance(tolerance) {}
+
+    /**
+     * @brief Check the next samples of the stream
+     *
+     * @param samples Samples in the order they were received
+     * @param count Number of samples
+     * @return uint64_t Samples missing in front of and between the given samples
+     */
+    uint64_t check(const Sample* samples, size_t count);
+
+    /**
+     * @brief Forget the previous sample and reset the statistics
+     *
+     */
+    void reset();
+
+    const GapStatistics& getStatistics() const { return statistics; }  ///< Statistics since the last reset
+
+    /**
+     * @brief Delay beyond the expected interval up to which no sample counts as missing
+     *
+     * At low frequencies half a period is accepted, so jitter never counts as gap.
+     *
+     * @param period Nominal period of the samples in ns
+     * @param tolerance Additional delay in ns, see `GapDetector`
+     * @return int64_t Accepted delay in ns
+     */
+    static int64_t lateLimit(int64_t period, int64_t tolerance = DEFAULT_TOLERANCE) {
+        return tolerance > period / 2 ? tolerance : period / 2;
+    }
+
+    static constexpr int64_t DEFAULT_TOLERANCE = 2000000;  ///< 2 ms, typical latency variation of the USB stack
+
+   private:
+    int64_t tolerance;
+    bool hasPrevious = false;
+    int64_t previousTimestamp = 0;
+    uint64_t previousSequence = 0;
+    GapStatistics statistics;
+};
+
+}  // namespace comm
+
+#endif  // GAPDETECTOR_H_
@@ -0,0 +1,61 @@
+/******************************************************************************
+ * Copyright (C) 2023 by Gschwind, Weber, Schoch, Niederberger                *
+ *                                                                            *
+ * This file is part of linescaleGUI.                                         *
+ *                                                                            *
+ * LinescaleGUI is free software: you can redistribute it and/or modify       *
+ * it under the terms of the GNU General Public License as published by       *
+ * the Free Software Foundation, either version 3 of the License, or          *
+ * (at your option) any later version.                                        *
+ *                                                                            *
+ * LinescaleGUI is distributed in the hope that it will be useful,            *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of             *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the               *
+ * GNU General Public License for more details.                               *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License          *
+ * along with linescaleGUI. If not, see <http://www.gnu.org/licenses/>.       *
+ ******************************************************************************/
+/**
+ * @file packetDecoder.cpp
+ * @authors Gschwind, Weber, Schoch, Niederberger
+ *
+ * @brief `comm::PacketDecoder` implementation
+ */
+
+#include "packetDecoder.h"
+
+namespace comm {
+
+PacketDecoder::PacketDecoder() : framer(Parser::PACKET_EXPECTED_LEN) {}
+
+void PacketDecoder::reset() {
+    framer.clear();
+    sampleClock.reset();
+}
+
+size_t PacketDecoder::decodeBatch(size_t frames, int64_t arrival, uint16_t deviceNumber) {
+    size_t parsed = parser.parseBatch(frameBuffer.data(), frames * Parser::PACKET_EXPECTED_LEN, batchSamples.data(),
+                                      frameStatus.data());
+    framer.reportRejected(frames - parsed);
+    if (parsed > 0) {
+        lastFrequency = batchSamples[parsed - 1].frequency;
+    }
+
+    // Rejected packets keep their timestamp and sequence number, so they show up as gap
+    size_t pending = framer.size() / Parser::PACKET_EXPECTED_LEN;
+    sampleClock.stamp(frameTimestamps.data(), frames, arrival, pending, lastFrequency);
+    for (size_t frame = 0, sample = 0; frame < frames; ++frame, ++nextSequence) {
+        if (frameStatus[frame] == ParseStatus::OK) {
+            batchSamples[sample].timestamp = frameTimestamps[frame];
+            batchSamples[sample].sequence = nextSequence;
+            batchSamples[sample].deviceId = deviceNumber;
+            ++sample;
+        } else {
+            ++rejected[size_t(frameStatus[frame])];
+        }
+    }
+    return parsed;
+}
+
+}  // namespace comm
@@ -0,0 +1,142 @@
+/******************************************************************************
+ * Copyright (C) 2023 by Gschwind, Weber, Schoch, Niederberger                *
+ *                                                                            *
+ * This file is part of linescaleGUI.                                         *
+ *                                                                            *
+ * LinescaleGUI is free software: you can redistribute it and/or modify       *
+ * it under the terms of the GNU General Public License as published by       *
+ * the Free Software Foundation, either version 3 of the License, or          *
+ * (at your option) any later version.                                        *
+ *                                                                            *
+ * LinescaleGUI is distributed in the hope that it will be useful,            *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of             *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the               *
+ * GNU General Public License for more details.                               *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License          *
+ * along with linescaleGUI. If not, see <http://www.gnu.org/licenses/>.       *
+ ******************************************************************************/
+/**
+ * @file packetDecoder.h
+ * @authors Gschwind, Weber, Schoch, Niederberger
+ *
+ * @brief `comm::PacketDecoder` declaration
+ *
+ */
+
+#pragma once
+#ifndef PACKETDECODER_H_
+#define PACKETDECODER_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include "../parser/parser.h"
+#include "framer.h"
+#include "sampleClock.h"
+
+namespace comm {
+
+/**
+ * @brief Turn the received bytes of a LineScale into timestamped samples
+ *
+ * Runs the stages every connection shares: `Framer`, `Parser::parseBatch`
+ * and `SampleClock`. Each extracted packet gets the next sequence number,
+ * rejected packets included, so they show up as gap. Nothing is allocated
+ * after construction.
+ *
+ * Used by `CommUSB` for the serial port and by `ReplayDevice`, so a replay
+ * takes exactly the path of live data.
+ */
+class PacketDecoder {
+   public:
+    static constexpr size_t BATCH_CAPACITY = 256;  ///< Packets decoded per `Parser::parseBatch` call
+    static constexpr size_t STATUS_COUNT = size_t(ParseStatus::INVALID_FREQUENCY) + 1;  ///< Values of `ParseStatus`
+
+    PacketDecoder();
+
+    /**
+     * @brief Get the free part of the framer buffer to receive into without a copy
+     *
+     * @param available Number of bytes that may be written
+     * @return char* First free byte, see `Framer::writeBuffer`
+     */
+    char* writeBuffer(size_t& available) { return framer.writeBuffer(available); }
+
+    /**
+     * @brief Mark bytes written to `writeBuffer` as received
+     *
+     * @param length Number of bytes written
+     */
+    void commit(size_t length) { framer.commit(length); }
+
+    /**
+     * @brief Copy received bytes into the framer
+     *
+     * @param data Received bytes
+     * @param length Number of bytes
+     */
+    void write(const char* data, size_t length) { framer.write(data, length); }
+
+    /**
+     * @brief Decode all complete packets received so far
+     *
+     * @tparam Deliver Callable with `(const Sample* samples, size_t count)`
+     * @param arrival Time the bytes were read, see `SampleClock::now`
+     * @param deviceNumber Written to `Sample::deviceId`
+     * @param deliver Called once per parsed batch, the samples are only valid during the call
+     */
+    template <typename Deliver>
+    void decode(int64_t arrival, uint16_t deviceNumber, Deliver deliver) {
+        size_t frames;
+        while ((frames = framer.extractFrames(frameBuffer.data(), BATCH_CAPACITY)) > 0) {
+            size_t parsed = decodeBatch(frames, arrival, deviceNumber);
+            deliver(static_cast<const Sample*>(batchSamples.data()), parsed);
+        }
+    }
+
+    /**
+     * @brief Drop the buffered bytes and forget the previous timestamp, e.g. after reconnecting
+     *
+     * The sequence numbers continue.
+     */
+    void reset();
+
+    const FramerStatistics& getStatistics() const { return framer.getStatistics(); }  ///< Counters of the framer
+    uint64_t getNextSequence() const { return nextSequence; }  ///< Sequence number of the next packet
+
+    /**
+     * @brief Get the number of packets rejected by a check of the parser
+     *
+     * @param status First failed check
+     * @return uint64_t Packets rejected with `status` since construction
+     */
+    uint64_t getRejected(ParseStatus status) const { return rejected[size_t(status)]; }
+
+   private:
+    /**
+     * @brief Parse and timestamp the packets extracted into `frameBuffer`
+     *
+     * @param frames Number of packets in `frameBuffer`
+     * @param arrival Time the bytes were read
+     * @param deviceNumber Written to `Sample::deviceId`
+     * @return size_t Number of samples written to `batchSamples`
+     */
+    size_t decodeBatch(size_t frames, int64_t arrival, uint16_t deviceNumber);
+
+    Framer framer;  ///< Splits the received bytes into packets
+    Parser parser;
+    std::array<char, BATCH_CAPACITY * Parser::PACKET_EXPECTED_LEN> frameBuffer;  ///< Packets extracted by `framer`
+    std::array<Sample, BATCH_CAPACITY> batchSamples;  ///< Preallocated output of `Parser::parseBatch`
+    std::array<ParseStatus, BATCH_CAPACITY> frameStatus;  ///< Result of every packet in `frameBuffer`
+    std::array<int64_t, BATCH_CAPACITY> frameTimestamps;  ///< Arrival time of every packet in `frameBuffer`
+
+    SampleClock sampleClock;    ///< Timestamps the packets of a read
+    uint64_t nextSequence = 1;  ///< Sequence number of the next extracted packet
+    int lastFrequency = 10;     ///< Frequency of the last valid packet, used for the interpolation
+    std::array<uint64_t, STATUS_COUNT> rejected{};  ///< Rejected packets by `ParseStatus`
+};
+
+}  // namespace comm
+
+#endif  // PACKETDECODER_H_
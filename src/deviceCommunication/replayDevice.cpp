@@ -0,0 +1,309 @@
+/******************************************************************************
+ * Copyright (C) 2023 by Gschwind, Weber, Schoch, Niederberger                *
+ *                                                                            *
+ * This file is part of linescaleGUI.                                         *
+ *                                                                            *
+ * LinescaleGUI is free software: you can redistribute it and/or modify       *
+ * it under the terms of the GNU General Public License as published by       *
+ * the Free Software Foundation, either version 3 of the License, or          *
+ * (at your option) any later version.                                        *
+ *                                                                            *
+ * LinescaleGUI is distributed in the hope that it will be useful,            *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of             *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the               *
+ * GNU General Public License for more details.                               *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License          *
+ * along with linescaleGUI. If not, see <http://www.gnu.org/licenses/>.       *
+ ******************************************************************************/
+/**
+ * @file replayDevice.cpp
+ * @authors Gschwind, Weber, Schoch, Niederberger
+ *
+ * @brief `comm::ReplayDevice` implementation
+ */
+
+#include "replayDevice.h"
+#include <QMutexLocker>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include "../simulator/frameGenerator.h"
+#include "command.h"
+#include "sampleClock.h"
+
+namespace comm {
+
+ReplayDevice::ReplayDevice(DeviceInfo identifier) {
+    this->identifier = identifier;
+    type = ConnType::REPLAY;
+    mode = AcquisitionMode::IO_THREAD;
+}
+
+ReplayDevice::~ReplayDevice() {
+    ReplayDevice::disconnectDevice();
+}
+
+bool ReplayDevice::connectDevice() {
+    if (connected) {
+        disconnectDevice();
+    }
+
+    qint64 total = 0;
+    bool valid = capture.open(identifier.ID);
+    if (valid) {
+        total = capture.getSize();
+    } else {
+        logfile.setPath(identifier.ID);
+        const Metadata& metadata = logfile.getMetadata();
+        valid = logfile.loadIndex() == 0 &&
+                (metadata.speed == 10 || metadata.speed == 40 || metadata.speed == 640 || metadata.speed == 1280);
+        if (valid) {
+            templateSample = Sample{};
+            templateSample.workingMode = WorkingMode::REALTIME;
+            templateSample.measureMode = metadata.mode;
+            templateSample.referenceZero = metadata.relZero;
+            templateSample.batteryPercent = 100;
+            templateSample.unitValue = metadata.unit;
+            templateSample.frequency = metadata.speed;
+            freq = metadata.speed;
+            total = logfile.getSampleCount();
+        }
+    }
+    if (valid) {
+        decoder.reset();
+        QMutexLocker locker(&statisticsMutex);
+        statistics = ReplayStatistics{};
+        statistics.position = capture.isOpen() ? capture.getOffset() : 0;
+        statistics.total = total;
+    }
+    connected = valid;
+    emit changedStateDevice(connected);
+    return connected;
+}
+
+void ReplayDevice::disconnectDevice() {
+    stopReplay();
+    if (connected) {
+        connected = false;
+        emit changedStateDevice(connected);
+    }
+}
+
+void ReplayDevice::sendData(const QByteArray& rawData) {
+    if (!connected) {
+        return;
+    }
+    if (rawData == command::REQUESTONLINE) {
+        startReplay();
+    } else if (rawData == command::DISCONNECTONLINE) {
+        stopReplay();
+    }
+}
+
+ReplayStatistics ReplayDevice::getStatistics() const {
+    QMutexLocker locker(&statisticsMutex);
+    ReplayStatistics result = statistics;
+    if (result.elapsed > 0.0) {
+        result.sampleRate = double(result.samples) / result.elapsed;
+        result.speed = result.replayed / result.elapsed;
+    }
+    return result;
+}
+
+FramerStatistics ReplayDevice::getFramerStatistics() const {
+    QMutexLocker locker(&statisticsMutex);
+    return framerStatistics;
+}
+
+void ReplayDevice::startReplay() {
+    if (thread != nullptr && !thread->isFinished()) {
+        return;
+    }
+    stopReplay();
+    stopRequested = false;
+    thread = QThread::create([this] { run(); });
+    thread->setObjectName("replay " + identifier.ID);
+    thread->start(QThread::TimeCriticalPriority);
+}
+
+void ReplayDevice::stopReplay() {
+    if (thread == nullptr) {
+        return;
+    }
+    stopRequested = true;
+    thread->wait();
+    delete thread;
+    thread = nullptr;
+}
+
+void ReplayDevice::run() {
+    PlayResult result = capture.isOpen() ? playCapture() : playLogfile();
+    if (result == PlayResult::STOPPED) {
+        return;
+    }
+
+    if (result == PlayResult::ENDED) {
+        // The consumer has to take the last samples before the end is reported
+        while (!stopRequested && sampleQueue.size() > 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        QMutexLocker locker(&statisticsMutex);
+        statistics.finished = true;
+    }
+    QMetaObject::invokeMethod(
+        this,
+        [this] {
+            if (connected) {
+                connected = false;
+                emit changedStateDevice(connected);
+            }
+        },
+        Qt::QueuedConnection);
+}
+
+ReplayDevice::PlayResult ReplayDevice::playLogfile() {
+    qint64 position, total;
+    double elapsedBefore, replayedBefore;
+    {
+        QMutexLocker locker(&statisticsMutex);
+        position = statistics.position;
+        total = statistics.total;
+        elapsedBefore = statistics.elapsed;
+        replayedBefore = statistics.replayed;
+    }
+
+    // Force `first + n` is due `n * period` after `start`
+    const qint64 first = position;
+    const int64_t start = SampleClock::now();
+    const double speed = identifier.replaySpeed;
+    const double period = speed > 0.0 ? double(SampleClock::NS_PER_SECOND) / (templateSample.frequency * speed) : 0.0;
+
+    while (!stopRequested && position < total) {
+        double lag;
+        if (!isDue(start + int64_t(double(position - first) * period), period > 0.0, lag)) {
+            continue;
+        }
+        int64_t now = SampleClock::now();
+        qint64 count = MAX_BURST;
+        if (period > 0.0) {
+            count = std::max(first + qint64(double(now - start) / period) + 1 - position, qint64(1));
+        }
+        count = std::min({count, qint64(MAX_BURST), total - position});
+        if (!logfile.readForces(position, int(count), forces)) {
+            emit errorDevice(QString("Unable to read the forces %1 to %2 of the logfile")
+                                 .arg(position)
+                                 .arg(position + count - 1));
+            return PlayResult::FAILED;
+        }
+
+        packets.resize(size_t(count) * Parser::PACKET_EXPECTED_LEN);
+        Sample sample = templateSample;
+        for (int i = 0; i < count; ++i) {
+            sample.measuredValue = forces[i];
+            sim::FrameGenerator::encodeFrame(sample, packets.data() + size_t(i) * Parser::PACKET_EXPECTED_LEN);
+        }
+        size_t delivered = feed(packets.data(), packets.size(), now);
+        position += count;
+
+        double replayed = replayedBefore + double(position - first) / templateSample.frequency;
+        double elapsed = elapsedBefore + double(SampleClock::now() - start) / SampleClock::NS_PER_SECOND;
+        updateStatistics(position, delivered, packets.size(), replayed, elapsed, lag);
+    }
+    return position < total ? PlayResult::STOPPED : PlayResult::ENDED;
+}
+
+ReplayDevice::PlayResult ReplayDevice::playCapture() {
+    double elapsedBefore, replayedBefore;
+    {
+        QMutexLocker locker(&statisticsMutex);
+        capture.setOffset(statistics.position);
+        elapsedBefore = statistics.elapsed;
+        replayedBefore = statistics.replayed;
+    }
+
+    // Every read is due at its original distance to the first one, divided by the speed
+    const int64_t start = SampleClock::now();
+    const double speed = identifier.replaySpeed;
+    CaptureRecord record;
+    int64_t firstArrival = 0;
+    bool started = false;
+    bool pending = false;
+
+    while (!stopRequested) {
+        if (!pending) {
+            if (!capture.next(record)) {
+                return PlayResult::ENDED;
+            }
+            if (record.isDrop()) {
+                // The recording has a hole here, like a reconnected port
+                decoder.reset();
+                QMutexLocker locker(&statisticsMutex);
+                statistics.position = capture.getOffset();
+                statistics.bytesLost += record.bytesLost;
+                continue;
+            }
+            if (!started) {
+                firstArrival = record.arrival;
+                started = true;
+            }
+            pending = true;
+        }
+        double lag;
+        int64_t due = speed > 0.0 ? start + int64_t(double(record.arrival - firstArrival) / speed) : 0;
+        if (!isDue(due, speed > 0.0, lag)) {
+            continue;
+        }
+        size_t delivered = feed(record.data, record.length, SampleClock::now());
+        pending = false;
+
+        double replayed = replayedBefore + double(record.arrival - firstArrival) / SampleClock::NS_PER_SECOND;
+        double elapsed = elapsedBefore + double(SampleClock::now() - start) / SampleClock::NS_PER_SECOND;
+        updateStatistics(capture.getOffset(), delivered, record.length, replayed, elapsed, lag);
+    }
+    return PlayResult::STOPPED;
+}
+
+bool ReplayDevice::isDue(int64_t due, bool paced, double& lag) {
+    lag = 0.0;
+    if (!paced) {
+        // As fast as possible, but never faster than the consumer, so no sample is dropped
+        if (sampleQueue.size() > sampleQueue.capacity() / 2) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            return false;
+        }
+        return true;
+    }
+    int64_t now = SampleClock::now();
+    if (now < due) {
+        auto wakeup = std::chrono::nanoseconds(std::min(due, now + MAX_SLEEP));
+        std::this_thread::sleep_until(std::chrono::steady_clock::time_point(wakeup));
+        return false;
+    }
+    lag = double(now - due) / SampleClock::NS_PER_SECOND;
+    return true;
+}
+
+size_t ReplayDevice::feed(const char* data, size_t length, int64_t arrival) {
+    size_t delivered = 0;
+    decoder.write(data, length);
+    decoder.decode(arrival, deviceNumber, [this, &delivered](const Sample* samples, size_t parsed) {
+        deliverSamples(samples, parsed);
+        delivered += parsed;
+    });
+    return delivered;
+}
+
+void ReplayDevice::updateStatistics(qint64 position, size_t delivered, size_t bytes, double replayed, double elapsed,
+                                    double lag) {
+    QMutexLocker locker(&statisticsMutex);
+    statistics.position = position;
+    statistics.samples += delivered;
+    statistics.bytes += bytes;
+    statistics.replayed = replayed;
+    statistics.elapsed = elapsed;
+    statistics.maxLag = std::max(statistics.maxLag, lag);
+    framerStatistics = decoder.getStatistics();
+}
+
+}  // namespace comm
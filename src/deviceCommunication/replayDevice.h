@@ -0,0 +1,234 @@
+/******************************************************************************
+ * Copyright (C) 2023 by Gschwind, Weber, Schoch, Niederberger                *
+ *                                                                            *
+ * This file is part of linescaleGUI.                                         *
+ *                                                                            *
+ * LinescaleGUI is free software: you can redistribute it and/or modify       *
+ * it under the terms of the GNU General Public License as published by       *
+ * the Free Software Foundation, either version 3 of the License, or          *
+ * (at your option) any later version.                                        *
+ *                                                                            *
+ * LinescaleGUI is distributed in the hope that it will be useful,            *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of             *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the               *
+ * GNU General Public License for more details.                               *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License          *
+ * along with linescaleGUI. If not, see <http://www.gnu.org/licenses/>.       *
+ ******************************************************************************/
+/**
+ * @file replayDevice.h
+ * @authors Gschwind, Weber, Schoch, Niederberger
+ *
+ * @brief `comm::ReplayDevice` declaration
+ *
+ */
+
+#pragma once
+#ifndef REPLAYDEVICE_H_
+#define REPLAYDEVICE_H_
+
+#include <QMutex>
+#include <QObject>
+#include <QThread>
+#include <QVector>
+#include <atomic>
+#include <vector>
+#include "../logfile/logfile.h"
+#include "captureReader.h"
+#include "commDevice.h"
+#include "packetDecoder.h"
+
+namespace comm {
+
+/**
+ * @brief Throughput of a replay
+ *
+ */
+struct ReplayStatistics {
+    qint64 position = 0;       ///< Next force of a logfile, or offset of the next read of a capture
+    qint64 total = 0;          ///< Number of forces of a logfile, or size of a capture
+    quint64 samples = 0;       ///< Samples delivered since the connection
+    quint64 bytes = 0;         ///< Bytes fed into the decoder since the connection
+    quint64 bytesLost = 0;     ///< Bytes of a capture its writer dropped, see `CaptureRecord::isDrop`
+    double replayed = 0.0;     ///< Recorded time played in s
+    double elapsed = 0.0;      ///< Time spent playing in s
+    double sampleRate = 0.0;   ///< Achieved samples per s while playing
+    double speed = 0.0;        ///< Achieved multiple of real time while playing
+    double maxLag = 0.0;       ///< Largest delay behind the schedule in s; 0 as fast as possible
+    bool finished = false;     ///< True after the last force was delivered
+};
+
+/**
+ * @brief Play a logfile or a raw capture through the same path as live data
+ *
+ * `DeviceInfo::ID` is the path of the file. The forces of a logfile are
+ * encoded into the packets a LineScale sends, the reads of a capture (see
+ * `captureFile.h`) are used as they are. Both are fed into a `PacketDecoder`,
+ * so framer, parser, sample clock and everything after the `CommMaster` see
+ * exactly what they would see from a serial port. Like a device, the replay starts with
+ * `command::REQUESTONLINE` and pauses with `command::DISCONNECTONLINE`; all
+ * other commands are ignored.
+ *
+ * The packets are paced on a steady clock at `DeviceInfo::replaySpeed` times
+ * the frequency of the logfile, the reads of a capture at the same multiple
+ * of their recorded timing. At speed 0 the replay runs as fast as the
+ * consumer drains the samples, without dropping any, which makes it an end
+ * to end load test; see `getStatistics`.
+ *
+ * Always reads on its own thread, see `AcquisitionMode::IO_THREAD`. Once all
+ * forces were delivered the device reports itself as disconnected. A logfile
+ * that can not be read to the end is reported with `errorDevice` and the
+ * device disconnects as well, without `ReplayStatistics::finished`.
+ */
+class ReplayDevice : public CommDevice {
+    Q_OBJECT
+
+   public:
+    static constexpr int MAX_BURST = 256;             ///< Packets fed into the decoder at once
+    static constexpr int64_t MAX_SLEEP = 10000000;    ///< Longest wait in ns, bounds the reaction to a stop
+
+    /**
+     * @brief Construct a new replay, nothing is read yet
+     *
+     * @param identifier Path of the logfile and speed of the replay
+     */
+    explicit ReplayDevice(DeviceInfo identifier);
+
+    /**
+     * @brief Stop the replay and destroy the object
+     *
+     */
+    virtual ~ReplayDevice();
+
+    /**
+     * @brief Open the capture or load the metadata of the logfile
+     *
+     * @return true if the file is a capture, or a logfile with a supported frequency
+     */
+    bool connectDevice() override;
+
+    /**
+     * @brief Stop the replay
+     *
+     */
+    void disconnectDevice() override;
+
+    /**
+     * @brief Start or pause the replay on `command::REQUESTONLINE` / `command::DISCONNECTONLINE`
+     *
+     * @param rawData Command as sent to a LineScale
+     */
+    void sendData(const QByteArray& rawData) override;
+
+    /**
+     * @brief Get the throughput of the replay
+     *
+     * Safe to call from any thread.
+     *
+     * @return ReplayStatistics Counters since the connection
+     */
+    ReplayStatistics getStatistics() const;
+
+    /**
+     * @brief Get the counters of the framing stage
+     *
+     * Safe to call from any thread.
+     *
+     * @return FramerStatistics Bytes dropped, frames rejected and resync events
+     */
+    FramerStatistics getFramerStatistics() const;
+
+   private:
+    /**
+     * @brief How a call of `playLogfile` or `playCapture` ended
+     *
+     */
+    enum class PlayResult {
+        STOPPED,  ///< `stopRequested` was set, a later call continues at the position
+        ENDED,    ///< All forces or reads were delivered
+        FAILED,   ///< Reading the file failed, reported with `errorDevice`
+    };
+
+    /**
+     * @brief Start the thread of the replay at the current position
+     *
+     */
+    void startReplay();
+
+    /**
+     * @brief Stop the thread of the replay and wait for it, the position is kept
+     *
+     */
+    void stopReplay();
+
+    /**
+     * @brief Body of the thread, plays the file and reports its end
+     *
+     */
+    void run();
+
+    /**
+     * @brief Encode and pace the forces of the logfile until the end or `stopRequested`
+     *
+     * @return PlayResult Why the replay stopped
+     */
+    PlayResult playLogfile();
+
+    /**
+     * @brief Pace the reads of the capture until the end or `stopRequested`
+     *
+     * @return PlayResult Why the replay stopped
+     */
+    PlayResult playCapture();
+
+    /**
+     * @brief Check if the next packets may be fed, otherwise wait a bit
+     *
+     * @param due Time the packets are due, see `SampleClock::now`; ignored if not paced
+     * @param paced False to play as fast as the consumer takes the samples
+     * @param lag Delay behind `due` in s
+     * @return true if due; false after waiting, the caller checks `stopRequested` and retries
+     */
+    bool isDue(int64_t due, bool paced, double& lag);
+
+    /**
+     * @brief Feed received bytes through the decoder and deliver the samples
+     *
+     * @param data Bytes as a LineScale sends them
+     * @param length Number of bytes
+     * @param arrival Time the bytes are received, see `SampleClock::now`
+     * @return size_t Number of delivered samples
+     */
+    size_t feed(const char* data, size_t length, int64_t arrival);
+
+    /**
+     * @brief Publish the progress after feeding
+     *
+     * @param position New `ReplayStatistics::position`
+     * @param delivered Delivered samples
+     * @param bytes Fed bytes
+     * @param replayed New `ReplayStatistics::replayed`
+     * @param elapsed New `ReplayStatistics::elapsed`
+     * @param lag Delay behind the schedule in s
+     */
+    void updateStatistics(qint64 position, size_t delivered, size_t bytes, double replayed, double elapsed, double lag);
+
+    DeviceInfo identifier;
+    Logfile logfile;
+    CaptureReader capture;              ///< Open if a capture is played instead of a logfile
+    Sample templateSample{};            ///< Metadata of the logfile as encoded into every packet
+    PacketDecoder decoder;              ///< Only used by the thread of the replay
+    QVector<float> forces;              ///< Forces of the current burst
+    std::vector<char> packets;          ///< Encoded packets of the current burst of a logfile
+    QThread* thread = nullptr;          ///< Runs `run` while playing
+    std::atomic<bool> stopRequested{false};
+
+    mutable QMutex statisticsMutex;
+    ReplayStatistics statistics;          ///< Guarded by `statisticsMutex`
+    FramerStatistics framerStatistics;    ///< Copy of the decoder statistics, guarded by `statisticsMutex`
+};
+
+}  // namespace comm
+
+#endif  // REPLAYDEVICE_H_
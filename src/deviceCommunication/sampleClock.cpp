@@ -0,0 +1,63 @@
+/******************************************************************************
+ * Copyright (C) 2023 by Gschwind, Weber, Schoch, Niederberger                *
+ *                                                                            *
+ * This file is part of linescaleGUI.                                         *
+ *                                                                            *
+ * LinescaleGUI is free software: you can redistribute it and/or modify       *
+ * it under the terms of the GNU General Public License as published by       *
+ * the Free Software Foundation, either version 3 of the License, or          *
+ * (at your option) any later version.                                        *
+ *                                                                            *
+ * LinescaleGUI is distributed in the hope that it will be useful,            *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of             *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the               *
+ * GNU General Public License for more details.                               *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License          *
+ * along with linescaleGUI. If not, see <http://www.gnu.org/licenses/>.       *
+ ******************************************************************************/
+/**
+ * @file sampleClock.cpp
+ * @authors Gschwind, Weber, Schoch, Niederberger
+ *
+ * @brief `comm::SampleClock` implementation
+ *
+ */
+
+#include "sampleClock.h"
+#include <chrono>
+
+namespace comm {
+
+int64_t SampleClock::now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+void SampleClock::stamp(int64_t* timestamps, size_t count, int64_t arrival, size_t pendingFrames,
+                        int frequency) {
+    if (count == 0) {
+        return;
+    }
+    int64_t period = frequency > 0 ? NS_PER_SECOND / frequency : 0;
+    int64_t newest = arrival - static_cast<int64_t>(pendingFrames) * period;
+    int64_t oldest = newest - static_cast<int64_t>(count - 1) * period;
+
+    if (oldest <= lastTimestamp) {
+        // Overlaps the previous burst, distribute the frames evenly after it
+        int64_t end =
+            newest > lastTimestamp + static_cast<int64_t>(count) ? newest : lastTimestamp + static_cast<int64_t>(count);
+        int64_t step = (end - lastTimestamp) / static_cast<int64_t>(count);
+        for (size_t i = 0; i < count; ++i) {
+            timestamps[i] = lastTimestamp + static_cast<int64_t>(i + 1) * step;
+        }
+    } else {
+        for (size_t i = 0; i < count; ++i) {
+            timestamps[i] = oldest + static_cast<int64_t>(i) * period;
+        }
+    }
+    lastTimestamp = timestamps[count - 1];
+}
+
+}  // namespace comm
@@ -0,0 +1,79 @@
+/******************************************************************************
+ * Copyright (C) 2023 by Gschwind, Weber, Schoch, Niederberger                *
+ *                                                                            *
+ * This file is part of linescaleGUI.                                         *
+ *                                                                            *
+ * LinescaleGUI is free software: you can redistribute it and/or modify       *
+ * it under the terms of the GNU General Public License as published by       *
+ * the Free Software Foundation, either version 3 of the License, or          *
+ * (at your option) any later version.                                        *
+ *                                                                            *
+ * LinescaleGUI is distributed in the hope that it will be useful,            *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of             *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the               *
+ * GNU General Public License for more details.                               *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License          *
+ * along with linescaleGUI. If not, see <http://www.gnu.org/licenses/>.       *
+ ******************************************************************************/
+/**
+ * @file sampleClock.h
+ * @authors Gschwind, Weber, Schoch, Niederberger
+ *
+ * @brief `comm::SampleClock` declaration
+ *
+ */
+
+#pragma once
+#ifndef SAMPLECLOCK_H_
+#define SAMPLECLOCK_H_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace comm {
+
+/**
+ * @brief Assign host arrival timestamps to the frames of a burst
+ *
+ * The serial driver hands over several frames at once, so only the arrival of
+ * the burst can be measured. The newest frame gets the arrival time, older
+ * frames are placed one nominal period apart before it. Timestamps never go
+ * backwards; if the interpolation would overlap the previous burst, the frames
+ * are squeezed in after the last timestamp instead.
+ */
+class SampleClock {
+   public:
+    /**
+     * @brief Current time of the monotonic host clock
+     *
+     * @return int64_t Time in ns of `std::chrono::steady_clock`
+     */
+    static int64_t now();
+
+    /**
+     * @brief Timestamp the frames of a burst
+     *
+     * @param timestamps Caller provided array receiving one timestamp per frame
+     * @param count Number of frames
+     * @param arrival Time the burst was read, see `now`
+     * @param pendingFrames Frames of the same burst which are still buffered and newer
+     * @param frequency Nominal sample frequency in Hz
+     */
+    void stamp(int64_t* timestamps, size_t count, int64_t arrival, size_t pendingFrames, int frequency);
+
+    /**
+     * @brief Forget the previous timestamp, e.g. after reconnecting
+     *
+     */
+    void reset() { lastTimestamp = 0; }
+
+    static constexpr int64_t NS_PER_SECOND = 1000000000;  ///< Resolution of the timestamps
+
+   private:
+    int64_t lastTimestamp = 0;
+};
+
+}  // namespace comm
+
+#endif  // SAMPLECLOCK_H_
@@ -0,0 +1,156 @@
+/******************************************************************************
+ * Copyright (C) 2023 by Gschwind, Weber, Schoch, Niederberger                *
+ *                                                                            *
+ * This file is part of linescaleGUI.                                         *
+ *                                                                            *
+ * LinescaleGUI is free software: you can redistribute it and/or modify       *
+ * it under the terms of the GNU General Public License as published by       *
+ * the Free Software Foundation, either version 3 of the License, or          *
+ * (at your option) any later version.                                        *
+ *                                                                            *
+ * LinescaleGUI is distributed in the hope that it will be useful,            *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of             *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the               *
+ * GNU General Public License for more details.                               *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License          *
+ * along with linescaleGUI. If not, see <http://www.gnu.org/licenses/>.       *
+ ******************************************************************************/
+/**
+ * @file spscQueue.h
+ * @authors Gschwind, Weber, Schoch, Niederberger
+ *
+ * @brief `comm::SpscQueue` declaration and implementation
+ *
+ */
+
+#pragma once
+#ifndef SPSCQUEUE_H_
+#define SPSCQUEUE_H_
+
+#include <atomic>
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+namespace comm {
+
+/// @todo Better way to disable the padding warning for MSVC.
+#if _MSC_VER && !__INTEL_COMPILER
+#pragma warning(push)
+#pragma warning(disable : 4324)
+#endif
+
+/**
+ * @brief Lock-free queue for exactly one producer and one consumer thread
+ *
+ * Used to hand samples from the I/O thread to the GUI thread. Both sides work
+ * on batches, so the atomic indices are only touched once per batch. The
+ * indices live on separate cache lines to avoid false sharing.
+ *
+ * If the queue is full, new elements are rejected and counted instead of
+ * blocking the producer.
+ *
+ * @tparam T Trivially copyable element type
+ */
+template <typename T>
+class SpscQueue {
+    static_assert(std::is_trivially_copyable<T>::value, "T must be trivially copyable");
+
+   public:
+    /**
+     * @brief Construct a new queue
+     *
+     * @param capacity Maximum number of queued elements, rounded up to the next power of two
+     */
+    explicit SpscQueue(size_t capacity) {
+        size_t rounded = 1;
+        while (rounded < capacity) {
+            rounded <<= 1;
+        }
+        buffer.resize(rounded);
+        mask = rounded - 1;
+    }
+
+    /**
+     * @brief Append elements; producer thread only
+     *
+     * @param items Elements to append
+     * @param count Number of elements
+     * @return size_t Number of elements appended; the rest is dropped and counted
+     */
+    size_t push(const T* items, size_t count) {
+        size_t head = writeIndex.load(std::memory_order_relaxed);
+        if (buffer.size() - (head - cachedReadIndex) < count) {
+            cachedReadIndex = readIndex.load(std::memory_order_acquire);
+        }
+        size_t free = buffer.size() - (head - cachedReadIndex);
+        size_t accepted = count < free ? count : free;
+        for (size_t i = 0; i < accepted; ++i) {
+            buffer[(head + i) & mask] = items[i];
+        }
+        writeIndex.store(head + accepted, std::memory_order_release);
+        if (accepted < count) {
+            droppedCount.fetch_add(count - accepted, std::memory_order_relaxed);
+        }
+        return accepted;
+    }
+
+    /**
+     * @brief Remove elements; consumer thread only
+     *
+     * @param items Caller provided array for the removed elements
+     * @param maxCount Maximum number of elements to remove
+     * @return size_t Number of elements written to `items`
+     */
+    size_t pop(T* items, size_t maxCount) {
+        size_t tail = readIndex.load(std::memory_order_relaxed);
+        if (cachedWriteIndex - tail < maxCount) {
+            cachedWriteIndex = writeIndex.load(std::memory_order_acquire);
+        }
+        size_t available = cachedWriteIndex - tail;
+        size_t taken = maxCount < available ? maxCount : available;
+        for (size_t i = 0; i < taken; ++i) {
+            items[i] = buffer[(tail + i) & mask];
+        }
+        readIndex.store(tail + taken, std::memory_order_release);
+        return taken;
+    }
+
+    /**
+     * @brief Get the approximate number of queued elements
+     *
+     * @return size_t Number of elements; exact only if neither side is active
+     */
+    size_t size() const {
+        return writeIndex.load(std::memory_order_acquire) - readIndex.load(std::memory_order_acquire);
+    }
+
+    size_t capacity() const { return buffer.size(); }  ///< Maximum number of queued elements
+
+    /**
+     * @brief Get the number of elements dropped because the queue was full
+     *
+     * @return size_t Total number of dropped elements
+     */
+    size_t dropped() const { return droppedCount.load(std::memory_order_relaxed); }
+
+   private:
+    std::vector<T> buffer;
+    size_t mask;
+
+    alignas(64) std::atomic<size_t> writeIndex{0};  ///< Written by the producer
+    size_t cachedReadIndex = 0;                     ///< Producer's copy of `readIndex`
+    std::atomic<size_t> droppedCount{0};            ///< Written by the producer
+
+    alignas(64) std::atomic<size_t> readIndex{0};  ///< Written by the consumer
+    size_t cachedWriteIndex = 0;                   ///< Consumer's copy of `writeIndex`
+};
+
+#if _MSC_VER && !__INTEL_COMPILER
+#pragma warning(pop)
+#endif
+
+}  // namespace comm
+
+#endif  // SPSCQUEUE_H_
@@ -0,0 +1,190 @@
+/******************************************************************************
+ * Copyright (C) 2023 by Gschwind, Weber, Schoch, Niederberger                *
+ *                                                                            *
+ * This file is part of linescaleGUI.                                         *
+ *                                                                            *
+ * LinescaleGUI is free software: you can redistribute it and/or modify       *
+ * it under the terms of the GNU General Public License as published by       *
+ * the Free Software Foundation, either version 3 of the License, or          *
+ * (at your option) any later version.                                        *
+ *                                                                            *
+ * LinescaleGUI is distributed in the hope that it will be useful,            *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of             *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the               *
+ * GNU General Public License for more details.                               *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License          *
+ * along with linescaleGUI. If not, see <http://www.gnu.org/licenses/>.       *
+ ******************************************************************************/
+/**
+ * @file streamMerger.cpp
+ * @authors Gschwind, Weber, Schoch, Niederberger
+ *
+ * @brief `comm::StreamMerger` implementation
+ *
+ */
+
+#include "streamMerger.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include "sampleClock.h"
+
+namespace comm {
+
+void StreamMerger::setResampling(Interpolation mode, int frequency) {
+    interpolation = frequency > 0 ? mode : Interpolation::NONE;
+    period = frequency > 0 ? SampleClock::NS_PER_SECOND / frequency : 0;
+    nextGridTime = 0;
+}
+
+void StreamMerger::push(const Sample* samples, size_t count) {
+    Stream* stream = nullptr;
+    for (size_t i = 0; i < count; ++i) {
+        const Sample& sample = samples[i];
+        if (sample.timestamp == 0) {
+            continue;
+        }
+        if (stream == nullptr || stream->deviceId != sample.deviceId) {
+            auto position = std::lower_bound(streams.begin(), streams.end(), sample.deviceId,
+                                             [](const Stream& s, uint16_t id) { return s.deviceId < id; });
+            if (position == streams.end() || position->deviceId != sample.deviceId) {
+                Stream added;
+                added.deviceId = sample.deviceId;
+                position = streams.insert(position, std::move(added));
+            }
+            stream = &*position;
+        }
+        if (sample.timestamp <= released || sample.timestamp <= stream->newest) {
+            ++lateSamples;
+            continue;
+        }
+        stream->samples.push_back(sample);
+        stream->newest = sample.timestamp;
+    }
+}
+
+void StreamMerger::removeDevice(uint16_t deviceId) {
+    streams.erase(std::remove_if(streams.begin(), streams.end(),
+                                 [deviceId](const Stream& s) { return s.deviceId == deviceId; }),
+                  streams.end());
+}
+
+void StreamMerger::clear() {
+    streams.clear();
+    released = 0;
+    nextGridTime = 0;
+}
+
+int64_t StreamMerger::getWatermark() const {
+    int64_t newest = 0;
+    int64_t slowest = std::numeric_limits<int64_t>::max();
+    for (const Stream& stream : streams) {
+        newest = std::max(newest, stream.newest);
+        slowest = std::min(slowest, stream.newest);
+    }
+    if (newest == 0) {
+        return released;
+    }
+    // A stalled device delays the output by at most `maxLatency`
+    return std::max({released, slowest, newest - maxLatency});
+}
+
+size_t StreamMerger::takeMerged(Sample* output, size_t maxCount) {
+    int64_t watermark = getWatermark();
+    size_t count = 0;
+    while (count < maxCount) {
+        // Few devices, so a linear search for the oldest head beats a heap
+        Stream* oldest = nullptr;
+        for (Stream& stream : streams) {
+            if (!stream.samples.empty() && stream.samples.front().timestamp <= watermark &&
+                (oldest == nullptr || stream.samples.front().timestamp < oldest->samples.front().timestamp)) {
+                oldest = &stream;
+            }
+        }
+        if (oldest == nullptr) {
+            break;
+        }
+        output[count++] = oldest->samples.front();
+        oldest->samples.pop_front();
+    }
+    // Everything up to the watermark was released if the output was not full
+    if (count < maxCount) {
+        released = watermark;
+    }
+    return count;
+}
+
+double StreamMerger::valueAt(const Stream& stream, int64_t time) const {
+    const std::deque<Sample>& samples = stream.samples;
+    if (samples.empty() || samples.front().timestamp > time) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    // After pruning the sample at or before `time` is one of the first two
+    size_t before = samples.size() > 1 && samples[1].timestamp <= time ? 1 : 0;
+    double value = toKiloNewton(samples[before]);
+    if (interpolation == Interpolation::LINEAR && before + 1 < samples.size()) {
+        const Sample& next = samples[before + 1];
+        double fraction = double(time - samples[before].timestamp) / double(next.timestamp - samples[before].timestamp);
+        value += fraction * (toKiloNewton(next) - value);
+    }
+    return value;
+}
+
+size_t StreamMerger::takeAligned(AlignedFrame* frames, double* forces, size_t maxFrames) {
+    if (interpolation == Interpolation::NONE || streams.empty()) {
+        return 0;
+    }
+    int64_t watermark = getWatermark();
+    if (nextGridTime == 0) {
+        int64_t first = std::numeric_limits<int64_t>::max();
+        for (const Stream& stream : streams) {
+            if (!stream.samples.empty()) {
+                first = std::min(first, stream.samples.front().timestamp);
+            }
+        }
+        if (first == std::numeric_limits<int64_t>::max()) {
+            return 0;
+        }
+        nextGridTime = (first + period - 1) / period * period;
+    }
+
+    size_t count = 0;
+    while (count < maxFrames && nextGridTime <= watermark) {
+        AlignedFrame& frame = frames[count];
+        frame = AlignedFrame{};
+        frame.timestamp = nextGridTime;
+        for (size_t i = 0; i < streams.size(); ++i) {
+            Stream& stream = streams[i];
+            // Keep only the last sample at or before the grid time and the ones after it
+            while (stream.samples.size() > 1 && stream.samples[1].timestamp <= nextGridTime) {
+                stream.samples.pop_front();
+            }
+            double value = valueAt(stream, nextGridTime);
+            forces[count * streams.size() + i] = value;
+            if (!std::isnan(value)) {
+                frame.total += value;
+                ++frame.devices;
+            }
+        }
+        released = nextGridTime;
+        nextGridTime += period;
+        ++count;
+    }
+    return count;
+}
+
+std::vector<uint16_t> StreamMerger::getDevices() const {
+    std::vector<uint16_t> devices;
+    devices.reserve(streams.size());
+    for (const Stream& stream : streams) {
+        devices.push_back(stream.deviceId);
+    }
+    return devices;
+}
+
+double StreamMerger::toKiloNewton(const Sample& sample) {
+    return sample.measuredValue / factorFromKn(sample.unitValue);
+}
+
+}  // namespace comm
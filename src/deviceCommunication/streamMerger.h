@@ -0,0 +1,197 @@
+/******************************************************************************
+ * Copyright (C) 2023 by Gschwind, Weber, Schoch, Niederberger                *
+ *                                                                            *
+ * This file is part of linescaleGUI.                                         *
+ *                                                                            *
+ * LinescaleGUI is free software: you can redistribute it and/or modify       *
+ * it under the terms of the GNU General Public License as published by       *
+ * the Free Software Foundation, either version 3 of the License, or          *
+ * (at your option) any later version.                                        *
+ *                                                                            *
+ * LinescaleGUI is distributed in the hope that it will be useful,            *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of             *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the               *
+ * GNU General Public License for more details.                               *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License          *
+ * along with linescaleGUI. If not, see <http://www.gnu.org/licenses/>.       *
+ ******************************************************************************/
+/**
+ * @file streamMerger.h
+ * @authors Gschwind, Weber, Schoch, Niederberger
+ *
+ * @brief `comm::StreamMerger` declaration
+ *
+ */
+
+#pragma once
+#ifndef STREAMMERGER_H_
+#define STREAMMERGER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+#include "../parser/parser.h"
+
+namespace comm {
+
+/**
+ * @brief Enum to describe how the streams are mapped onto a shared clock
+ *
+ */
+enum class Interpolation {
+    NONE,             ///< No resampling, the samples are only merged in timestamp order
+    ZERO_ORDER_HOLD,  ///< Use the last sample at or before the grid time
+    LINEAR,           ///< Interpolate between the samples around the grid time
+};
+
+/**
+ * @brief One point of the shared clock
+ *
+ * The force of every device at this time is written to a separate array, see
+ * `StreamMerger::takeAligned`.
+ */
+struct AlignedFrame {
+    int64_t timestamp = 0;  ///< Grid time in ns of the host steady clock
+    double total = 0.0;     ///< Sum of the forces of all valid devices in kN
+    uint16_t devices = 0;   ///< Number of devices with a valid force at this time
+};
+
+/**
+ * @brief Merge the sample streams of several devices onto one time base
+ *
+ * Every device has its own queue, ordered by `Sample::timestamp`. The merger
+ * only releases data up to the watermark: the newest time for which all
+ * devices have delivered their samples. A device which falls behind by more
+ * than the maximum latency no longer holds the watermark back, so the output
+ * is delayed by at most that latency. Samples arriving below an already
+ * released watermark are dropped and counted.
+ *
+ * The output is either the k-way merge of all samples (`takeMerged`) or,
+ * with resampling enabled, one `AlignedFrame` per period of a shared clock
+ * (`takeAligned`). Forces are combined in kN regardless of the unit of the devices.
+ */
+class StreamMerger {
+   public:
+    /**
+     * @brief Construct a new stream merger
+     *
+     * @param maxLatency Maximum delay of the watermark behind the newest sample in ns
+     */
+    explicit StreamMerger(int64_t maxLatency = DEFAULT_MAX_LATENCY) : maxLatency(maxLatency) {}
+
+    /**
+     * @brief Enable resampling onto a shared clock
+     *
+     * @param mode Interpolation used; `Interpolation::NONE` disables resampling
+     * @param frequency Frequency of the shared clock in Hz
+     */
+    void setResampling(Interpolation mode, int frequency);
+
+    Interpolation getInterpolation() const { return interpolation; }  ///< Current resampling mode
+
+    /**
+     * @brief Queue new samples
+     *
+     * Samples are assigned to their device by `Sample::deviceId`; unknown devices
+     * are added automatically. Samples without timestamp are ignored.
+     *
+     * @param samples Samples, oldest first per device
+     * @param count Number of samples
+     */
+    void push(const Sample* samples, size_t count);
+
+    /**
+     * @brief Forget a device and all its queued samples
+     *
+     * @param deviceId `Sample::deviceId` of the device
+     */
+    void removeDevice(uint16_t deviceId);
+
+    /**
+     * @brief Forget all devices and samples
+     *
+     */
+    void clear();
+
+    /**
+     * @brief Take the queued samples of all devices up to the watermark, ordered by timestamp
+     *
+     * @param output Caller provided array for the samples
+     * @param maxCount Maximum number of samples to take
+     * @return size_t Number of samples written to `output`
+     */
+    size_t takeMerged(Sample* output, size_t maxCount);
+
+    /**
+     * @brief Take the points of the shared clock up to the watermark
+     *
+     * Requires resampling, see `setResampling`. For every frame, the force of
+     * each device in kN is written to `forces`, ordered as returned by `getDevices`.
+     * Devices without a value at the grid time are written as NaN.
+     *
+     * @param frames Caller provided array for the frames
+     * @param forces Caller provided array with room for `maxFrames * deviceCount()` forces
+     * @param maxFrames Maximum number of frames to take
+     * @return size_t Number of frames written to `frames`
+     */
+    size_t takeAligned(AlignedFrame* frames, double* forces, size_t maxFrames);
+
+    /**
+     * @brief Get the time up to which all devices have delivered their samples
+     *
+     * @return int64_t Watermark in ns; 0 if no sample was queued yet
+     */
+    int64_t getWatermark() const;
+
+    /**
+     * @brief Get the devices in the order used by `takeAligned`
+     *
+     * @return std::vector<uint16_t> `Sample::deviceId` of every device
+     */
+    std::vector<uint16_t> getDevices() const;
+
+    size_t deviceCount() const { return streams.size(); }  ///< Number of known devices
+    uint64_t getLateSamples() const { return lateSamples; }  ///< Samples dropped below the watermark
+
+    /**
+     * @brief Convert the measured force of a sample to kN
+     *
+     * @param sample Sample in any unit
+     * @return double Force in kN
+     */
+    static double toKiloNewton(const Sample& sample);
+
+    static constexpr int64_t DEFAULT_MAX_LATENCY = 50000000;  ///< 50 ms, a few drains of the GUI
+
+   private:
+    /**
+     * @brief Queued samples of one device
+     *
+     */
+    struct Stream {
+        uint16_t deviceId = 0;
+        int64_t newest = 0;  ///< Timestamp of the newest queued sample
+        std::deque<Sample> samples;
+    };
+
+    /**
+     * @brief Get the force of a stream at a grid time
+     *
+     * @return double Force in kN or NaN if there is no sample at or before `time`
+     */
+    double valueAt(const Stream& stream, int64_t time) const;
+
+    std::vector<Stream> streams;  ///< Ordered by device ID
+    int64_t maxLatency;
+    int64_t released = 0;    ///< Data up to this time was already released
+    int64_t nextGridTime = 0;
+    int64_t period = 0;
+    Interpolation interpolation = Interpolation::NONE;
+    uint64_t lateSamples = 0;
+};
+
+}  // namespace comm
+
+#endif  // STREAMMERGER_H_
@@ -26,6 +26,7 @@
 
 #include "connectionWidget.h"
 #include <QPushButton>
+#include <QSignalBlocker>
 #include "ui_connectionWidget.h"
 
 ConnectionWidget::ConnectionWidget(QWidget* parent) : QWidget(parent), ui(new Ui::ConnectionWidget) {
@@ -42,7 +43,8 @@ ConnectionWidget::ConnectionWidget(QWidget* parent) : QWidget(parent), ui(new Ui
     ui->boxUnit->addItem("kgf", static_cast<int>(UnitValue::KGF));
     ui->boxUnit->setCurrentIndex(-1);  // clear box
 
-    connect(ui->btnRemove, &QPushButton::pressed, this, [=] { communication->removeConnection(); });
+    connect(ui->btnRemove, &QPushButton::pressed, this, &ConnectionWidget::removeSelectedDevice);
+    connect(ui->boxDevice, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &ConnectionWidget::selectDevice);
     connect(ui->boxFreq, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &ConnectionWidget::requestNewFreq);
     connect(ui->boxUnit, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &ConnectionWidget::requestNewUnit);
 }
@@ -53,13 +55,47 @@ ConnectionWidget::~ConnectionWidget() {
 
 void ConnectionWidget::setCommunicationMaster(comm::CommMaster* comm) {
     this->communication = comm;
+    connect(comm, &comm::CommMaster::changedStateMaster, this, &ConnectionWidget::updateDevices);
+    connect(comm, &comm::CommMaster::changedActiveDevice, this, &ConnectionWidget::updateDevices);
+    updateDevices();
+}
+
+QString ConnectionWidget::getSelectedDevice() const {
+    return ui->boxDevice->currentData().toString();
+}
+
+void ConnectionWidget::selectDevice(int index) {
+    if (index >= 0 && communication != nullptr) {
+        communication->setActiveDevice(ui->boxDevice->itemData(index).toString());
+    }
+}
+
+void ConnectionWidget::updateDevices() {
+    if (communication == nullptr) {
+        return;
+    }
+    // Only the user changes the active device through the selector
+    QSignalBlocker blocker(ui->boxDevice);
+    ui->boxDevice->clear();
+    const QStringList devices = communication->getConnectedDevices();
+    for (const QString& deviceId : devices) {
+        ui->boxDevice->addItem(QString("%1: %2").arg(communication->getDeviceNumber(deviceId)).arg(deviceId), deviceId);
+    }
+    ui->boxDevice->setCurrentIndex(ui->boxDevice->findData(communication->getActiveDevice()));
+}
+
+void ConnectionWidget::removeSelectedDevice() {
+    QString deviceId = getSelectedDevice();
+    if (communication != nullptr && !deviceId.isEmpty()) {
+        communication->removeConnection(deviceId);
+    }
 }
 
 void ConnectionWidget::requestNewFreq(int index) {
     if (index >= 0 && index < ui->boxFreq->count()) {
         int newFreq = ui->boxFreq->currentData().toInt();
         if (communication != nullptr) {
-            communication->setNewFreq(newFreq);
+            communication->setNewFreq(communication->getActiveDevice(), newFreq);
         }
     }
 }
@@ -68,7 +104,7 @@ void ConnectionWidget::requestNewUnit(int index) {
     if (index >= 0 && index < ui->boxUnit->count()) {
         UnitValue unit = UnitValue(ui->boxUnit->currentData().toInt());
         if (communication != nullptr) {
-            communication->setNewUnit(unit);
+            communication->setNewUnit(communication->getActiveDevice(), unit);
         }
     }
 }
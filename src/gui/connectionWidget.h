@@ -79,6 +79,13 @@ class ConnectionWidget : public QWidget {
      */
     void setCommunicationMaster(comm::CommMaster* comm);
 
+    /**
+     * @brief Get the device selected in the device selector
+     *
+     * @return QString `comm::DeviceInfo::ID` of the device; empty if none is connected
+     */
+    QString getSelectedDevice() const;
+
     /**
      * @brief Updates the data inside the device widget
      *
@@ -88,6 +95,28 @@ class ConnectionWidget : public QWidget {
 
    private slots:
 
+    /**
+     * @brief Make the selected device the active device
+     *
+     * Called upon a change on the device selector.
+     *
+     * @param index Index of the current item in the device selector, -1 if empty
+     */
+    void selectDevice(int index);
+
+    /**
+     * @brief Fill the device selector with the connected devices
+     *
+     * Called if a device was added or removed or the active device changed.
+     */
+    void updateDevices();
+
+    /**
+     * @brief Disconnect the device selected in the device selector
+     *
+     */
+    void removeSelectedDevice();
+
     /**
      * @brief Request new frequency from the connected device
      *
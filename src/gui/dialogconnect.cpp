@@ -84,7 +84,7 @@ void DialogConnect::requestConnection() {
     }
     bool success = comm->addConnection(devices[index]);
     if (success) {
-        comm->setNewFreq(ui->boxFreq->currentData().toInt());
+        comm->setNewFreq(devices[index].ID, ui->boxFreq->currentData().toInt());
         close();
     }
 }
@@ -76,7 +76,7 @@ void DialogDebug::appendText(const QString& text, const QColor& color) {
 void DialogDebug::sendMsg() {
     QString payload = ui->inputPayload->text();
     appendText(payload, Qt::blue);
-    comm->sendData(payload);
+    comm->sendData(comm->getActiveDevice(), payload);
 }
 
 void DialogDebug::clearLog() {
@@ -25,7 +25,10 @@
  */
 
 #include "mainwindow.h"
+#include <QDateTime>
 #include <QDesktopServices>
+#include <QFileDialog>
+#include <QInputDialog>
 #include <QTimer>
 #include "../deviceCommunication/command.h"
 #include "../notification/notification.h"
@@ -36,6 +39,9 @@ MainWindow::MainWindow(QWidget* parent) : QMainWindow(parent), ui(new Ui::MainWi
 
     notification = new Notification(ui->textBrowserLog);
     comm = new comm::CommMaster();
+    recorder = new Recorder(this);
+    publisher = new stream::SamplePublisher(this);
+    server = new stream::SampleServer(this);
 
     dAbout = new DialogAbout(this);
     dDebug = new DialogDebug(comm, this);
@@ -53,10 +59,16 @@ MainWindow::MainWindow(QWidget* parent) : QMainWindow(parent), ui(new Ui::MainWi
     connect(ui->actionClearLog, &QAction::triggered, notification, &Notification::clear);
     connect(ui->actionSaveLog, &QAction::triggered, notification, &Notification::saveLog);
     connect(ui->actionSaveImage, &QAction::triggered, ui->widgetChart, &Plot::saveImage);
+    connect(ui->actionRecord, &QAction::triggered, this, &MainWindow::triggerRecording);
+    connect(ui->actionOpenLogfile, &QAction::triggered, this, &MainWindow::openLogfile);
+    connect(ui->actionReplayLogfile, &QAction::triggered, this, &MainWindow::replayLogfile);
+    connect(ui->actionPublish, &QAction::triggered, this, &MainWindow::triggerPublishing);
+    connect(ui->actionServe, &QAction::triggered, this, &MainWindow::triggerServing);
+    connect(ui->actionCapture, &QAction::triggered, this, &MainWindow::triggerCapturing);
 
     // Tool bar actions
     connect(ui->actionConnect, &QAction::triggered, dConnect, &DialogConnect::show);
-    connect(ui->actionDisconnect, &QAction::triggered, this, [=] { comm->removeConnection(); });
+    connect(ui->actionDisconnect, &QAction::triggered, this, [=] { comm->removeAllConnections(); });
     connect(ui->actionStartStop, &QAction::triggered, this, &MainWindow::triggerReadings);
 
     // Buttons next to readings
@@ -65,8 +77,23 @@ MainWindow::MainWindow(QWidget* parent) : QMainWindow(parent), ui(new Ui::MainWi
     connect(ui->btnResetPeak, &QPushButton::pressed, this, &MainWindow::sendResetPeak);
 
     // updates from CommMaster
-    connect(comm, &comm::CommMaster::newSampleMaster, this, &MainWindow::receiveNewSample);
+    connect(comm, &comm::CommMaster::newSamplesMaster, this, &MainWindow::receiveNewSamples);
+    connect(comm, &comm::CommMaster::newSamplesMaster, recorder, &Recorder::addSamples);
+    connect(comm, &comm::CommMaster::newSamplesMaster, publisher, &stream::SamplePublisher::publish);
+    connect(comm, &comm::CommMaster::newSamplesMaster, server, &stream::SampleServer::publish);
+    connect(server, &stream::SampleServer::commandReceived, this, &MainWindow::sendClientCommand);
     connect(comm, &comm::CommMaster::changedStateMaster, this, &MainWindow::toggleActions);
+    connect(comm, &comm::CommMaster::changedStateMaster, this, &MainWindow::reportReplay);
+    connect(comm, &comm::CommMaster::changedActiveDevice, this, &MainWindow::changeActiveDevice);
+    connect(comm, &comm::CommMaster::samplesMissing, this, [=](const QString& deviceId, quint64 count) {
+        notification->push(QString("%1: %2 samples missing").arg(deviceId).arg(count));
+    });
+    connect(comm, &comm::CommMaster::errorMaster, this, [=](const QString& deviceId, const QString& message) {
+        notification->push(QString("%1: %2").arg(deviceId, message), Notification::SEVERITY_WARNING);
+    });
+
+    // Signal from the recorder
+    connect(recorder, &Recorder::recordingFailed, this, [=] { notification->push("Recording failed"); });
 
     // Signal from plotWidget
     connect(ui->widgetChart, &Plot::stopHardware, this, [=]{triggerReadings(true);});
@@ -84,6 +111,7 @@ MainWindow::MainWindow(QWidget* parent) : QMainWindow(parent), ui(new Ui::MainWi
 }
 
 MainWindow::~MainWindow() {
+    recorder->stop();
     delete comm;
     delete ui;
     delete notification;
@@ -99,63 +127,241 @@ void MainWindow::showLog(void) {
 }
 
 void MainWindow::sendResetPeak() {
-    comm->sendData(command::RESETPEAK);
-    maxValue = 0;
+    comm->sendData(comm->getActiveDevice(), command::RESETPEAK);
+    peakValue = FixedPoint{};
+    peakUnit = UnitValue::NONE;
     ui->lblPeakForce->setText("-");
 }
 
 void MainWindow::sendSetAbsoluteZero() {
-    comm->sendData(command::SETABSOLUTEMODE);
+    comm->sendData(comm->getActiveDevice(), command::SETABSOLUTEMODE);
 }
 
 void MainWindow::sendSetRelativeZero() {
-    comm->sendData(command::SETRELATIVEMODE);
-    comm->sendData(command::SETZERO);
+    comm->sendData(comm->getActiveDevice(), command::SETRELATIVEMODE);
+    comm->sendData(comm->getActiveDevice(), command::SETZERO);
 }
 
 void MainWindow::triggerReadings(bool forceStop) {
     statusReading = forceStop ? forceStop : statusReading;
     if (!statusReading) {
-        comm->sendData(command::REQUESTONLINE);
+        for (const QString& deviceId : comm->getConnectedDevices()) {
+            comm->sendData(deviceId, command::REQUESTONLINE);
+        }
     } else {
         QTimer::singleShot(10, [=] { statusReading = false; });
         notification->push("Stop reading");
-        comm->sendData(command::DISCONNECTONLINE);
+        for (const QString& deviceId : comm->getConnectedDevices()) {
+            comm->sendData(deviceId, command::DISCONNECTONLINE);
+        }
+    }
+}
+
+void MainWindow::triggerRecording(bool record) {
+    if (!record) {
+        qint64 count = recorder->getSampleCount();
+        bool success = recorder->stop();
+        notification->push(success ? QString("Recorded %1 samples").arg(count) : QString("Recording failed"));
+        return;
+    }
+
+    QString fileName = QFileDialog::getSaveFileName(this, "", "Recording", "Binary Logfile (*.lscb)");
+    Metadata metadata{};
+    metadata.deviceID = comm->getActiveDevice();
+    metadata.date = QDate::currentDate().toString("dd.MM.yy");
+    metadata.time = QTime::currentTime().toString("HH:mm:ss");
+    if (fileName.isEmpty() || !recorder->start(fileName, metadata, comm->getDeviceNumber(comm->getActiveDevice()))) {
+        ui->actionRecord->setChecked(false);
+        notification->push("Recording canceled");
+        return;
+    }
+    notification->push("Start recording to " + fileName);
+}
+
+void MainWindow::triggerPublishing(bool share) {
+    if (!share) {
+        publisher->close();
+        notification->push("Stop sharing samples");
+        return;
+    }
+    if (!publisher->open()) {
+        ui->actionPublish->setChecked(false);
+        notification->push(stream::SamplePublisher::isPublished() ? "Samples are already shared by another process"
+                                                                  : "Unable to share samples");
+        return;
     }
+    notification->push("Sharing samples in " + publisher->getName());
 }
 
-void MainWindow::receiveNewSample(Sample reading) {
+void MainWindow::triggerServing(bool serve) {
+    if (!serve) {
+        server->close();
+        notification->push("Stop serving samples");
+        return;
+    }
+    if (!server->listen()) {
+        ui->actionServe->setChecked(false);
+        notification->push("Unable to serve samples");
+        return;
+    }
+    notification->push("Serving samples on " + server->getSocketPath());
+}
+
+void MainWindow::triggerCapturing(bool capture) {
+    if (!capture) {
+        comm->setCaptureDirectory(QString());
+        notification->push("Stop capturing raw bytes of new connections");
+        return;
+    }
+    QString directory = QFileDialog::getExistingDirectory(this, "Directory of the raw captures");
+    if (directory.isEmpty()) {
+        ui->actionCapture->setChecked(false);
+        return;
+    }
+    comm->setCaptureDirectory(directory);
+    notification->push("Capturing raw bytes of new connections into " + directory);
+}
+
+void MainWindow::sendClientCommand(quint16 device, const QByteArray& command) {
+    QString deviceId = device == 0 ? comm->getActiveDevice() : comm->getDeviceId(device);
+    if (deviceId.isEmpty() || !comm->getConnectedDevices().contains(deviceId)) {
+        notification->push(QString("Command of a client for unknown device %1").arg(device));
+        return;
+    }
+    comm->sendData(deviceId, command);
+}
+
+void MainWindow::openLogfile() {
+    QString fileName = QFileDialog::getOpenFileName(this, "", "",
+                                                    "Logfile (*.csv *.lscb)\nCSV Logfile (*.csv)\n"
+                                                    "Binary Logfile (*.lscb)");
+    if (fileName.isEmpty()) {
+        return;
+    }
+    Logfile logfile;
+    logfile.setPath(fileName);
+    int result = logfile.load();
+    if (result != 0) {
+        notification->push(QString("Unable to load %1 (%2)").arg(fileName).arg(result),
+                           Notification::SEVERITY_WARNING);
+        return;
+    }
+    ui->widgetChart->addLogfile(logfile);
+    notification->push(QString("Loaded %1 samples from %2").arg(logfile.getSampleCount()).arg(fileName));
+}
+
+void MainWindow::replayLogfile() {
+    QString fileName = QFileDialog::getOpenFileName(
+        this, "", "", "Logfile or capture (*.csv *.lscb *.lsraw)\nLogfile (*.csv *.lscb)\nRaw capture (*.lsraw)");
+    if (fileName.isEmpty()) {
+        return;
+    }
+    bool ok;
+    double speed = QInputDialog::getDouble(this, "Replay logfile", "Multiple of real time, 0 for as fast as possible",
+                                           1.0, 0.0, 1000.0, 1, &ok);
+    if (!ok) {
+        return;
+    }
+    comm::DeviceInfo device{comm::ConnType::REPLAY, fileName, 0};
+    device.replaySpeed = speed;
+    if (!comm->addConnection(device)) {
+        notification->push(QString("Unable to replay %1").arg(fileName), Notification::SEVERITY_WARNING);
+        return;
+    }
+    replayId = fileName;
+    notification->push(QString("Replaying %1 once the reading is started").arg(fileName));
+}
+
+void MainWindow::reportReplay() {
+    if (replayId.isEmpty()) {
+        return;
+    }
+    comm::ReplayStatistics statistics = comm->getReplayStatistics(replayId);
+    if (!statistics.finished) {
+        return;
+    }
+    notification->push(QString("Replayed %1 samples in %2 s, %3 Hz, %4 x real time")
+                           .arg(statistics.samples)
+                           .arg(statistics.elapsed, 0, 'f', 2)
+                           .arg(statistics.sampleRate, 0, 'f', 0)
+                           .arg(statistics.speed, 0, 'f', 1));
+    if (statistics.bytesLost > 0) {
+        notification->push(QString("%1 bytes are missing in the capture %2, they were dropped while capturing")
+                               .arg(statistics.bytesLost)
+                               .arg(replayId),
+                           Notification::SEVERITY_WARNING);
+    }
+    replayId.clear();
+}
+
+void MainWindow::changeActiveDevice(const QString& deviceId) {
+    activeDeviceNumber = comm->getDeviceNumber(deviceId);
+    currentUnit = UnitValue::NONE;  // Update the unit with the next sample
+    peakValue = FixedPoint{-1000, 0};  // The next sample is the new peak
+    peakUnit = UnitValue::NONE;
+    ui->lblPeakForce->setText("-");
+    ui->widgetChart->beginNewGraph();
+}
+
+void MainWindow::receiveNewSamples(const QVector<Sample>& allReadings) {
+    // Only the samples of the active device are shown
+    activeReadings.clear();
+    for (const Sample& reading : allReadings) {
+        if (reading.deviceId == activeDeviceNumber) {
+            activeReadings.append(reading);
+        }
+    }
+    const QVector<Sample>& readings = activeReadings;
+    if (readings.isEmpty()) {
+        return;
+    }
     if (!statusReading) {
         notification->push("Start reading");
         statusReading = true;
     }
-    if (currentUnit != reading.unitValue) {
-        maxValue = -1000;  // Trigger reset of peak value to update the unit
-        currentUnit = reading.unitValue;
-        switch (reading.unitValue) {
-            case UnitValue::KN:
-                unitString = " kN";
-                break;
-            case UnitValue::LBF:
-                unitString = " lbf";
-                break;
-
-            case UnitValue::KGF:
-                unitString = " kgf";
-                break;
-            default:
-                break;
+
+    bool newPeak = false;
+    for (const Sample& reading : readings) {
+        if (currentUnit != reading.unitValue) {
+            newPeak = true;  // Show the peak in the new unit
+            currentUnit = reading.unitValue;
+            switch (reading.unitValue) {
+                case UnitValue::KN:
+                    unitString = " kN";
+                    break;
+                case UnitValue::LBF:
+                    unitString = " lbf";
+                    break;
+
+                case UnitValue::KGF:
+                    unitString = " kgf";
+                    break;
+                default:
+                    break;
+            }
+        }
+
+        // Exact within a unit, otherwise compared in kN
+        bool higher = (reading.unitValue == peakUnit || peakUnit == UnitValue::NONE)
+                          ? reading.measuredFixed >= peakValue
+                          : reading.measuredValue / factorFromKn(reading.unitValue) >= peakKn;
+        if (higher) {
+            peakValue = reading.measuredFixed;
+            peakUnit = reading.unitValue;
+            peakKn = reading.measuredValue / factorFromKn(peakUnit);
+            newPeak = true;
         }
     }
 
-    if (reading.measuredValue >= maxValue) {
-        maxValue = reading.measuredValue;
-        ui->lblPeakForce->setText(QString("%1").arg(reading.measuredValue, 3, 'f', 2) + unitString);
+    const Sample& newest = readings.last();
+    if (newPeak && peakUnit != UnitValue::NONE) {
+        double peakForce = peakUnit == currentUnit ? peakValue.toDouble() : peakKn * factorFromKn(currentUnit);
+        ui->lblPeakForce->setText(QString("%1").arg(peakForce, 3, 'f', 2) + unitString);
     }
-    ui->lblCurrentForce->setText(QString("%1").arg(reading.measuredValue, 3, 'f', 2) + unitString);
-    ui->lblReferenceZero->setText(QString("%1").arg(reading.referenceZero, 3, 'f', 2) + unitString);
-    ui->widgetConnection->updateWidget(reading);
-    ui->widgetChart->addConsecutiveSample(reading);
+    ui->lblCurrentForce->setText(QString("%1").arg(newest.measuredValue, 3, 'f', 2) + unitString);
+    ui->lblReferenceZero->setText(QString("%1").arg(newest.referenceZero, 3, 'f', 2) + unitString);
+    ui->widgetConnection->updateWidget(newest);
+    ui->widgetChart->addConsecutiveSamples(readings);
 }
 
 void MainWindow::toggleActions(bool connected) {
@@ -30,8 +30,11 @@
 
 #include <QMainWindow>
 #include "../deviceCommunication/commMaster.h"
+#include "../logfile/recorder.h"
 #include "../notification/notification.h"
 #include "../parser/parser.h"
+#include "../streaming/samplePublisher.h"
+#include "../streaming/sampleServer.h"
 #include "dialogabout.h"
 #include "dialogconnect.h"
 #include "dialogdebug.h"
@@ -99,18 +102,31 @@ class MainWindow : public QMainWindow {
 
    private slots:
     /**
-     * @brief Receive new sample from CommMaster
+     * @brief Receive new samples from CommMaster
      *
      * This slot updates the peak and current value of the right sidebar.
      * The correct unit is extracted from the `Sample` and set accordingly.
-     * When a change in unit is detected, the peak value is reset.
+     * The peak is kept when the unit changes and shown in the new unit.
+     * The peak is tracked over every sample, the labels are only updated
+     * once per batch with the newest sample.
      *
      * It also updates the bool `MainWindow::statusReading` keeping track of
      * the status of the connection.
      *
-     * @param reading Current sample
+     * Only the samples of the active device are shown.
+     *
+     * @param allReadings New samples of all devices, oldest first
+     */
+    void receiveNewSamples(const QVector<Sample>& allReadings);
+
+    /**
+     * @brief Show the samples of another device
+     *
+     * Resets the peak value and starts a new graph.
+     *
+     * @param deviceId `DeviceInfo::ID` of the new active device
      */
-    void receiveNewSample(Sample reading);
+    void changeActiveDevice(const QString& deviceId);
 
     /**
      * @brief Toggle the GUI elements on connection
@@ -126,9 +142,9 @@ class MainWindow : public QMainWindow {
     /**
      * @brief Start or stop the readings
      *
-     * Send the command to the connected device. If the host receives a new
+     * Send the command to all connected devices. If the host receives a new
      * statusReading, the bool `MainWindow::statusReading` will be enabled by
-     * `MainWindow::receiveNewSample`.
+     * `MainWindow::receiveNewSamples`.
      * If the host terminates the stream, the bool will be set to false after
      * a delay. This is to prevent buffered data from setting the bool to true.
      *
@@ -136,6 +152,72 @@ class MainWindow : public QMainWindow {
      */
     void triggerReadings(bool forceStop = false);
 
+    /**
+     * @brief Start or stop recording the active device to a binary logfile
+     *
+     * Triggered by the menu action "Record". Asks for the path when started.
+     *
+     * @param record True to start, false to stop the recording
+     */
+    void triggerRecording(bool record);
+
+    /**
+     * @brief Start or stop sharing the live samples with other local processes
+     *
+     * Triggered by the menu action "Share live samples", see `stream::SamplePublisher`.
+     *
+     * @param share True to create the shared memory ring, false to remove it
+     */
+    void triggerPublishing(bool share);
+
+    /**
+     * @brief Start or stop streaming the live samples to local clients
+     *
+     * Triggered by the menu action "Serve live samples", see `stream::SampleServer`.
+     *
+     * @param serve True to listen on the socket, false to disconnect all clients
+     */
+    void triggerServing(bool serve);
+
+    /**
+     * @brief Start or stop capturing the raw bytes of the devices connected from now on
+     *
+     * Triggered by the menu action "Capture raw bytes". Asks for the directory
+     * of the captures, see `comm::CommMaster::setCaptureDirectory`.
+     *
+     * @param capture True to capture the next connections
+     */
+    void triggerCapturing(bool capture);
+
+    /**
+     * @brief Forward a command of a streaming client to a device
+     *
+     * @param device Device number, 0 for the active device
+     * @param command Bytes of the command, see `command.h`
+     */
+    void sendClientCommand(quint16 device, const QByteArray& command);
+
+    /**
+     * @brief Show a logfile in a new graph
+     *
+     * Triggered by the menu action "Open logfile". Asks for the path.
+     */
+    void openLogfile();
+
+    /**
+     * @brief Play a logfile or a raw capture through the live path as if a device sent it
+     *
+     * Triggered by the menu action "Replay logfile". Asks for the path and the
+     * speed; the replay starts with the reading, see `comm::ReplayDevice`.
+     */
+    void replayLogfile();
+
+    /**
+     * @brief Show the throughput of a finished replay
+     *
+     */
+    void reportReplay();
+
    private:
     Ui::MainWindow* ui;
     comm::CommMaster* comm;
@@ -143,11 +225,19 @@ class MainWindow : public QMainWindow {
     DialogDebug* dDebug;
     DialogConnect* dConnect;
     Notification* notification;
+    Recorder* recorder;
+    stream::SamplePublisher* publisher;
+    stream::SampleServer* server;
     Plot* plot;
-    float maxValue = 0;
+    FixedPoint peakValue{-1000, 0};        ///< Highest value since the last reset, compared without rounding
+    UnitValue peakUnit = UnitValue::NONE;  ///< Unit of `peakValue`, `UnitValue::NONE` before the first peak
+    double peakKn = 0.0;                   ///< `peakValue` in kN, to compare and show it in other units
     bool statusReading = false;  ///< Tracks whether the host reads data or not
     UnitValue currentUnit;       ///< Current unit value, used to detect a change
     QString unitString = "";     ///< Cache the current unitString
+    quint16 activeDeviceNumber = 0;  ///< `Sample::deviceId` of the shown device
+    QString replayId;                ///< `DeviceInfo::ID` of the replay not reported yet; empty if none
+    QVector<Sample> activeReadings;  ///< Samples of the shown device, reused for every batch
 };
 
 #endif  // MAINWINDOW_H_
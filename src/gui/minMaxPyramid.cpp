@@ -0,0 +1,245 @@
+/******************************************************************************
+ * Copyright (C) 2023 by Gschwind, Weber, Schoch, Niederberger                *
+ *                                                                            *
+ * This file is part of linescaleGUI.                                         *
+ *                                                                            *
+ * LinescaleGUI is free software: you can redistribute it and/or modify       *
+ * it under the terms of the GNU General Public License as published by       *
+ * the Free Software Foundation, either version 3 of the License, or          *
+ * (at your option) any later version.                                        *
+ *                                                                            *
+ * LinescaleGUI is distributed in the hope that it will be useful,            *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of             *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the               *
+ * GNU General Public License for more details.                               *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License          *
+ * along with linescaleGUI. If not, see <http://www.gnu.org/licenses/>.       *
+ ******************************************************************************/
+/**
+ * @file minMaxPyramid.cpp
+ * @authors Gschwind, Weber, Schoch, Niederberger
+ *
+ * @brief `MinMaxPyramid` implementation
+ *
+ */
+
+#include "minMaxPyramid.h"
+#include <algorithm>
+
+void MinMaxPyramid::append(double time, double value) {
+    detach();
+    times.append(time);
+    values.append(value);
+    extend(times.size());
+}
+
+void MinMaxPyramid::append(const QVector<double>& newTimes, const QVector<double>& newValues) {
+    for (int i = 0; i < newTimes.size(); ++i) {
+        append(newTimes[i], newValues[i]);
+    }
+}
+
+void MinMaxPyramid::assign(const TimeAxis& newTimes, const QVector<float>& newValues, double newScale) {
+    clear();
+    axis = newTimes.mid(0, newValues.size());
+    forces = newValues;
+    valueScale = newScale;
+    assigned = true;
+
+    // Only the buckets are allocated, each level once
+    qint64 count = axis.size();
+    for (qint64 buckets = count / FANOUT; buckets > 0; buckets /= FANOUT) {
+        levels.append(QVector<Bucket>());
+        levels.last().reserve(int(buckets));
+    }
+    for (qint64 last = FANOUT; last <= count; last += FANOUT) {
+        extend(last);
+    }
+}
+
+void MinMaxPyramid::reserve(int count) {
+    times.reserve(count);
+    values.reserve(count);
+}
+
+void MinMaxPyramid::clear() {
+    times.clear();
+    values.clear();
+    axis = TimeAxis();
+    forces.clear();
+    valueScale = 1.0;
+    assigned = false;
+    levels.clear();
+}
+
+void MinMaxPyramid::detach() {
+    if (!assigned) {
+        return;
+    }
+    qint64 count = axis.size();
+    times = axis.toVector();
+    values.resize(int(count));
+    for (int i = 0; i < values.size(); ++i) {
+        values[i] = forces[i] * valueScale;
+    }
+    axis = TimeAxis();
+    forces.clear();
+    assigned = false;
+}
+
+qint64 MinMaxPyramid::lowerIndex(double time) const {
+    if (assigned) {
+        return std::lower_bound(axis.begin(), axis.end(), time) - axis.begin();
+    }
+    return std::lower_bound(times.begin(), times.end(), time) - times.begin();
+}
+
+qint64 MinMaxPyramid::upperIndex(double time) const {
+    if (assigned) {
+        return std::upper_bound(axis.begin(), axis.end(), time) - axis.begin();
+    }
+    return std::upper_bound(times.begin(), times.end(), time) - times.begin();
+}
+
+void MinMaxPyramid::extend(qint64 count) {
+    if (count % FANOUT != 0) {
+        return;
+    }
+
+    // Bucket of level 1 from the last points
+    qint64 first = count - FANOUT;
+    Bucket bucket{timeAt(first), valueAt(first), timeAt(first), valueAt(first)};
+    for (qint64 i = first + 1; i < count; ++i) {
+        double value = valueAt(i);
+        if (value < bucket.min) {
+            bucket = {timeAt(i), value, bucket.maxTime, bucket.max};
+        }
+        if (value > bucket.max) {
+            bucket = {bucket.minTime, bucket.min, timeAt(i), value};
+        }
+    }
+    if (levels.isEmpty()) {
+        levels.append(QVector<Bucket>());
+    }
+    levels[0].append(bucket);
+
+    // Every completed group of buckets completes a bucket of the next level
+    for (int level = 0; levels[level].size() % FANOUT == 0; ++level) {
+        const QVector<Bucket>& children = levels[level];
+        Bucket merged = children[children.size() - FANOUT];
+        for (int i = children.size() - FANOUT + 1; i < children.size(); ++i) {
+            if (children[i].min < merged.min) {
+                merged.minTime = children[i].minTime;
+                merged.min = children[i].min;
+            }
+            if (children[i].max > merged.max) {
+                merged.maxTime = children[i].maxTime;
+                merged.max = children[i].max;
+            }
+        }
+        if (level + 1 == levels.size()) {
+            levels.append(QVector<Bucket>());
+        }
+        levels[level + 1].append(merged);
+    }
+}
+
+qint64 MinMaxPyramid::bucketSize(int level) {
+    qint64 size = 1;
+    for (int i = 0; i < level; ++i) {
+        size *= FANOUT;
+    }
+    return size;
+}
+
+int MinMaxPyramid::sample(double lower, double upper, int pixels, QVector<double>& sampledTimes,
+                          QVector<double>& sampledValues) const {
+    sampledTimes.clear();
+    sampledValues.clear();
+    if (isEmpty()) {
+        return 0;
+    }
+
+    // One more point on each side, so the line leaves the visible range
+    qint64 first = lowerIndex(lower);
+    qint64 last = upperIndex(upper);
+    first = first > 0 ? first - 1 : 0;
+    last = last < size() ? last + 1 : last;
+
+    int level = 0;
+    qint64 maxBuckets = qint64(BUCKETS_PER_PIXEL) * qMax(pixels, 1);
+    while (level < levels.size() && (last - first) / bucketSize(level) > maxBuckets) {
+        ++level;
+    }
+    // Align to the buckets, so panning does not change the shape of the line
+    first -= first % bucketSize(level);
+
+    int expected = int(qMin<qint64>(last - first, 2 * maxBuckets + 2 * FANOUT * levelCount()));
+    sampledTimes.reserve(expected);
+    sampledValues.reserve(expected);
+    emitRange(level, first, last, sampledTimes, sampledValues);
+    return level;
+}
+
+void MinMaxPyramid::emitRange(int level, qint64 first, qint64 last, QVector<double>& sampledTimes,
+                              QVector<double>& sampledValues) const {
+    if (level == 0) {
+        for (qint64 i = first; i < last; ++i) {
+            sampledTimes.append(timeAt(i));
+            sampledValues.append(valueAt(i));
+        }
+        return;
+    }
+
+    const QVector<Bucket>& buckets = levels[level - 1];
+    qint64 size = bucketSize(level);
+    qint64 end = qMin<qint64>(buckets.size(), last / size);
+    for (qint64 i = first / size; i < end; ++i) {
+        const Bucket& bucket = buckets[int(i)];
+        bool minFirst = bucket.minTime <= bucket.maxTime;
+        sampledTimes.append(minFirst ? bucket.minTime : bucket.maxTime);
+        sampledValues.append(minFirst ? bucket.min : bucket.max);
+        sampledTimes.append(minFirst ? bucket.maxTime : bucket.minTime);
+        sampledValues.append(minFirst ? bucket.max : bucket.min);
+    }
+    // Incomplete bucket at the end of the range or of the data
+    qint64 rest = qMax(first, end * size);
+    if (rest < last) {
+        emitRange(level - 1, rest, last, sampledTimes, sampledValues);
+    }
+}
+
+bool MinMaxPyramid::extremes(double lower, double upper, double& min, double& max) const {
+    qint64 first = lowerIndex(lower);
+    qint64 last = upperIndex(upper);
+    if (first >= last) {
+        return false;
+    }
+    min = max = valueAt(first);
+
+    // Climb while the range starts inside a bucket, then descend while it ends inside one
+    int level = 0;
+    while (first < last) {
+        qint64 size = bucketSize(level);
+        bool aligned = first % (size * FANOUT) == 0;
+        if (level < levels.size() && aligned && first + size * FANOUT <= last) {
+            ++level;
+            continue;
+        }
+        if (first + size > last) {
+            --level;
+            continue;
+        }
+        if (level == 0) {
+            min = qMin(min, valueAt(first));
+            max = qMax(max, valueAt(first));
+        } else {
+            const Bucket& bucket = levels[level - 1][int(first / size)];
+            min = qMin(min, bucket.min);
+            max = qMax(max, bucket.max);
+        }
+        first += size;
+    }
+    return true;
+}
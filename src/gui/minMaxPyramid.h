@@ -0,0 +1,205 @@
+/******************************************************************************
+ * Copyright (C) 2023 by Gschwind, Weber, Schoch, Niederberger                *
+ *                                                                            *
+ * This file is part of linescaleGUI.                                         *
+ *                                                                            *
+ * LinescaleGUI is free software: you can redistribute it and/or modify       *
+ * it under the terms of the GNU General Public License as published by       *
+ * the Free Software Foundation, either version 3 of the License, or          *
+ * (at your option) any later version.                                        *
+ *                                                                            *
+ * LinescaleGUI is distributed in the hope that it will be useful,            *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of             *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the               *
+ * GNU General Public License for more details.                               *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License          *
+ * along with linescaleGUI. If not, see <http://www.gnu.org/licenses/>.       *
+ ******************************************************************************/
+/**
+ * @file minMaxPyramid.h
+ * @authors Gschwind, Weber, Schoch, Niederberger
+ *
+ * @brief `MinMaxPyramid` declaration
+ *
+ */
+
+#pragma once
+#ifndef MINMAXPYRAMID_H_
+#define MINMAXPYRAMID_H_
+
+#include <QVector>
+#include <QtGlobal>
+#include "../logfile/timeAxis.h"
+
+/**
+ * @brief Multi-resolution min/max summary of a graph
+ *
+ * Level 0 holds the points themselves. Every bucket of level `n` summarises
+ * `FANOUT^n` consecutive points by their minimum and maximum, so a bucket of
+ * level `n + 1` is built from `FANOUT` buckets of level `n`. The levels are
+ * extended while points are appended, at amortised constant cost per point.
+ *
+ * `sample` picks the coarsest level which still has about two buckets per
+ * pixel, so the number of returned points depends on the width of the plot
+ * and not on the number of points in the visible range. The minimum and
+ * maximum of every bucket are kept, hence peaks never disappear. The same
+ * buckets answer `extremes` for any time range in O(FANOUT * levels).
+ *
+ * The times have to be appended in ascending order. Evenly spaced points,
+ * e.g. of a logfile, are better `assign`ed: their level 0 is not copied, so
+ * only the buckets take memory, about a quarter of a double per point.
+ */
+class MinMaxPyramid {
+   public:
+    static constexpr int FANOUT = 8;            ///< Buckets of level `n` per bucket of level `n + 1`
+    static constexpr int BUCKETS_PER_PIXEL = 2;  ///< Resolution of the level chosen by `sample`
+
+    /**
+     * @brief Append a single point
+     *
+     * @param time Horizontal value, not less than the previous one
+     * @param value Vertical value
+     */
+    void append(double time, double value);
+
+    /**
+     * @brief Append several points
+     *
+     * @param times Horizontal values, ascending
+     * @param values Vertical values, same size as `times`
+     */
+    void append(const QVector<double>& times, const QVector<double>& values);
+
+    /**
+     * @brief Replace all points by evenly spaced ones and build their buckets
+     *
+     * Level 0 refers to `times` and the implicitly shared `values` instead of
+     * copying them, the value of a point is `values[i] * scale`. Appending
+     * afterwards copies level 0 once.
+     *
+     * @param times Horizontal values
+     * @param values Vertical values before scaling, at least as many as `times`
+     * @param scale Factor of the vertical values, e.g. to convert a unit
+     */
+    void assign(const TimeAxis& times, const QVector<float>& values, double scale = 1.0);
+
+    /**
+     * @brief Reserve memory for the points, e.g. before appending many of them
+     *
+     * @param count Expected number of points
+     */
+    void reserve(int count);
+
+    /**
+     * @brief Remove all points
+     *
+     */
+    void clear();
+
+    qint64 size() const { return assigned ? axis.size() : times.size(); }  ///< Number of points
+    bool isEmpty() const { return size() == 0; }                            ///< True without points
+    int levelCount() const { return levels.size() + 1; }                    ///< Number of levels including the points
+
+    /**
+     * @brief Points to draw a time range at a given width
+     *
+     * The range is extended by one point on each side, so the line reaches
+     * the border of the plot.
+     *
+     * @param lower First time of the range
+     * @param upper Last time of the range
+     * @param pixels Width of the range on the screen
+     * @param sampledTimes Horizontal values of the points to draw, ascending
+     * @param sampledValues Vertical values of the points to draw
+     * @return int Level the points were taken from, 0 for the points themselves
+     */
+    int sample(double lower, double upper, int pixels, QVector<double>& sampledTimes,
+               QVector<double>& sampledValues) const;
+
+    /**
+     * @brief Smallest and largest value of the points in a time range
+     *
+     * The range is covered by the largest complete buckets which fit into it,
+     * so at most `2 * FANOUT` buckets per level are read.
+     *
+     * @param lower First time of the range
+     * @param upper Last time of the range
+     * @param min Smallest value
+     * @param max Largest value
+     * @return true if there are points in the range
+     */
+    bool extremes(double lower, double upper, double& min, double& max) const;
+
+   private:
+    /**
+     * @brief Minimum and maximum of `FANOUT^level` consecutive points
+     */
+    struct Bucket {
+        double minTime;  ///< Time of the minimum, the earliest if ambiguous
+        double min;      ///< Smallest value
+        double maxTime;  ///< Time of the maximum, the earliest if ambiguous
+        double max;      ///< Largest value
+    };
+
+    /**
+     * @brief Build the buckets completed by a point
+     *
+     * @param count Number of points up to and including the completing one
+     */
+    void extend(qint64 count);
+
+    /**
+     * @brief Copy the assigned level 0, so points can be appended
+     *
+     */
+    void detach();
+
+    /** @brief Horizontal value of the point `index` */
+    double timeAt(qint64 index) const { return assigned ? axis[index] : times[int(index)]; }
+
+    /** @brief Vertical value of the point `index` */
+    double valueAt(qint64 index) const { return assigned ? forces[int(index)] * valueScale : values[int(index)]; }
+
+    /**
+     * @brief Index of the first point not before `time`, like `std::lower_bound`
+     *
+     * @param time Horizontal value
+     * @return qint64 Index in `[0, size()]`
+     */
+    qint64 lowerIndex(double time) const;
+
+    /**
+     * @brief Index of the first point after `time`, like `std::upper_bound`
+     *
+     * @param time Horizontal value
+     * @return qint64 Index in `[0, size()]`
+     */
+    qint64 upperIndex(double time) const;
+
+    /**
+     * @brief Append the points of `[first, last)` using level `level` or finer
+     *
+     * Complete buckets of `level` are used, the rest is taken from lower levels.
+     *
+     * @param level Level of the buckets
+     * @param first Index of the first point, a multiple of the bucket size of `level`
+     * @param last One past the index of the last point
+     * @param sampledTimes Horizontal values of the points to draw
+     * @param sampledValues Vertical values of the points to draw
+     */
+    void emitRange(int level, qint64 first, qint64 last, QVector<double>& sampledTimes,
+                   QVector<double>& sampledValues) const;
+
+    static qint64 bucketSize(int level);  ///< Points per bucket of `level`
+
+    QVector<double> times;            ///< Level 0 of appended points, horizontal values
+    QVector<double> values;           ///< Level 0 of appended points, vertical values
+    TimeAxis axis;                    ///< Level 0 of assigned points, horizontal values
+    QVector<float> forces;            ///< Level 0 of assigned points, vertical values before `valueScale`
+    double valueScale = 1.0;          ///< Factor of `forces`
+    bool assigned = false;            ///< Level 0 is `axis` and `forces` instead of `times` and `values`
+    QVector<QVector<Bucket>> levels;  ///< `levels[n]` is level `n + 1`
+};
+
+#endif  // MINMAXPYRAMID_H_
@@ -26,17 +26,13 @@
 #include "plotWidget.h"
 #include <QFileDialog>
 #include <QStandardPaths>
+#include <cmath>
+#include "../deviceCommunication/gapDetector.h"
+#include "../deviceCommunication/sampleClock.h"
 
 Plot::Plot(QWidget* parent) : QWidget(parent) {
-    updateTimer = new QTimer(this);
-    updateTimer->setInterval(16);
-    updateTimer->setTimerType(Qt::TimerType::PreciseTimer);
-    connect(updateTimer, &QTimer::timeout, this, &Plot::updatePlot);
-
-    disableReplotTimer = new QTimer(this);
-    disableReplotTimer->setInterval(1000);
-    disableReplotTimer->setTimerType(Qt::TimerType::VeryCoarseTimer);
-    connect(disableReplotTimer, &QTimer::timeout, this, &Plot::disableUpdating);
+    scheduler = new RenderScheduler(this);
+    connect(scheduler, &RenderScheduler::frame, this, &Plot::updatePlot);
 
     customPlot = new QCustomPlot(parent);
     // customPlot->setOpenGl(true); 
@@ -67,6 +63,7 @@ Plot::Plot(QWidget* parent) : QWidget(parent) {
     connect(customPlot, &QCustomPlot::mouseWheel, this, &Plot::mouseWheel);
     connect(customPlot, &QCustomPlot::mouseMove, this, &Plot::mouseMove);
     customPlot->setContextMenuPolicy(Qt::ContextMenuPolicy::CustomContextMenu);
+    connect(customPlot, &QCustomPlot::beforeReplot, this, &Plot::resampleGraphs);
     connect(customPlot, &QCustomPlot::customContextMenuRequested, this, &Plot::contextMenuRequest);
 
     auto layout = new QVBoxLayout(this);
@@ -90,6 +87,12 @@ Plot::Plot(QWidget* parent) : QWidget(parent) {
     autoShowNewestAction->setChecked(true);
     addAction(autoShowNewestAction);
 
+    liveWindowAction = new QAction(QString("Show last %1 s only").arg(DEFAULT_LIVE_WINDOW), this);
+    liveWindowAction->setCheckable(true);
+    connect(liveWindowAction, &QAction::toggled, this,
+            [=](bool checked) { setLiveWindow(checked ? DEFAULT_LIVE_WINDOW : 0.0); });
+    addAction(liveWindowAction);
+
     saveImageAction = new QAction("Save as image", this);
     connect(saveImageAction, &QAction::triggered, this, &Plot::saveImage);
     addAction(saveImageAction);
@@ -125,8 +128,8 @@ void Plot::beginNewGraph(bool startFromOrigin) {
     customPlot->addGraph();
     if (startFromOrigin) {
         lastTime = 0;
-        maxValue = 0;
-        minValue = 0;
+        lastSequence = 0;
+        lastTimestamp = 0;
     }
 }
 
@@ -178,8 +181,7 @@ void Plot::mouseMove() {
 }
 
 void Plot::addData(double time, double force) {
-    minValue = (force < minValue) ? force : minValue;
-    maxValue = (force > maxValue) ? force : maxValue;
+    force /= factorFromKn(currentUnit);
     lastTime = time;
     if (customPlot->graphCount() == 0) {
         beginNewGraph();
@@ -187,16 +189,137 @@ void Plot::addData(double time, double force) {
         autoRangeAction->setChecked(true);
         autoShowNewestAction->setChecked(true);
     }
-    customPlot->graph()->addData(time, force);
-    if (!updateTimer->isActive()) {
-        updatePlot();
-        updateTimer->start();
-        disableReplotTimer->start();
-    } else {
-        hadNewData = true;
+    currentPoints().append(time, force);
+    scheduleReplot();
+}
+
+void Plot::addConsecutiveSamples(const QVector<Sample>& samples) {
+    batchTimes.clear();
+    batchForces.clear();
+    double time = lastTime;
+    for (const Sample& sample : samples) {
+        if (currentUnit != sample.unitValue) {
+            convertToNewUnit(sample.unitValue);
+        }
+        time += timeStep(sample);
+        batchTimes.append(time);
+        batchForces.append(sample.measuredValue / factorFromKn(sample.unitValue));
+    }
+    appendToGraph(batchTimes, batchForces);
+}
+
+void Plot::appendToGraph(const QVector<double>& times, const QVector<double>& forces) {
+    if (times.isEmpty()) {
+        return;
+    }
+    lastTime = times.last();
+    if (customPlot->graphCount() == 0) {
+        beginNewGraph();
+        // Enable auto range and show newest when the first graph.
+        autoRangeAction->setChecked(true);
+        autoShowNewestAction->setChecked(true);
+    }
+    currentPoints().append(times, forces);
+    scheduleReplot();
+}
+
+void Plot::addLogfile(Logfile& logfile) {
+    const QVector<float>& forces = logfile.getForce();
+    TimeAxis time = logfile.getTime();
+    if (forces.isEmpty()) {
+        return;
+    }
+    UnitValue unit = logfile.getMetadata().unit;
+    if (currentUnit == UnitValue::NONE) {
+        currentUnit = unit;
+    }
+    double factor = 1.0 / factorFromKn(unit);
+
+    beginNewGraph();
+    // Never a live window; shares the forces of the logfile, only the buckets are allocated
+    MinMaxPyramid& pyramid = graphPoints[customPlot->graph()].pyramid;
+    pyramid.assign(time, forces, factor);
+    lastTime = time[pyramid.size() - 1];
+
+    autoShowNewestAction->setChecked(false);
+    customPlot->xAxis->setRange(time[0], lastTime);
+    scheduleReplot();
+}
+
+void Plot::setLiveWindow(double seconds, bool keepAll) {
+    liveWindow = qMax(seconds, 0.0);
+    keepHistory = keepAll;
+    liveWindowAction->blockSignals(true);
+    liveWindowAction->setChecked(liveWindow > 0);
+    liveWindowAction->blockSignals(false);
+
+    // Continue in a new graph, the points of the current one are kept as they are
+    auto current = graphPoints.constFind(customPlot->graph());
+    if (current != graphPoints.constEnd() && current->appended() > 0) {
+        beginNewGraph(false);
     }
 }
 
+Plot::GraphPoints& Plot::currentPoints() {
+    if (customPlot->graphCount() == 0) {
+        beginNewGraph();
+    }
+    auto points = graphPoints.find(customPlot->graph());
+    if (points == graphPoints.end()) {
+        points = graphPoints.insert(customPlot->graph(), GraphPoints());
+        points->rolling = liveWindow > 0;
+        points->history = !points->rolling || keepHistory;
+        if (points->rolling) {
+            points->window.setCapacity(int(std::ceil(liveWindow * MAX_FREQUENCY)));
+        }
+    }
+    return *points;
+}
+
+bool Plot::GraphPoints::extremes(const QCPRange& range, double& min, double& max) {
+    if (rolling && !window.isEmpty() && (!history || range.lower >= window.timeAt(0))) {
+        if (range.upper >= window.timeAt(window.size() - 1)) {
+            return window.extremes(range.lower, min, max);
+        }
+        if (!history) {
+            return window.extremes(range.lower, range.upper, min, max);
+        }
+    }
+    return pyramid.extremes(range.lower, range.upper, min, max);
+}
+
+double Plot::timeStep(const Sample& sample) {
+    double period = 1.0 / (double)sample.frequency;
+    double steps = 1.0;
+    if (lastSequence != 0 && sample.sequence > lastSequence) {
+        steps = double(sample.sequence - lastSequence);
+        // Samples which never arrived do not advance the sequence, only the timestamp
+        int64_t late = sample.timestamp - lastTimestamp -
+                       int64_t(steps * period * comm::SampleClock::NS_PER_SECOND);
+        int64_t periodNs = comm::SampleClock::NS_PER_SECOND / sample.frequency;
+        if (lastTimestamp != 0 && late > comm::GapDetector::lateLimit(periodNs)) {
+            steps += std::round(double(late) / comm::SampleClock::NS_PER_SECOND / period);
+        }
+    }
+    lastSequence = sample.sequence;
+    lastTimestamp = sample.timestamp;
+    return steps * period;
+}
+
+void Plot::scheduleReplot() {
+    scheduler->requestFrame();
+}
+
+void Plot::showEvent(QShowEvent* event) {
+    QWidget::showEvent(event);
+    scheduler->setPaused(false);
+}
+
+void Plot::hideEvent(QHideEvent* event) {
+    QWidget::hideEvent(event);
+    scheduler->setPaused(true);  // Also sent when the window is minimized
+}
+
 void Plot::contextMenuRequest(QPoint pos) {
     auto selectionTol = customPlot->selectionTolerance();
 
@@ -223,6 +346,7 @@ void Plot::contextMenuRequest(QPoint pos) {
     }
     if (!clickedOnAxis || customPlot->xAxis->selectedParts()) {
         menu->addAction(autoShowNewestAction);
+        menu->addAction(liveWindowAction);
     }
 
     menu->addSeparator();
@@ -232,29 +356,64 @@ void Plot::contextMenuRequest(QPoint pos) {
 }
 
 void Plot::updatePlot() {
-    auto lowerBound = lastTime - customPlot->xAxis->range().size();
+    double width = customPlot->xAxis->range().size();
+    if (liveWindow > 0) {
+        width = qMin(width, liveWindow);  // Older points are gone
+    }
+    auto lowerBound = lastTime - width;
 
-    /// @todo Scale to what data-range is in the viewport as option (default?).
     if (autoShowNewestAction->isChecked()) {
         customPlot->xAxis->setRange(lowerBound, lastTime);
     }
     if (autoRangeAction->isChecked()) {
-        customPlot->yAxis->setRange(minValue, maxValue);
+        // Only the visible points, the axis always shows zero
+        QCPRange range = customPlot->xAxis->range();
+        double minValue = 0.0, maxValue = 0.0;
+        for (GraphPoints& points : graphPoints) {
+            double min, max;
+            if (points.extremes(range, min, max)) {
+                minValue = qMin(minValue, min);
+                maxValue = qMax(maxValue, max);
+            }
+        }
+        maxValue = qMax(0.5, maxValue);  // Hide sensor noise (threshold in kN)
+        double factor = factorFromKn(currentUnit);
+        customPlot->yAxis->setRange(minValue * factor, maxValue * factor);
     }
 
     customPlot->replot(QCustomPlot::rpQueuedRefresh);
 }
 
-void Plot::disableUpdating() {
-    if (!hadNewData) {
-        updateTimer->stop();
-        disableReplotTimer->stop();
+void Plot::resampleGraphs() {
+    QCPRange range = customPlot->xAxis->range();
+    int pixels = customPlot->axisRect()->width();
+    double factor = factorFromKn(currentUnit);
+    for (auto it = graphPoints.begin(); it != graphPoints.end(); ++it) {
+        GraphPoints& points = it.value();
+        if (points.range == range && points.pixels == pixels && points.sampled == points.appended()) {
+            continue;
+        }
+        // The window is cheaper, the pyramid reaches further back
+        bool fromWindow = points.rolling && (!points.history || points.window.isEmpty() ||
+                                             range.lower >= points.window.timeAt(0));
+        if (fromWindow) {
+            points.window.sample(range.lower, range.upper, pixels, sampledTimes, sampledForces);
+        } else {
+            points.pyramid.sample(range.lower, range.upper, pixels, sampledTimes, sampledForces);
+        }
+        for (double& force : sampledForces) {
+            force *= factor;  // Only the visible points are converted
+        }
+        it.key()->setData(sampledTimes, sampledForces, true);
+        points.range = range;
+        points.pixels = pixels;
+        points.sampled = points.appended();
     }
-    hadNewData = false;
 }
 
 void Plot::deleteSelectedGraphs() {
     for (auto g : customPlot->selectedGraphs()) {
+        graphPoints.remove(g);
         customPlot->removeGraph(g);
     }
     customPlot->replot();
@@ -270,53 +429,9 @@ void Plot::clearSelection() {
 }
 
 void Plot::convertToNewUnit(UnitValue nextUnit) {
-    double factorBack = 1;
-    double factorForward = 1;
-
-    switch (currentUnit) {
-        case UnitValue::LBF:
-            factorBack = 1 / factorKnToLbf;
-            break;
-
-        case UnitValue::KGF:
-            factorBack = 1 / factorKnToKgf;
-            break;
-
-        default:
-            break;
-    }
-
-    switch (nextUnit) {
-        case UnitValue::LBF:
-            factorForward = factorKnToLbf;
-            break;
-
-        case UnitValue::KGF:
-            factorForward = factorKnToKgf;
-            break;
-
-        default:
-            break;
-    }
-
-    double factor = factorBack * factorForward;
-
-    maxValue = 0.5 * factorForward;  // Hide sensor noise (threshold in kN)
-    minValue = 0;
-
-    int graphCount = customPlot->graphCount();
-    for (int i = 0; i < graphCount; ++i) {
-        auto plotData = customPlot->graph(i)->data();
-        QCPGraphData* dataPoint;
-        double newValue;
-        for (dataPoint = plotData->begin(); dataPoint < plotData->end(); ++dataPoint) {
-            newValue = dataPoint->value * factor;
-
-            maxValue = newValue > maxValue ? newValue : maxValue;
-            minValue = newValue < minValue ? newValue : minValue;
-
-            dataPoint->value = newValue;
-        }
+    // Resample all graphs with the next replot
+    for (GraphPoints& points : graphPoints) {
+        points.sampled = -1;
     }
 
     currentUnit = nextUnit;
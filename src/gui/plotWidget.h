@@ -28,12 +28,16 @@
 #ifndef PLOTWIDGET_H_
 #define PLOTWIDGET_H_
 
-#include <QTimer>
+#include <QHash>
 #include <QVector>
 #include <QWidget>
 
+#include "../logfile/logfile.h"
 #include "../notification/notification.h"
 #include "../parser/parser.h"
+#include "minMaxPyramid.h"
+#include "renderScheduler.h"
+#include "rollingWindow.h"
 
 /// @todo Better way to disable this warning for MSVC.
 #if _MSC_VER && !__INTEL_COMPILER
@@ -48,6 +52,19 @@
 /**
  * @brief Widget to display a dynamic line graph chart.
  *
+ * The points of every graph are kept in a `MinMaxPyramid`. Before each replot
+ * the graphs are filled with the points of the visible range at the
+ * resolution of the screen, so panning and zooming through long recordings
+ * costs the same as through short ones.
+ *
+ * The points are stored in kN and converted to the current unit only while
+ * they are copied to the graphs, so a unit change costs nothing and never
+ * rounds the stored points.
+ *
+ * In the live window mode, see `setLiveWindow`, new graphs keep only their
+ * newest points in a `RollingWindow`. Memory and frame time stay constant
+ * during arbitrarily long live sessions.
+ *
  * @todo Allow to zoom with panning (touchscreen).
  * @todo Maybe implement custom range dialog.
  */
@@ -68,7 +85,7 @@ class Plot : public QWidget {
      * update rate of 60 Hz.
      *
      * @param time Horizontal value (time).
-     * @param force Vertical value (force).
+     * @param force Vertical value (force) in the current unit.
      */
     void addData(double time, double force);
 
@@ -77,9 +94,11 @@ class Plot : public QWidget {
      *
      * The sample is appended to the data; its time value will be set as
      * `lastTime + 1/sample.frequency` where `lastTime` is the time of the last data point
-     * added to the current graph. `sample.measuredValue` will be used as the force value.
+     * added to the current graph. If the sample carries a sequence number and arrival
+     * timestamp, missing samples are skipped instead of compressing the time axis, see
+     * `timeStep`. `sample.measuredValue` will be used as the force value.
      *
-     * If the current unit differs from the previous, the existing plot will be recalculated.
+     * If the current unit differs from the previous, the whole plot is shown in the new unit.
      *
      * @param sample The sample to add.
      */
@@ -87,9 +106,19 @@ class Plot : public QWidget {
         if (currentUnit != sample.unitValue) {
             convertToNewUnit(sample.unitValue);
         }
-        addData(lastTime + 1.0 / (double)sample.frequency, sample.measuredValue);
+        addData(lastTime + timeStep(sample), sample.measuredValue);
     }
 
+    /**
+     * @brief Add consecutive samples to the data.
+     *
+     * Same as `addConsecutiveSample` for every sample, but the graph is extended
+     * once per batch instead of once per sample.
+     *
+     * @param samples The samples to add, oldest first.
+     */
+    void addConsecutiveSamples(const QVector<Sample>& samples);
+
     /**
      * @brief Add a new graph to the plot and use it for all new points added.
      *
@@ -98,6 +127,34 @@ class Plot : public QWidget {
      */
     void beginNewGraph(bool startFromOrigin = true);
 
+    /**
+     * @brief Show the forces of a logfile in a new graph.
+     *
+     * The forces are shared with the logfile and converted to the unit of the
+     * plot when sampled, so only the buckets of the `MinMaxPyramid` take memory.
+     * The x-axis is set to the whole logfile and stops following the newest data.
+     *
+     * @param logfile Loaded logfile.
+     */
+    void addLogfile(Logfile& logfile);
+
+    /**
+     * @brief Keep only the newest points of the live data.
+     *
+     * Points added from now on go to a new graph which holds the last `seconds`
+     * at up to `MAX_FREQUENCY`. The points so far stay in their graph. With
+     * `keepAll`, all points are also kept in a `MinMaxPyramid` to pan
+     * back in time, which lets the memory grow again. Use a `Recorder` to
+     * keep the history on the disk instead.
+     *
+     * @param seconds Length of the window, 0 to keep all points.
+     * @param keepAll Keep all points in addition to the window.
+     */
+    void setLiveWindow(double seconds, bool keepAll = false);
+
+    static constexpr double DEFAULT_LIVE_WINDOW = 60.0;  ///< Live window of the context menu in s
+    static constexpr int MAX_FREQUENCY = 1280;           ///< Highest sample rate of a LineScale in Hz
+
     /**
      * @brief Save the current plot window as png to the local machine
      *
@@ -114,6 +171,19 @@ class Plot : public QWidget {
      */
     void attachNotification(Notification* notification);
 
+   protected:
+    /**
+     * @brief Resume the replots when the plot becomes visible.
+     * @param event Show event from qt.
+     */
+    void showEvent(QShowEvent* event) override;
+
+    /**
+     * @brief Pause the replots while the plot is hidden or minimized.
+     * @param event Hide event from qt.
+     */
+    void hideEvent(QHideEvent* event) override;
+
    private slots:
     /**
      * @brief Handle a selection change inside the plot.
@@ -157,9 +227,12 @@ class Plot : public QWidget {
     void updatePlot();
 
     /**
-     * @brief Disable the auto updating timer.
+     * @brief Fill the graphs with the points of the visible range.
+     *
+     * Called before every replot. Graphs whose range, width and points did not
+     * change since the last call are left untouched.
      */
-    void disableUpdating();
+    void resampleGraphs();
 
     /**
      * @brief Delete all selected graphs.
@@ -175,15 +248,90 @@ class Plot : public QWidget {
     /**
      * @brief Update the plot after a unit change was detected
      *
-     * To go from the current unit to the `next`, all values in the plot are
-     * multiplied by a conversion factor.
-     * The minimum and maximum values are update according to the new values.
-     * The initial maximum value is slightly above zero to hide the sensor noise.
+     * The stored points stay in kN, only the graphs are resampled in the
+     * `next` unit with the next replot.
      *
      * @param next The next unit
      */
     void convertToNewUnit(UnitValue next);
 
+    /**
+     * @brief Append already sorted points to the current graph and schedule a replot.
+     *
+     * @param times Horizontal values (time), ascending.
+     * @param forces Vertical values (force) in kN.
+     */
+    void appendToGraph(const QVector<double>& times, const QVector<double>& forces);
+
+    /**
+     * @brief Replot with the next frame of the `RenderScheduler`.
+     */
+    void scheduleReplot();
+
+    /**
+     * @brief Time between the previous and the given sample.
+     *
+     * Normally one nominal period. Samples skipped in the sequence and longer
+     * pauses in the arrival timestamps are added, so gaps stay visible.
+     *
+     * @param sample The next sample.
+     * @return double Time step in seconds.
+     */
+    double timeStep(const Sample& sample);
+
+    /**
+     * @brief All points of a graph and the range they were last sampled for.
+     */
+    struct GraphPoints {
+        MinMaxPyramid pyramid;  ///< All points of the graph, unless only the `window` is kept
+        RollingWindow window;   ///< Newest points of a live window graph
+        bool rolling = false;   ///< Points are added to `window`
+        bool history = true;    ///< Points are added to `pyramid`
+        QCPRange range;         ///< Visible range of the last `resampleGraphs`
+        int pixels = 0;         ///< Width of the axis rect in the last `resampleGraphs`
+        qint64 sampled = -1;    ///< `appended` in the last `resampleGraphs`, -1 to force it
+
+        void append(double time, double force) {
+            if (rolling) {
+                window.append(time, force);
+            }
+            if (history) {
+                pyramid.append(time, force);
+            }
+        }
+        void append(const QVector<double>& times, const QVector<double>& forces) {
+            if (rolling) {
+                window.append(times, forces);
+            }
+            if (history) {
+                pyramid.append(times, forces);
+            }
+        }
+        qint64 appended() const { return rolling ? window.appended() : pyramid.size(); }
+
+        /**
+         * @brief Smallest and largest force in a time range.
+         *
+         * A range which ends at the newest point is answered by the deques of
+         * the `window`, any other range by the `pyramid` or by a scan of the `window`.
+         *
+         * @param range Time range.
+         * @param min Smallest force in kN.
+         * @param max Largest force in kN.
+         * @return true if there are points in the range.
+         */
+        bool extremes(const QCPRange& range, double& min, double& max);
+    };
+
+    /**
+     * @brief Points of the current graph, created with the first graph if necessary.
+     *
+     * New points use the live window set by `setLiveWindow`.
+     *
+     * @return GraphPoints& Points of the graph new data is added to.
+     */
+    GraphPoints& currentPoints();
+
    signals:
     /**
      * @brief Emit before saving a plot. Prevent simultaneous export and new data acquisition
@@ -193,25 +341,29 @@ class Plot : public QWidget {
 
    private:
     QCustomPlot* customPlot;
-    double minValue = 0.0, maxValue = 0.0;
     double lastTime = 0.0;
-    bool hadNewData = false;
+    uint64_t lastSequence = 0;   ///< `Sample::sequence` of the last point, 0 if unknown
+    int64_t lastTimestamp = 0;   ///< `Sample::timestamp` of the last point, 0 if unknown
+    QVector<double> batchTimes;   ///< Reused by `addConsecutiveSamples`
+    QVector<double> batchForces;  ///< Reused by `addConsecutiveSamples`
+    QHash<QCPGraph*, GraphPoints> graphPoints;  ///< Points of the graphs added since the start, in kN
+    QVector<double> sampledTimes;               ///< Reused by `resampleGraphs`
+    QVector<double> sampledForces;              ///< Reused by `resampleGraphs`
 
-    UnitValue currentUnit;
+    UnitValue currentUnit = UnitValue::NONE;
+    double liveWindow = 0.0;   ///< Length of the live window in s, 0 to keep all points
+    bool keepHistory = false;  ///< Live window graphs also keep all points
 
-    QTimer* updateTimer;
-    QTimer* disableReplotTimer;
+    RenderScheduler* scheduler;  ///< Paces the replots of new data
 
     QAction* deleteGraphAction;
     QAction* autoRangeAction;
     QAction* autoShowNewestAction;
+    QAction* liveWindowAction;
     QAction* clearSelectionAction;
     QAction* saveImageAction;
 
     Notification* notification = nullptr;
-
-    static constexpr double factorKnToLbf = 224.8089431;  ///< Convert from kN to lbf
-    static constexpr double factorKnToKgf = 101.9716213;  ///< Convert from kN to kgf
 };
 
 #endif  // PLOTWIDGET_H_
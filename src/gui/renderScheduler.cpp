@@ -0,0 +1,71 @@
+/******************************************************************************
+ * Copyright (C) 2023 by Gschwind, Weber, Schoch, Niederberger                *
+ *                                                                            *
+ * This file is part of linescaleGUI.                                         *
+ *                                                                            *
+ * LinescaleGUI is free software: you can redistribute it and/or modify       *
+ * it under the terms of the GNU General Public License as published by       *
+ * the Free Software Foundation, either version 3 of the License, or          *
+ * (at your option) any later version.                                        *
+ *                                                                            *
+ * LinescaleGUI is distributed in the hope that it will be useful,            *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of             *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the               *
+ * GNU General Public License for more details.                               *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License          *
+ * along with linescaleGUI. If not, see <http://www.gnu.org/licenses/>.       *
+ ******************************************************************************/
+/**
+ * @file renderScheduler.cpp
+ * @authors Gschwind, Weber, Schoch, Niederberger
+ *
+ * @brief `RenderScheduler` implementation
+ *
+ */
+
+#include "renderScheduler.h"
+#include <cmath>
+
+RenderScheduler::RenderScheduler(QObject* parent) : QObject(parent) {
+    timer = new QTimer(this);
+    timer->setSingleShot(true);
+    timer->setTimerType(Qt::TimerType::PreciseTimer);
+    connect(timer, &QTimer::timeout, this, &RenderScheduler::drawFrame);
+}
+
+void RenderScheduler::requestFrame() {
+    pending = true;
+    if (!paused && !timer->isActive()) {
+        schedule();
+    }
+}
+
+void RenderScheduler::setPaused(bool pause) {
+    paused = pause;
+    if (paused) {
+        timer->stop();
+    } else if (pending) {
+        schedule();
+    }
+}
+
+void RenderScheduler::recordFrame(qint64 nanoseconds) {
+    double cost = double(nanoseconds) / 1e6;
+    averageCost = averageCost == 0.0 ? cost : 0.8 * averageCost + 0.2 * cost;
+    int budgeted = int(std::ceil(averageCost / FRAME_BUDGET));
+    interval = qBound(MIN_INTERVAL, budgeted, MAX_INTERVAL);
+}
+
+void RenderScheduler::schedule() {
+    // Data arriving slower than the interval is drawn right away
+    qint64 elapsed = sinceFrame.isValid() ? sinceFrame.elapsed() : interval;
+    timer->start(int(qMax<qint64>(0, interval - elapsed)));
+}
+
+void RenderScheduler::drawFrame() {
+    pending = false;
+    sinceFrame.start();
+    emit frame();
+    recordFrame(sinceFrame.nsecsElapsed());
+}
@@ -0,0 +1,120 @@
+/******************************************************************************
+ * Copyright (C) 2023 by Gschwind, Weber, Schoch, Niederberger                *
+ *                                                                            *
+ * This file is part of linescaleGUI.                                         *
+ *                                                                            *
+ * LinescaleGUI is free software: you can redistribute it and/or modify       *
+ * it under the terms of the GNU General Public License as published by       *
+ * the Free Software Foundation, either version 3 of the License, or          *
+ * (at your option) any later version.                                        *
+ *                                                                            *
+ * LinescaleGUI is distributed in the hope that it will be useful,            *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of             *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the               *
+ * GNU General Public License for more details.                               *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License          *
+ * along with linescaleGUI. If not, see <http://www.gnu.org/licenses/>.       *
+ ******************************************************************************/
+/**
+ * @file renderScheduler.h
+ * @authors Gschwind, Weber, Schoch, Niederberger
+ *
+ * @brief `RenderScheduler` declaration
+ *
+ */
+
+#pragma once
+#ifndef RENDERSCHEDULER_H_
+#define RENDERSCHEDULER_H_
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QTimer>
+
+/**
+ * @brief Decide when to redraw a widget whose data changes
+ *
+ * `requestFrame` marks the widget as outdated. The signal `frame` follows
+ * once, no matter how many requests arrived in between, and not earlier than
+ * `getInterval` after the previous frame. Without requests no frame is drawn,
+ * so a widget without new data costs nothing.
+ *
+ * The duration of every frame is measured. The interval is adapted so that
+ * drawing takes at most `FRAME_BUDGET` of the time, between
+ * `MIN_INTERVAL` and `MAX_INTERVAL`.
+ *
+ * While paused, e.g. because the widget is hidden or minimized, requests are
+ * only remembered and the frame follows when the scheduler is resumed.
+ */
+class RenderScheduler : public QObject {
+    Q_OBJECT
+
+   public:
+    static constexpr int MIN_INTERVAL = 16;       ///< Shortest time between two frames in ms, about 60 Hz
+    static constexpr int MAX_INTERVAL = 250;      ///< Longest time between two frames in ms
+    static constexpr double FRAME_BUDGET = 0.25;  ///< Share of the time spent drawing
+
+    /**
+     * @brief Construct a new scheduler
+     *
+     * @param parent The parent object or `nullptr`
+     */
+    explicit RenderScheduler(QObject* parent = nullptr);
+
+    /**
+     * @brief Draw a frame as soon as the interval allows
+     *
+     */
+    void requestFrame();
+
+    /**
+     * @brief Stop or continue drawing frames
+     *
+     * @param paused True to only remember requests, false to draw them
+     */
+    void setPaused(bool paused);
+
+    /**
+     * @brief Adapt the interval to the duration of a frame
+     *
+     * Called after every `frame`. The durations are smoothed, so a single
+     * slow frame does not halve the frame rate.
+     *
+     * @param nanoseconds Time spent drawing the frame
+     */
+    void recordFrame(qint64 nanoseconds);
+
+    int getInterval() const { return interval; }  ///< Current time between two frames in ms
+    bool isPaused() const { return paused; }      ///< True while frames are held back
+    bool isPending() const { return pending; }    ///< True if a requested frame was not drawn yet
+
+   signals:
+    /**
+     * @brief Draw the widget now
+     *
+     */
+    void frame();
+
+   private:
+    /**
+     * @brief Emit `frame` and measure it
+     *
+     */
+    void drawFrame();
+
+    /**
+     * @brief Start the timer for the pending frame
+     *
+     */
+    void schedule();
+
+    QTimer* timer;
+    QElapsedTimer sinceFrame;    ///< Started with the last frame
+    double averageCost = 0.0;    ///< Smoothed duration of a frame in ms
+    int interval = MIN_INTERVAL;
+    bool paused = false;
+    bool pending = false;
+};
+
+#endif  // RENDERSCHEDULER_H_
@@ -0,0 +1,193 @@
+/******************************************************************************
+ * Copyright (C) 2023 by Gschwind, Weber, Schoch, Niederberger                *
+ *                                                                            *
+ * This file is part of linescaleGUI.                                         *
+ *                                                                            *
+ * LinescaleGUI is free software: you can redistribute it and/or modify       *
+ * it under the terms of the GNU General Public License as published by       *
+ * the Free Software Foundation, either version 3 of the License, or          *
+ * (at your option) any later version.                                        *
+ *                                                                            *
+ * LinescaleGUI is distributed in the hope that it will be useful,            *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of             *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the               *
+ * GNU General Public License for more details.                               *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License          *
+ * along with linescaleGUI. If not, see <http://www.gnu.org/licenses/>.       *
+ ******************************************************************************/
+/**
+ * @file rollingWindow.cpp
+ * @authors Gschwind, Weber, Schoch, Niederberger
+ *
+ * @brief `RollingWindow` implementation
+ *
+ */
+
+#include "rollingWindow.h"
+
+void RollingWindow::setCapacity(int points) {
+    times.resize(qMax(points, 1));
+    values.resize(qMax(points, 1));
+    times.squeeze();
+    values.squeeze();
+    clear();
+}
+
+void RollingWindow::append(double time, double value) {
+    if (times.isEmpty()) {
+        setCapacity(1);
+    }
+    int position;
+    if (count < times.size()) {
+        position = physical(count);
+        ++count;
+    } else {
+        position = head;
+        head = head + 1 < times.size() ? head + 1 : 0;
+    }
+    times[position] = time;
+    values[position] = value;
+    pushExtreme({total, time, value});
+    ++total;
+
+    // Drop the point which was replaced in the buffer
+    while (minimums.front().number < total - count) {
+        minimums.pop_front();
+    }
+    while (maximums.front().number < total - count) {
+        maximums.pop_front();
+    }
+}
+
+void RollingWindow::pushExtreme(const Extreme& extreme) {
+    while (!minimums.empty() && minimums.back().value >= extreme.value) {
+        minimums.pop_back();
+    }
+    minimums.push_back(extreme);
+    while (!maximums.empty() && maximums.back().value <= extreme.value) {
+        maximums.pop_back();
+    }
+    maximums.push_back(extreme);
+}
+
+void RollingWindow::append(const QVector<double>& newTimes, const QVector<double>& newValues) {
+    for (int i = 0; i < newTimes.size(); ++i) {
+        append(newTimes[i], newValues[i]);
+    }
+}
+
+void RollingWindow::clear() {
+    head = 0;
+    count = 0;
+    total = 0;
+    minimums.clear();
+    maximums.clear();
+    extremesFrom = -std::numeric_limits<double>::infinity();
+}
+
+bool RollingWindow::extremes(double lower, double& min, double& max) {
+    if (lower < extremesFrom) {
+        // Points before the previous range were dropped, collect them again
+        minimums.clear();
+        maximums.clear();
+        for (int i = find(lower, false); i < count; ++i) {
+            pushExtreme({total - count + i, timeAt(i), valueAt(i)});
+        }
+    }
+    extremesFrom = lower;
+
+    while (!minimums.empty() && minimums.front().time < lower) {
+        minimums.pop_front();
+    }
+    while (!maximums.empty() && maximums.front().time < lower) {
+        maximums.pop_front();
+    }
+    if (minimums.empty()) {
+        return false;
+    }
+    min = minimums.front().value;
+    max = maximums.front().value;
+    return true;
+}
+
+bool RollingWindow::extremes(double lower, double upper, double& min, double& max) const {
+    int first = find(lower, false);
+    int last = find(upper, true);
+    if (first >= last) {
+        return false;
+    }
+    min = max = valueAt(first);
+    for (int i = first + 1; i < last; ++i) {
+        min = qMin(min, valueAt(i));
+        max = qMax(max, valueAt(i));
+    }
+    return true;
+}
+
+int RollingWindow::find(double time, bool orLater) const {
+    int first = 0;
+    int length = count;
+    while (length > 0) {
+        int half = length / 2;
+        double candidate = timeAt(first + half);
+        if (candidate < time || (orLater && candidate == time)) {
+            first += half + 1;
+            length -= half + 1;
+        } else {
+            length = half;
+        }
+    }
+    return first;
+}
+
+void RollingWindow::sample(double lower, double upper, int pixels, QVector<double>& sampledTimes,
+                           QVector<double>& sampledValues) const {
+    sampledTimes.clear();
+    sampledValues.clear();
+    if (count == 0) {
+        return;
+    }
+
+    // One more point on each side, so the line leaves the visible range
+    int first = find(lower, false);
+    int last = find(upper, true);
+    first = first > 0 ? first - 1 : 0;
+    last = last < count ? last + 1 : last;
+
+    int maxBuckets = BUCKETS_PER_PIXEL * qMax(pixels, 1);
+    int bucketSize = (last - first + maxBuckets - 1) / maxBuckets;
+    if (bucketSize <= 1) {
+        sampledTimes.reserve(last - first);
+        sampledValues.reserve(last - first);
+        for (int i = first; i < last; ++i) {
+            sampledTimes.append(timeAt(i));
+            sampledValues.append(valueAt(i));
+        }
+        return;
+    }
+
+    // Align the buckets to the appended points, not to the oldest point kept
+    qint64 oldest = total - count;
+    int bucketStart = first - int((oldest + first) % bucketSize);
+    sampledTimes.reserve(2 * (maxBuckets + 2));
+    sampledValues.reserve(2 * (maxBuckets + 2));
+    for (; bucketStart < last; bucketStart += bucketSize) {
+        int begin = qMax(bucketStart, first);
+        int end = qMin(bucketStart + bucketSize, last);
+        int minIndex = begin;
+        int maxIndex = begin;
+        for (int i = begin + 1; i < end; ++i) {
+            minIndex = valueAt(i) < valueAt(minIndex) ? i : minIndex;
+            maxIndex = valueAt(i) > valueAt(maxIndex) ? i : maxIndex;
+        }
+        int earlier = qMin(minIndex, maxIndex);
+        int later = qMax(minIndex, maxIndex);
+        sampledTimes.append(timeAt(earlier));
+        sampledValues.append(valueAt(earlier));
+        if (later != earlier) {
+            sampledTimes.append(timeAt(later));
+            sampledValues.append(valueAt(later));
+        }
+    }
+}
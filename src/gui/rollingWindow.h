@@ -0,0 +1,182 @@
+/******************************************************************************
+ * Copyright (C) 2023 by Gschwind, Weber, Schoch, Niederberger                *
+ *                                                                            *
+ * This file is part of linescaleGUI.                                         *
+ *                                                                            *
+ * LinescaleGUI is free software: you can redistribute it and/or modify       *
+ * it under the terms of the GNU General Public License as published by       *
+ * the Free Software Foundation, either version 3 of the License, or          *
+ * (at your option) any later version.                                        *
+ *                                                                            *
+ * LinescaleGUI is distributed in the hope that it will be useful,            *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of             *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the               *
+ * GNU General Public License for more details.                               *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License          *
+ * along with linescaleGUI. If not, see <http://www.gnu.org/licenses/>.       *
+ ******************************************************************************/
+/**
+ * @file rollingWindow.h
+ * @authors Gschwind, Weber, Schoch, Niederberger
+ *
+ * @brief `RollingWindow` declaration
+ *
+ */
+
+#pragma once
+#ifndef ROLLINGWINDOW_H_
+#define ROLLINGWINDOW_H_
+
+#include <QVector>
+#include <QtGlobal>
+#include <deque>
+#include <limits>
+
+/**
+ * @brief Fixed number of the newest points of a graph
+ *
+ * The points are kept in a circular buffer which is allocated once by
+ * `setCapacity`. When it is full, every new point replaces the oldest one, so
+ * neither the memory nor the cost of `sample` grow with the length of a live
+ * session.
+ *
+ * The extremes of the newest points are tracked in two monotonic deques, see
+ * `extremes`, so the y-range of a scrolling plot costs O(1) per point.
+ *
+ * The times have to be appended in ascending order.
+ */
+class RollingWindow {
+   public:
+    static constexpr int BUCKETS_PER_PIXEL = 2;  ///< Resolution of the points returned by `sample`
+
+    /**
+     * @brief Allocate the buffer and remove all points
+     *
+     * @param points Maximum number of points
+     */
+    void setCapacity(int points);
+
+    /**
+     * @brief Append a single point, replacing the oldest one if full
+     *
+     * @param time Horizontal value, not less than the previous one
+     * @param value Vertical value
+     */
+    void append(double time, double value);
+
+    /**
+     * @brief Append several points
+     *
+     * @param times Horizontal values, ascending
+     * @param values Vertical values, same size as `times`
+     */
+    void append(const QVector<double>& times, const QVector<double>& values);
+
+    /**
+     * @brief Remove all points, keeping the buffer
+     *
+     */
+    void clear();
+
+    int capacity() const { return times.size(); }  ///< Maximum number of points
+    int size() const { return count; }             ///< Number of points kept
+    bool isEmpty() const { return count == 0; }    ///< True without points
+    qint64 appended() const { return total; }      ///< Points appended since the last `clear`
+
+    double timeAt(int index) const { return times[physical(index)]; }    ///< Time of a point, 0 is the oldest
+    double valueAt(int index) const { return values[physical(index)]; }  ///< Value of a point, 0 is the oldest
+
+    /**
+     * @brief Points to draw a time range at a given width
+     *
+     * If there are more than `BUCKETS_PER_PIXEL` points per pixel, consecutive
+     * points are combined to their minimum and maximum. The buckets are
+     * aligned to the number of appended points, so the line does not change
+     * its shape while it scrolls. The range is extended by one point on each
+     * side, so the line reaches the border of the plot.
+     *
+     * @param lower First time of the range
+     * @param upper Last time of the range
+     * @param pixels Width of the range on the screen
+     * @param sampledTimes Horizontal values of the points to draw, ascending
+     * @param sampledValues Vertical values of the points to draw
+     */
+    void sample(double lower, double upper, int pixels, QVector<double>& sampledTimes,
+                QVector<double>& sampledValues) const;
+
+    /**
+     * @brief Smallest and largest value of the points from `lower` to the newest point
+     *
+     * Meant for a range which scrolls with the newest points: while `lower`
+     * does not decrease, the points which left the range are dropped from the
+     * deques and the result is read from their fronts. A smaller `lower`
+     * than in the previous call rebuilds the deques once.
+     *
+     * @param lower First time of the range
+     * @param min Smallest value
+     * @param max Largest value
+     * @return true if there are points in the range
+     */
+    bool extremes(double lower, double& min, double& max);
+
+    /**
+     * @brief Smallest and largest value of the points in a time range, by scanning them
+     *
+     * @param lower First time of the range
+     * @param upper Last time of the range
+     * @param min Smallest value
+     * @param max Largest value
+     * @return true if there are points in the range
+     */
+    bool extremes(double lower, double upper, double& min, double& max) const;
+
+   private:
+    /**
+     * @brief Candidate for the minimum or maximum of the newest points
+     */
+    struct Extreme {
+        qint64 number;  ///< Number of the point, counted by `total`
+        double time;    ///< Time of the point
+        double value;   ///< Value of the point
+    };
+
+    /**
+     * @brief Add a point to the monotonic deques, removing the candidates it beats
+     *
+     * @param extreme Point newer than all points in the deques
+     */
+    void pushExtreme(const Extreme& extreme);
+
+    /**
+     * @brief Position of a point in the buffer
+     *
+     * @param index Index of the point, 0 is the oldest
+     * @return int Index into `times` and `values`
+     */
+    int physical(int index) const {
+        int position = head + index;
+        return position < times.size() ? position : position - times.size();
+    }
+
+    /**
+     * @brief Index of the first point not before `time`, like `std::lower_bound`
+     *
+     * @param time Time to look for
+     * @param orLater Find the first point after `time` instead, like `std::upper_bound`
+     * @return int Index of the point, `size()` if there is none
+     */
+    int find(double time, bool orLater) const;
+
+    QVector<double> times;   ///< Horizontal values, circular
+    QVector<double> values;  ///< Vertical values, circular
+    int head = 0;            ///< Position of the oldest point
+    int count = 0;           ///< Number of points kept
+    qint64 total = 0;        ///< Points appended since the last `clear`
+
+    std::deque<Extreme> minimums;  ///< Increasing values, the front is the minimum
+    std::deque<Extreme> maximums;  ///< Decreasing values, the front is the maximum
+    double extremesFrom = -std::numeric_limits<double>::infinity();  ///< Older points are not in the deques
+};
+
+#endif  // ROLLINGWINDOW_H_
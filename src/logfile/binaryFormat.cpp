@@ -0,0 +1,273 @@
+/******************************************************************************
+ * Copyright (C) 2023 by Gschwind, Weber, Schoch, Niederberger                *
+ *                                                                            *
+ * This file is part of linescaleGUI.                                         *
+ *                                                                            *
+ * LinescaleGUI is free software: you can redistribute it and/or modify       *
+ * it under the terms of the GNU General Public License as published by       *
+ * the Free Software Foundation, either version 3 of the License, or          *
+ * (at your option) any later version.                                        *
+ *                                                                            *
+ * LinescaleGUI is distributed in the hope that it will be useful,            *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of             *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the               *
+ * GNU General Public License for more details.                               *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License          *
+ * along with linescaleGUI. If not, see <http://www.gnu.org/licenses/>.       *
+ ******************************************************************************/
+/**
+ * @file binaryFormat.cpp
+ * @authors Gschwind, Weber, Schoch, Niederberger
+ *
+ * @brief Encoding of binary logfiles
+ *
+ */
+
+#include "binaryFormat.h"
+#include <QDataStream>
+#include <QtEndian>
+#include <algorithm>
+#include <climits>
+#include <limits>
+#ifdef Q_OS_WIN
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace binlog {
+
+namespace {
+
+/**
+ * @brief Create a stream in the byte order and version of binary logfiles
+ */
+void setupStream(QDataStream& stream) {
+    stream.setVersion(QDataStream::Qt_5_0);
+    stream.setByteOrder(QDataStream::LittleEndian);
+}
+
+}  // namespace
+
+qint64 toCenti(float force) {
+    return qRound64(double(force) * 100.0);
+}
+
+float fromCenti(qint32 centi) {
+    return float(centi / 100.0);
+}
+
+QByteArray encodeHeader(const Metadata& metadata, const Header& header) {
+    QByteArray data;
+    QDataStream out(&data, QIODevice::WriteOnly);
+    setupStream(out);
+    out << Logfile::BINARY_MAGIC << Logfile::BINARY_VERSION;
+    out << metadata.deviceID << metadata.date << metadata.time << qint32(metadata.logNr) << quint8(metadata.unit)
+        << quint8(metadata.mode) << qint32(toCenti(metadata.relZero)) << qint32(metadata.speed)
+        << qint32(toCenti(metadata.triggerForce)) << qint32(toCenti(metadata.stopForce)) << qint32(metadata.preCatch)
+        << qint32(metadata.catchTime) << qint32(metadata.totalTime);
+    out << header.blockSize << header.sampleCount << header.indexOffset;
+    return data;
+}
+
+bool decodeHeader(const char* begin, const char* end, Metadata& metadata, Header& header) {
+    QByteArray contents = QByteArray::fromRawData(begin, int(std::min<qint64>(end - begin, INT_MAX)));
+    QDataStream in(contents);
+    setupStream(in);
+
+    quint32 magic;
+    quint16 version;
+    in >> magic >> version;
+    if (magic != Logfile::BINARY_MAGIC || version != Logfile::BINARY_VERSION) {
+        return false;
+    }
+
+    quint8 unit, mode;
+    qint32 logNr, relZero, speed, triggerForce, stopForce, preCatch, catchTime, totalTime;
+    in >> metadata.deviceID >> metadata.date >> metadata.time >> logNr >> unit >> mode >> relZero >> speed >>
+        triggerForce >> stopForce >> preCatch >> catchTime >> totalTime;
+    in >> header.blockSize >> header.sampleCount >> header.indexOffset;
+    if (in.status() != QDataStream::Ok || unit == quint8(UnitValue::NONE) || unit > quint8(UnitValue::LBF) ||
+        mode == quint8(MeasureMode::NONE) || mode > quint8(MeasureMode::REL_ZERO) || header.blockSize == 0 ||
+        header.sampleCount < 0 || header.sampleCount > std::numeric_limits<int>::max() || header.indexOffset < 0) {
+        return false;
+    }
+    metadata.logNr = logNr;
+    metadata.unit = UnitValue(unit);
+    metadata.mode = MeasureMode(mode);
+    metadata.relZero = fromCenti(relZero);
+    metadata.speed = speed;
+    metadata.triggerForce = fromCenti(triggerForce);
+    metadata.stopForce = fromCenti(stopForce);
+    metadata.preCatch = preCatch;
+    metadata.catchTime = catchTime;
+    metadata.totalTime = totalTime;
+    header.dataOffset = in.device()->pos();
+    return true;
+}
+
+LogfileBlock encodeBlock(quint32 number, const qint32* forces, int count, QByteArray& data) {
+    LogfileBlock info{0, 0, 0, 2};
+    if (count > 0) {
+        auto [blockMin, blockMax] = std::minmax_element(forces, forces + count);
+        info.minForce = *blockMin;
+        info.maxForce = *blockMax;
+    }
+    if (info.minForce < std::numeric_limits<qint16>::min() || info.maxForce > std::numeric_limits<qint16>::max()) {
+        info.sampleSize = 4;
+    }
+
+    data.resize(int(Logfile::BLOCK_HEADER_SIZE) + count * info.sampleSize);
+    char* cursor = data.data();
+    qToLittleEndian<quint32>(number, cursor);
+    qToLittleEndian<quint32>(quint32(count), cursor + 4);
+    qToLittleEndian<qint32>(info.minForce, cursor + 8);
+    qToLittleEndian<qint32>(info.maxForce, cursor + 12);
+    cursor[16] = char(info.sampleSize);
+    cursor += Logfile::BLOCK_HEADER_SIZE;
+    if (info.sampleSize == 2) {
+        for (int i = 0; i < count; ++i) {
+            qToLittleEndian<qint16>(qint16(forces[i]), cursor + 2 * i);
+        }
+    } else {
+        qToLittleEndian<qint32>(forces, count, cursor);
+    }
+    return info;
+}
+
+int checkBlock(const char* data, qint64 available, quint32 number, quint32 blockSize, LogfileBlock& info) {
+    if (available < Logfile::BLOCK_HEADER_SIZE || qFromLittleEndian<quint32>(data) != number) {
+        return -1;
+    }
+    quint32 count = qFromLittleEndian<quint32>(data + 4);
+    info.minForce = qFromLittleEndian<qint32>(data + 8);
+    info.maxForce = qFromLittleEndian<qint32>(data + 12);
+    info.sampleSize = quint8(data[16]);
+    if (count == 0 || count > blockSize || (info.sampleSize != 2 && info.sampleSize != 4) ||
+        Logfile::BLOCK_HEADER_SIZE + qint64(count) * info.sampleSize > available) {
+        return -1;
+    }
+    return int(count);
+}
+
+void decodeBlock(const char* data, int count, quint8 sampleSize, qint32* forces) {
+    data += Logfile::BLOCK_HEADER_SIZE;
+    if (sampleSize == 2) {
+        for (int i = 0; i < count; ++i) {
+            forces[i] = qFromLittleEndian<qint16>(data + 2 * i);
+        }
+    } else {
+        qFromLittleEndian<qint32>(data, count, forces);
+    }
+}
+
+QByteArray encodeIndex(const QVector<LogfileBlock>& blocks) {
+    QByteArray data;
+    QDataStream out(&data, QIODevice::WriteOnly);
+    setupStream(out);
+    for (const LogfileBlock& info : blocks) {
+        out << info.offset << info.minForce << info.maxForce << info.sampleSize;
+    }
+    return data;
+}
+
+bool decodeIndex(const char* begin, const char* end, const Header& header, QVector<LogfileBlock>& blocks) {
+    qint64 size = end - begin;
+    qint64 blockCount = (header.sampleCount + header.blockSize - 1) / header.blockSize;
+    if (header.indexOffset < header.dataOffset ||
+        header.indexOffset + blockCount * Logfile::BLOCK_INDEX_ENTRY_SIZE > size) {
+        return false;
+    }
+
+    QByteArray contents = QByteArray::fromRawData(begin + header.indexOffset, int(end - begin - header.indexOffset));
+    QDataStream in(contents);
+    setupStream(in);
+    blocks.resize(int(blockCount));
+    for (int block = 0; block < blocks.size(); ++block) {
+        LogfileBlock& info = blocks[block];
+        in >> info.offset >> info.minForce >> info.maxForce >> info.sampleSize;
+        qint64 count = std::min<qint64>(header.blockSize, header.sampleCount - qint64(block) * header.blockSize);
+        if ((info.sampleSize != 2 && info.sampleSize != 4) || info.offset < header.dataOffset ||
+            info.offset + Logfile::BLOCK_HEADER_SIZE + count * info.sampleSize > size) {
+            blocks.clear();
+            return false;
+        }
+    }
+    return in.status() == QDataStream::Ok;
+}
+
+qint64 scanBlocks(const char* begin, const char* end, const Header& header, QVector<LogfileBlock>& blocks) {
+    blocks.clear();
+    qint64 sampleCount = 0;
+    qint64 offset = header.dataOffset;
+    LogfileBlock info;
+    int count;
+    // Only the last block may be partially filled
+    while (sampleCount % header.blockSize == 0 &&
+           (count = checkBlock(begin + offset, end - begin - offset, quint32(blocks.size()), header.blockSize,
+                               info)) > 0) {
+        info.offset = offset;
+        blocks.append(info);
+        sampleCount += count;
+        offset += Logfile::BLOCK_HEADER_SIZE + qint64(count) * info.sampleSize;
+    }
+    return sampleCount;
+}
+
+bool sync(QFile& file) {
+    if (!file.flush()) {
+        return false;
+    }
+#ifdef Q_OS_WIN
+    return _commit(file.handle()) == 0;
+#else
+    return ::fsync(file.handle()) == 0;
+#endif
+}
+
+bool finalize(QFile& file, const Metadata* metadata) {
+    // Map the file once to find the complete blocks
+    QByteArray contents;
+    qint64 size = file.size();
+    uchar* mapped = file.map(0, size);
+    const char* begin = reinterpret_cast<const char*>(mapped);
+    if (mapped == nullptr) {
+        contents = file.seek(0) ? file.readAll() : QByteArray();
+        begin = contents.constData();
+        size = contents.size();
+    }
+    Metadata stored;
+    Header header;
+    QVector<LogfileBlock> blocks;
+    bool valid = decodeHeader(begin, begin + size, stored, header);
+    if (valid && header.indexOffset == 0) {
+        header.sampleCount = scanBlocks(begin, begin + size, header, blocks);
+    }
+    if (mapped != nullptr) {
+        file.unmap(mapped);
+    }
+    if (!valid || header.indexOffset != 0) {
+        return valid;
+    }
+
+    qint64 dataEnd = header.dataOffset;
+    if (!blocks.isEmpty()) {
+        qint64 lastCount = header.sampleCount - qint64(blocks.size() - 1) * header.blockSize;
+        dataEnd = blocks.last().offset + Logfile::BLOCK_HEADER_SIZE + lastCount * blocks.last().sampleSize;
+    }
+    header.indexOffset = dataEnd;
+
+    // The index has to be on the disk before the header points to it
+    QByteArray index = encodeIndex(blocks);
+    if (!file.resize(dataEnd) || !file.seek(dataEnd) || file.write(index) != index.size() || !sync(file)) {
+        return false;
+    }
+    QByteArray encoded = encodeHeader(metadata ? *metadata : stored, header);
+    if (encoded.size() != header.dataOffset) {
+        encoded = encodeHeader(stored, header);  // The header can not grow into the first block
+    }
+    return file.seek(0) && file.write(encoded) == encoded.size() && sync(file);
+}
+
+}  // namespace binlog
@@ -0,0 +1,179 @@
+/******************************************************************************
+ * Copyright (C) 2023 by Gschwind, Weber, Schoch, Niederberger                *
+ *                                                                            *
+ * This file is part of linescaleGUI.                                         *
+ *                                                                            *
+ * LinescaleGUI is free software: you can redistribute it and/or modify       *
+ * it under the terms of the GNU General Public License as published by       *
+ * the Free Software Foundation, either version 3 of the License, or          *
+ * (at your option) any later version.                                        *
+ *                                                                            *
+ * LinescaleGUI is distributed in the hope that it will be useful,            *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of             *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the               *
+ * GNU General Public License for more details.                               *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License          *
+ * along with linescaleGUI. If not, see <http://www.gnu.org/licenses/>.       *
+ ******************************************************************************/
+/**
+ * @file binaryFormat.h
+ * @authors Gschwind, Weber, Schoch, Niederberger
+ *
+ * @brief Encoding of binary logfiles, shared by `Logfile` and `Recorder`
+ *
+ */
+
+#pragma once
+#ifndef BINARYFORMAT_H_
+#define BINARYFORMAT_H_
+
+#include <QByteArray>
+#include <QFile>
+#include <QVector>
+#include "logfile.h"
+
+namespace binlog {
+
+/**
+ * @brief Fields of the header following the metadata
+ *
+ */
+struct Header {
+    quint32 blockSize = Logfile::BLOCK_SIZE;  ///< Forces per block, only the last block may hold less
+    qint64 sampleCount = 0;                   ///< Number of forces; 0 if the file was not closed
+    qint64 indexOffset = 0;                   ///< Position of the block index; 0 if the file was not closed
+    qint64 dataOffset = 0;                    ///< Position of the first block, i.e. size of the header
+};
+
+/**
+ * @brief Convert a force to centi-units, as written with two decimals
+ *
+ * @param force Force
+ * @return qint64 Force in centi-units, rounded
+ */
+qint64 toCenti(float force);
+
+/**
+ * @brief Convert centi-units to a force, exactly like parsing the two decimals
+ *
+ * @param centi Force in centi-units
+ * @return float Force
+ */
+float fromCenti(qint32 centi);
+
+/**
+ * @brief Encode the header of a binary logfile
+ *
+ * `Header::sampleCount` and `Header::indexOffset` are the last bytes of the
+ * header, so they can be patched in place, see `Header::dataOffset`.
+ *
+ * @param metadata Metadata of the logfile
+ * @param header Fields following the metadata
+ * @return QByteArray Header of `Header::dataOffset` bytes
+ */
+QByteArray encodeHeader(const Metadata& metadata, const Header& header);
+
+/**
+ * @brief Decode the header of a binary logfile
+ *
+ * @param begin First byte of the file
+ * @param end One past the last byte of the file
+ * @param metadata Decoded metadata
+ * @param header Decoded fields following the metadata
+ * @return true if the header is valid and of the current version
+ */
+bool decodeHeader(const char* begin, const char* end, Metadata& metadata, Header& header);
+
+/**
+ * @brief Encode a block
+ *
+ * The forces are stored as int16 if all of them fit, otherwise as int32.
+ *
+ * @param number Number of the block
+ * @param forces Forces in centi-units
+ * @param count Number of forces
+ * @param data Encoded block, including its header
+ * @return LogfileBlock Index entry of the block, without offset
+ */
+LogfileBlock encodeBlock(quint32 number, const qint32* forces, int count, QByteArray& data);
+
+/**
+ * @brief Check the header of a block without decoding its forces
+ *
+ * @param data First byte of the block
+ * @param available Bytes available from `data` on
+ * @param number Expected number of the block
+ * @param blockSize Maximum forces per block
+ * @param info Min, max and bytes per force of the block
+ * @return int Number of forces in the block; -1 if the block is invalid or truncated
+ */
+int checkBlock(const char* data, qint64 available, quint32 number, quint32 blockSize, LogfileBlock& info);
+
+/**
+ * @brief Decode the forces of a block checked by `checkBlock`
+ *
+ * @param data First byte of the block
+ * @param count Number of forces returned by `checkBlock`
+ * @param sampleSize Bytes per force
+ * @param forces Decoded forces in centi-units, room for `count` forces
+ */
+void decodeBlock(const char* data, int count, quint8 sampleSize, qint32* forces);
+
+/**
+ * @brief Encode the block index
+ *
+ * @param blocks Index entries of all blocks
+ * @return QByteArray Encoded index
+ */
+QByteArray encodeIndex(const QVector<LogfileBlock>& blocks);
+
+/**
+ * @brief Decode the block index of a closed logfile
+ *
+ * @param begin First byte of the file
+ * @param end One past the last byte of the file
+ * @param header Header of the file
+ * @param blocks Index entries of all blocks
+ * @return true if the index is valid and all blocks are inside the file
+ */
+bool decodeIndex(const char* begin, const char* end, const Header& header, QVector<LogfileBlock>& blocks);
+
+/**
+ * @brief Rebuild the block index of a logfile that was not closed
+ *
+ * Walks the blocks from `Header::dataOffset` on and stops at the first
+ * truncated or invalid block, e.g. the one written during a crash.
+ *
+ * @param begin First byte of the file
+ * @param end One past the last byte of the file
+ * @param header Header of the file
+ * @param blocks Index entries of all complete blocks
+ * @return qint64 Number of forces in these blocks
+ */
+qint64 scanBlocks(const char* begin, const char* end, const Header& header, QVector<LogfileBlock>& blocks);
+
+/**
+ * @brief Write buffered data and make sure it reached the disk
+ *
+ * @param file Opened file
+ * @return true on success
+ */
+bool sync(QFile& file);
+
+/**
+ * @brief Close a binary logfile which was written block by block
+ *
+ * Removes a truncated block at the end, appends the block index and patches
+ * the number of forces and the index position in the header. Files which are
+ * already closed are left untouched.
+ *
+ * @param file Logfile opened for reading and writing
+ * @param metadata Metadata to write to the header instead of the current one; `nullptr` to keep it
+ * @return true on success
+ */
+bool finalize(QFile& file, const Metadata* metadata = nullptr);
+
+}  // namespace binlog
+
+#endif  // BINARYFORMAT_H_
@@ -28,28 +28,268 @@
 #include <QCoreApplication>
 #include <QDebug>
 #include <QDir>
+#include <QtEndian>
 #include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <thread>
+#include <vector>
+#include "binaryFormat.h"
+
+namespace {
+
+/**
+ * @brief Forces of a chunk of whole lines, see `Logfile::parseForces`
+ */
+struct ForceChunk {
+    const char* begin = nullptr;  ///< First character of the chunk
+    const char* end = nullptr;    ///< One past the last character of the chunk
+    int firstIndex = 0;           ///< Index of the first force in the chunk
+    int lines = 0;                ///< Number of lines in the chunk
+    int parsed = 0;               ///< Number of valid lines before the first invalid one
+    float minForce = std::numeric_limits<float>::max();
+    float maxForce = std::numeric_limits<float>::lowest();
+    int minForceIndex = 0;
+    int maxForceIndex = 0;
+};
+
+/**
+ * @brief Count the lines in `[begin, end)`, including a last line without newline
+ */
+int countLines(const char* begin, const char* end) {
+    int lines = 0;
+    while (begin < end) {
+        const char* newline = static_cast<const char*>(std::memchr(begin, '\n', size_t(end - begin)));
+        ++lines;
+        if (newline == nullptr) {
+            break;
+        }
+        begin = newline + 1;
+    }
+    return lines;
+}
+
+/**
+ * @brief Parse a single force line like `QString::toFloat` but without allocating
+ *
+ * Surrounding whitespace (including the `\r` of Windows line endings) is ignored.
+ *
+ * @param begin First character of the line
+ * @param end One past the last character of the line, excluding `\n`
+ * @param force Parsed force
+ * @return true if the line is a valid number
+ */
+bool parseForce(const char* begin, const char* end, float& force) {
+    while (begin < end && std::isspace(static_cast<unsigned char>(*begin))) {
+        ++begin;
+    }
+    while (end > begin && std::isspace(static_cast<unsigned char>(end[-1]))) {
+        --end;
+    }
+    if (begin < end && *begin == '+') {
+        ++begin;  // Accepted by `QString::toFloat`, but not by `std::from_chars`
+    }
+    if (begin == end) {
+        return false;
+    }
+#if defined(__cpp_lib_to_chars)
+    // Parse as double and round to float afterwards, exactly like `QString::toFloat`
+    double value;
+    auto [last, error] = std::from_chars(begin, end, value);
+    if (error != std::errc() || last != end) {
+        return false;
+    }
+#else
+    // Standard libraries without floating point `std::from_chars`
+    bool success;
+    double value = QByteArray::fromRawData(begin, int(end - begin)).toDouble(&success);
+    if (!success) {
+        return false;
+    }
+#endif
+    if (std::isfinite(value) && std::fabs(value) > double(std::numeric_limits<float>::max())) {
+        return false;  // Out of range for a float
+    }
+    force = float(value);
+    return true;
+}
+
+/**
+ * @brief Parse all lines of `chunk` into `forces`, stop at the first invalid line
+ */
+void parseChunk(ForceChunk& chunk, float* forces) {
+    const char* line = chunk.begin;
+    for (int i = 0; i < chunk.lines; ++i) {
+        const char* newline = static_cast<const char*>(std::memchr(line, '\n', size_t(chunk.end - line)));
+        const char* lineEnd = newline ? newline : chunk.end;
+        int index = chunk.firstIndex + i;
+
+        float newForce;
+        if (!parseForce(line, lineEnd, newForce)) {
+            return;
+        }
+        if (newForce <= chunk.minForce) {
+            chunk.minForce = newForce;
+            chunk.minForceIndex = index;
+        }
+        if (newForce >= chunk.maxForce) {
+            chunk.maxForce = newForce;
+            chunk.maxForceIndex = index;
+        }
+        forces[index] = newForce;
+        ++chunk.parsed;
+        line = lineEnd + 1;
+    }
+}
+
+}  // namespace
 
 int Logfile::load() {
+    return loadFile(true);
+}
+
+int Logfile::loadIndex() {
+    return loadFile(false);
+}
+
+int Logfile::loadFile(bool withForces) {
     QFile file(filePath);
     if (!file.open(QIODevice::ReadOnly)) {
         return -1;  // Unable to open file
     }
 
-    QTextStream in(&file);
+    // Empty files and some special files can not be mapped, read them instead
+    QByteArray contents;
+    qint64 size = file.size();
+    const char* begin = reinterpret_cast<const char*>(file.map(0, size));
+    if (begin == nullptr) {
+        contents = file.readAll();
+        begin = contents.constData();
+        size = contents.size();
+    }
+    const char* end = begin + size;
+
+    if (size >= 4 && qFromLittleEndian<quint32>(begin) == BINARY_MAGIC) {
+        format = LogfileFormat::BINARY;
+        return loadBinary(begin, end, withForces);
+    }
+    format = LogfileFormat::CSV;
+    blocks.clear();
+
+    // The header ends after the line in front of the first force
+    const char* headerEnd = begin;
+    for (int line = 1; line < LINE_NUMBER_FORCE && headerEnd < end; ++line) {
+        const char* newline = static_cast<const char*>(std::memchr(headerEnd, '\n', size_t(end - headerEnd)));
+        headerEnd = newline ? newline + 1 : end;
+    }
 
+    QTextStream in(QByteArray::fromRawData(begin, int(headerEnd - begin)), QIODevice::ReadOnly);
     int invalidLineNumber = parseMetadata(in);
     if (invalidLineNumber != 0) {
         return invalidLineNumber;  // Unable to parse metadata
     }
 
-    int index = 0;
-    float period = 1.0 / metadata.speed;
+    invalidLineNumber = parseForces(headerEnd, end);
+    sampleCount = forceVector.size();
+    return invalidLineNumber;
+}
+
+int Logfile::parseForces(const char* begin, const char* end) {
+    // Split into chunks of whole lines
+    size_t threads = std::max(1u, std::thread::hardware_concurrency());
+    size_t chunkSize = std::max(MIN_CHUNK_SIZE, size_t(end - begin) / threads + 1);
+    std::vector<ForceChunk> chunks;
+    for (const char* chunkBegin = begin; chunkBegin < end;) {
+        const char* chunkEnd = chunkBegin + std::min(chunkSize, size_t(end - chunkBegin));
+        const char* newline = static_cast<const char*>(std::memchr(chunkEnd - 1, '\n', size_t(end - chunkEnd + 1)));
+        chunkEnd = newline ? newline + 1 : end;
+        chunks.push_back({chunkBegin, chunkEnd});
+        chunkBegin = chunkEnd;
+    }
+
+    auto forEachChunk = [&chunks](auto function) {
+        std::vector<std::thread> workers;
+        for (size_t i = 1; i < chunks.size(); ++i) {
+            workers.emplace_back(function, std::ref(chunks[i]));
+        }
+        if (!chunks.empty()) {
+            function(chunks[0]);
+        }
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+    };
+
+    // Count the lines to size the vectors once
+    forEachChunk([](ForceChunk& chunk) { chunk.lines = countLines(chunk.begin, chunk.end); });
+    int lines = 0;
+    for (ForceChunk& chunk : chunks) {
+        chunk.firstIndex = lines;
+        lines += chunk.lines;
+    }
+    forceVector.resize(lines);
+
+    float* forces = forceVector.data();
+    forEachChunk([forces](ForceChunk& chunk) { parseChunk(chunk, forces); });
+
+    // Merge in file order, ties go to the later index as when parsing sequentially
+    for (const ForceChunk& chunk : chunks) {
+        if (chunk.parsed > 0) {
+            if (chunk.minForce <= minForce) {
+                minForce = chunk.minForce;
+                minForceIndex = chunk.minForceIndex;
+            }
+            if (chunk.maxForce >= maxForce) {
+                maxForce = chunk.maxForce;
+                maxForceIndex = chunk.maxForceIndex;
+            }
+        }
+        if (chunk.parsed < chunk.lines) {
+            int index = chunk.firstIndex + chunk.parsed;
+            forceVector.resize(index);
+            return LINE_NUMBER_FORCE + index;
+        }
+    }
+    return 0;
+}
+
+int Logfile::loadBinary(const char* begin, const char* end, bool withForces) {
+    binlog::Header header;
+    if (!binlog::decodeHeader(begin, end, metadata, header)) {
+        return INVALID_BINARY;
+    }
+    blockSize = header.blockSize;
+    if (header.indexOffset != 0) {
+        if (!binlog::decodeIndex(begin, end, header, blocks)) {
+            return INVALID_BINARY;
+        }
+        sampleCount = header.sampleCount;
+    } else {
+        // Not closed, e.g. a recording interrupted by a crash
+        sampleCount = binlog::scanBlocks(begin, end, header, blocks);
+    }
+    if (!withForces) {
+        return 0;
+    }
 
-    while (!in.atEnd()) {
-        bool success;
-        float newForce = in.readLine().toFloat(&success);
-        if (success) {
+    forceVector.resize(int(sampleCount));
+    QVector<qint32> centi(int(blockSize));
+    for (int block = 0; block < blocks.size(); ++block) {
+        int first = block * int(blockSize);
+        LogfileBlock info;
+        int count = binlog::checkBlock(begin + blocks[block].offset, end - begin - blocks[block].offset, quint32(block),
+                                       blockSize, info);
+        if (count != int(std::min<qint64>(blockSize, sampleCount - first))) {
+            forceVector.resize(first);
+            sampleCount = first;
+            return INVALID_BINARY;
+        }
+        binlog::decodeBlock(begin + blocks[block].offset, count, info.sampleSize, centi.data());
+        for (int i = 0; i < count; ++i) {
+            int index = first + i;
+            float newForce = binlog::fromCenti(centi[i]);
             if (newForce <= minForce) {
                 minForce = newForce;
                 minForceIndex = index;
@@ -58,18 +298,160 @@ int Logfile::load() {
                 maxForce = newForce;
                 maxForceIndex = index;
             }
-            forceVector.append(newForce);
-            timeVector.append(period * index);
-            ++index;
-        } else {
-            invalidLineNumber = LINE_NUMBER_FORCE + index;
-            break;
+            forceVector[index] = newForce;
         }
     }
-    return invalidLineNumber;
+    return 0;
+}
+
+bool Logfile::readBlock(QFile& file, int block, QVector<qint32>& forces) {
+    const LogfileBlock& info = blocks[block];
+    int count = int(std::min<qint64>(blockSize, sampleCount - qint64(block) * blockSize));
+    qint64 length = BLOCK_HEADER_SIZE + qint64(count) * info.sampleSize;
+    if (!file.seek(info.offset)) {
+        return false;
+    }
+    QByteArray data = file.read(length);
+    LogfileBlock checked;
+    if (binlog::checkBlock(data.constData(), data.size(), quint32(block), blockSize, checked) != count) {
+        return false;
+    }
+    forces.resize(count);
+    binlog::decodeBlock(data.constData(), count, checked.sampleSize, forces.data());
+    return true;
+}
+
+bool Logfile::readForces(qint64 first, int count, QVector<float>& forces) {
+    if (first < 0 || count < 0 || first + count > sampleCount) {
+        return false;
+    }
+    forces.resize(count);
+    if (forceVector.size() == sampleCount) {
+        std::copy(forceVector.constBegin() + first, forceVector.constBegin() + first + count, forces.begin());
+        return true;
+    }
+    if (format != LogfileFormat::BINARY || blocks.isEmpty()) {
+        return false;
+    }
+
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    QVector<qint32> centi;
+    qint64 index = first;
+    while (index < first + count) {
+        int block = int(index / blockSize);
+        if (!readBlock(file, block, centi)) {
+            return false;
+        }
+        qint64 blockFirst = qint64(block) * blockSize;
+        qint64 stop = std::min(first + count, blockFirst + centi.size());
+        for (; index < stop; ++index) {
+            forces[int(index - first)] = binlog::fromCenti(centi[int(index - blockFirst)]);
+        }
+    }
+    return true;
+}
+
+bool Logfile::findPeaks(qint64 first, qint64 count, float& min, float& max) {
+    if (first < 0 || count <= 0 || first + count > sampleCount) {
+        return false;
+    }
+    bool loaded = forceVector.size() == sampleCount;
+    float low = std::numeric_limits<float>::max();
+    float high = std::numeric_limits<float>::lowest();
+    auto scanLoaded = [&](qint64 from, qint64 to) {
+        for (qint64 i = from; i < to; ++i) {
+            low = std::min(low, forceVector[int(i)]);
+            high = std::max(high, forceVector[int(i)]);
+        }
+    };
+
+    if (format != LogfileFormat::BINARY || blocks.isEmpty()) {
+        if (!loaded) {
+            return false;
+        }
+        scanLoaded(first, first + count);
+    } else {
+        QFile file(filePath);
+        QVector<qint32> centi;
+        qint64 last = first + count;
+        for (qint64 block = first / blockSize; block * blockSize < last; ++block) {
+            qint64 blockFirst = block * blockSize;
+            qint64 blockLast = std::min(blockFirst + blockSize, sampleCount);
+            qint64 from = std::max(first, blockFirst);
+            qint64 to = std::min(last, blockLast);
+            if (from == blockFirst && to == blockLast) {
+                // Completely covered, the block index is enough
+                low = std::min(low, binlog::fromCenti(blocks[int(block)].minForce));
+                high = std::max(high, binlog::fromCenti(blocks[int(block)].maxForce));
+            } else if (loaded) {
+                scanLoaded(from, to);
+            } else {
+                if ((!file.isOpen() && !file.open(QIODevice::ReadOnly)) || !readBlock(file, int(block), centi)) {
+                    return false;
+                }
+                for (qint64 i = from; i < to; ++i) {
+                    low = std::min(low, binlog::fromCenti(centi[int(i - blockFirst)]));
+                    high = std::max(high, binlog::fromCenti(centi[int(i - blockFirst)]));
+                }
+            }
+        }
+    }
+    min = low;
+    max = high;
+    return true;
+}
+
+bool Logfile::writeBinary() {
+    QVector<qint32> centi(forceVector.size());
+    for (int i = 0; i < forceVector.size(); ++i) {
+        qint64 value = binlog::toCenti(forceVector[i]);
+        if (value < std::numeric_limits<qint32>::min() || value > std::numeric_limits<qint32>::max()) {
+            return false;
+        }
+        centi[i] = qint32(value);
+    }
+
+    QFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return false;
+    }
+
+    // Encode the blocks first, the header points to the index behind them
+    binlog::Header header;
+    header.sampleCount = centi.size();
+    header.dataOffset = binlog::encodeHeader(metadata, header).size();
+    QByteArray data;
+    int blockCount = int((centi.size() + BLOCK_SIZE - 1) / BLOCK_SIZE);
+    blocks.resize(blockCount);
+    qint64 offset = header.dataOffset;
+    for (int block = 0; block < blockCount; ++block) {
+        int first = block * int(BLOCK_SIZE);
+        int count = std::min(int(BLOCK_SIZE), centi.size() - first);
+        QByteArray encoded;
+        blocks[block] = binlog::encodeBlock(quint32(block), centi.constData() + first, count, encoded);
+        blocks[block].offset = offset;
+        offset += encoded.size();
+        data.append(encoded);
+    }
+    header.indexOffset = offset;
+
+    QByteArray index = binlog::encodeIndex(blocks);
+    bool success = file.write(binlog::encodeHeader(metadata, header)) == header.dataOffset &&
+                   file.write(data) == data.size() && file.write(index) == index.size();
+
+    blockSize = BLOCK_SIZE;
+    sampleCount = centi.size();
+    return success;
 }
 
 bool Logfile::write() {
+    if (format == LogfileFormat::BINARY) {
+        return writeBinary();
+    }
+
     QFile file(filePath);
     if (!file.open(QIODevice::ReadWrite | QIODevice::Text)) {
         return false;
@@ -217,14 +599,12 @@ const QVector<float>& Logfile::getForce() {
     return forceVector;
 }
 
-const QVector<float>& Logfile::getTime() {
-    return timeVector;
+TimeAxis Logfile::getTime() {
+    return TimeAxis(0.0, 1.0 / metadata.speed, sampleCount);
 }
 
 void Logfile::setForce(const QVector<float>& force) {
     forceVector = force;
-}
-
-void Logfile::setTime(const QVector<float>& time) {
-    timeVector = time;
+    sampleCount = force.size();
+    blocks.clear();
 }
@@ -33,6 +33,7 @@
 #include <QVector>
 #include <limits>
 #include "../parser/parser.h"
+#include "timeAxis.h"
 
 /**
  * @brief Metadata as saved in the current logfile
@@ -54,19 +55,111 @@ struct Metadata {
     int totalTime;       ///< Total time = preCatch + catchTime
 };
 
+/**
+ * @brief Storage format of a logfile
+ *
+ */
+enum class LogfileFormat {
+    CSV,     ///< Text as written by the device, one force per line
+    BINARY,  ///< Versioned binary container with a block index
+};
+
+/**
+ * @brief Entry of the block index of a binary logfile
+ *
+ */
+struct LogfileBlock {
+    qint64 offset;      ///< Position of the block in the file
+    qint32 minForce;    ///< Minimum force of the block in centi-units
+    qint32 maxForce;    ///< Maximum force of the block in centi-units
+    quint8 sampleSize;  ///< Bytes per force, 2 (int16) or 4 (int32)
+};
+
 /**
  * @brief Class to represent a logfile from the device
  *
+ * A logfile is either stored as CSV like the device writes it, or in the
+ * binary format. The binary format holds the same metadata and the forces as
+ * integer centi-units, so both formats can be converted into each other
+ * without loss. Little endian layout:
+ *
+ * - Header written with `QDataStream`: magic `LSCB`, version, all `Metadata`
+ *   fields (forces in centi-units), forces per block, number of forces and
+ *   position of the block index
+ * - Blocks: block number, number of forces, min, max (centi-units) and bytes
+ *   per force, followed by the int16 or int32 forces of the block
+ * - Block index: offset, min, max and bytes per force of every block
+ *
+ * All blocks except the last hold the same number of forces, so the block of
+ * any force is found in O(1) and peak queries only read partially covered blocks.
+ * The blocks can be appended one by one while recording, see `Recorder`. The
+ * number of forces and the index position are zero until the file is closed;
+ * such files are loaded up to the last complete block.
  */
 class Logfile {
    public:
+    static constexpr int INVALID_BINARY = -2;             ///< `load` result of a corrupt binary logfile
+    static constexpr quint32 BINARY_MAGIC = 0x4243534C;   ///< "LSCB" read as little endian
+    static constexpr quint16 BINARY_VERSION = 1;          ///< Current version of the binary format
+    static constexpr quint32 BLOCK_SIZE = 4096;           ///< Forces per block of written binary logfiles
+    static constexpr qint64 BLOCK_INDEX_ENTRY_SIZE = 17;  ///< Bytes of a `LogfileBlock` in the file
+    static constexpr qint64 BLOCK_HEADER_SIZE = 17;       ///< Bytes in front of the forces of a block
+
     /**
      * @brief Open the file and parse the data
      *
-     * @return int 0 on success; -1 if unable to open, first invalid line number on failure
+     * The file is memory mapped. After the header, the forces are split into
+     * chunks of whole lines which are parsed in parallel.
+     *
+     * Binary logfiles are detected by their magic number and loaded completely.
+     *
+     * @return int 0 on success; -1 if unable to open, first invalid line number on failure,
+     *             `INVALID_BINARY` for a corrupt binary logfile
      */
     int load();
 
+    /**
+     * @brief Open the file and parse only the metadata and the block index
+     *
+     * The forces of binary logfiles can then be read with `readForces` and
+     * `findPeaks` without loading the whole file. CSV logfiles have no index
+     * and are loaded completely.
+     *
+     * @return int Same as `load`
+     */
+    int loadIndex();
+
+    /**
+     * @brief Read consecutive forces
+     *
+     * Reads from the loaded forces if available, otherwise only the affected
+     * blocks are read from a binary logfile.
+     *
+     * @param first Index of the first force; the time of the force is `first / speed`
+     * @param count Number of forces
+     * @param forces Read forces
+     * @return true if all forces were read
+     */
+    bool readForces(qint64 first, int count, QVector<float>& forces);
+
+    /**
+     * @brief Find the minimum and maximum of consecutive forces
+     *
+     * Blocks of binary logfiles that are completely inside the range are
+     * answered from the block index without reading them.
+     *
+     * @param first Index of the first force
+     * @param count Number of forces
+     * @param min Minimum force in the range
+     * @param max Maximum force in the range
+     * @return true on success
+     */
+    bool findPeaks(qint64 first, qint64 count, float& min, float& max);
+
+    qint64 getSampleCount() { return sampleCount; }                ///< Number of forces in the file
+    LogfileFormat getFormat() { return format; }                   ///< Format of the loaded file
+    void setFormat(LogfileFormat newFormat) { format = newFormat; }  ///< Format used by `write`
+
     float getMinForce() { return minForce; }            ///< Return min force of the logfile
     float getMaxForce() { return maxForce; }            ///< Return max force of the logfile
     float getMinForceIndex() { return minForceIndex; }  ///< Return timestamp of min force
@@ -75,6 +168,9 @@ class Logfile {
     /**
      * @brief Write the current metadata and force vector into a file
      *
+     * Uses the format set by `setFormat`, by default CSV. Forces written to a
+     * binary logfile are rounded to centi-units, like the two decimals of CSV.
+     *
      * @return true if successfully written to the harddisk
      */
     bool write();
@@ -122,11 +218,13 @@ class Logfile {
     const QVector<float>& getForce();
 
     /**
-     * @brief Get the timeVector
+     * @brief Get the time of every force
      *
-     * @return QVector<float>&
+     * The time values are computed from the speed on demand.
+     *
+     * @return TimeAxis Time axis with one value per force in the file
      */
-    const QVector<float>& getTime();
+    TimeAxis getTime();
 
     /**
      * @brief Set the forceVector
@@ -135,13 +233,6 @@ class Logfile {
      */
     void setForce(const QVector<float>& force);
 
-    /**
-     * @brief Set the timeVector
-     *
-     * @param time
-     */
-    void setTime(const QVector<float>& time);
-
    private:
     /**
      * @brief Parse the metadata from a given text stream
@@ -151,6 +242,53 @@ class Logfile {
      */
     int parseMetadata(QTextStream& in);
 
+    /**
+     * @brief Parse the force lines following the header
+     *
+     * Sizes `forceVector` once and fills it in parallel. On failure, it holds
+     * the forces in front of the invalid line.
+     *
+     * @param begin First character of the first force line
+     * @param end One past the last character of the file
+     * @return int 0 on success; first invalid line number on failure
+     */
+    int parseForces(const char* begin, const char* end);
+
+    /**
+     * @brief Open the file and parse it in either format
+     *
+     * @param withForces Whether to load the forces of binary logfiles
+     * @return int Same as `load`
+     */
+    int loadFile(bool withForces);
+
+    /**
+     * @brief Parse a binary logfile
+     *
+     * @param begin First byte of the file
+     * @param end One past the last byte of the file
+     * @param withForces Whether to load the forces or only the block index
+     * @return int 0 on success; `INVALID_BINARY` if corrupt or of unknown version
+     */
+    int loadBinary(const char* begin, const char* end, bool withForces);
+
+    /**
+     * @brief Write the current metadata and force vector as binary logfile
+     *
+     * @return true if successfully written to the harddisk
+     */
+    bool writeBinary();
+
+    /**
+     * @brief Read a single block of a binary logfile
+     *
+     * @param file Opened binary logfile
+     * @param block Number of the block
+     * @param forces Forces of the block in centi-units
+     * @return true on success
+     */
+    bool readBlock(QFile& file, int block, QVector<qint32>& forces);
+
     /**
      * @brief Split the input line and return a float
      *
@@ -197,12 +335,16 @@ class Logfile {
     QString filePath;
     Metadata metadata;
     QVector<float> forceVector;
-    QVector<float> timeVector;
+    LogfileFormat format = LogfileFormat::CSV;  ///< Format of the file
+    QVector<LogfileBlock> blocks;               ///< Block index of a binary logfile
+    quint32 blockSize = BLOCK_SIZE;             ///< Forces per block of a binary logfile
+    qint64 sampleCount = 0;                     ///< Number of forces in the file
     float minForce = std::numeric_limits<float>::max();     ///< Minimum force present
     float maxForce = std::numeric_limits<float>::lowest();  ///< Maximum force present
     int minForceIndex = 0;                                  ///< Index of minForce
     int maxForceIndex = 0;                                  ///< Index of maxForce
     static constexpr int LINE_NUMBER_FORCE = 14;            ///< Start of the force vector
+    static constexpr size_t MIN_CHUNK_SIZE = 1 << 20;       ///< Minimum bytes parsed by one thread
 };
 
 #endif  // LOGFILE_H_
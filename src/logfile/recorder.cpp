@@ -0,0 +1,198 @@
+/******************************************************************************
+ * Copyright (C) 2023 by Gschwind, Weber, Schoch, Niederberger                *
+ *                                                                            *
+ * This file is part of linescaleGUI.                                         *
+ *                                                                            *
+ * LinescaleGUI is free software: you can redistribute it and/or modify       *
+ * it under the terms of the GNU General Public License as published by       *
+ * the Free Software Foundation, either version 3 of the License, or          *
+ * (at your option) any later version.                                        *
+ *                                                                            *
+ * LinescaleGUI is distributed in the hope that it will be useful,            *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of             *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the               *
+ * GNU General Public License for more details.                               *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License          *
+ * along with linescaleGUI. If not, see <http://www.gnu.org/licenses/>.       *
+ ******************************************************************************/
+/**
+ * @file recorder.cpp
+ * @authors Gschwind, Weber, Schoch, Niederberger
+ *
+ * @brief `Recorder` implementation
+ *
+ */
+
+#include "recorder.h"
+#include <chrono>
+#include <limits>
+#include "binaryFormat.h"
+
+Recorder::Recorder(QObject* parent) : QObject(parent) {}
+
+Recorder::~Recorder() {
+    stop();
+}
+
+bool Recorder::start(const QString& path, const Metadata& newMetadata, quint16 newDeviceId) {
+    if (isRecording()) {
+        return false;
+    }
+    metadata = newMetadata;
+    // Rewritten with the first sample, but the header has to be valid until then
+    metadata.unit = metadata.unit == UnitValue::NONE ? UnitValue::KN : metadata.unit;
+    metadata.mode = metadata.mode == MeasureMode::NONE ? MeasureMode::ABS_ZERO : metadata.mode;
+    blockSize = requestedBlockSize != 0 ? requestedBlockSize : Logfile::BLOCK_SIZE;
+
+    file.setFileName(path);
+    if (!file.open(QIODevice::ReadWrite | QIODevice::Truncate)) {
+        return false;
+    }
+    if (!writeHeader()) {
+        file.close();
+        return false;
+    }
+
+    deviceId = newDeviceId;
+    sampleCount = 0;
+    failureReported = false;
+    failed = false;
+    pendingFull = false;
+    stopping = false;
+    current.clear();
+    current.reserve(int(blockSize));
+    pending.clear();
+    pending.reserve(int(blockSize));
+    writer = std::thread(&Recorder::writeBlocks, this);
+    return true;
+}
+
+bool Recorder::stop() {
+    if (!isRecording()) {
+        return false;
+    }
+    if (!current.isEmpty()) {
+        handOff();
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    condition.notify_all();
+    writer.join();
+
+    bool success = !failed && binlog::finalize(file, &metadata);
+    file.close();
+    return success;
+}
+
+bool Recorder::recover(const QString& path) {
+    QFile file(path);
+    return file.open(QIODevice::ReadWrite) && binlog::finalize(file);
+}
+
+void Recorder::addSamples(const QVector<Sample>& samples) {
+    if (!isRecording()) {
+        return;
+    }
+    for (const Sample& sample : samples) {
+        if (deviceId != 0 && sample.deviceId != deviceId) {
+            continue;
+        }
+        if (sampleCount == 0) {
+            metadata.unit = sample.unitValue;
+            metadata.mode = sample.measureMode;
+            metadata.relZero = float(sample.referenceZero);
+            metadata.speed = sample.frequency;
+            if (requestedBlockSize == 0) {
+                blockSize = blockSizeFor(sample.frequency);
+                current.reserve(int(blockSize));
+                pending.reserve(int(blockSize));
+            }
+            // No block was handed to the writer thread yet, so the file is not shared
+            if (!writeHeader()) {
+                failed = true;
+            }
+        }
+
+        qint64 centi = sample.measuredFixed.toCenti();
+        if (sample.unitValue != metadata.unit) {
+            double force = sample.measuredValue / factorFromKn(sample.unitValue) * factorFromKn(metadata.unit);
+            centi = binlog::toCenti(float(force));
+        }
+        current.append(qint32(qBound<qint64>(std::numeric_limits<qint32>::min(), centi,
+                                             std::numeric_limits<qint32>::max())));
+        ++sampleCount;
+        if (current.size() == int(blockSize)) {
+            handOff();
+        }
+    }
+
+    if (failed && !failureReported) {
+        failureReported = true;
+        emit recordingFailed();
+    }
+}
+
+bool Recorder::writeHeader() {
+    // The size depends only on the strings of the metadata, so the header never overlaps a block
+    binlog::Header header;
+    header.blockSize = blockSize;
+    QByteArray encoded = binlog::encodeHeader(metadata, header);
+    return file.seek(0) && file.write(encoded) == encoded.size() && file.flush();
+}
+
+quint32 Recorder::blockSizeFor(int frequency) const {
+    if (syncInterval <= 0 || frequency <= 0) {
+        return Logfile::BLOCK_SIZE;
+    }
+    qint64 forces = qint64(frequency) * syncInterval / 1000;
+    return quint32(qBound<qint64>(1, forces, Logfile::BLOCK_SIZE));
+}
+
+void Recorder::handOff() {
+    {
+        // Only waits if the disk is slower than the device
+        std::unique_lock<std::mutex> lock(mutex);
+        condition.wait(lock, [this] { return !pendingFull; });
+        std::swap(current, pending);
+        pendingFull = true;
+    }
+    condition.notify_all();
+    current.clear();
+}
+
+void Recorder::writeBlocks() {
+    QVector<qint32> writing;  // Takes over the reserved buffers of the GUI thread
+    QByteArray encoded;
+    quint32 number = 0;
+    auto lastSync = std::chrono::steady_clock::now();
+
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            condition.wait(lock, [this] { return pendingFull || stopping; });
+            if (!pendingFull) {
+                break;  // Stopping and every block is written
+            }
+            std::swap(writing, pending);
+            pendingFull = false;
+        }
+        condition.notify_all();
+
+        binlog::encodeBlock(number++, writing.constData(), writing.size(), encoded);
+        if (file.write(encoded) != encoded.size() || !file.flush()) {
+            failed = true;
+        }
+        writing.clear();
+
+        auto now = std::chrono::steady_clock::now();
+        if (syncInterval >= 0 && now - lastSync >= std::chrono::milliseconds(syncInterval)) {
+            if (!binlog::sync(file)) {
+                failed = true;
+            }
+            lastSync = now;
+        }
+    }
+}
@@ -0,0 +1,193 @@
+/******************************************************************************
+ * Copyright (C) 2023 by Gschwind, Weber, Schoch, Niederberger                *
+ *                                                                            *
+ * This file is part of linescaleGUI.                                         *
+ *                                                                            *
+ * LinescaleGUI is free software: you can redistribute it and/or modify       *
+ * it under the terms of the GNU General Public License as published by       *
+ * the Free Software Foundation, either version 3 of the License, or          *
+ * (at your option) any later version.                                        *
+ *                                                                            *
+ * LinescaleGUI is distributed in the hope that it will be useful,            *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of             *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the               *
+ * GNU General Public License for more details.                               *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License          *
+ * along with linescaleGUI. If not, see <http://www.gnu.org/licenses/>.       *
+ ******************************************************************************/
+/**
+ * @file recorder.h
+ * @authors Gschwind, Weber, Schoch, Niederberger
+ *
+ * @brief `Recorder` declaration
+ *
+ */
+
+#pragma once
+#ifndef RECORDER_H_
+#define RECORDER_H_
+
+#include <QFile>
+#include <QObject>
+#include <QVector>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include "logfile.h"
+
+/**
+ * @brief Record a live session into a binary logfile while it runs
+ *
+ * The forces are collected in the GUI thread until a block is full. The full
+ * block is handed to a writer thread, which appends it to the file while the
+ * next block is filled. Only these two blocks are kept in memory, so the
+ * memory use does not grow with the length of the session.
+ *
+ * Every block is flushed to the operating system as soon as it is written and
+ * synced to the disk at most every `setSyncInterval`. After a crash the file
+ * can be loaded up to the last complete block, see `recover`. `stop` writes
+ * the last partial block and the block index and patches the header.
+ *
+ * The unit, measure mode and frequency of the header are taken from the first
+ * recorded sample, which rewrites the header before any block is written. So
+ * a recovered logfile has the same header as a stopped one. Forces in another
+ * unit are converted to it.
+ */
+class Recorder : public QObject {
+    Q_OBJECT
+
+   public:
+    /**
+     * @brief Construct a new recorder
+     *
+     * @param parent The parent object or `nullptr`
+     */
+    explicit Recorder(QObject* parent = nullptr);
+
+    /**
+     * @brief Stop a running recording
+     *
+     */
+    ~Recorder();
+
+    /**
+     * @brief Create the logfile and start recording
+     *
+     * @param path Path of the binary logfile; an existing file is replaced
+     * @param metadata Metadata of the header
+     * @param deviceId Record only samples with this `Sample::deviceId`; 0 for all samples
+     * @return true if the file was created
+     */
+    bool start(const QString& path, const Metadata& metadata, quint16 deviceId = 0);
+
+    /**
+     * @brief Write the remaining forces and close the logfile
+     *
+     * @return true if every force was written
+     */
+    bool stop();
+
+    bool isRecording() const { return writer.joinable(); }  ///< True between `start` and `stop`
+    qint64 getSampleCount() const { return sampleCount; }    ///< Forces recorded since `start`
+
+    /**
+     * @brief Set how often the file is synced to the disk
+     *
+     * Takes effect with the next `start`.
+     *
+     * @param milliseconds Minimum time between two syncs; 0 after every block, negative to never sync
+     */
+    void setSyncInterval(int milliseconds) { syncInterval = milliseconds; }
+
+    /**
+     * @brief Set the forces per block
+     *
+     * A block reaches the file only when it is full, so a crash loses the
+     * forces of the current block. By default a block holds the forces of one
+     * sync interval at the frequency of the first sample, at most
+     * `Logfile::BLOCK_SIZE`. Takes effect with the next `start`.
+     *
+     * @param forces Forces per block; 0 to size the blocks from the frequency
+     */
+    void setBlockSize(quint32 forces) { requestedBlockSize = forces; }
+
+    /**
+     * @brief Close a logfile whose recording was interrupted, e.g. by a crash
+     *
+     * Keeps all complete blocks. Logfiles which were closed are left untouched.
+     *
+     * @param path Path of the binary logfile
+     * @return true if the logfile is closed now
+     */
+    static bool recover(const QString& path);
+
+    static constexpr int DEFAULT_SYNC_INTERVAL = 1000;  ///< Default of `setSyncInterval` in ms
+
+   public slots:
+    /**
+     * @brief Append samples to the recording
+     *
+     * Connect to `comm::CommMaster::newSamplesMaster`. Ignored if not recording.
+     * Waits only if the writer thread is more than a block behind.
+     *
+     * @param samples New samples, oldest first
+     */
+    void addSamples(const QVector<Sample>& samples);
+
+   signals:
+    /**
+     * @brief Emit once if writing to the logfile failed
+     *
+     */
+    void recordingFailed();
+
+   private:
+    /**
+     * @brief Write the header with the current metadata to the start of the file
+     *
+     * @return true if the header was written
+     */
+    bool writeHeader();
+
+    /**
+     * @brief Forces per block for a device frequency, see `setBlockSize`
+     *
+     * @param frequency Frequency of the recorded device in Hz
+     * @return quint32 Forces of one sync interval, within 1 and `Logfile::BLOCK_SIZE`
+     */
+    quint32 blockSizeFor(int frequency) const;
+
+    /**
+     * @brief Hand the current block to the writer thread
+     *
+     */
+    void handOff();
+
+    /**
+     * @brief Loop of the writer thread, appends the handed over blocks
+     *
+     */
+    void writeBlocks();
+
+    QFile file;                 ///< Written by the writer thread while recording
+    Metadata metadata;          ///< Header of the recording
+    quint16 deviceId = 0;       ///< Recorded device, 0 for all
+    qint64 sampleCount = 0;     ///< Forces recorded since `start`
+    bool failureReported = false;
+    quint32 requestedBlockSize = 0;           ///< See `setBlockSize`
+    quint32 blockSize = Logfile::BLOCK_SIZE;  ///< Forces per block of the current recording
+    int syncInterval = DEFAULT_SYNC_INTERVAL;
+
+    QVector<qint32> current;  ///< Block filled by the GUI thread, in centi-units
+    QVector<qint32> pending;  ///< Block handed to the writer thread
+    bool pendingFull = false;  ///< Guarded by `mutex`
+    bool stopping = false;     ///< Guarded by `mutex`
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::thread writer;
+    std::atomic<bool> failed{false};  ///< Set by the writer thread
+};
+
+#endif  // RECORDER_H_
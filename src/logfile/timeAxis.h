@@ -0,0 +1,167 @@
+/******************************************************************************
+ * Copyright (C) 2023 by Gschwind, Weber, Schoch, Niederberger                *
+ *                                                                            *
+ * This file is part of linescaleGUI.                                         *
+ *                                                                            *
+ * LinescaleGUI is free software: you can redistribute it and/or modify       *
+ * it under the terms of the GNU General Public License as published by       *
+ * the Free Software Foundation, either version 3 of the License, or          *
+ * (at your option) any later version.                                        *
+ *                                                                            *
+ * LinescaleGUI is distributed in the hope that it will be useful,            *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of             *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the               *
+ * GNU General Public License for more details.                               *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License          *
+ * along with linescaleGUI. If not, see <http://www.gnu.org/licenses/>.       *
+ ******************************************************************************/
+/**
+ * @file timeAxis.h
+ * @authors Gschwind, Weber, Schoch, Niederberger
+ *
+ * @brief `TimeAxis` declaration and implementation
+ *
+ */
+
+#pragma once
+#ifndef TIMEAXIS_H_
+#define TIMEAXIS_H_
+
+#include <QVector>
+#include <QtGlobal>
+#include <cmath>
+#include <iterator>
+
+/**
+ * @brief Equidistant time values computed on demand
+ *
+ * The time of the sample `index` is `start + period * index`. Only these three
+ * numbers are stored, so the time axis of a logfile takes no memory per sample.
+ * The interface follows a read-only `QVector<double>`.
+ */
+class TimeAxis {
+   public:
+    /**
+     * @brief Random access iterator over the time values
+     */
+    class const_iterator {
+       public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = double;
+        using difference_type = qint64;
+        using pointer = void;
+        using reference = double;
+
+        const_iterator() = default;
+        const_iterator(const TimeAxis* axis, qint64 index) : axis(axis), index(index) {}
+
+        double operator*() const { return (*axis)[index]; }
+        double operator[](qint64 offset) const { return (*axis)[index + offset]; }
+
+        const_iterator& operator++() {
+            ++index;
+            return *this;
+        }
+        const_iterator operator++(int) { return {axis, index++}; }
+        const_iterator& operator--() {
+            --index;
+            return *this;
+        }
+        const_iterator operator--(int) { return {axis, index--}; }
+        const_iterator& operator+=(qint64 offset) {
+            index += offset;
+            return *this;
+        }
+        const_iterator& operator-=(qint64 offset) {
+            index -= offset;
+            return *this;
+        }
+        const_iterator operator+(qint64 offset) const { return {axis, index + offset}; }
+        const_iterator operator-(qint64 offset) const { return {axis, index - offset}; }
+        qint64 operator-(const const_iterator& other) const { return index - other.index; }
+
+        bool operator==(const const_iterator& other) const { return index == other.index; }
+        bool operator!=(const const_iterator& other) const { return index != other.index; }
+        bool operator<(const const_iterator& other) const { return index < other.index; }
+        bool operator<=(const const_iterator& other) const { return index <= other.index; }
+        bool operator>(const const_iterator& other) const { return index > other.index; }
+        bool operator>=(const const_iterator& other) const { return index >= other.index; }
+
+       private:
+        const TimeAxis* axis = nullptr;
+        qint64 index = 0;
+    };
+
+    TimeAxis() = default;
+
+    /**
+     * @brief Construct a new time axis
+     *
+     * @param start Time of the first sample in seconds
+     * @param period Time between two samples in seconds
+     * @param count Number of samples
+     */
+    TimeAxis(double start, double period, qint64 count) : start(start), period(period), count(count) {}
+
+    double operator[](qint64 index) const { return start + period * double(index); }  ///< Time of sample `index`
+    qint64 size() const { return count; }                                            ///< Number of samples
+    bool isEmpty() const { return count == 0; }                                      ///< True without samples
+    double getStart() const { return start; }                                        ///< Time of the first sample
+    double getPeriod() const { return period; }                                      ///< Time between samples
+
+    const_iterator begin() const { return {this, 0}; }
+    const_iterator end() const { return {this, count}; }
+
+    /**
+     * @brief Sub-range of the time axis, like `QVector::mid`
+     *
+     * @param first Index of the first sample
+     * @param length Number of samples, -1 for all up to the end
+     * @return TimeAxis Time axis of the samples `[first, first + length)`, clamped to this axis
+     */
+    TimeAxis mid(qint64 first, qint64 length = -1) const {
+        first = qBound<qint64>(0, first, count);
+        length = (length < 0 || first + length > count) ? count - first : length;
+        return TimeAxis((*this)[first], period, length);
+    }
+
+    /**
+     * @brief Index of the sample closest to `time`
+     *
+     * @param time Time in seconds
+     * @return qint64 Index in `[0, size())`, or 0 for an empty axis
+     */
+    qint64 indexOf(double time) const {
+        if (count == 0 || !(period > 0)) {
+            return 0;
+        }
+        double index = std::round((time - start) / period);
+        return index <= 0 ? 0 : index >= double(count - 1) ? count - 1 : qint64(index);
+    }
+
+    /**
+     * @brief Materialise the time values, e.g. for a plot
+     *
+     * @return QVector<double> All time values
+     */
+    QVector<double> toVector() const {
+        QVector<double> values(static_cast<int>(count));
+        for (int i = 0; i < values.size(); ++i) {
+            values[i] = (*this)[i];
+        }
+        return values;
+    }
+
+    bool operator==(const TimeAxis& other) const {
+        return start == other.start && period == other.period && count == other.count;
+    }
+    bool operator!=(const TimeAxis& other) const { return !(*this == other); }
+
+   private:
+    double start = 0.0;   ///< Time of the first sample in seconds
+    double period = 0.0;  ///< Time between two samples in seconds
+    qint64 count = 0;     ///< Number of samples
+};
+
+#endif  // TIMEAXIS_H_
@@ -0,0 +1,334 @@
+/******************************************************************************
+ * Copyright (C) 2023 by Gschwind, Weber, Schoch, Niederberger                *
+ *                                                                            *
+ * This file is part of linescaleGUI.                                         *
+ *                                                                            *
+ * LinescaleGUI is free software: you can redistribute it and/or modify       *
+ * it under the terms of the GNU General Public License as published by       *
+ * the Free Software Foundation, either version 3 of the License, or          *
+ * (at your option) any later version.                                        *
+ *                                                                            *
+ * LinescaleGUI is distributed in the hope that it will be useful,            *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of             *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the               *
+ * GNU General Public License for more details.                               *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License          *
+ * along with linescaleGUI. If not, see <http://www.gnu.org/licenses/>.       *
+ ******************************************************************************/
+/**
+ * @file frameValidator.cpp
+ * @authors Gschwind, Weber, Schoch, Niederberger
+ *
+ * @brief `FrameValidator` implementation
+ *
+ */
+
+#include "frameValidator.h"
+#include "parser.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(_M_AMD64) || (defined(__i386__) && defined(__SSE2__)) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FRAMEVALIDATOR_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define FRAMEVALIDATOR_TARGET_AVX2
+#else
+#define FRAMEVALIDATOR_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace {
+
+// Layout of a packet, see `Parser` and design/serialProtocol.pdf
+constexpr size_t FRAME_LEN = Parser::PACKET_EXPECTED_LEN;
+constexpr size_t CHECKED_LEN = 17;
+constexpr size_t WORKING_MODE_INDEX = 0;
+constexpr size_t MEASURE_MODE_INDEX = 7;
+constexpr size_t UNIT_VALUE_INDEX = 15;
+constexpr size_t FREQUENCY_INDEX = 16;
+constexpr size_t CHECKSUM_UPPER_INDEX = 17;
+constexpr size_t CHECKSUM_LOWER_INDEX = 18;
+constexpr size_t TERMINATOR_INDEX = 19;
+
+/**
+ * @brief Compare the checksum digits with the sum of the first bytes
+ *
+ * @param frame Pointer to the packet
+ * @param sum Sum of the first `CHECKED_LEN` bytes
+ * @return true if the digits are valid and match
+ */
+inline bool checksumMatches(const unsigned char* frame, unsigned sum) {
+    unsigned upper = unsigned(frame[CHECKSUM_UPPER_INDEX]) - '0';
+    unsigned lower = unsigned(frame[CHECKSUM_LOWER_INDEX]) - '0';
+    return upper < 10 && lower < 10 && sum % 100 == upper * 10 + lower;
+}
+
+bool isValidScalar(const unsigned char* frame) {
+    unsigned char mode = frame[WORKING_MODE_INDEX];
+    unsigned char measureMode = frame[MEASURE_MODE_INDEX];
+    unsigned char unit = frame[UNIT_VALUE_INDEX];
+    unsigned char freq = frame[FREQUENCY_INDEX];
+    if (frame[TERMINATOR_INDEX] != '\r' || (mode != 'R' && mode != 'O' && mode != 'C') ||
+        (measureMode != 'N' && measureMode != 'Z') || (unit != 'N' && unit != 'G' && unit != 'B') ||
+        (freq != 'S' && freq != 'F' && freq != 'M' && freq != 'Q')) {
+        return false;
+    }
+
+    unsigned sum = 0;
+    for (size_t i = 0; i < CHECKED_LEN; ++i) {
+        sum += frame[i];
+    }
+    return checksumMatches(frame, sum);
+}
+
+uint64_t validateScalar(const char* frames, size_t count) {
+    const unsigned char* frame = reinterpret_cast<const unsigned char*>(frames);
+    uint64_t mask = 0;
+    for (size_t i = 0; i < count; ++i, frame += FRAME_LEN) {
+        mask |= uint64_t(isValidScalar(frame)) << i;
+    }
+    return mask;
+}
+
+#ifdef FRAMEVALIDATOR_X86
+
+// Both vectors are loaded per packet: `head` holds bytes 0..15, `tail` bytes 4..19.
+// Every allowed tag value is placed at its index in one of the pattern vectors,
+// the packet is valid if each tag matches at least one pattern.
+constexpr int HEAD_TAG_BITS = (1 << WORKING_MODE_INDEX) | (1 << MEASURE_MODE_INDEX) | (1 << UNIT_VALUE_INDEX);
+constexpr int TAIL_OFFSET = 4;
+constexpr int TAIL_TAG_BITS = (1 << (FREQUENCY_INDEX - TAIL_OFFSET)) | (1 << (TERMINATOR_INDEX - TAIL_OFFSET));
+constexpr int TAIL_DIGIT_BITS =
+    (1 << (CHECKSUM_UPPER_INDEX - TAIL_OFFSET)) | (1 << (CHECKSUM_LOWER_INDEX - TAIL_OFFSET));
+
+/**
+ * @brief Create a pattern vector with up to three tag bytes at the given indices
+ */
+inline __m128i headPattern(char mode, char measureMode, char unit) {
+    alignas(16) char bytes[16] = {};
+    bytes[WORKING_MODE_INDEX] = mode;
+    bytes[MEASURE_MODE_INDEX] = measureMode;
+    bytes[UNIT_VALUE_INDEX] = unit;
+    return _mm_load_si128(reinterpret_cast<const __m128i*>(bytes));
+}
+
+inline __m128i tailPattern(char freq) {
+    alignas(16) char bytes[16] = {};
+    bytes[FREQUENCY_INDEX - TAIL_OFFSET] = freq;
+    bytes[TERMINATOR_INDEX - TAIL_OFFSET] = '\r';
+    return _mm_load_si128(reinterpret_cast<const __m128i*>(bytes));
+}
+
+/**
+ * @brief Pattern vectors shared by the SSE2 and AVX2 implementation
+ */
+struct Patterns {
+    __m128i head[3];
+    __m128i tail[4];
+};
+
+const Patterns& patterns() {
+    static const Patterns instance = {
+        {headPattern('R', 'N', 'N'), headPattern('O', 'Z', 'G'), headPattern('C', 'Z', 'B')},
+        {tailPattern('S'), tailPattern('F'), tailPattern('M'), tailPattern('Q')},
+    };
+    return instance;
+}
+
+uint64_t validateSSE2(const char* frames, size_t count) {
+    const Patterns& p = patterns();
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i asciiZero = _mm_set1_epi8('0');
+    const __m128i nine = _mm_set1_epi8(9);
+
+    const unsigned char* frame = reinterpret_cast<const unsigned char*>(frames);
+    uint64_t mask = 0;
+    for (size_t i = 0; i < count; ++i, frame += FRAME_LEN) {
+        __m128i head = _mm_loadu_si128(reinterpret_cast<const __m128i*>(frame));
+        __m128i tail = _mm_loadu_si128(reinterpret_cast<const __m128i*>(frame + TAIL_OFFSET));
+
+        __m128i headMatch =
+            _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(head, p.head[0]), _mm_cmpeq_epi8(head, p.head[1])),
+                         _mm_cmpeq_epi8(head, p.head[2]));
+        __m128i tailMatch =
+            _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(tail, p.tail[0]), _mm_cmpeq_epi8(tail, p.tail[1])),
+                         _mm_or_si128(_mm_cmpeq_epi8(tail, p.tail[2]), _mm_cmpeq_epi8(tail, p.tail[3])));
+        __m128i digitOffset = _mm_sub_epi8(tail, asciiZero);
+        __m128i isDigit = _mm_cmpeq_epi8(_mm_min_epu8(digitOffset, nine), digitOffset);
+
+        int headBits = _mm_movemask_epi8(headMatch);
+        int tailBits = _mm_movemask_epi8(tailMatch) | (_mm_movemask_epi8(isDigit) & TAIL_DIGIT_BITS);
+        if ((headBits & HEAD_TAG_BITS) != HEAD_TAG_BITS || (tailBits & (TAIL_TAG_BITS | TAIL_DIGIT_BITS)) !=
+                                                               (TAIL_TAG_BITS | TAIL_DIGIT_BITS)) {
+            continue;
+        }
+
+        // Sum of bytes 0..15 as two 64 bit partial sums, byte 16 is added separately
+        __m128i sums = _mm_sad_epu8(head, zero);
+        unsigned sum =
+            unsigned(_mm_cvtsi128_si32(sums)) + unsigned(_mm_extract_epi16(sums, 4)) + frame[FREQUENCY_INDEX];
+        mask |= uint64_t(checksumMatches(frame, sum)) << i;
+    }
+    return mask;
+}
+
+FRAMEVALIDATOR_TARGET_AVX2 inline __m256i loadPair(const unsigned char* frame, size_t offset) {
+    __m128i first = _mm_loadu_si128(reinterpret_cast<const __m128i*>(frame + offset));
+    __m128i second = _mm_loadu_si128(reinterpret_cast<const __m128i*>(frame + FRAME_LEN + offset));
+    return _mm256_inserti128_si256(_mm256_castsi128_si256(first), second, 1);
+}
+
+FRAMEVALIDATOR_TARGET_AVX2 uint64_t validateAVX2(const char* frames, size_t count) {
+    const Patterns& p = patterns();
+    const __m256i head0 = _mm256_broadcastsi128_si256(p.head[0]);
+    const __m256i head1 = _mm256_broadcastsi128_si256(p.head[1]);
+    const __m256i head2 = _mm256_broadcastsi128_si256(p.head[2]);
+    const __m256i tail0 = _mm256_broadcastsi128_si256(p.tail[0]);
+    const __m256i tail1 = _mm256_broadcastsi128_si256(p.tail[1]);
+    const __m256i tail2 = _mm256_broadcastsi128_si256(p.tail[2]);
+    const __m256i tail3 = _mm256_broadcastsi128_si256(p.tail[3]);
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i asciiZero = _mm256_set1_epi8('0');
+    const __m256i nine = _mm256_set1_epi8(9);
+    constexpr uint32_t headRequired = uint32_t(HEAD_TAG_BITS) | (uint32_t(HEAD_TAG_BITS) << 16);
+    constexpr uint32_t tailRequired =
+        uint32_t(TAIL_TAG_BITS | TAIL_DIGIT_BITS) | (uint32_t(TAIL_TAG_BITS | TAIL_DIGIT_BITS) << 16);
+    constexpr uint32_t digitBits = uint32_t(TAIL_DIGIT_BITS) | (uint32_t(TAIL_DIGIT_BITS) << 16);
+
+    const unsigned char* frame = reinterpret_cast<const unsigned char*>(frames);
+    uint64_t mask = 0;
+    size_t i = 0;
+    for (; i + 1 < count; i += 2, frame += 2 * FRAME_LEN) {
+        __m256i head = loadPair(frame, 0);
+        __m256i tail = loadPair(frame, TAIL_OFFSET);
+
+        __m256i headMatch = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(head, head0), _mm256_cmpeq_epi8(head, head1)),
+            _mm256_cmpeq_epi8(head, head2));
+        __m256i tailMatch =
+            _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(tail, tail0), _mm256_cmpeq_epi8(tail, tail1)),
+                            _mm256_or_si256(_mm256_cmpeq_epi8(tail, tail2), _mm256_cmpeq_epi8(tail, tail3)));
+        __m256i digitOffset = _mm256_sub_epi8(tail, asciiZero);
+        __m256i isDigit = _mm256_cmpeq_epi8(_mm256_min_epu8(digitOffset, nine), digitOffset);
+
+        uint32_t headBits = uint32_t(_mm256_movemask_epi8(headMatch)) & headRequired;
+        uint32_t tailBits =
+            (uint32_t(_mm256_movemask_epi8(tailMatch)) | (uint32_t(_mm256_movemask_epi8(isDigit)) & digitBits)) &
+            tailRequired;
+
+        // Lane 0 holds the sums of the first packet, lane 1 of the second one
+        alignas(32) uint64_t sums[4];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(sums), _mm256_sad_epu8(head, zero));
+
+        bool firstValid = (headBits & 0xFFFF) == (headRequired & 0xFFFF) &&
+                          (tailBits & 0xFFFF) == (tailRequired & 0xFFFF) &&
+                          checksumMatches(frame, unsigned(sums[0] + sums[1]) + frame[FREQUENCY_INDEX]);
+        const unsigned char* second = frame + FRAME_LEN;
+        bool secondValid = (headBits >> 16) == (headRequired >> 16) && (tailBits >> 16) == (tailRequired >> 16) &&
+                           checksumMatches(second, unsigned(sums[2] + sums[3]) + second[FREQUENCY_INDEX]);
+        mask |= (uint64_t(firstValid) << i) | (uint64_t(secondValid) << (i + 1));
+    }
+    if (i < count) {
+        mask |= validateSSE2(reinterpret_cast<const char*>(frame), 1) << i;
+    }
+    return mask;
+}
+
+/**
+ * @brief Check whether the CPU and the operating system support AVX2
+ */
+bool cpuSupportsAVX2() {
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+        return false;
+    }
+    __cpuid(info, 1);
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6) {
+        return false;
+    }
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif  // FRAMEVALIDATOR_X86
+
+using ValidateFunction = uint64_t (*)(const char*, size_t);
+
+ValidateFunction functionFor(FrameValidator::Implementation implementation) {
+    switch (implementation) {
+#ifdef FRAMEVALIDATOR_X86
+        case FrameValidator::Implementation::AVX2:
+            return validateAVX2;
+        case FrameValidator::Implementation::SSE2:
+            return validateSSE2;
+#endif
+        default:
+            return validateScalar;
+    }
+}
+
+ValidateFunction activeFunction() {
+    static const ValidateFunction function = functionFor(FrameValidator::activeImplementation());
+    return function;
+}
+
+}  // namespace
+
+uint64_t FrameValidator::validate(const char* frames, size_t count) {
+    return activeFunction()(frames, count < MASK_BITS ? count : MASK_BITS);
+}
+
+size_t FrameValidator::validate(const char* frames, size_t count, uint64_t* masks) {
+    ValidateFunction function = activeFunction();
+    size_t valid = 0;
+    for (size_t first = 0; first < count; first += MASK_BITS) {
+        size_t chunk = count - first < MASK_BITS ? count - first : MASK_BITS;
+        uint64_t mask = function(frames + first * FRAME_LEN, chunk);
+        masks[first / MASK_BITS] = mask;
+        for (; mask != 0; mask &= mask - 1) {
+            ++valid;
+        }
+    }
+    return valid;
+}
+
+uint64_t FrameValidator::validateWith(Implementation implementation, const char* frames, size_t count) {
+    if (!isSupported(implementation)) {
+        implementation = Implementation::SCALAR;
+    }
+    return functionFor(implementation)(frames, count < MASK_BITS ? count : MASK_BITS);
+}
+
+FrameValidator::Implementation FrameValidator::activeImplementation() {
+    static const Implementation implementation = isSupported(Implementation::AVX2)   ? Implementation::AVX2
+                                                 : isSupported(Implementation::SSE2) ? Implementation::SSE2
+                                                                                     : Implementation::SCALAR;
+    return implementation;
+}
+
+bool FrameValidator::isSupported(Implementation implementation) {
+    switch (implementation) {
+#ifdef FRAMEVALIDATOR_X86
+        case Implementation::AVX2: {
+            static const bool avx2 = cpuSupportsAVX2();
+            return avx2;
+        }
+        case Implementation::SSE2:
+            return true;
+#endif
+        case Implementation::SCALAR:
+            return true;
+        default:
+            return false;
+    }
+}
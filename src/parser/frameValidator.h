@@ -0,0 +1,109 @@
+/******************************************************************************
+ * Copyright (C) 2023 by Gschwind, Weber, Schoch, Niederberger                *
+ *                                                                            *
+ * This file is part of linescaleGUI.                                         *
+ *                                                                            *
+ * LinescaleGUI is free software: you can redistribute it and/or modify       *
+ * it under the terms of the GNU General Public License as published by       *
+ * the Free Software Foundation, either version 3 of the License, or          *
+ * (at your option) any later version.                                        *
+ *                                                                            *
+ * LinescaleGUI is distributed in the hope that it will be useful,            *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of             *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the               *
+ * GNU General Public License for more details.                               *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License          *
+ * along with linescaleGUI. If not, see <http://www.gnu.org/licenses/>.       *
+ ******************************************************************************/
+/**
+ * @file frameValidator.h
+ * @authors Gschwind, Weber, Schoch, Niederberger
+ *
+ * @brief `FrameValidator` declaration
+ *
+ */
+
+#pragma once
+#ifndef FRAMEVALIDATOR_H_
+#define FRAMEVALIDATOR_H_
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Validate bursts of packets before they are parsed
+ *
+ * Checks the structure of back-to-back 20-byte packets: the checksum, the
+ * `\r` terminator and the tag bytes for working mode, measure mode, unit and
+ * frequency. The numeric fields are not checked, they are validated while
+ * decoding in `Parser`.
+ *
+ * The implementation is selected once at runtime: AVX2 (two packets per
+ * instruction), SSE2 or a portable scalar fallback. All implementations give
+ * the same result.
+ */
+class FrameValidator {
+   public:
+    /**
+     * @brief Available implementations
+     *
+     */
+    enum class Implementation {
+        SCALAR,  ///< Portable fallback
+        SSE2,    ///< 128 bit vectors, one packet per iteration
+        AVX2,    ///< 256 bit vectors, two packets per iteration
+    };
+
+    /**
+     * @brief Validate up to `MASK_BITS` packets
+     *
+     * @param frames Pointer to the first byte of the first packet
+     * @param count Number of packets, at most `MASK_BITS`
+     * @return uint64_t Bit `i` is set if packet `i` is valid
+     */
+    static uint64_t validate(const char* frames, size_t count);
+
+    /**
+     * @brief Validate an arbitrary number of packets
+     *
+     * @param frames Pointer to the first byte of the first packet
+     * @param count Number of packets
+     * @param masks Caller provided array with `(count + MASK_BITS - 1) / MASK_BITS` entries;
+     *              bit `i % MASK_BITS` of `masks[i / MASK_BITS]` is set if packet `i` is valid
+     * @return size_t Number of valid packets
+     */
+    static size_t validate(const char* frames, size_t count, uint64_t* masks);
+
+    /**
+     * @brief Validate up to `MASK_BITS` packets with a specific implementation
+     *
+     * Used to compare the implementations in tests and benchmarks. Falls back to
+     * the scalar implementation if `implementation` is not supported by the CPU.
+     *
+     * @param implementation Implementation to use
+     * @param frames Pointer to the first byte of the first packet
+     * @param count Number of packets, at most `MASK_BITS`
+     * @return uint64_t Bit `i` is set if packet `i` is valid
+     */
+    static uint64_t validateWith(Implementation implementation, const char* frames, size_t count);
+
+    /**
+     * @brief Get the implementation selected for this CPU
+     *
+     * @return Implementation Fastest supported implementation
+     */
+    static Implementation activeImplementation();
+
+    /**
+     * @brief Check whether the CPU supports an implementation
+     *
+     * @param implementation Implementation to check
+     * @return true if `implementation` can be used
+     */
+    static bool isSupported(Implementation implementation);
+
+    static constexpr size_t MASK_BITS = 64;  ///< Packets covered by a single mask
+};
+
+#endif  // FRAMEVALIDATOR_H_
@@ -25,7 +25,77 @@
  */
 
 #include "parser.h"
+#include <algorithm>
+#include <array>
 #include <iostream>
+#include "frameValidator.h"
+
+namespace {
+
+constexpr uint8_t CHAR_INVALID = 0xFF;  ///< Character not allowed in a decimal field
+constexpr uint8_t CHAR_POINT = 0xFE;    ///< Decimal point
+constexpr uint8_t CHAR_MINUS = 0xFD;    ///< Negative sign
+constexpr uint8_t CHAR_PLUS = 0xFC;     ///< Positive sign
+
+/**
+ * @brief Lookup table to classify the characters of a decimal field
+ *
+ * Digits map to their value, all other characters to one of the `CHAR_*` markers.
+ */
+constexpr std::array<uint8_t, 256> makeCharTable() {
+    std::array<uint8_t, 256> table{};
+    for (size_t i = 0; i < table.size(); ++i) {
+        table[i] = CHAR_INVALID;
+    }
+    for (uint8_t digit = 0; digit < 10; ++digit) {
+        table['0' + digit] = digit;
+    }
+    table['.'] = CHAR_POINT;
+    table['-'] = CHAR_MINUS;
+    table['+'] = CHAR_PLUS;
+    return table;
+}
+constexpr std::array<uint8_t, 256> CHAR_TABLE = makeCharTable();
+
+/// Powers of ten for the number of decimals of a `FixedPoint`
+constexpr int64_t POW10[] = {1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000};
+
+constexpr double factorKnToLbf = 224.8089431;  ///< Convert from kN to lbf
+constexpr double factorKnToKgf = 101.9716213;  ///< Convert from kN to kgf
+
+}  // namespace
+
+double FixedPoint::toDouble() const {
+    // Both operands are exact, so the division is correctly rounded
+    return double(mantissa) / double(POW10[decimals]);
+}
+
+int64_t FixedPoint::toCenti() const {
+    if (decimals <= 2) {
+        return int64_t(mantissa) * POW10[2 - decimals];
+    }
+    int64_t divisor = POW10[decimals - 2];
+    int64_t half = mantissa < 0 ? -divisor / 2 : divisor / 2;
+    return (int64_t(mantissa) + half) / divisor;
+}
+
+int FixedPoint::compare(const FixedPoint& other) const {
+    int8_t commonDecimals = decimals > other.decimals ? decimals : other.decimals;
+    int64_t lhs = int64_t(mantissa) * POW10[commonDecimals - decimals];
+    int64_t rhs = int64_t(other.mantissa) * POW10[commonDecimals - other.decimals];
+    return (lhs > rhs) - (lhs < rhs);
+}
+
+double factorFromKn(UnitValue unit) {
+    switch (unit) {
+        case UnitValue::KGF:
+            return factorKnToKgf;
+        case UnitValue::LBF:
+            return factorKnToLbf;
+        default:
+            return 1.0;
+    }
+}
 
 QTextStream& operator<<(QTextStream& out, const UnitValue unit) {
     switch (unit) {
@@ -83,25 +153,78 @@ QTextStream& operator<<(QTextStream& out, const MeasureMode mode) {
 }
 
 bool Parser::parsePackage(QByteArray& package, Sample& data) {
-    return checkPackage(package) && parseWorkingMode(package, data) && parseMeasuredValue(package, data) &&
-           parseMeasureMode(package, data) && parseReferenceZero(package, data) && parseBatteryPercent(package, data) &&
-           parseUnitValue(package, data) && parseFrequency(package, data);
+    if (package.length() != PACKET_EXPECTED_LEN) {
+        return false;
+    }
+    return parseFrame(package.constData(), data) == ParseStatus::OK;
 }
 
-bool Parser::checkPackage(QByteArray& package) {
-    QByteArray value;
+ParseStatus Parser::parseFrame(const char* frame, Sample& data) {
+    if (frame[PACKET_TERMINATOR_INDEX] != '\r') {
+        return ParseStatus::INVALID_TERMINATOR;
+    }
+    if (!checkPackage(frame)) {
+        return ParseStatus::INVALID_CHECKSUM;
+    }
+    return parseFields(frame, data);
+}
 
-    if (package.length() != PACKET_EXPECTED_LEN) {
-        return false;
+ParseStatus Parser::parseFields(const char* frame, Sample& data) {
+    if (!parseWorkingMode(frame, data)) {
+        return ParseStatus::INVALID_WORKING_MODE;
+    }
+    if (!parseMeasuredValue(frame, data)) {
+        return ParseStatus::INVALID_MEASURED_VALUE;
+    }
+    if (!parseMeasureMode(frame, data)) {
+        return ParseStatus::INVALID_MEASURE_MODE;
+    }
+    if (!parseReferenceZero(frame, data)) {
+        return ParseStatus::INVALID_REFERENCE_ZERO;
+    }
+    parseBatteryPercent(frame, data);
+    if (!parseUnitValue(frame, data)) {
+        return ParseStatus::INVALID_UNIT_VALUE;
+    }
+    if (!parseFrequency(frame, data)) {
+        return ParseStatus::INVALID_FREQUENCY;
+    }
+    return ParseStatus::OK;
+}
+
+size_t Parser::parseBatch(const char* frames, size_t length, Sample* samples, ParseStatus* status) {
+    size_t frameCount = length / PACKET_EXPECTED_LEN;
+    size_t parsed = 0;
+    for (size_t first = 0; first < frameCount; first += FrameValidator::MASK_BITS) {
+        size_t chunk = std::min(frameCount - first, FrameValidator::MASK_BITS);
+        uint64_t validMask = FrameValidator::validate(frames + first * PACKET_EXPECTED_LEN, chunk);
+
+        for (size_t i = 0; i < chunk; ++i) {
+            const char* frame = frames + (first + i) * PACKET_EXPECTED_LEN;
+            // Structure and checksum of valid packets are already checked, invalid
+            // packets go through all checks again to find the exact reason. `parseFrame`
+            // covers every check of the validator, so they are never accepted.
+            ParseStatus result = (validMask >> i) & 1 ? parseFields(frame, samples[parsed])
+                                                      : parseFrame(frame, samples[parsed]);
+            if (result == ParseStatus::OK) {
+                ++parsed;  // failed packets are overwritten by the next one
+            }
+            if (status != nullptr) {
+                status[first + i] = result;
+            }
+        }
     }
+    return parsed;
+}
 
+bool Parser::checkPackage(const char* frame) {
     int checkVal = 0;
-    for (int i = 0; i < PACKET_CHECKED_LEN; i++) {
-        checkVal += int(package.at(i));
+    for (size_t i = 0; i < PACKET_CHECKED_LEN; i++) {
+        checkVal += int(static_cast<unsigned char>(frame[i]));  // same as `FrameValidator`
     }
 
-    auto upperDigit = package.at(PACKET_CHECKSUM_UPPER_DIGIT_INDEX);
-    auto lowerDigit = package.at(PACKET_CHECKSUM_LOWER_DIGIT_INDEX);
+    auto upperDigit = frame[PACKET_CHECKSUM_UPPER_DIGIT_INDEX];
+    auto lowerDigit = frame[PACKET_CHECKSUM_LOWER_DIGIT_INDEX];
     if (!std::isdigit(upperDigit) || !std::isdigit(lowerDigit)) {
         return false;
     }
@@ -114,8 +237,8 @@ bool Parser::checkPackage(QByteArray& package) {
     }
 }
 
-bool Parser::parseWorkingMode(QByteArray& package, Sample& data) {
-    switch (package.at(PACKET_WORKING_MODE_INDEX)) {
+bool Parser::parseWorkingMode(const char* frame, Sample& data) {
+    switch (frame[PACKET_WORKING_MODE_INDEX]) {
         case 'R':
             data.workingMode = WorkingMode::REALTIME;
             break;
@@ -132,14 +255,16 @@ bool Parser::parseWorkingMode(QByteArray& package, Sample& data) {
     return true;
 }
 
-bool Parser::parseMeasuredValue(QByteArray& package, Sample& data) {
-    bool isOk;
-    data.measuredValue = package.mid(PACKET_MEASURE_VALUE_START_INDEX, PACKET_MEASURE_VALUE_LEN).toDouble(&isOk);
-    return isOk;
+bool Parser::parseMeasuredValue(const char* frame, Sample& data) {
+    if (!decodeFixedPoint(frame + PACKET_MEASURE_VALUE_START_INDEX, PACKET_MEASURE_VALUE_LEN, data.measuredFixed)) {
+        return false;
+    }
+    data.measuredValue = data.measuredFixed.toDouble();
+    return true;
 }
 
-bool Parser::parseMeasureMode(QByteArray& package, Sample& data) {
-    switch (package.at(PACKET_MEASURE_MODE_INDEX)) {
+bool Parser::parseMeasureMode(const char* frame, Sample& data) {
+    switch (frame[PACKET_MEASURE_MODE_INDEX]) {
         case 'N':
             data.measureMode = MeasureMode::ABS_ZERO;
             break;
@@ -153,19 +278,21 @@ bool Parser::parseMeasureMode(QByteArray& package, Sample& data) {
     return true;
 }
 
-bool Parser::parseReferenceZero(QByteArray& package, Sample& data) {
-    bool isOk;
-    data.referenceZero = package.mid(PACKET_REFERENCE_ZERO_START_INDEX, PACKET_REFERENCE_ZERO_LEN).toDouble(&isOk);
-    return isOk;
+bool Parser::parseReferenceZero(const char* frame, Sample& data) {
+    if (!decodeFixedPoint(frame + PACKET_REFERENCE_ZERO_START_INDEX, PACKET_REFERENCE_ZERO_LEN, data.referenceFixed)) {
+        return false;
+    }
+    data.referenceZero = data.referenceFixed.toDouble();
+    return true;
 }
 
-bool Parser::parseBatteryPercent(QByteArray& package, Sample& data) {
-    data.batteryPercent = int(package.at(PACKET_BATTERY_PERCENT_INDEX) - 0x20) * 2;
+bool Parser::parseBatteryPercent(const char* frame, Sample& data) {
+    data.batteryPercent = int(frame[PACKET_BATTERY_PERCENT_INDEX] - 0x20) * 2;
     return true;
 }
 
-bool Parser::parseUnitValue(QByteArray& package, Sample& data) {
-    switch (package.at(PACKET_UNIT_VALUE_INDEX)) {
+bool Parser::parseUnitValue(const char* frame, Sample& data) {
+    switch (frame[PACKET_UNIT_VALUE_INDEX]) {
         case 'N':
             data.unitValue = UnitValue::KN;
             break;
@@ -182,8 +309,8 @@ bool Parser::parseUnitValue(QByteArray& package, Sample& data) {
     return true;
 }
 
-bool Parser::parseFrequency(QByteArray& package, Sample& data) {
-    switch (package.at(PACKET_FREQUENCY_INDEX)) {
+bool Parser::parseFrequency(const char* frame, Sample& data) {
+    switch (frame[PACKET_FREQUENCY_INDEX]) {
         case 'S':
             data.frequency = 10;
             break;
@@ -202,3 +329,40 @@ bool Parser::parseFrequency(QByteArray& package, Sample& data) {
     }
     return true;
 }
+
+bool Parser::decodeFixedPoint(const char* field, size_t len, FixedPoint& value) {
+    static_assert(sizeof(POW10) / sizeof(POW10[0]) == 10, "POW10 must cover all decimals of a 9 digit field");
+    if (len == 0 || len > 9) {
+        return false;
+    }
+
+    size_t i = 0;
+    int32_t sign = 1;
+    uint8_t first = CHAR_TABLE[static_cast<uint8_t>(field[0])];
+    if (first == CHAR_MINUS || first == CHAR_PLUS) {
+        sign = first == CHAR_MINUS ? -1 : 1;
+        ++i;
+    }
+
+    int32_t mantissa = 0;
+    size_t digits = 0;
+    size_t pointIndex = len;  // `len` marks a missing decimal point
+    for (; i < len; ++i) {
+        uint8_t c = CHAR_TABLE[static_cast<uint8_t>(field[i])];
+        if (c < 10) {
+            mantissa = mantissa * 10 + c;
+            ++digits;
+        } else if (c == CHAR_POINT && pointIndex == len) {
+            pointIndex = i;
+        } else {
+            return false;
+        }
+    }
+    if (digits == 0) {
+        return false;
+    }
+
+    value.mantissa = sign * mantissa;
+    value.decimals = static_cast<int8_t>(pointIndex == len ? 0 : len - 1 - pointIndex);
+    return true;
+}
@@ -30,6 +30,7 @@
 #include <QByteArray>
 #include <QObject>
 #include <QTextStream>
+#include <cstdint>
 
 /**
  * @brief Indicates the working mode sent by the Line Scale
@@ -63,6 +64,14 @@ enum class UnitValue {
     LBF,   ///< Indicates that the unit of measurement is lbf
 };
 
+/**
+ * @brief Factor to convert a force from kN to a unit
+ *
+ * @param unit Target unit
+ * @return double Conversion factor, 1 for kN and `UnitValue::NONE`
+ */
+double factorFromKn(UnitValue unit);
+
 /**
  * @brief Overload the << operator for the UnitValue
  *
@@ -97,6 +106,50 @@ MeasureMode parseMeasureMode(const QString& input);
  */
 QTextStream& operator<<(QTextStream& out, const MeasureMode mode);
 
+/**
+ * @brief Exact decimal value of a force field as sent by the LineScale.
+ *
+ * The force fields are transmitted as 6-character decimals with a varying
+ * position of the decimal point (e.g. `-00.01`, `314.15` or `999999`). The
+ * value is stored as integer `mantissa` and the number of `decimals`, so
+ * `-00.01` becomes `{-1, 2}`. Comparisons are exact and free of rounding.
+ */
+struct FixedPoint {
+    int32_t mantissa = 0;  ///< Digits of the field as integer, including the sign
+    int8_t decimals = 0;   ///< Number of digits after the decimal point
+
+    /**
+     * @brief Convert to a double
+     *
+     * @return double `mantissa / 10^decimals`, correctly rounded
+     */
+    double toDouble() const;
+
+    /**
+     * @brief Convert to hundredths of the unit (centi-units)
+     *
+     * Fields with more than two decimals are rounded half away from zero.
+     *
+     * @return int64_t Value in centi-units
+     */
+    int64_t toCenti() const;
+
+    /**
+     * @brief Three-way comparison with another value
+     *
+     * @param other Value to compare to
+     * @return int Negative if smaller, zero if equal, positive if larger than `other`
+     */
+    int compare(const FixedPoint& other) const;
+
+    bool operator==(const FixedPoint& other) const { return compare(other) == 0; }
+    bool operator!=(const FixedPoint& other) const { return compare(other) != 0; }
+    bool operator<(const FixedPoint& other) const { return compare(other) < 0; }
+    bool operator<=(const FixedPoint& other) const { return compare(other) <= 0; }
+    bool operator>(const FixedPoint& other) const { return compare(other) > 0; }
+    bool operator>=(const FixedPoint& other) const { return compare(other) >= 0; }
+};
+
 /**
  * @brief A sample received from a LineScale.
  *
@@ -106,14 +159,36 @@ QTextStream& operator<<(QTextStream& out, const MeasureMode mode);
  * percent of battery left, and so on.
  */
 struct Sample {
-    WorkingMode workingMode;  ///< Indicates the working mode sent by the Line Scale
-    double measuredValue;     ///< Stores value of measured force
-    MeasureMode measureMode;  ///< Indicates if the measured force is relative to a previous set
-                              ///< value or if it is absolute
-    double referenceZero;     ///< Stores reference force
-    int batteryPercent;       ///< Stores battery voltage of the Line Scale in percent
-    UnitValue unitValue;      ///< Stores the unit of the measured force
-    int frequency;            ///< Stores the connection frequency between host device and Line Scale
+    WorkingMode workingMode;    ///< Indicates the working mode sent by the Line Scale
+    double measuredValue;       ///< Stores value of measured force
+    MeasureMode measureMode;    ///< Indicates if the measured force is relative to a previous set
+                                ///< value or if it is absolute
+    double referenceZero;       ///< Stores reference force
+    int batteryPercent;         ///< Stores battery voltage of the Line Scale in percent
+    UnitValue unitValue;        ///< Stores the unit of the measured force
+    int frequency;              ///< Stores the connection frequency between host device and Line Scale
+    FixedPoint measuredFixed;   ///< Exact value of `measuredValue` as sent by the Line Scale
+    FixedPoint referenceFixed;  ///< Exact value of `referenceZero` as sent by the Line Scale
+    int64_t timestamp = 0;      ///< Host steady clock arrival time in ns; 0 if unknown
+    uint64_t sequence = 0;      ///< Index of the frame in the received stream, starting at 1; 0 if unknown
+    uint16_t deviceId = 0;      ///< Number of the device, see `comm::CommMaster::getDeviceNumber`; 0 if unknown
+};
+
+/**
+ * @brief Result of parsing a single packet
+ *
+ * Names the first check that failed, `OK` if the packet was parsed completely.
+ */
+enum class ParseStatus : uint8_t {
+    OK,                      ///< Packet parsed successfully
+    INVALID_TERMINATOR,      ///< Last byte of the packet is not `\r`
+    INVALID_CHECKSUM,        ///< Checksum digits missing or not matching
+    INVALID_WORKING_MODE,    ///< Unknown working mode character
+    INVALID_MEASURED_VALUE,  ///< Measured value is not a decimal number
+    INVALID_MEASURE_MODE,    ///< Unknown measure mode character
+    INVALID_REFERENCE_ZERO,  ///< Reference zero is not a decimal number
+    INVALID_UNIT_VALUE,      ///< Unknown unit character
+    INVALID_FREQUENCY,       ///< Unknown frequency character
 };
 
 /**
@@ -134,18 +209,70 @@ class Parser : public QObject {
      * @return false: If parsing resulted in an error
      */
     bool parsePackage(QByteArray& package, Sample& data);
+
+    /**
+     * @brief Parse a single packet of exactly `PACKET_EXPECTED_LEN` bytes.
+     *
+     * Does not allocate; `data` is only fully written if `ParseStatus::OK` is returned.
+     *
+     * @param frame Pointer to the first byte of the packet
+     * @param data Parsed sample
+     * @return ParseStatus `ParseStatus::OK` on success, otherwise the first failed check
+     */
+    ParseStatus parseFrame(const char* frame, Sample& data);
+
+    /**
+     * @brief Parse a burst of back-to-back packets in one call.
+     *
+     * `frames` holds `length / PACKET_EXPECTED_LEN` packets without any separator in
+     * between; trailing bytes which do not form a complete packet are ignored.
+     * Successfully parsed packets are written to `samples` in order and without gaps, so
+     * `samples` must have room for one `Sample` per packet. No heap memory is allocated.
+     * The structure of the packets is checked in bulk by `FrameValidator` first.
+     *
+     * @param frames Pointer to the first byte of the first packet
+     * @param length Number of bytes in `frames`
+     * @param samples Caller provided array for the parsed samples
+     * @param status Optional caller provided array receiving one `ParseStatus` per packet
+     * @return size_t Number of samples written to `samples`
+     */
+    size_t parseBatch(const char* frames, size_t length, Sample* samples, ParseStatus* status = nullptr);
+
+    /**
+     * @brief Decode a decimal field like `-00.01` without allocating
+     *
+     * Accepts an optional sign followed by digits with at most one decimal point.
+     * Characters are classified with a lookup table instead of the locale-aware
+     * `QByteArray::toDouble`.
+     *
+     * @param field Pointer to the first character of the field
+     * @param len Number of characters in the field (at most 9)
+     * @param value Decoded value
+     * @return true if the field is a valid decimal number
+     */
+    static bool decodeFixedPoint(const char* field, size_t len, FixedPoint& value);
+
     static constexpr size_t PACKET_EXPECTED_LEN =
         20;  ///< Length the package should have so it would be parsed correctly
 
    private:
-    bool checkPackage(QByteArray& package);
-    bool parseWorkingMode(QByteArray& package, Sample& data);
-    bool parseMeasuredValue(QByteArray& package, Sample& data);
-    bool parseMeasureMode(QByteArray& package, Sample& data);
-    bool parseReferenceZero(QByteArray& package, Sample& data);
-    bool parseBatteryPercent(QByteArray& package, Sample& data);
-    bool parseUnitValue(QByteArray& package, Sample& data);
-    bool parseFrequency(QByteArray& package, Sample& data);
+    /**
+     * @brief Parse all fields of a packet whose checksum was already checked
+     *
+     * @param frame Pointer to the first byte of the packet
+     * @param data Parsed sample
+     * @return ParseStatus `ParseStatus::OK` on success, otherwise the first failed check
+     */
+    ParseStatus parseFields(const char* frame, Sample& data);
+
+    bool checkPackage(const char* frame);
+    bool parseWorkingMode(const char* frame, Sample& data);
+    bool parseMeasuredValue(const char* frame, Sample& data);
+    bool parseMeasureMode(const char* frame, Sample& data);
+    bool parseReferenceZero(const char* frame, Sample& data);
+    bool parseBatteryPercent(const char* frame, Sample& data);
+    bool parseUnitValue(const char* frame, Sample& data);
+    bool parseFrequency(const char* frame, Sample& data);
 
     static constexpr size_t PACKET_CHECKED_LEN = 17;
     static constexpr size_t PACKET_WORKING_MODE_INDEX = 0;
@@ -159,6 +286,7 @@ class Parser : public QObject {
     static constexpr size_t PACKET_BATTERY_PERCENT_INDEX = 14;
     static constexpr size_t PACKET_UNIT_VALUE_INDEX = 15;
     static constexpr size_t PACKET_FREQUENCY_INDEX = 16;
+    static constexpr size_t PACKET_TERMINATOR_INDEX = 19;
 };
 
 #endif  // PARSER_H
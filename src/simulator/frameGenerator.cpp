@@ -0,0 +1,255 @@
+/******************************************************************************
+ * Copyright (C) 2023 by Gschwind, Weber, Schoch, Niederberger                *
+ *                                                                            *
+ * This file is part of linescaleGUI.                                         *
+ *                                                                            *
+ * LinescaleGUI is free software: you can redistribute it and/or modify       *
+ * it under the terms of the GNU General Public License as published by       *
+ * the Free Software Foundation, either version 3 of the License, or          *
+ * (at your option) any later version.                                        *
+ *                                                                            *
+ * LinescaleGUI is distributed in the hope that it will be useful,            *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of             *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the               *
+ * GNU General Public License for more details.                               *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License          *
+ * along with linescaleGUI. If not, see <http://www.gnu.org/licenses/>.       *
+ ******************************************************************************/
+/**
+ * @file frameGenerator.cpp
+ * @authors Gschwind, Weber, Schoch, Niederberger
+ *
+ * @brief `sim::FrameGenerator` implementation
+ *
+ */
+
+#include "frameGenerator.h"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+namespace sim {
+
+namespace {
+
+constexpr double pi = 3.14159265358979323846;
+
+/**
+ * @brief Write a force into a 6 character field with as many decimals as possible
+ *
+ * @param value Force in the unit of the frame
+ * @param field Destination of 6 characters
+ */
+void encodeForce(double value, char* field) {
+    char text[32];
+    for (int decimals = 2; decimals >= 0; --decimals) {
+        int length = std::snprintf(text, sizeof(text), "%0*.*f", 6, decimals, value);
+        if (length == 6) {
+            std::memcpy(field, text, 6);
+            return;
+        }
+    }
+    std::memcpy(field, value < 0 ? "-99999" : "999999", 6);
+}
+
+}  // namespace
+
+FrameGenerator::FrameGenerator(const SimulatorConfig& config) : config(config), random(config.seed) {}
+
+void FrameGenerator::setReplay(const QVector<float>& forces, UnitValue forceUnit) {
+    replay = forces;
+    replayUnit = forceUnit;
+    config.waveform = Waveform::REPLAY;
+}
+
+void FrameGenerator::encodeFrame(const Sample& sample, char* frame) {
+    switch (sample.workingMode) {
+        case WorkingMode::OVERLOADED:
+            frame[0] = 'O';
+            break;
+        case WorkingMode::MAX_CAPACITY:
+            frame[0] = 'C';
+            break;
+        default:
+            frame[0] = 'R';
+            break;
+    }
+    encodeForce(sample.measuredValue, frame + 1);
+    frame[7] = sample.measureMode == MeasureMode::REL_ZERO ? 'Z' : 'N';
+    encodeForce(sample.referenceZero, frame + 8);
+    frame[14] = char(0x20 + sample.batteryPercent / 2);
+    switch (sample.unitValue) {
+        case UnitValue::KGF:
+            frame[15] = 'G';
+            break;
+        case UnitValue::LBF:
+            frame[15] = 'B';
+            break;
+        default:
+            frame[15] = 'N';
+            break;
+    }
+    switch (sample.frequency) {
+        case 40:
+            frame[16] = 'F';
+            break;
+        case 640:
+            frame[16] = 'M';
+            break;
+        case 1280:
+            frame[16] = 'Q';
+            break;
+        default:
+            frame[16] = 'S';
+            break;
+    }
+
+    int checksum = 0;
+    for (size_t i = 0; i < 17; ++i) {
+        checksum += int(static_cast<unsigned char>(frame[i]));
+    }
+    checksum %= 100;
+    frame[17] = char('0' + checksum / 10);
+    frame[18] = char('0' + checksum % 10);
+    frame[19] = '\r';
+}
+
+double FrameGenerator::nextForce() {
+    double time = double(frameIndex) / double(frequency);
+    switch (config.waveform) {
+        case Waveform::SINE:
+            return config.offset + config.amplitude * std::sin(2.0 * pi * time / config.period);
+        case Waveform::RAMP:
+            return config.offset + config.amplitude * std::fmod(time, config.period) / config.period;
+        case Waveform::NOISE:
+            return config.offset + config.amplitude * std::uniform_real_distribution<double>(-1.0, 1.0)(random);
+        case Waveform::REPLAY:
+            if (!replay.isEmpty()) {
+                return replay[int(frameIndex % uint64_t(replay.size()))] / factorFromKn(replayUnit);
+            }
+            return config.offset;
+        default:
+            return config.offset;
+    }
+}
+
+QByteArray FrameGenerator::nextFrames(int count) {
+    QByteArray frames(count * int(Parser::PACKET_EXPECTED_LEN), '\0');
+    std::uniform_real_distribution<double> chance(0.0, 1.0);
+    std::uniform_int_distribution<int> position(0, int(Parser::PACKET_EXPECTED_LEN) - 1);
+
+    for (int i = 0; i < count; ++i) {
+        lastForce = nextForce();
+        ++frameIndex;
+
+        Sample sample{};
+        sample.workingMode = WorkingMode::REALTIME;
+        sample.measureMode = measureMode;
+        sample.measuredValue = (lastForce - (measureMode == MeasureMode::REL_ZERO ? referenceZero : 0.0)) *
+                               factorFromKn(unit);
+        sample.referenceZero = referenceZero * factorFromKn(unit);
+        sample.batteryPercent = config.battery;
+        sample.unitValue = unit;
+        sample.frequency = frequency;
+
+        char* frame = frames.data() + i * int(Parser::PACKET_EXPECTED_LEN);
+        encodeFrame(sample, frame);
+        if (config.corruptionRate > 0.0 && chance(random) < config.corruptionRate) {
+            frame[position(random)] ^= 0x5A;
+        }
+    }
+    return frames;
+}
+
+QList<QByteArray> FrameGenerator::split(const QByteArray& data) {
+    QList<QByteArray> chunks;
+    if (config.maxChunk <= 0) {
+        chunks.append(data);
+        return chunks;
+    }
+    std::uniform_int_distribution<int> size(1, config.maxChunk);
+    for (int offset = 0; offset < data.size();) {
+        int length = size(random);
+        chunks.append(data.mid(offset, length));
+        offset += length;
+    }
+    return chunks;
+}
+
+int FrameGenerator::receive(const QByteArray& data) {
+    received.append(data);
+    int executed = 0;
+    int end;
+    // Every command is `opcode [arguments] \r \n checksum`
+    while ((end = received.indexOf("\r\n")) >= 0 && received.size() >= end + 3) {
+        unsigned int sum = 0;
+        for (int i = 0; i < end + 2; ++i) {
+            sum += static_cast<unsigned char>(received[i]);
+        }
+        if (end > 0 && (sum & 0xFF) == static_cast<unsigned char>(received[end + 2]) && execute(received[0])) {
+            ++executed;
+        }
+        received.remove(0, end + 3);
+    }
+    return executed;
+}
+
+bool FrameGenerator::execute(char opcode) {
+    switch (opcode) {
+        case 'O':  // POWEROFF
+            poweredOff = true;
+            online = false;
+            break;
+        case 'Z':  // SETZERO
+            referenceZero = lastForce;
+            measureMode = MeasureMode::REL_ZERO;
+            break;
+        case 'N':  // SWITCHTOKN
+            unit = UnitValue::KN;
+            break;
+        case 'G':  // SWITCHTOKGF
+            unit = UnitValue::KGF;
+            break;
+        case 'B':  // SWITCHTOLBF
+            unit = UnitValue::LBF;
+            break;
+        case 'S':  // SETSPEED10
+            frequency = 10;
+            break;
+        case 'F':  // SETSPEED40
+            frequency = 40;
+            break;
+        case 'M':  // SETSPEED640
+            frequency = 640;
+            break;
+        case 'Q':  // SETSPEED1280
+            frequency = 1280;
+            break;
+        case 'L':  // SWITCHMODE
+            measureMode = measureMode == MeasureMode::REL_ZERO ? MeasureMode::ABS_ZERO : MeasureMode::REL_ZERO;
+            break;
+        case 'X':  // SETRELATIVEMODE
+            measureMode = MeasureMode::REL_ZERO;
+            break;
+        case 'Y':  // SETABSOLUTEMODE
+            measureMode = MeasureMode::ABS_ZERO;
+            break;
+        case 'T':  // SETCURRENTTOABSOLUTE, the absolute zero is not simulated
+        case 'C':  // RESETPEAK, the peak is not part of the stream
+            break;
+        case 'A':  // REQUESTONLINE
+            online = true;
+            break;
+        case 'E':  // DISCONNECTONLINE
+            online = false;
+            break;
+        case 'R':  // READFIRSTLOG / READLASTLOG, logs are not simulated
+            break;
+        default:
+            return false;
+    }
+    return true;
+}
+
+}  // namespace sim
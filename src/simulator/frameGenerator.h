@@ -0,0 +1,178 @@
+/******************************************************************************
+ * Copyright (C) 2023 by Gschwind, Weber, Schoch, Niederberger                *
+ *                                                                            *
+ * This file is part of linescaleGUI.                                         *
+ *                                                                            *
+ * LinescaleGUI is free software: you can redistribute it and/or modify       *
+ * it under the terms of the GNU General Public License as published by       *
+ * the Free Software Foundation, either version 3 of the License, or          *
+ * (at your option) any later version.                                        *
+ *                                                                            *
+ * LinescaleGUI is distributed in the hope that it will be useful,            *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of             *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the               *
+ * GNU General Public License for more details.                               *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License          *
+ * along with linescaleGUI. If not, see <http://www.gnu.org/licenses/>.       *
+ ******************************************************************************/
+/**
+ * @file frameGenerator.h
+ * @authors Gschwind, Weber, Schoch, Niederberger
+ *
+ * @brief `sim::FrameGenerator` declaration
+ *
+ */
+
+#pragma once
+#ifndef FRAMEGENERATOR_H_
+#define FRAMEGENERATOR_H_
+
+#include <QByteArray>
+#include <QList>
+#include <QVector>
+#include <cstdint>
+#include <random>
+#include "../parser/parser.h"
+
+/**
+ * @brief Namespace for the simulation of a LineScale
+ *
+ */
+namespace sim {
+
+/**
+ * @brief Enum to describe the simulated force signal
+ *
+ */
+enum class Waveform {
+    CONSTANT,  ///< Constant force of `SimulatorConfig::offset`
+    SINE,      ///< Sine around `offset` with `amplitude`
+    RAMP,      ///< Sawtooth from `offset` to `offset + amplitude`
+    NOISE,     ///< Uniform noise around `offset` with `amplitude`
+    REPLAY,    ///< Forces of a logfile, see `FrameGenerator::setReplay`
+};
+
+/**
+ * @brief Settings of the simulated device and the simulated transmission errors
+ *
+ */
+struct SimulatorConfig {
+    Waveform waveform = Waveform::SINE;  ///< Simulated force signal
+    double offset = 0.0;                 ///< Offset of the signal in kN
+    double amplitude = 1.0;              ///< Amplitude of the signal in kN
+    double period = 2.0;                 ///< Period of the signal in s
+    double corruptionRate = 0.0;         ///< Probability of a frame with one flipped byte
+    int maxChunk = 0;                    ///< Split the output in random chunks of 1 to `maxChunk` bytes; 0 to disable
+    int burstFrames = 1;                 ///< Number of frames sent together
+    int battery = 80;                    ///< Battery level in percent
+    uint32_t seed = 1;                   ///< Seed of the random generator, for reproducible runs
+};
+
+/**
+ * @brief Generate the byte stream of a LineScale
+ *
+ * Creates valid 20-byte frames as expected by `Parser`, reacts on the
+ * commands of `command.h` and injects transmission errors on request.
+ * Independent of any I/O, so it can be used for tests as well as for the
+ * `linescale-sim` tool.
+ */
+class FrameGenerator {
+   public:
+    /**
+     * @brief Construct a new frame generator
+     *
+     * @param config Settings of the simulated device
+     */
+    explicit FrameGenerator(const SimulatorConfig& config = SimulatorConfig{});
+
+    /**
+     * @brief Replay the forces of a logfile instead of a synthetic signal
+     *
+     * The forces are converted to kN, so the frames follow the unit selected on
+     * the simulated device like the synthetic signals.
+     *
+     * @param forces Forces of the logfile, repeated after the last value
+     * @param forceUnit Unit of `forces`, see `Metadata::unit`
+     */
+    void setReplay(const QVector<float>& forces, UnitValue forceUnit);
+
+    /**
+     * @brief Encode a sample into a frame
+     *
+     * The forces are written with as many decimals as fit into the 6 characters.
+     *
+     * @param sample Sample to encode; `measuredValue`, `referenceZero`, modes, unit,
+     *               battery and frequency are used
+     * @param frame Caller provided array of `Parser::PACKET_EXPECTED_LEN` bytes
+     */
+    static void encodeFrame(const Sample& sample, char* frame);
+
+    /**
+     * @brief Generate the next frames
+     *
+     * Each frame is corrupted with the probability `SimulatorConfig::corruptionRate`.
+     *
+     * @param count Number of frames
+     * @return QByteArray Frames back-to-back
+     */
+    QByteArray nextFrames(int count);
+
+    /**
+     * @brief Split data into chunks as the serial driver would deliver them
+     *
+     * @param data Bytes to send
+     * @return QList<QByteArray> Chunks of random size, see `SimulatorConfig::maxChunk`
+     */
+    QList<QByteArray> split(const QByteArray& data);
+
+    /**
+     * @brief Receive bytes from the host and execute the commands
+     *
+     * Incomplete commands are kept until the next call; commands with an
+     * invalid checksum are ignored.
+     *
+     * @param data Bytes sent by the host
+     * @return int Number of executed commands
+     */
+    int receive(const QByteArray& data);
+
+    int getFrequency() const { return frequency; }  ///< Current frequency in Hz
+    bool isOnline() const { return online; }       ///< True if the host requested the stream
+    bool isPoweredOff() const { return poweredOff; }  ///< True after the power off command
+    const SimulatorConfig& getConfig() const { return config; }  ///< Current settings
+
+   private:
+    /**
+     * @brief Execute a single command
+     *
+     * @param opcode First byte of the command
+     * @return true if the opcode is known
+     */
+    bool execute(char opcode);
+
+    /**
+     * @brief Force of the simulated signal for the next frame
+     *
+     * @return double Force in kN, absolute
+     */
+    double nextForce();
+
+    SimulatorConfig config;
+    std::mt19937 random;
+    QByteArray received;
+    QVector<float> replay;
+    UnitValue replayUnit = UnitValue::KN;  ///< Unit of `replay`
+    uint64_t frameIndex = 0;
+    int frequency = 10;
+    bool online = false;
+    bool poweredOff = false;
+    UnitValue unit = UnitValue::KN;
+    MeasureMode measureMode = MeasureMode::ABS_ZERO;
+    double referenceZero = 0.0;  ///< In kN
+    double lastForce = 0.0;      ///< Absolute force of the last frame in kN
+};
+
+}  // namespace sim
+
+#endif  // FRAMEGENERATOR_H_
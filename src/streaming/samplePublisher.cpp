@@ -0,0 +1,212 @@
+/******************************************************************************
+ * Copyright (C) 2023 by Gschwind, Weber, Schoch, Niederberger                *
+ *                                                                            *
+ * This file is part of linescaleGUI.                                         *
+ *                                                                            *
+ * LinescaleGUI is free software: you can redistribute it and/or modify       *
+ * it under the terms of the GNU General Public License as published by       *
+ * the Free Software Foundation, either version 3 of the License, or          *
+ * (at your option) any later version.                                        *
+ *                                                                            *
+ * LinescaleGUI is distributed in the hope that it will be useful,            *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of             *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the               *
+ * GNU General Public License for more details.                               *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License          *
+ * along with linescaleGUI. If not, see <http://www.gnu.org/licenses/>.       *
+ ******************************************************************************/
+/**
+ * @file samplePublisher.cpp
+ * @authors Gschwind, Weber, Schoch, Niederberger
+ *
+ * @brief `SamplePublisher` implementation
+ *
+ */
+
+#include "samplePublisher.h"
+#include <cerrno>
+#include <new>
+
+#if defined(Q_OS_UNIX)
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace stream {
+
+namespace {
+
+#if defined(Q_OS_UNIX)
+/**
+ * @brief Map the header of an existing ring
+ *
+ * @param path Name of the shared memory object
+ * @return RingHeader* Writable header, `nullptr` if there is no ring; unmap with `munmap`
+ */
+RingHeader* mapExisting(const QByteArray& path) {
+    int fd = shm_open(path.constData(), O_RDWR, 0);
+    if (fd < 0) {
+        return nullptr;
+    }
+    void* memory = MAP_FAILED;
+    struct stat status;
+    if (fstat(fd, &status) == 0 && size_t(status.st_size) >= sizeof(RingHeader)) {
+        memory = mmap(nullptr, sizeof(RingHeader), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    ::close(fd);
+    return memory == MAP_FAILED ? nullptr : static_cast<RingHeader*>(memory);
+}
+
+/**
+ * @brief Check whether the publisher of a ring is still running
+ *
+ * Rings of an older layout have no owner and count as left over.
+ *
+ * @param header Header of the ring
+ * @return true if the owner is alive and did not close the ring
+ */
+bool hasLiveOwner(const RingHeader* header) {
+    if (header->magic != RING_MAGIC || header->version != RING_VERSION ||
+        header->closed.load(std::memory_order_acquire) != 0 || header->owner == 0) {
+        return false;
+    }
+    // Signal 0 only checks the process; EPERM means it runs under another user
+    return kill(pid_t(header->owner), 0) == 0 || errno == EPERM;
+}
+#endif
+
+}  // namespace
+
+SamplePublisher::SamplePublisher(QObject* parent) : QObject(parent) {}
+
+SamplePublisher::~SamplePublisher() {
+    close();
+}
+
+bool SamplePublisher::open(const QString& newName, quint32 capacity) {
+    close();
+#if defined(Q_OS_UNIX)
+    quint32 rounded = 1;
+    while (rounded < capacity) {
+        rounded <<= 1;
+    }
+    QByteArray path = newName.toLocal8Bit();
+    if (RingHeader* existing = mapExisting(path)) {
+        bool running = hasLiveOwner(existing);
+        if (!running) {
+            // Left over by a crash, tell its readers that it is replaced
+            existing->closed.store(1, std::memory_order_release);
+        }
+        munmap(existing, sizeof(RingHeader));
+        if (running) {
+            return false;
+        }
+        shm_unlink(path.constData());
+    }
+
+    int fd = shm_open(path.constData(), O_RDWR | O_CREAT | O_EXCL, 0644);
+    if (fd < 0) {
+        return false;
+    }
+    size_t size = ringSize(rounded);
+    void* memory = MAP_FAILED;
+    if (ftruncate(fd, off_t(size)) == 0) {
+        memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    ::close(fd);  // The mapping stays valid
+    if (memory == MAP_FAILED) {
+        shm_unlink(path.constData());
+        return false;
+    }
+
+    header = new (memory) RingHeader;
+    ring = reinterpret_cast<RingSlot*>(static_cast<char*>(memory) + sizeof(RingHeader));
+    for (quint32 i = 0; i < rounded; ++i) {
+        new (&ring[i]) RingSlot;
+    }
+    header->version = RING_VERSION;
+    header->capacity = rounded;
+    header->slotSize = sizeof(RingSlot);
+    header->owner = quint32(getpid());
+    // Readers check the magic first
+    std::atomic_thread_fence(std::memory_order_release);
+    header->magic = RING_MAGIC;
+
+    name = newName;
+    mask = rounded - 1;
+    mappedSize = size;
+    return true;
+#else
+    Q_UNUSED(newName);
+    Q_UNUSED(capacity);
+    return false;
+#endif
+}
+
+bool SamplePublisher::isPublished(const QString& name) {
+#if defined(Q_OS_UNIX)
+    RingHeader* existing = mapExisting(name.toLocal8Bit());
+    if (existing == nullptr) {
+        return false;
+    }
+    bool running = hasLiveOwner(existing);
+    munmap(existing, sizeof(RingHeader));
+    return running;
+#else
+    Q_UNUSED(name);
+    return false;
+#endif
+}
+
+void SamplePublisher::close() {
+    if (!isOpen()) {
+        return;
+    }
+#if defined(Q_OS_UNIX)
+    header->closed.store(1, std::memory_order_release);
+    munmap(header, mappedSize);
+    shm_unlink(name.toLocal8Bit().constData());
+#endif
+    header = nullptr;
+    ring = nullptr;
+    name.clear();
+}
+
+quint64 SamplePublisher::getPublished() const {
+    return isOpen() ? header->written.load(std::memory_order_relaxed) : 0;
+}
+
+void SamplePublisher::publish(const QVector<Sample>& samples) {
+    if (!isOpen() || samples.isEmpty()) {
+        return;
+    }
+    quint64 written = header->written.load(std::memory_order_relaxed);
+    for (const Sample& sample : samples) {
+        RingSlot& slot = ring[written & mask];
+        quint32 lock = slot.lock.load(std::memory_order_relaxed);
+        slot.lock.store(lock + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        slot.sample.index = written;
+        slot.sample.timestamp = sample.timestamp;
+        slot.sample.sequence = sample.sequence;
+        slot.sample.force = sample.measuredValue;
+        slot.sample.referenceZero = sample.referenceZero;
+        slot.sample.deviceId = sample.deviceId;
+        slot.sample.unit = quint8(sample.unitValue);
+        slot.sample.mode = quint8(sample.measureMode);
+        slot.sample.frequency = quint16(sample.frequency);
+        slot.sample.battery = quint8(qBound(0, sample.batteryPercent, 255));
+
+        slot.lock.store(lock + 2, std::memory_order_release);
+        ++written;
+    }
+    // One store per batch, readers see the whole batch at once
+    header->written.store(written, std::memory_order_release);
+}
+
+}  // namespace stream
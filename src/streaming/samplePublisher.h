@@ -0,0 +1,124 @@
+/******************************************************************************
+ * Copyright (C) 2023 by Gschwind, Weber, Schoch, Niederberger                *
+ *                                                                            *
+ * This file is part of linescaleGUI.                                         *
+ *                                                                            *
+ * LinescaleGUI is free software: you can redistribute it and/or modify       *
+ * it under the terms of the GNU General Public License as published by       *
+ * the Free Software Foundation, either version 3 of the License, or          *
+ * (at your option) any later version.                                        *
+ *                                                                            *
+ * LinescaleGUI is distributed in the hope that it will be useful,            *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of             *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the               *
+ * GNU General Public License for more details.                               *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License          *
+ * along with linescaleGUI. If not, see <http://www.gnu.org/licenses/>.       *
+ ******************************************************************************/
+/**
+ * @file samplePublisher.h
+ * @authors Gschwind, Weber, Schoch, Niederberger
+ *
+ * @brief `SamplePublisher` declaration
+ *
+ */
+
+#pragma once
+#ifndef SAMPLEPUBLISHER_H_
+#define SAMPLEPUBLISHER_H_
+
+#include <QObject>
+#include <QString>
+#include <QVector>
+#include "../parser/parser.h"
+#include "sharedRing.h"
+
+namespace stream {
+
+/**
+ * @brief Publish the live samples in a shared memory ring for other local processes
+ *
+ * The samples are written into a POSIX shared memory object, see
+ * `sharedRing.h` for the layout. Every slot is guarded by a sequence lock, so
+ * the publisher never waits and any number of readers, e.g. `SampleSubscriber`,
+ * copy the samples straight out of the mapping. Readers which fall more than
+ * the capacity behind lose the oldest samples.
+ *
+ * The publisher runs in the thread of `comm::CommMaster`, after the samples
+ * were taken from the I/O threads, so the acquisition is not slowed down.
+ *
+ * Only available on Unix, `open` fails elsewhere.
+ */
+class SamplePublisher : public QObject {
+    Q_OBJECT
+
+   public:
+    static constexpr quint32 DEFAULT_CAPACITY = 16384;  ///< About 13 s at 1280 Hz
+
+    /**
+     * @brief Construct a new publisher
+     *
+     * @param parent The parent object or `nullptr`
+     */
+    explicit SamplePublisher(QObject* parent = nullptr);
+
+    /**
+     * @brief Close the ring
+     *
+     */
+    ~SamplePublisher();
+
+    /**
+     * @brief Create the shared memory and start publishing
+     *
+     * A ring with the same name left over by a crash is replaced; readers of
+     * a replaced ring see `RingHeader::closed`. Fails if the publisher of the
+     * existing ring is still running, see `isPublished`.
+     *
+     * @param name Name of the shared memory object, starting with a slash
+     * @param capacity Number of slots, rounded up to the next power of two
+     * @return true if the ring was created
+     */
+    bool open(const QString& name = DEFAULT_RING_NAME, quint32 capacity = DEFAULT_CAPACITY);
+
+    /**
+     * @brief Check whether a running process publishes a ring
+     *
+     * @param name Name of the shared memory object
+     * @return true if the publisher of the ring is alive, also if it is this process
+     */
+    static bool isPublished(const QString& name = DEFAULT_RING_NAME);
+
+    /**
+     * @brief Mark the ring as closed and remove it
+     *
+     * Readers keep their mapping until they close it.
+     */
+    void close();
+
+    bool isOpen() const { return header != nullptr; }  ///< True between `open` and `close`
+    QString getName() const { return name; }            ///< Name of the open ring
+    quint64 getPublished() const;                       ///< Samples published since `open`
+
+   public slots:
+    /**
+     * @brief Publish samples
+     *
+     * Connect to `comm::CommMaster::newSamplesMaster`. Ignored if not open.
+     *
+     * @param samples New samples, oldest first
+     */
+    void publish(const QVector<Sample>& samples);
+
+   private:
+    QString name;
+    RingHeader* header = nullptr;  ///< Start of the mapping
+    RingSlot* ring = nullptr;      ///< Follows the header
+    quint32 mask = 0;              ///< Capacity - 1
+    size_t mappedSize = 0;
+};
+
+}  // namespace stream
+
+#endif  // SAMPLEPUBLISHER_H_
@@ -0,0 +1,262 @@
+/******************************************************************************
+ * Copyright (C) 2023 by Gschwind, Weber, Schoch, Niederberger                *
+ *                                                                            *
+ * This file is part of linescaleGUI.                                         *
+ *                                                                            *
+ * LinescaleGUI is free software: you can redistribute it and/or modify       *
+ * it under the terms of the GNU General Public License as published by       *
+ * the Free Software Foundation, either version 3 of the License, or          *
+ * (at your option) any later version.                                        *
+ *                                                                            *
+ * LinescaleGUI is distributed in the hope that it will be useful,            *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of             *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the               *
+ * GNU General Public License for more details.                               *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License          *
+ * along with linescaleGUI. If not, see <http://www.gnu.org/licenses/>.       *
+ ******************************************************************************/
+/**
+ * @file sampleServer.cpp
+ * @authors Gschwind, Weber, Schoch, Niederberger
+ *
+ * @brief `SampleServer` implementation
+ *
+ */
+
+#include "sampleServer.h"
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QTextStream>
+#include <QtEndian>
+#include <cstring>
+#include "../deviceCommunication/command.h"
+
+namespace stream {
+
+namespace {
+
+constexpr qint64 MAX_LINE = 256;  ///< Longer lines of a client are a protocol error
+
+/**
+ * @brief Bit pattern of a double, for the little endian conversion
+ *
+ */
+quint64 doubleBits(double value) {
+    quint64 bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+/**
+ * @brief Commands of `command.h` by name
+ *
+ */
+const QHash<QByteArray, QByteArray>& commandsByName() {
+    static const QHash<QByteArray, QByteArray> commands = {
+        {"POWEROFF", command::POWEROFF},
+        {"SETZERO", command::SETZERO},
+        {"SWITCHTOKN", command::SWITCHTOKN},
+        {"SWITCHTOKGF", command::SWITCHTOKGF},
+        {"SWITCHTOLBF", command::SWITCHTOLBF},
+        {"SETSPEED10", command::SETSPEED10},
+        {"SETSPEED40", command::SETSPEED40},
+        {"SETSPEED640", command::SETSPEED640},
+        {"SETSPEED1280", command::SETSPEED1280},
+        {"SWITCHMODE", command::SWITCHMODE},
+        {"SETRELATIVEMODE", command::SETRELATIVEMODE},
+        {"SETABSOLUTEMODE", command::SETABSOLUTEMODE},
+        {"SETCURRENTTOABSOLUTE", command::SETCURRENTTOABSOLUTE},
+        {"RESETPEAK", command::RESETPEAK},
+        {"REQUESTONLINE", command::REQUESTONLINE},
+        {"DISCONNECTONLINE", command::DISCONNECTONLINE},
+        {"READFIRSTLOG", command::READFIRSTLOG},
+        {"READLASTLOG", command::READLASTLOG},
+    };
+    return commands;
+}
+
+}  // namespace
+
+SampleServer::SampleServer(QObject* parent) : QObject(parent), server(new QLocalServer(this)) {
+    connect(server, &QLocalServer::newConnection, this, &SampleServer::acceptClients);
+}
+
+SampleServer::~SampleServer() {
+    close();
+}
+
+bool SampleServer::listen(const QString& name) {
+    close();
+    QLocalServer::removeServer(name);
+    server->setSocketOptions(QLocalServer::UserAccessOption);
+    return server->listen(name);
+}
+
+void SampleServer::close() {
+    const QList<QLocalSocket*> sockets = clients.keys();
+    clients.clear();
+    for (QLocalSocket* socket : sockets) {
+        socket->disconnect(this);
+        socket->abort();
+        socket->deleteLater();
+    }
+    server->close();
+}
+
+bool SampleServer::isListening() const {
+    return server->isListening();
+}
+
+QString SampleServer::getSocketPath() const {
+    return server->fullServerName();
+}
+
+void SampleServer::encodeBinary(const QVector<Sample>& samples, quint64 firstIndex, QByteArray& frame) {
+    frame.resize(FRAME_HEADER_SIZE + RECORD_SIZE * samples.size());
+    uchar* cursor = reinterpret_cast<uchar*>(frame.data());
+    qToLittleEndian<quint32>(FRAME_MAGIC, cursor);
+    qToLittleEndian<quint32>(quint32(samples.size()), cursor + 4);
+    qToLittleEndian<quint64>(firstIndex, cursor + 8);
+    cursor += FRAME_HEADER_SIZE;
+
+    for (const Sample& sample : samples) {
+        qToLittleEndian<qint64>(sample.timestamp, cursor);
+        qToLittleEndian<quint64>(sample.sequence, cursor + 8);
+        qToLittleEndian<quint64>(doubleBits(sample.measuredValue), cursor + 16);
+        qToLittleEndian<quint16>(sample.deviceId, cursor + 24);
+        cursor[26] = uchar(sample.unitValue);
+        cursor[27] = uchar(sample.measureMode);
+        qToLittleEndian<quint16>(quint16(sample.frequency), cursor + 28);
+        cursor[30] = uchar(qBound(0, sample.batteryPercent, 255));
+        cursor[31] = 0;
+        cursor += RECORD_SIZE;
+    }
+}
+
+void SampleServer::encodeText(const QVector<Sample>& samples, quint64 firstIndex, QByteArray& frame) {
+    frame.clear();
+    QTextStream out(&frame);
+    quint64 index = firstIndex;
+    for (const Sample& sample : samples) {
+        out << index++ << ' ' << sample.timestamp << ' ' << sample.deviceId << ' ' << sample.measuredValue << ' '
+            << sample.unitValue << ' ' << sample.measureMode << ' ' << sample.sequence << '\n';
+    }
+    out.flush();
+}
+
+bool SampleServer::parseCommand(const QByteArray& line, QByteArray& command, quint16& device) {
+    QList<QByteArray> words = line.simplified().split(' ');
+    if (words.size() > 2) {
+        return false;
+    }
+    auto found = commandsByName().constFind(words[0].toUpper());
+    if (found == commandsByName().constEnd()) {
+        return false;
+    }
+    device = 0;
+    if (words.size() == 2) {
+        bool ok;
+        device = words[1].toUShort(&ok);
+        if (!ok) {
+            return false;
+        }
+    }
+    command = found.value();
+    return true;
+}
+
+void SampleServer::publish(const QVector<Sample>& samples) {
+    if (samples.isEmpty()) {
+        return;
+    }
+    quint64 firstIndex = published;
+    published += quint64(samples.size());
+    if (clients.isEmpty()) {
+        return;
+    }
+
+    // Encoded once, the queues share the implicitly shared frames
+    QByteArray binaryFrame, textFrame;
+    for (auto it = clients.begin(); it != clients.end(); ++it) {
+        QByteArray& frame = it->framing == Framing::BINARY ? binaryFrame : textFrame;
+        if (frame.isEmpty()) {
+            if (it->framing == Framing::BINARY) {
+                encodeBinary(samples, firstIndex, frame);
+            } else {
+                encodeText(samples, firstIndex, frame);
+            }
+        }
+        enqueue(it.value(), frame, samples.size());
+        flushClient(it.key());
+    }
+}
+
+void SampleServer::enqueue(Client& client, const QByteArray& frame, int count) {
+    client.queue.enqueue(frame);
+    client.counts.enqueue(count);
+    client.queued += frame.size();
+    while (client.queued > queueLimit && client.queue.size() > 1) {
+        client.queued -= client.queue.dequeue().size();
+        dropped += quint64(client.counts.dequeue());
+    }
+}
+
+void SampleServer::acceptClients() {
+    while (QLocalSocket* socket = server->nextPendingConnection()) {
+        clients.insert(socket, Client());
+        connect(socket, &QLocalSocket::readyRead, this, [this, socket] { readClient(socket); });
+        connect(socket, &QLocalSocket::bytesWritten, this, [this, socket] { flushClient(socket); });
+        connect(socket, &QLocalSocket::disconnected, this, [this, socket] {
+            clients.remove(socket);
+            socket->deleteLater();
+        });
+    }
+}
+
+void SampleServer::readClient(QLocalSocket* socket) {
+    auto client = clients.find(socket);
+    if (client == clients.end()) {
+        return;
+    }
+    while (socket->canReadLine()) {
+        // Reads at most `MAX_LINE` bytes; the rest of a longer line would look like a new command
+        QByteArray line = socket->readLine(MAX_LINE + 1);
+        if (!line.endsWith('\n')) {
+            socket->abort();
+            return;
+        }
+        line = line.trimmed();
+        QByteArray bytes;
+        quint16 device;
+        if (line == "binary" || line == "text") {
+            // Applies from the next batch on, so frames are never mixed
+            client->framing = line == "binary" ? Framing::BINARY : Framing::TEXT;
+        } else if (parseCommand(line, bytes, device)) {
+            emit commandReceived(device, bytes);
+        } else if (!line.isEmpty() && client->framing == Framing::TEXT) {
+            enqueue(client.value(), "# unknown command " + line + '\n', 0);
+        }
+    }
+    if (socket->bytesAvailable() > MAX_LINE) {
+        socket->abort();  // No line break, not a client of this protocol
+        return;
+    }
+    flushClient(socket);
+}
+
+void SampleServer::flushClient(QLocalSocket* socket) {
+    auto client = clients.find(socket);
+    if (client == clients.end()) {
+        return;
+    }
+    // Keep the unbounded buffer of the socket small, the queue drops instead
+    while (!client->queue.isEmpty() && socket->bytesToWrite() < SOCKET_BUFFER) {
+        QByteArray frame = client->queue.dequeue();
+        client->counts.dequeue();
+        client->queued -= frame.size();
+        socket->write(frame);
+    }
+}
+
+}  // namespace stream
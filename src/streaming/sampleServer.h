@@ -0,0 +1,233 @@
+/******************************************************************************
+ * Copyright (C) 2023 by Gschwind, Weber, Schoch, Niederberger                *
+ *                                                                            *
+ * This file is part of linescaleGUI.                                         *
+ *                                                                            *
+ * LinescaleGUI is free software: you can redistribute it and/or modify       *
+ * it under the terms of the GNU General Public License as published by       *
+ * the Free Software Foundation, either version 3 of the License, or          *
+ * (at your option) any later version.                                        *
+ *                                                                            *
+ * LinescaleGUI is distributed in the hope that it will be useful,            *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of             *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the               *
+ * GNU General Public License for more details.                               *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License          *
+ * along with linescaleGUI. If not, see <http://www.gnu.org/licenses/>.       *
+ ******************************************************************************/
+/**
+ * @file sampleServer.h
+ * @authors Gschwind, Weber, Schoch, Niederberger
+ *
+ * @brief `SampleServer` declaration
+ *
+ */
+
+#pragma once
+#ifndef SAMPLESERVER_H_
+#define SAMPLESERVER_H_
+
+#include <QByteArray>
+#include <QHash>
+#include <QObject>
+#include <QQueue>
+#include <QString>
+#include <QVector>
+#include "../parser/parser.h"
+
+class QLocalServer;
+class QLocalSocket;
+
+namespace stream {
+
+constexpr char DEFAULT_SERVER_NAME[] = "linescale";  ///< Socket name for `QLocalServer::listen`
+
+/**
+ * @brief Stream the live samples to local clients over a Unix domain socket
+ *
+ * A client receives every batch of samples published after it connected. The
+ * clients choose the framing by sending a line:
+ *
+ * - `text` (default): one line per sample,
+ *   `<index> <timestamp> <device> <force> <unit> <mode> <sequence>`, e.g.
+ *   `42 8123456789 1 0.53 kN ABS 43`. Lines starting with `#` are messages
+ *   of the server.
+ * - `binary`: one frame per batch, a `FRAME_HEADER_SIZE` byte header
+ *   (`FRAME_MAGIC`, count, index of the first sample) followed by `count`
+ *   records of `RECORD_SIZE` bytes, see `encodeBinary`. All little endian.
+ *
+ * Every other line is a command of `command.h` by name, optionally followed
+ * by a device number, e.g. `SETZERO` for the active device or
+ * `SETSPEED1280 2`. The command is emitted with `commandReceived`. A client
+ * sending a line of more than 256 bytes is disconnected.
+ *
+ * Each client has its own queue of at most `setQueueLimit` bytes. If a client
+ * reads too slowly, its oldest batches are dropped; the gap is visible in the
+ * sample indices. Neither the acquisition nor other clients ever wait.
+ *
+ * On Windows the socket is a named pipe.
+ */
+class SampleServer : public QObject {
+    Q_OBJECT
+
+   public:
+    static constexpr quint32 FRAME_MAGIC = 0x4653534c;      ///< "LSSF" in little endian
+    static constexpr int FRAME_HEADER_SIZE = 16;            ///< Magic, count, first index
+    static constexpr int RECORD_SIZE = 32;                  ///< Bytes per sample of the binary framing
+    static constexpr qint64 DEFAULT_QUEUE_LIMIT = 1 << 20;  ///< About 25 s at 1280 Hz in binary
+    static constexpr qint64 SOCKET_BUFFER = 64 * 1024;      ///< Bytes handed to a socket at once
+
+    /**
+     * @brief Framing of the samples sent to a client
+     *
+     */
+    enum class Framing {
+        TEXT,    ///< One line per sample
+        BINARY,  ///< One frame per batch
+    };
+
+    /**
+     * @brief Construct a new server, not listening yet
+     *
+     * @param parent The parent object or `nullptr`
+     */
+    explicit SampleServer(QObject* parent = nullptr);
+
+    /**
+     * @brief Disconnect all clients
+     *
+     */
+    ~SampleServer();
+
+    /**
+     * @brief Start accepting clients
+     *
+     * A stale socket of the same name, e.g. left over by a crash, is removed.
+     *
+     * @param name Name of the socket or absolute path, see `QLocalServer::listen`
+     * @return true if listening
+     */
+    bool listen(const QString& name = DEFAULT_SERVER_NAME);
+
+    /**
+     * @brief Disconnect all clients and stop listening
+     *
+     */
+    void close();
+
+    bool isListening() const;                              ///< True between `listen` and `close`
+    QString getSocketPath() const;                         ///< Full path of the socket while listening
+    int getClientCount() const { return clients.size(); }  ///< Connected clients
+    quint64 getDropped() const { return dropped; }         ///< Samples dropped for slow clients
+
+    /**
+     * @brief Set the maximum number of bytes queued per client
+     *
+     * @param bytes Limit; the newest batch is always queued
+     */
+    void setQueueLimit(qint64 bytes) { queueLimit = bytes; }
+
+    /**
+     * @brief Encode samples in the binary framing
+     *
+     * Each record holds timestamp (i64, ns), sequence (u64), force (f64),
+     * device (u16), unit (u8), mode (u8), frequency (u16), battery (u8) and
+     * one reserved byte.
+     *
+     * @param samples Samples of one batch
+     * @param firstIndex Index of the first sample in the stream
+     * @param frame Replaced by the frame
+     */
+    static void encodeBinary(const QVector<Sample>& samples, quint64 firstIndex, QByteArray& frame);
+
+    /**
+     * @brief Encode samples in the text framing
+     *
+     * @param samples Samples of one batch
+     * @param firstIndex Index of the first sample in the stream
+     * @param frame Replaced by the lines
+     */
+    static void encodeText(const QVector<Sample>& samples, quint64 firstIndex, QByteArray& frame);
+
+    /**
+     * @brief Parse a command line of a client
+     *
+     * @param line Line without the line break
+     * @param command Bytes of the command, see `command.h`
+     * @param device Device number, 0 for the active device
+     * @return true if the line names a command
+     */
+    static bool parseCommand(const QByteArray& line, QByteArray& command, quint16& device);
+
+   public slots:
+    /**
+     * @brief Send samples to all clients
+     *
+     * Connect to `comm::CommMaster::newSamplesMaster`. Every batch is encoded
+     * once per framing in use.
+     *
+     * @param samples New samples, oldest first
+     */
+    void publish(const QVector<Sample>& samples);
+
+   signals:
+    /**
+     * @brief Emit if a client sent a command
+     *
+     * @param device Device number, see `comm::CommMaster::getDeviceNumber`; 0 for the active device
+     * @param command Bytes of the command, see `command.h`
+     */
+    void commandReceived(quint16 device, const QByteArray& command);
+
+   private:
+    /**
+     * @brief Queued batches of a connected client
+     *
+     */
+    struct Client {
+        Framing framing = Framing::TEXT;
+        QQueue<QByteArray> queue;  ///< Batches not handed to the socket yet
+        QQueue<int> counts;        ///< Samples of every queued batch
+        qint64 queued = 0;         ///< Bytes in `queue`
+    };
+
+    /**
+     * @brief Accept the pending connections
+     *
+     */
+    void acceptClients();
+
+    /**
+     * @brief Handle the lines sent by a client
+     *
+     * @param socket Socket of the client
+     */
+    void readClient(QLocalSocket* socket);
+
+    /**
+     * @brief Hand queued batches to the socket while its buffer has room
+     *
+     * @param socket Socket of the client
+     */
+    void flushClient(QLocalSocket* socket);
+
+    /**
+     * @brief Queue a batch, dropping the oldest batches above the limit
+     *
+     * @param client The client
+     * @param frame Encoded batch
+     * @param count Samples in the batch
+     */
+    void enqueue(Client& client, const QByteArray& frame, int count);
+
+    QLocalServer* server;
+    QHash<QLocalSocket*, Client> clients;
+    qint64 queueLimit = DEFAULT_QUEUE_LIMIT;
+    quint64 published = 0;  ///< Index of the next sample
+    quint64 dropped = 0;
+};
+
+}  // namespace stream
+
+#endif  // SAMPLESERVER_H_
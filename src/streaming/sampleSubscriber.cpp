@@ -0,0 +1,139 @@
+/******************************************************************************
+ * Copyright (C) 2023 by Gschwind, Weber, Schoch, Niederberger                *
+ *                                                                            *
+ * This file is part of linescaleGUI.                                         *
+ *                                                                            *
+ * LinescaleGUI is free software: you can redistribute it and/or modify       *
+ * it under the terms of the GNU General Public License as published by       *
+ * the Free Software Foundation, either version 3 of the License, or          *
+ * (at your option) any later version.                                        *
+ *                                                                            *
+ * LinescaleGUI is distributed in the hope that it will be useful,            *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of             *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the               *
+ * GNU General Public License for more details.                               *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License          *
+ * along with linescaleGUI. If not, see <http://www.gnu.org/licenses/>.       *
+ ******************************************************************************/
+/**
+ * @file sampleSubscriber.cpp
+ * @authors Gschwind, Weber, Schoch, Niederberger
+ *
+ * @brief `SampleSubscriber` implementation
+ *
+ */
+
+#include "sampleSubscriber.h"
+#include <cstring>
+
+#if defined(Q_OS_UNIX)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace stream {
+
+SampleSubscriber::~SampleSubscriber() {
+    close();
+}
+
+bool SampleSubscriber::open(const QString& name, bool fromStart) {
+    close();
+#if defined(Q_OS_UNIX)
+    int fd = shm_open(name.toLocal8Bit().constData(), O_RDONLY, 0);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat status;
+    void* memory = MAP_FAILED;
+    size_t size = 0;
+    if (fstat(fd, &status) == 0 && size_t(status.st_size) >= sizeof(RingHeader)) {
+        size = size_t(status.st_size);
+        memory = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    }
+    ::close(fd);
+    if (memory == MAP_FAILED) {
+        return false;
+    }
+
+    const RingHeader* mapped = static_cast<const RingHeader*>(memory);
+    bool valid = mapped->magic == RING_MAGIC;
+    std::atomic_thread_fence(std::memory_order_acquire);  // Pairs with the publisher writing the magic last
+    valid = valid && mapped->version == RING_VERSION && mapped->slotSize == sizeof(RingSlot) &&
+            mapped->capacity > 0 && (mapped->capacity & (mapped->capacity - 1)) == 0 &&
+            ringSize(mapped->capacity) <= size;
+    if (!valid) {
+        munmap(memory, size);
+        return false;
+    }
+
+    header = mapped;
+    ring = reinterpret_cast<const RingSlot*>(static_cast<const char*>(memory) + sizeof(RingHeader));
+    capacity = mapped->capacity;
+    mappedSize = size;
+    quint64 written = header->written.load(std::memory_order_acquire);
+    next = !fromStart ? written : (written > capacity ? written - capacity : 0);
+    lost = 0;
+    return true;
+#else
+    Q_UNUSED(name);
+    Q_UNUSED(fromStart);
+    return false;
+#endif
+}
+
+void SampleSubscriber::close() {
+    if (!isOpen()) {
+        return;
+    }
+#if defined(Q_OS_UNIX)
+    munmap(const_cast<RingHeader*>(header), mappedSize);
+#endif
+    header = nullptr;
+    ring = nullptr;
+}
+
+bool SampleSubscriber::isClosed() const {
+    return !isOpen() || header->closed.load(std::memory_order_acquire) != 0;
+}
+
+quint64 SampleSubscriber::available() const {
+    return isOpen() ? header->written.load(std::memory_order_acquire) - next : 0;
+}
+
+int SampleSubscriber::read(QVector<SharedSample>& samples, int maxCount) {
+    samples.clear();
+    if (!isOpen()) {
+        return 0;
+    }
+    quint64 written = header->written.load(std::memory_order_acquire);
+    while (next < written && samples.size() < maxCount) {
+        if (written - next > capacity) {
+            // The publisher lapped this reader
+            lost += written - capacity - next;
+            next = written - capacity;
+        }
+        const RingSlot& slot = ring[next & (capacity - 1)];
+        quint32 before = slot.lock.load(std::memory_order_acquire);
+        SharedSample copy;
+        std::memcpy(&copy, &slot.sample, sizeof(copy));  // May be torn, checked below
+        std::atomic_thread_fence(std::memory_order_acquire);
+        quint32 after = slot.lock.load(std::memory_order_relaxed);
+
+        if (before != after || (before & 1) != 0 || copy.index != next) {
+            // Overwritten while copying, the publisher is already a lap ahead
+            ++lost;
+            ++next;
+            written = header->written.load(std::memory_order_acquire);
+            continue;
+        }
+        samples.append(copy);
+        ++next;
+    }
+    return samples.size();
+}
+
+}  // namespace stream
@@ -0,0 +1,110 @@
+/******************************************************************************
+ * Copyright (C) 2023 by Gschwind, Weber, Schoch, Niederberger                *
+ *                                                                            *
+ * This file is part of linescaleGUI.                                         *
+ *                                                                            *
+ * LinescaleGUI is free software: you can redistribute it and/or modify       *
+ * it under the terms of the GNU General Public License as published by       *
+ * the Free Software Foundation, either version 3 of the License, or          *
+ * (at your option) any later version.                                        *
+ *                                                                            *
+ * LinescaleGUI is distributed in the hope that it will be useful,            *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of             *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the               *
+ * GNU General Public License for more details.                               *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License          *
+ * along with linescaleGUI. If not, see <http://www.gnu.org/licenses/>.       *
+ ******************************************************************************/
+/**
+ * @file sampleSubscriber.h
+ * @authors Gschwind, Weber, Schoch, Niederberger
+ *
+ * @brief `SampleSubscriber` declaration
+ *
+ */
+
+#pragma once
+#ifndef SAMPLESUBSCRIBER_H_
+#define SAMPLESUBSCRIBER_H_
+
+#include <QString>
+#include <QVector>
+#include "sharedRing.h"
+
+namespace stream {
+
+/**
+ * @brief Read the samples of a `SamplePublisher` in another process
+ *
+ * The ring is mapped read-only. `read` copies the samples published since the
+ * previous call and never blocks the publisher. Poll it as often as the
+ * latency requires; a call without new samples only loads one atomic.
+ *
+ * Only available on Unix, `open` fails elsewhere.
+ */
+class SampleSubscriber {
+   public:
+    SampleSubscriber() = default;
+    SampleSubscriber(const SampleSubscriber&) = delete;
+    SampleSubscriber& operator=(const SampleSubscriber&) = delete;
+
+    /**
+     * @brief Unmap the ring
+     *
+     */
+    ~SampleSubscriber();
+
+    /**
+     * @brief Map a ring
+     *
+     * @param name Name of the shared memory object, see `SamplePublisher::open`
+     * @param fromStart Read the samples still in the ring, otherwise only new samples
+     * @return true if a ring with a matching layout was mapped
+     */
+    bool open(const QString& name = DEFAULT_RING_NAME, bool fromStart = false);
+
+    /**
+     * @brief Unmap the ring
+     *
+     */
+    void close();
+
+    bool isOpen() const { return header != nullptr; }  ///< True between `open` and `close`
+    quint64 getLost() const { return lost; }            ///< Samples overwritten before they were read
+
+    /**
+     * @brief Check if the publisher closed or replaced the ring
+     *
+     * @return true if the ring has to be opened again
+     */
+    bool isClosed() const;
+
+    /**
+     * @brief Number of published samples not read yet, including the ones already lost
+     *
+     * @return quint64 Samples behind the publisher
+     */
+    quint64 available() const;
+
+    /**
+     * @brief Copy the samples published since the previous call
+     *
+     * @param samples Cleared, then the new samples, oldest first
+     * @param maxCount Maximum number of samples to copy
+     * @return int Number of samples copied
+     */
+    int read(QVector<SharedSample>& samples, int maxCount = 4096);
+
+   private:
+    const RingHeader* header = nullptr;  ///< Start of the mapping
+    const RingSlot* ring = nullptr;      ///< Follows the header
+    quint32 capacity = 0;
+    size_t mappedSize = 0;
+    quint64 next = 0;  ///< Index of the next sample to read
+    quint64 lost = 0;
+};
+
+}  // namespace stream
+
+#endif  // SAMPLESUBSCRIBER_H_
@@ -0,0 +1,126 @@
+/******************************************************************************
+ * Copyright (C) 2023 by Gschwind, Weber, Schoch, Niederberger                *
+ *                                                                            *
+ * This file is part of linescaleGUI.                                         *
+ *                                                                            *
+ * LinescaleGUI is free software: you can redistribute it and/or modify       *
+ * it under the terms of the GNU General Public License as published by       *
+ * the Free Software Foundation, either version 3 of the License, or          *
+ * (at your option) any later version.                                        *
+ *                                                                            *
+ * LinescaleGUI is distributed in the hope that it will be useful,            *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of             *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the               *
+ * GNU General Public License for more details.                               *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License          *
+ * along with linescaleGUI. If not, see <http://www.gnu.org/licenses/>.       *
+ ******************************************************************************/
+/**
+ * @file sharedRing.h
+ * @authors Gschwind, Weber, Schoch, Niederberger
+ *
+ * @brief Layout of the shared memory ring written by `SamplePublisher`
+ *
+ * The layout is fixed, so tools written in other languages can map the ring:
+ *
+ * | Offset            | Size | Content                                       |
+ * |-------------------|------|-----------------------------------------------|
+ * | 0                 | 64   | `RingHeader`                                  |
+ * | 64                | 64   | `RingHeader::written`, alone on a cache line  |
+ * | 128 + 64 * n      | 64   | `RingSlot` n, n < `RingHeader::capacity`      |
+ *
+ * All values are in the byte order of the host.
+ *
+ */
+
+#pragma once
+#ifndef SHAREDRING_H_
+#define SHAREDRING_H_
+
+#include <QtGlobal>
+#include <atomic>
+#include <cstddef>
+
+namespace stream {
+
+/// @todo Better way to disable the padding warning for MSVC.
+#if _MSC_VER && !__INTEL_COMPILER
+#pragma warning(push)
+#pragma warning(disable : 4324)
+#endif
+
+static_assert(std::atomic<quint32>::is_always_lock_free, "Shared atomics have to be lock free");
+static_assert(std::atomic<quint64>::is_always_lock_free, "Shared atomics have to be lock free");
+
+constexpr quint32 RING_MAGIC = 0x4d53534c;  ///< "LSSM" in little endian
+constexpr quint32 RING_VERSION = 1;         ///< Incremented with every change of the layout
+constexpr char DEFAULT_RING_NAME[] = "/linescale-samples";  ///< Name for `shm_open`
+
+/**
+ * @brief Sample as published, a subset of `Sample`
+ *
+ */
+struct SharedSample {
+    quint64 index;          ///< Position in the published stream, starting at 0
+    qint64 timestamp;       ///< Arrival time in ns of the monotonic clock, shared by all processes; 0 if unknown
+    quint64 sequence;       ///< `Sample::sequence`; 0 if unknown
+    double force;           ///< Measured force in `unit`
+    double referenceZero;   ///< Reference force in `unit`
+    quint16 deviceId;       ///< `Sample::deviceId`; 0 if unknown
+    quint8 unit;            ///< `UnitValue` as number
+    quint8 mode;            ///< `MeasureMode` as number
+    quint16 frequency;      ///< Frequency of the device in Hz
+    quint8 battery;         ///< Battery in percent
+    quint8 reserved = 0;    ///< Always 0
+};
+
+/**
+ * @brief One sample, guarded by a sequence lock
+ *
+ * `lock` is odd while the publisher writes the slot. A reader copies the
+ * sample and accepts the copy only if `lock` was even and did not change
+ * meanwhile, so the publisher never waits for a reader.
+ */
+struct alignas(64) RingSlot {
+    std::atomic<quint32> lock{0};  ///< Sequence lock, odd while written
+    quint32 reserved = 0;          ///< Always 0
+    SharedSample sample;           ///< Valid if `lock` is even and unchanged
+};
+
+/**
+ * @brief Start of the shared memory
+ *
+ */
+struct alignas(64) RingHeader {
+    quint32 magic;     ///< `RING_MAGIC`, written last when the ring is created
+    quint32 version;   ///< `RING_VERSION`
+    quint32 capacity;  ///< Number of slots, a power of two
+    quint32 slotSize;  ///< `sizeof(RingSlot)`
+    std::atomic<quint32> closed{0};  ///< 1 after the publisher closed the ring; map it again
+    quint32 owner;     ///< Process ID of the publisher
+
+    alignas(64) std::atomic<quint64> written{0};  ///< Samples published; sample n is in slot `n % capacity`
+};
+
+static_assert(sizeof(SharedSample) == 48, "Layout of SharedSample changed");
+static_assert(sizeof(RingSlot) == 64, "Layout of RingSlot changed");
+static_assert(sizeof(RingHeader) == 128, "Layout of RingHeader changed");
+
+/**
+ * @brief Size of the shared memory of a ring
+ *
+ * @param capacity Number of slots
+ * @return size_t Size in bytes
+ */
+constexpr size_t ringSize(quint32 capacity) {
+    return sizeof(RingHeader) + size_t(capacity) * sizeof(RingSlot);
+}
+
+#if _MSC_VER && !__INTEL_COMPILER
+#pragma warning(pop)
+#endif
+
+}  // namespace stream
+
+#endif  // SHAREDRING_H_
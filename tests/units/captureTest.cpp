@@ -0,0 +1,278 @@
+/******************************************************************************
+ * Copyright (C) 2023 by Gschwind, Weber, Schoch, Niederberger                *
+ *                                                                            *
+ * This file is part of linescaleGUI.                                         *
+ *                                                                            *
+ * LinescaleGUI is free software: you can redistribute it and/or modify       *
+ * it under the terms of the GNU General Public License as published by       *
+ * the Free Software Foundation, either version 3 of the License, or          *
+ * (at your option) any later version.                                        *
+ *                                                                            *
+ * LinescaleGUI is distributed in the hope that it will be useful,            *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of             *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the               *
+ * GNU General Public License for more details.                               *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License          *
+ * along with linescaleGUI. If not, see <http://www.gnu.org/licenses/>.       *
+ ******************************************************************************/
+/**
+ * @file captureTest.cpp
+ * @authors Gschwind, Weber, Schoch, Niederberger
+ *
+ * @brief Test class for the raw captures
+ *
+ * Writes captures with `comm::CaptureWriter`, reads them back and checks that
+ * decoding a capture always gives the same samples.
+ *
+ */
+
+#include <gtest/gtest.h>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QThread>
+#include <array>
+#include <vector>
+#include "../../src/deviceCommunication/captureReader.h"
+#include "../../src/deviceCommunication/captureWriter.h"
+#include "../../src/deviceCommunication/command.h"
+#include "../../src/deviceCommunication/packetDecoder.h"
+#include "../../src/deviceCommunication/replayDevice.h"
+#include "../../src/simulator/frameGenerator.h"
+
+namespace {
+
+/**
+ * @brief Write a capture of simulated reads with transmission errors
+ *
+ * @param path Path of the capture
+ * @return QByteArray All captured bytes
+ */
+QByteArray writeCapture(const QString& path) {
+    sim::SimulatorConfig config;
+    config.corruptionRate = 0.05;
+    config.maxChunk = 90;
+    config.seed = 7;
+    sim::FrameGenerator generator(config);
+    generator.receive(command::SETSPEED640);
+
+    comm::CaptureWriter writer;
+    EXPECT_TRUE(writer.open(path, "/dev/ttyUSB0"));
+    QByteArray bytes;
+    int64_t arrival = 1000000000;
+    for (const QByteArray& chunk : generator.split(generator.nextFrames(2000))) {
+        writer.append(arrival, chunk.constData(), size_t(chunk.size()));
+        bytes += chunk;
+        arrival += 1562500;  // 640 Hz, one frame per read on average
+    }
+    writer.close();
+    EXPECT_EQ(writer.getStatistics().bytesCaptured, quint64(bytes.size()));
+    EXPECT_EQ(writer.getStatistics().bytesDropped, 0u);
+    EXPECT_FALSE(writer.getStatistics().failed);
+    return bytes;
+}
+
+/**
+ * @brief Decode a capture like `linescale-reparse`
+ *
+ * @param path Path of the capture
+ * @param decoder Decoder of the capture
+ * @return QVector<Sample> All parsed samples
+ */
+QVector<Sample> decodeCapture(const QString& path, comm::PacketDecoder& decoder) {
+    QVector<Sample> samples;
+    comm::CaptureReader reader;
+    EXPECT_TRUE(reader.open(path));
+    comm::CaptureRecord record;
+    while (reader.next(record)) {
+        decoder.write(record.data, record.length);
+        decoder.decode(record.arrival, 1, [&samples](const Sample* parsed, size_t count) {
+            samples += QVector<Sample>(parsed, parsed + count);
+        });
+    }
+    EXPECT_FALSE(reader.isTruncated());
+    return samples;
+}
+
+}  // namespace
+
+TEST(CaptureTest, writeAndRead) {
+    const QString path = "capture_read.lsraw";
+    comm::CaptureWriter writer;
+    ASSERT_TRUE(writer.open(path, "COM101"));
+    EXPECT_TRUE(writer.isOpen());
+    writer.append(5, "abc", 3);
+    writer.append(7, "", 0);  // Nothing read, nothing captured
+    writer.append(9, "defgh", 5);
+    writer.close();
+    EXPECT_FALSE(writer.isOpen());
+
+    comm::CaptureReader reader;
+    ASSERT_TRUE(reader.open(path));
+    EXPECT_EQ(reader.getDeviceId(), "COM101");
+    comm::CaptureRecord record;
+    ASSERT_TRUE(reader.next(record));
+    EXPECT_EQ(record.arrival, 5);
+    EXPECT_EQ(QByteArray(record.data, int(record.length)), "abc");
+    qint64 second = reader.getOffset();
+    ASSERT_TRUE(reader.next(record));
+    EXPECT_EQ(record.arrival, 9);
+    EXPECT_EQ(QByteArray(record.data, int(record.length)), "defgh");
+    EXPECT_FALSE(reader.next(record));
+    EXPECT_FALSE(reader.isTruncated());
+    EXPECT_EQ(reader.getOffset(), reader.getSize());
+
+    reader.setOffset(second);
+    ASSERT_TRUE(reader.next(record));
+    EXPECT_EQ(record.arrival, 9);
+    reader.close();
+    QFile::remove(path);
+}
+
+TEST(CaptureTest, truncatedAndInvalid) {
+    const QString path = "capture_truncated.lsraw";
+    comm::CaptureWriter writer;
+    ASSERT_TRUE(writer.open(path, "COM101"));
+    writer.append(5, "abc", 3);
+    writer.close();
+
+    // A record cut off by a crash
+    QFile file(path);
+    ASSERT_TRUE(file.open(QIODevice::Append));
+    std::array<char, 14> partial{};
+    partial[8] = 10;  // Length of the data
+    file.write(partial.data(), qint64(partial.size()));
+    file.close();
+
+    comm::CaptureReader reader;
+    ASSERT_TRUE(reader.open(path));
+    comm::CaptureRecord record;
+    EXPECT_TRUE(reader.next(record));
+    EXPECT_FALSE(reader.next(record));
+    EXPECT_TRUE(reader.isTruncated());
+    reader.close();
+
+    ASSERT_TRUE(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    file.write("R-00.01N000.00?NF41\r");
+    file.close();
+    EXPECT_FALSE(reader.open(path));
+    EXPECT_FALSE(reader.open("capture_missing.lsraw"));
+    QFile::remove(path);
+}
+
+TEST(CaptureTest, dropRecords) {
+    const QString path = "capture_drop.lsraw";
+    // Larger than the queue, so it is always dropped
+    std::vector<char> tooLarge(comm::CaptureWriter::QUEUE_CAPACITY);
+    comm::CaptureWriter writer;
+    ASSERT_TRUE(writer.open(path, "COM101"));
+    writer.append(5, "abc", 3);
+    writer.append(6, tooLarge.data(), tooLarge.size());
+    writer.append(7, tooLarge.data(), tooLarge.size());
+    writer.append(9, "defgh", 5);
+    writer.append(11, tooLarge.data(), tooLarge.size());
+    writer.close();
+    EXPECT_EQ(writer.getStatistics().bytesDropped, 3 * tooLarge.size());
+    EXPECT_EQ(writer.getStatistics().readsDropped, 3u);
+
+    comm::CaptureReader reader;
+    ASSERT_TRUE(reader.open(path));
+    comm::CaptureRecord record;
+    ASSERT_TRUE(reader.next(record));
+    EXPECT_FALSE(record.isDrop());
+    ASSERT_TRUE(reader.next(record));
+    EXPECT_TRUE(record.isDrop());
+    EXPECT_EQ(record.arrival, 6);
+    EXPECT_EQ(record.bytesLost, 2 * tooLarge.size());
+    EXPECT_EQ(record.readsLost, 2u);
+    ASSERT_TRUE(reader.next(record));
+    EXPECT_EQ(record.arrival, 9);
+    EXPECT_EQ(QByteArray(record.data, int(record.length)), "defgh");
+    EXPECT_EQ(record.bytesLost, 0u);
+    ASSERT_TRUE(reader.next(record));  // Written by `close`
+    EXPECT_TRUE(record.isDrop());
+    EXPECT_EQ(record.arrival, 11);
+    EXPECT_EQ(record.bytesLost, tooLarge.size());
+    EXPECT_FALSE(reader.next(record));
+    EXPECT_FALSE(reader.isTruncated());
+    reader.close();
+    QFile::remove(path);
+}
+
+TEST(CaptureTest, unknownVersion) {
+    const QString path = "capture_version.lsraw";
+    QFile file(path);
+    ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+    std::array<char, 20> contents{'L', 'S', 'R', 'W', char(comm::CAPTURE_VERSION + 1), 0, 0, 0, 5, 0};
+    file.write(contents.data(), qint64(contents.size()));
+    file.close();
+
+    comm::CaptureReader reader;
+    EXPECT_FALSE(reader.open(path));
+    QFile::remove(path);
+}
+
+TEST(CaptureTest, reparseIsDeterministic) {
+    const QString path = "capture_reparse.lsraw";
+    QByteArray bytes = writeCapture(path);
+
+    comm::PacketDecoder first, second;
+    QVector<Sample> samples = decodeCapture(path, first);
+    QVector<Sample> again = decodeCapture(path, second);
+    ASSERT_EQ(samples.size(), again.size());
+    for (int i = 0; i < samples.size(); ++i) {
+        ASSERT_EQ(samples[i].sequence, again[i].sequence);
+        ASSERT_EQ(samples[i].timestamp, again[i].timestamp);
+        ASSERT_EQ(samples[i].measuredValue, again[i].measuredValue);
+    }
+
+    const comm::FramerStatistics& statistics = first.getStatistics();
+    EXPECT_EQ(statistics.bytesReceived, quint64(bytes.size()));
+    EXPECT_GT(statistics.framesRejected + statistics.bytesDropped, 0u);  // The corrupted frames
+    EXPECT_EQ(quint64(samples.size()), statistics.framesExtracted - statistics.framesRejected);
+    quint64 rejected = 0;
+    for (size_t status = 0; status < comm::PacketDecoder::STATUS_COUNT; ++status) {
+        rejected += first.getRejected(ParseStatus(status));
+    }
+    EXPECT_EQ(rejected, statistics.framesRejected);
+    EXPECT_EQ(first.getRejected(ParseStatus::OK), 0u);
+    QFile::remove(path);
+}
+
+TEST(CaptureTest, replayCapture) {
+    const QString path = "capture_replay.lsraw";
+    writeCapture(path);
+    comm::PacketDecoder decoder;
+    QVector<Sample> expected = decodeCapture(path, decoder);
+
+    comm::DeviceInfo info{comm::ConnType::REPLAY, path, 0};
+    info.replaySpeed = 0.0;
+    comm::ReplayDevice device(info);
+    ASSERT_TRUE(device.connectDevice());
+    device.sendData(command::REQUESTONLINE);
+
+    QVector<Sample> samples;
+    std::array<Sample, 256> buffer;
+    QElapsedTimer timer;
+    timer.start();
+    while (device.getStatus() && timer.elapsed() < 10000) {
+        size_t taken = device.takeSamples(buffer.data(), buffer.size());
+        samples += QVector<Sample>(buffer.data(), buffer.data() + taken);
+        QCoreApplication::processEvents();
+        if (taken == 0) {
+            QThread::msleep(1);
+        }
+    }
+    ASSERT_FALSE(device.getStatus());
+    ASSERT_EQ(samples.size(), expected.size());
+    for (int i = 0; i < samples.size(); ++i) {
+        ASSERT_EQ(samples[i].sequence, expected[i].sequence);  // Timestamps are taken at the replay
+        ASSERT_EQ(samples[i].measuredValue, expected[i].measuredValue);
+    }
+    comm::ReplayStatistics statistics = device.getStatistics();
+    EXPECT_TRUE(statistics.finished);
+    EXPECT_EQ(statistics.position, statistics.total);
+    EXPECT_GT(statistics.replayed, 0.0);
+    QFile::remove(path);
+}
@@ -0,0 +1,128 @@
+/******************************************************************************
+ * Copyright (C) 2023 by Gschwind, Weber, Schoch, Niederberger                *
+ *                                                                            *
+ * This file is part of linescaleGUI.                                         *
+ *                                                                            *
+ * LinescaleGUI is free software: you can redistribute it and/or modify       *
+ * it under the terms of the GNU General Public License as published by       *
+ * the Free Software Foundation, either version 3 of the License, or          *
+ * (at your option) any later version.                                        *
+ *                                                                            *
+ * LinescaleGUI is distributed in the hope that it will be useful,            *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of             *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the               *
+ * GNU General Public License for more details.                               *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License          *
+ * along with linescaleGUI. If not, see <http://www.gnu.org/licenses/>.       *
+ ******************************************************************************/
+/**
+ * @file commMasterTest.cpp
+ * @authors Gschwind, Weber, Schoch, Niederberger
+ *
+ * @brief Test class for the merge stage of the communication master
+ *
+ */
+
+#include <gtest/gtest.h>
+#include <QMetaObject>
+#include <QVector>
+#include "../../src/deviceCommunication/commMaster.h"
+
+namespace {
+
+constexpr int64_t MS = 1000000;
+
+/**
+ * @brief Create a timestamped sample in kN
+ *
+ * @param deviceId Device number
+ * @param timestamp Arrival time in ns
+ * @param force Measured force in kN
+ * @return Sample
+ */
+Sample makeSample(uint16_t deviceId, int64_t timestamp, double force) {
+    Sample sample{};
+    sample.unitValue = UnitValue::KN;
+    sample.measuredValue = force;
+    sample.timestamp = timestamp;
+    sample.deviceId = deviceId;
+    return sample;
+}
+
+/**
+ * @brief Output of one `CommMaster::newAlignedFrames`
+ */
+struct AlignedOutput {
+    QVector<comm::AlignedFrame> frames;
+    QVector<quint16> devices;
+    QVector<double> forces;
+};
+
+/**
+ * @brief Feed a batch of samples to the master as if a device had sent it
+ *
+ * @param comm Master with merging enabled
+ * @param readings Samples of the batch
+ * @return Output emitted for the batch
+ */
+QVector<AlignedOutput> feed(comm::CommMaster& comm, const QVector<Sample>& readings) {
+    QVector<AlignedOutput> outputs;
+    QMetaObject::Connection connection = QObject::connect(
+        &comm, &comm::CommMaster::newAlignedFrames,
+        [&](const QVector<comm::AlignedFrame>& frames, const QVector<quint16>& devices,
+            const QVector<double>& forces) { outputs.append({frames, devices, forces}); });
+    QMetaObject::invokeMethod(&comm, "receiveSamplesMaster", Qt::DirectConnection,
+                              Q_ARG(QVector<Sample>, readings));
+    QObject::disconnect(connection);
+    return outputs;
+}
+
+TEST(CommMasterTest, AlignTwoDevicesLinear) {
+    comm::CommMaster comm;
+    comm.setMerging(true, comm::Interpolation::LINEAR, 100);
+
+    // The second device is drained first, the columns are still ordered by device number
+    QVector<Sample> readings = {makeSample(2, 10 * MS, 1.0), makeSample(2, 35 * MS, 1.0),
+                                makeSample(1, 10 * MS, 0.0), makeSample(1, 30 * MS, 2.0)};
+    QVector<AlignedOutput> outputs = feed(comm, readings);
+    ASSERT_EQ(outputs.size(), 1);
+    const AlignedOutput& output = outputs[0];
+    ASSERT_EQ(output.devices, QVector<quint16>({1, 2}));
+    ASSERT_EQ(output.frames.size(), 3);  // 10, 20 and 30 ms
+    ASSERT_EQ(output.forces.size(), 6);
+
+    EXPECT_EQ(output.frames[1].timestamp, 20 * MS);
+    EXPECT_DOUBLE_EQ(output.forces[2], 1.0);
+    EXPECT_DOUBLE_EQ(output.forces[3], 1.0);
+    EXPECT_DOUBLE_EQ(output.frames[1].total, 2.0);
+    EXPECT_EQ(output.frames[1].devices, 2u);
+}
+
+TEST(CommMasterTest, AlignTwoDevicesInBatches) {
+    comm::CommMaster comm;
+    comm.setMerging(true, comm::Interpolation::ZERO_ORDER_HOLD, 100);
+
+    Sample kgf = makeSample(2, 10 * MS, 101.9716213);
+    kgf.unitValue = UnitValue::KGF;
+    QVector<AlignedOutput> outputs = feed(comm, {makeSample(1, 10 * MS, 3.0), kgf});
+    ASSERT_EQ(outputs.size(), 1);
+    ASSERT_EQ(outputs[0].frames.size(), 1);
+    EXPECT_NEAR(outputs[0].forces[1], 1.0, 1e-9);  // kgf converted to kN
+
+    // The values of the first batch are held until the next samples at 30 ms
+    outputs = feed(comm, {makeSample(1, 30 * MS, 5.0), makeSample(2, 30 * MS, 0.5)});
+    ASSERT_EQ(outputs.size(), 1);
+    const AlignedOutput& output = outputs[0];
+    ASSERT_EQ(output.devices, QVector<quint16>({1, 2}));
+    ASSERT_EQ(output.frames.size(), 2);
+    EXPECT_EQ(output.frames[0].timestamp, 20 * MS);
+    EXPECT_DOUBLE_EQ(output.forces[0], 3.0);
+    EXPECT_NEAR(output.forces[1], 1.0, 1e-9);
+    EXPECT_EQ(output.frames[1].timestamp, 30 * MS);
+    EXPECT_DOUBLE_EQ(output.forces[2], 5.0);
+    EXPECT_DOUBLE_EQ(output.forces[3], 0.5);
+    EXPECT_DOUBLE_EQ(output.frames[1].total, 5.5);
+}
+
+}  // namespace
@@ -0,0 +1,120 @@
+/******************************************************************************
+ * Copyright (C) 2023 by Gschwind, Weber, Schoch, Niederberger                *
+ *                                                                            *
+ * This file is part of linescaleGUI.                                         *
+ *                                                                            *
+ * LinescaleGUI is free software: you can redistribute it and/or modify       *
+ * it under the terms of the GNU General Public License as published by       *
+ * the Free Software Foundation, either version 3 of the License, or          *
+ * (at your option) any later version.                                        *
+ *                                                                            *
+ * LinescaleGUI is distributed in the hope that it will be useful,            *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of             *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the               *
+ * GNU General Public License for more details.                               *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License          *
+ * along with linescaleGUI. If not, see <http://www.gnu.org/licenses/>.       *
+ ******************************************************************************/
+/**
+ * @file frameGeneratorTest.cpp
+ * @authors Gschwind, Weber, Schoch, Niederberger
+ *
+ * @brief Test class for the LineScale simulator
+ *
+ */
+
+#include <gtest/gtest.h>
+#include "../../src/deviceCommunication/command.h"
+#include "../../src/parser/frameValidator.h"
+#include "../../src/parser/parser.h"
+#include "../../src/simulator/frameGenerator.h"
+
+namespace {
+
+TEST(FrameGeneratorTest, EncodeMatchesParser) {
+    char frame[Parser::PACKET_EXPECTED_LEN];
+    Sample sample{};
+    sample.workingMode = WorkingMode::REALTIME;
+    sample.measuredValue = -0.01;
+    sample.measureMode = MeasureMode::ABS_ZERO;
+    sample.batteryPercent = 62;
+    sample.unitValue = UnitValue::KN;
+    sample.frequency = 40;
+    sim::FrameGenerator::encodeFrame(sample, frame);
+    EXPECT_EQ(QByteArray(frame, Parser::PACKET_EXPECTED_LEN), QByteArray("R-00.01N000.00?NF41\r"));
+}
+
+TEST(FrameGeneratorTest, GeneratedFramesAreValid) {
+    sim::SimulatorConfig config;
+    config.amplitude = 300.0;  // needs fewer decimals for large values
+    sim::FrameGenerator generator(config);
+    QByteArray frames = generator.nextFrames(100);
+
+    Parser parser;
+    Sample samples[100];
+    EXPECT_EQ(parser.parseBatch(frames.constData(), size_t(frames.size()), samples), 100u);
+    EXPECT_EQ(samples[0].frequency, 10);
+}
+
+TEST(FrameGeneratorTest, CorruptionAndSplitting) {
+    sim::SimulatorConfig config;
+    config.corruptionRate = 1.0;
+    config.maxChunk = 7;
+    sim::FrameGenerator generator(config);
+    QByteArray frames = generator.nextFrames(50);
+
+    // The validator also checks the terminator
+    EXPECT_EQ(FrameValidator::validate(frames.constData(), 50), 0u);
+
+    QByteArray joined;
+    for (const QByteArray& chunk : generator.split(frames)) {
+        EXPECT_LE(chunk.size(), 7);
+        joined.append(chunk);
+    }
+    EXPECT_EQ(joined, frames);
+}
+
+TEST(FrameGeneratorTest, ReplayConvertsUnit) {
+    sim::FrameGenerator generator;
+    generator.setReplay({101.9716213f}, UnitValue::KGF);
+
+    Parser parser;
+    Sample sample;
+    QByteArray frame = generator.nextFrames(1);
+    ASSERT_TRUE(parser.parsePackage(frame, sample));
+    EXPECT_EQ(sample.unitValue, UnitValue::KN);
+    EXPECT_NEAR(sample.measuredValue, 1.0, 0.01);
+
+    generator.receive(command::SWITCHTOLBF);
+    frame = generator.nextFrames(1);
+    ASSERT_TRUE(parser.parsePackage(frame, sample));
+    EXPECT_EQ(sample.unitValue, UnitValue::LBF);
+    EXPECT_NEAR(sample.measuredValue, 224.81, 0.01);
+}
+
+TEST(FrameGeneratorTest, Commands) {
+    sim::FrameGenerator generator;
+    EXPECT_FALSE(generator.isOnline());
+    // Split in the middle of a command
+    QByteArray commands = command::REQUESTONLINE + command::SETSPEED1280 + command::SWITCHTOLBF;
+    EXPECT_EQ(generator.receive(commands.left(5)), 1);
+    EXPECT_EQ(generator.receive(commands.mid(5)), 2);
+    EXPECT_TRUE(generator.isOnline());
+    EXPECT_EQ(generator.getFrequency(), 1280);
+
+    Parser parser;
+    Sample sample;
+    QByteArray frame = generator.nextFrames(1);
+    ASSERT_TRUE(parser.parsePackage(frame, sample));
+    EXPECT_EQ(sample.unitValue, UnitValue::LBF);
+    EXPECT_EQ(sample.frequency, 1280);
+
+    // Invalid checksum
+    QByteArray invalid = command::POWEROFF;
+    invalid[3] = 0;
+    EXPECT_EQ(generator.receive(invalid + command::READLASTLOG), 1);
+    EXPECT_FALSE(generator.isPoweredOff());
+}
+
+}  // namespace
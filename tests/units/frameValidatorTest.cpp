@@ -0,0 +1,107 @@
+/******************************************************************************
+ * Copyright (C) 2023 by Gschwind, Weber, Schoch, Niederberger                *
+ *                                                                            *
+ * This file is part of linescaleGUI.                                         *
+ *                                                                            *
+ * LinescaleGUI is free software: you can redistribute it and/or modify       *
+ * it under the terms of the GNU General Public License as published by       *
+ * the Free Software Foundation, either version 3 of the License, or          *
+ * (at your option) any later version.                                        *
+ *                                                                            *
+ * LinescaleGUI is distributed in the hope that it will be useful,            *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of             *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the               *
+ * GNU General Public License for more details.                               *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License          *
+ * along with linescaleGUI. If not, see <http://www.gnu.org/licenses/>.       *
+ ******************************************************************************/
+/**
+ * @file frameValidatorTest.cpp
+ * @authors Gschwind, Weber, Schoch, Niederberger
+ *
+ * @brief Test class for the frame validator
+ *
+ * Checks that all implementations of the validator agree with the scalar
+ * implementation and with `Parser::parsePackage`.
+ *
+ */
+
+#include <gtest/gtest.h>
+#include <string>
+#include "../../src/parser/frameValidator.h"
+#include "../../src/parser/parser.h"
+
+namespace {
+
+const std::string validPackages[] = {
+    "R-00.01N000.00?NF41\r", "R000.63Z-32.84RNS10\r", "R000019Z000001RGS95\r",
+    "O-00.01N000.00?NF38\r", "C-00.01N000.00?NF26\r", "R-00.01N000.00?NQ52\r",
+};
+
+/**
+ * @brief Create a burst of `count` packets, every `corruptEvery`th packet has a flipped byte
+ *
+ * @param count Number of packets
+ * @param corruptEvery Period of the corrupted packets; 0 for no corruption
+ * @return std::string Packets back-to-back
+ */
+std::string makeBurst(size_t count, size_t corruptEvery) {
+    std::string burst;
+    for (size_t i = 0; i < count; ++i) {
+        std::string package = validPackages[i % (sizeof(validPackages) / sizeof(validPackages[0]))];
+        if (corruptEvery != 0 && i % corruptEvery == 0) {
+            package[(i * 7) % Parser::PACKET_EXPECTED_LEN] ^= 0x5A;
+        }
+        burst += package;
+    }
+    return burst;
+}
+
+const FrameValidator::Implementation implementations[] = {
+    FrameValidator::Implementation::SCALAR,
+    FrameValidator::Implementation::SSE2,
+    FrameValidator::Implementation::AVX2,
+};
+
+TEST(FrameValidatorTest, AllValid) {
+    std::string burst = makeBurst(64, 0);
+    for (auto implementation : implementations) {
+        EXPECT_EQ(FrameValidator::validateWith(implementation, burst.data(), 64), ~uint64_t(0));
+        EXPECT_EQ(FrameValidator::validateWith(implementation, burst.data(), 17), (uint64_t(1) << 17) - 1);
+    }
+}
+
+TEST(FrameValidatorTest, ImplementationsAgreeWithParser) {
+    std::string burst = makeBurst(63, 3);
+    Parser parser;
+    uint64_t expected = 0;
+    for (size_t i = 0; i < 63; ++i) {
+        QByteArray package(burst.data() + i * Parser::PACKET_EXPECTED_LEN, Parser::PACKET_EXPECTED_LEN);
+        Sample sample;
+        // The parser itself does not check the terminator, that is done while framing
+        bool valid = parser.parsePackage(package, sample) && package.at(Parser::PACKET_EXPECTED_LEN - 1) == '\r';
+        expected |= uint64_t(valid) << i;
+    }
+    for (auto implementation : implementations) {
+        EXPECT_EQ(FrameValidator::validateWith(implementation, burst.data(), 63), expected);
+    }
+}
+
+TEST(FrameValidatorTest, MissingTerminator) {
+    std::string burst = makeBurst(2, 0);
+    burst[Parser::PACKET_EXPECTED_LEN - 1] = '\n';
+    for (auto implementation : implementations) {
+        EXPECT_EQ(FrameValidator::validateWith(implementation, burst.data(), 2), 0b10u);
+    }
+}
+
+TEST(FrameValidatorTest, ValidateManyMasks) {
+    std::string burst = makeBurst(130, 10);
+    uint64_t masks[3];
+    size_t valid = FrameValidator::validate(burst.data(), 130, masks);
+    EXPECT_EQ(valid, 130u - 13u);
+    EXPECT_EQ(masks[2] >> 2, 0u);
+}
+
+}  // namespace
@@ -0,0 +1,128 @@
+/******************************************************************************
+ * Copyright (C) 2023 by Gschwind, Weber, Schoch, Niederberger                *
+ *                                                                            *
+ * This file is part of linescaleGUI.                                         *
+ *                                                                            *
+ * LinescaleGUI is free software: you can redistribute it and/or modify       *
+ * it under the terms of the GNU General Public License as published by       *
+ * the Free Software Foundation, either version 3 of the License, or          *
+ * (at your option) any later version.                                        *
+ *                                                                            *
+ * LinescaleGUI is distributed in the hope that it will be useful,            *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of             *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the               *
+ * GNU General Public License for more details.                               *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License          *
+ * along with linescaleGUI. If not, see <http://www.gnu.org/licenses/>.       *
+ ******************************************************************************/
+/**
+ * @file framerTest.cpp
+ * @authors Gschwind, Weber, Schoch, Niederberger
+ *
+ * @brief Test class for the framer
+ *
+ * Feeds clean, split and garbled streams into `comm::Framer` and checks the
+ * extracted frames and the statistics.
+ *
+ */
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <string>
+#include "../../src/deviceCommunication/framer.h"
+
+namespace {
+
+constexpr size_t FRAME_LEN = 20;
+const std::string packageA = "R-00.01N000.00?NF41\r";
+const std::string packageB = "R000.63Z-32.84RNS10\r";
+
+/**
+ * @brief Extract all frames currently available in the framer
+ *
+ * @param framer Framer to extract from
+ * @return std::string Extracted frames back-to-back
+ */
+std::string extractAll(comm::Framer& framer) {
+    std::string result;
+    char output[4 * FRAME_LEN];
+    size_t frames;
+    while ((frames = framer.extractFrames(output, 4)) > 0) {
+        result.append(output, frames * FRAME_LEN);
+    }
+    return result;
+}
+
+TEST(FramerTest, CleanStream) {
+    comm::Framer framer(FRAME_LEN);
+    std::string stream = packageA + packageB + packageA;
+    framer.write(stream.data(), stream.size());
+    EXPECT_EQ(extractAll(framer), stream);
+    EXPECT_EQ(framer.size(), 0u);
+    EXPECT_EQ(framer.getStatistics().framesExtracted, 3u);
+    EXPECT_EQ(framer.getStatistics().resyncEvents, 0u);
+    EXPECT_EQ(framer.getStatistics().bytesDropped, 0u);
+}
+
+TEST(FramerTest, SplitPackage) {
+    comm::Framer framer(FRAME_LEN);
+    framer.write(packageA.data(), 7);
+    EXPECT_EQ(extractAll(framer), "");
+    framer.write(packageA.data() + 7, FRAME_LEN - 7);
+    EXPECT_EQ(extractAll(framer), packageA);
+}
+
+TEST(FramerTest, ResyncAfterGarbage) {
+    comm::Framer framer(FRAME_LEN);
+    std::string stream = "xyz" + packageA + "\r12" + packageB;
+    framer.write(stream.data(), stream.size());
+    EXPECT_EQ(extractAll(framer), packageA + packageB);
+    EXPECT_EQ(framer.getStatistics().bytesDropped, 6u);
+    EXPECT_EQ(framer.getStatistics().resyncEvents, 2u);
+}
+
+TEST(FramerTest, GarbageWithoutTerminator) {
+    comm::Framer framer(FRAME_LEN);
+    std::string garbage(100, 'x');
+    framer.write(garbage.data(), garbage.size());
+    EXPECT_EQ(extractAll(framer), "");
+    EXPECT_EQ(framer.size(), FRAME_LEN - 1);  // could still be the start of a frame
+    framer.write(packageA.data(), packageA.size());
+    EXPECT_EQ(extractAll(framer), packageA);
+    EXPECT_EQ(framer.getStatistics().bytesDropped, 100u);
+    EXPECT_EQ(framer.getStatistics().resyncEvents, 1u);
+}
+
+TEST(FramerTest, WrapAroundWithWriteBuffer) {
+    comm::Framer framer(FRAME_LEN, 64);
+    std::string expected;
+    for (int i = 0; i < 10; ++i) {
+        const std::string& package = i % 2 ? packageA : packageB;
+        size_t written = 0;
+        while (written < package.size()) {
+            size_t available;
+            char* destination = framer.writeBuffer(available);
+            size_t chunk = std::min(available, package.size() - written);
+            std::copy_n(package.data() + written, chunk, destination);
+            framer.commit(chunk);
+            written += chunk;
+        }
+        expected += package;
+        if (i % 3 == 2) {
+            EXPECT_EQ(extractAll(framer), expected);
+            expected.clear();
+        }
+    }
+    EXPECT_EQ(extractAll(framer), expected);
+}
+
+TEST(FramerTest, OverflowDropsOldest) {
+    comm::Framer framer(FRAME_LEN, 64);
+    std::string stream = packageA + packageA + packageA + packageB;
+    framer.write(stream.data(), stream.size());
+    EXPECT_EQ(framer.getStatistics().bytesDropped, 16u);
+    EXPECT_EQ(extractAll(framer), packageA + packageA + packageB);
+}
+
+}  // namespace
@@ -25,9 +25,13 @@
  */
 
 #include <gtest/gtest.h>
+#include <QDataStream>
 #include <QDir>
 #include <QTextStream>
+#include <cstdlib>
+#include "../../src/logfile/binaryFormat.h"
 #include "../../src/logfile/logfile.h"
+#include "../../src/logfile/recorder.h"
 #include "../../src/parser/parser.h"
 
 namespace {
@@ -102,13 +106,12 @@ class LogfileReadTest : public ::testing::Test {
 
         ASSERT_EQ(expectedForceVector.length(), expectedTimeVector.length());
         ASSERT_EQ(logfile.getForce().length(), expectedForceVector.length());
-        ASSERT_EQ(logfile.getTime().length(), expectedTimeVector.length());
+        ASSERT_EQ(logfile.getTime().size(), expectedTimeVector.length());
 
         QVectorIterator<float> expectedTimeIterator(expectedTimeVector);
-        QVector<float> timeVector = logfile.getTime();
-        QVectorIterator<float> timeIterator(timeVector);
-        while (expectedTimeIterator.hasNext()) {
-            EXPECT_FLOAT_EQ(expectedTimeIterator.next(), timeIterator.next());
+        TimeAxis timeAxis = logfile.getTime();
+        for (double time : timeAxis) {
+            EXPECT_FLOAT_EQ(expectedTimeIterator.next(), time);
         }
     }
 };
@@ -185,6 +188,48 @@ TEST_F(LogfileErrorTest, wrongUnit) {
     logfile.setPath("../../../tests/inputFiles/logfileErrorUnit.csv");
 }
 
+/**
+ * @brief Logfiles larger than one chunk are parsed in parallel
+ *
+ * The forces behind the header of `logfile1.csv` are repeated until the file
+ * spans several chunks. An invalid line in a later chunk must be reported with
+ * its line number and the forces in front of it must be kept.
+ */
+TEST(LogfileLoadTest, loadLargeFile) {
+    QFile source("../../../tests/inputFiles/logfile1.csv");
+    ASSERT_TRUE(source.open(QIODevice::ReadOnly));
+    QByteArray header;
+    for (int line = 0; line < 13; ++line) {
+        header.append(source.readLine());
+    }
+
+    constexpr int forces = 600000;
+    constexpr int invalidIndex = 500000;
+    QByteArray body;
+    for (int i = 0; i < forces; ++i) {
+        body.append(i == invalidIndex ? QByteArray("1.0a") : QByteArray::number(i % 1000 - 500)).append("\r\n");
+    }
+
+    QString path = "logfile_large.csv";
+    QFile file(path);
+    ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+    file.write(header + body);
+    file.close();
+
+    Logfile logfile;
+    logfile.setPath(path);
+    EXPECT_EQ(logfile.load(), 14 + invalidIndex);
+    ASSERT_EQ(logfile.getForce().length(), invalidIndex);
+    ASSERT_EQ(logfile.getTime().size(), invalidIndex);
+    EXPECT_EQ(logfile.getForce()[invalidIndex - 1], float((invalidIndex - 1) % 1000 - 500));
+    EXPECT_FLOAT_EQ(logfile.getTime()[invalidIndex - 1], float(invalidIndex - 1) / 1280);
+    EXPECT_EQ(logfile.getMinForce(), -500);
+    EXPECT_EQ(logfile.getMaxForce(), 499);
+    EXPECT_EQ(logfile.getMinForceIndex(), 499000);
+    EXPECT_EQ(logfile.getMaxForceIndex(), 499999);
+    file.remove();
+}
+
 TEST(LogfileLoadTest, loadWithoutPath) {
     Logfile logfile;
     ASSERT_EQ(logfile.load(), -1);
@@ -212,6 +257,279 @@ TEST(LogfileWriteTest, writeCorrectData) {
     exportFile.remove();
 }
 
+TEST(LogfileLoadTest, timeAxis) {
+    Logfile logfile;
+    logfile.setPath("../../../tests/inputFiles/logfile0.csv");
+    ASSERT_EQ(logfile.load(), 0);
+    TimeAxis time = logfile.getTime();
+    ASSERT_EQ(time.size(), 5);
+    EXPECT_DOUBLE_EQ(time[4], 4.0 / 40);
+    EXPECT_EQ(time.end() - time.begin(), 5);
+    EXPECT_DOUBLE_EQ(*(time.begin() + 2), 2.0 / 40);
+    EXPECT_EQ(time.indexOf(0.06), 2);
+    EXPECT_EQ(time.indexOf(-1.0), 0);
+    EXPECT_EQ(time.indexOf(10.0), 4);
+
+    TimeAxis tail = time.mid(3);
+    ASSERT_EQ(tail.size(), 2);
+    EXPECT_DOUBLE_EQ(tail[0], 3.0 / 40);
+    EXPECT_EQ(tail.toVector(), QVector<double>({time[3], time[4]}));
+}
+
+// *****************************************************************************
+// Binary logfiles
+// *****************************************************************************
+
+TEST(LogfileBinaryTest, convertLossless) {
+    Logfile csv;
+    csv.setPath("../../../tests/inputFiles/logfile1.csv");
+    ASSERT_EQ(csv.load(), 0);
+
+    Logfile binary;
+    binary.setMetadata(csv.getMetadata());
+    binary.setForce(csv.getForce());
+    binary.setFormat(LogfileFormat::BINARY);
+    binary.setPath("logfile_out.lscb");
+    ASSERT_TRUE(binary.write());
+
+    Logfile converted;
+    converted.setPath(binary.getPath());
+    ASSERT_EQ(converted.load(), 0);
+    EXPECT_EQ(converted.getFormat(), LogfileFormat::BINARY);
+    checkMetaData(converted.getMetadata(), csv.getMetadata());
+    EXPECT_EQ(converted.getForce(), csv.getForce());
+    EXPECT_EQ(converted.getTime(), csv.getTime());
+    EXPECT_EQ(converted.getMinForceIndex(), csv.getMinForceIndex());
+    EXPECT_EQ(converted.getMaxForceIndex(), csv.getMaxForceIndex());
+
+    converted.setFormat(LogfileFormat::CSV);
+    converted.setPath("logfile_out.csv");
+    ASSERT_TRUE(converted.write());
+    QFile compareTo("../../../tests/inputFiles/logfile1.csv");
+    QFile exportFile(converted.getPath());
+    compareFiles(compareTo, exportFile);
+    exportFile.remove();
+    QFile::remove(binary.getPath());
+}
+
+TEST(LogfileBinaryTest, randomAccess) {
+    // Three blocks, the second one needs 32 bit forces
+    QVector<float> force;
+    for (int i = 0; i < 2 * int(Logfile::BLOCK_SIZE) + 100; ++i) {
+        force << float((i % 200 - 100) / 100.0);
+    }
+    force[int(Logfile::BLOCK_SIZE) + 7] = 12345.67f;
+    force[int(Logfile::BLOCK_SIZE) + 9] = -999.99f;
+
+    Logfile binary;
+    binary.setMetadata(
+        {"FF:6C:05", "15.05.22", "16:14:25", 2, UnitValue::KN, MeasureMode::ABS_ZERO, 0.02, 1280, 0.7, 0, 3, 15, 18});
+    binary.setForce(force);
+    binary.setFormat(LogfileFormat::BINARY);
+    binary.setPath("logfile_random.lscb");
+    ASSERT_TRUE(binary.write());
+
+    Logfile logfile;
+    logfile.setPath(binary.getPath());
+    ASSERT_EQ(logfile.loadIndex(), 0);
+    EXPECT_TRUE(logfile.getForce().isEmpty());
+    EXPECT_EQ(logfile.getSampleCount(), force.size());
+
+    QVector<float> forces;
+    ASSERT_TRUE(logfile.readForces(Logfile::BLOCK_SIZE - 5, 20, forces));
+    EXPECT_EQ(forces, force.mid(Logfile::BLOCK_SIZE - 5, 20));
+    ASSERT_TRUE(logfile.readForces(force.size() - 3, 3, forces));
+    EXPECT_EQ(forces, force.mid(force.size() - 3));
+    EXPECT_FALSE(logfile.readForces(force.size() - 3, 4, forces));
+
+    float min, max;
+    ASSERT_TRUE(logfile.findPeaks(0, force.size(), min, max));
+    EXPECT_EQ(min, -999.99f);
+    EXPECT_EQ(max, 12345.67f);
+    ASSERT_TRUE(logfile.findPeaks(Logfile::BLOCK_SIZE + 8, 10, min, max));
+    EXPECT_EQ(min, -999.99f);
+    EXPECT_EQ(max, force[int(Logfile::BLOCK_SIZE) + 17]);
+    ASSERT_TRUE(logfile.findPeaks(10, 50, min, max));
+    EXPECT_EQ(min, force[10]);
+    EXPECT_EQ(max, force[59]);
+    QFile::remove(binary.getPath());
+}
+
+TEST(LogfileBinaryTest, unknownVersion) {
+    QFile file("logfile_version.lscb");
+    ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+    QDataStream out(&file);
+    out.setByteOrder(QDataStream::LittleEndian);
+    out << Logfile::BINARY_MAGIC << quint16(Logfile::BINARY_VERSION + 1);
+    file.close();
+
+    Logfile logfile;
+    logfile.setPath(file.fileName());
+    EXPECT_EQ(logfile.load(), Logfile::INVALID_BINARY);
+    file.remove();
+}
+
+TEST(RecorderTest, recordAndLoad) {
+    QVector<Sample> samples;
+    for (int i = 0; i < 10; ++i) {
+        Sample sample{};
+        sample.unitValue = UnitValue::KGF;
+        sample.measureMode = MeasureMode::REL_ZERO;
+        sample.referenceZero = 0.5;
+        sample.frequency = 640;
+        sample.measuredFixed = FixedPoint{i * 125 - 300, 2};
+        sample.measuredValue = sample.measuredFixed.toDouble();
+        sample.deviceId = i == 3 ? 2 : 1;  // Sample of another device
+        samples << sample;
+    }
+
+    Recorder recorder;
+    recorder.setBlockSize(4);
+    recorder.setSyncInterval(0);
+    Metadata metadata{};
+    metadata.deviceID = "FF:6C:05";
+    metadata.date = "15.05.22";
+    metadata.time = "16:14:25";
+    ASSERT_TRUE(recorder.start("logfile_recorded.lscb", metadata, 1));
+    EXPECT_FALSE(recorder.start("logfile_recorded.lscb", metadata, 1));
+    recorder.addSamples(samples.mid(0, 5));
+    recorder.addSamples(samples.mid(5));
+    EXPECT_EQ(recorder.getSampleCount(), 9);
+    ASSERT_TRUE(recorder.stop());
+    EXPECT_FALSE(recorder.isRecording());
+
+    Logfile logfile;
+    logfile.setPath("logfile_recorded.lscb");
+    ASSERT_EQ(logfile.load(), 0);
+    EXPECT_EQ(logfile.getMetadata().deviceID, metadata.deviceID);
+    EXPECT_EQ(logfile.getMetadata().unit, UnitValue::KGF);
+    EXPECT_EQ(logfile.getMetadata().mode, MeasureMode::REL_ZERO);
+    EXPECT_EQ(logfile.getMetadata().speed, 640);
+    QVector<float> expected;
+    for (const Sample& sample : samples) {
+        if (sample.deviceId == 1) {
+            expected << float(sample.measuredFixed.toCenti() / 100.0);
+        }
+    }
+    EXPECT_EQ(logfile.getForce(), expected);
+    EXPECT_TRUE(Recorder::recover(logfile.getPath()));  // Closed files stay untouched
+    ASSERT_EQ(logfile.load(), 0);
+    EXPECT_EQ(logfile.getForce(), expected);
+    QFile::remove(logfile.getPath());
+}
+
+TEST(RecorderTest, recoverAfterCrash) {
+    // Header and blocks as written during a recording, the last block is cut off
+    Metadata metadata{
+        "FF:6C:05", "15.05.22", "16:14:25", 2, UnitValue::KN, MeasureMode::ABS_ZERO, 0, 40, 0, 0, 0, 0, 0};
+    binlog::Header header;
+    header.blockSize = 3;
+    QByteArray contents = binlog::encodeHeader(metadata, header);
+    QVector<qint32> forces{100, -250, 40000, 7, 8, 9, 10, 11, 12};
+    QByteArray block;
+    for (quint32 number = 0; number < 3; ++number) {
+        binlog::encodeBlock(number, forces.constData() + 3 * number, 3, block);
+        contents += number < 2 ? block : block.left(block.size() - 1);
+    }
+    QFile file("logfile_crashed.lscb");
+    ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+    file.write(contents);
+    file.close();
+
+    Logfile logfile;
+    logfile.setPath(file.fileName());
+    ASSERT_EQ(logfile.load(), 0);
+    EXPECT_EQ(logfile.getForce(), QVector<float>({1.0f, -2.5f, 400.0f, 0.07f, 0.08f, 0.09f}));
+
+    ASSERT_TRUE(Recorder::recover(file.fileName()));
+    ASSERT_EQ(logfile.loadIndex(), 0);
+    EXPECT_EQ(logfile.getSampleCount(), 6);
+    QVector<float> tail;
+    ASSERT_TRUE(logfile.readForces(4, 2, tail));
+    EXPECT_EQ(tail, QVector<float>({0.08f, 0.09f}));
+    float min, max;
+    ASSERT_TRUE(logfile.findPeaks(0, 6, min, max));
+    EXPECT_EQ(min, -2.5f);
+    EXPECT_EQ(max, 400.0f);
+    file.remove();
+}
+
+TEST(RecorderTest, recoverKilledRecording) {
+    QVector<Sample> samples;
+    for (int i = 0; i < 14; ++i) {
+        Sample sample{};
+        sample.unitValue = UnitValue::KGF;
+        sample.measureMode = MeasureMode::REL_ZERO;
+        sample.frequency = 640;
+        sample.measuredFixed = FixedPoint{i * 25 - 100, 2};
+        sample.measuredValue = sample.measuredFixed.toDouble();
+        samples << sample;
+    }
+
+    // The header is started with defaults, the process exits without `stop`
+    EXPECT_EXIT(
+        {
+            Recorder recorder;
+            recorder.setBlockSize(4);
+            recorder.start("logfile_killed.lscb", Metadata{});
+            // Handing off the third block waits until the first one is written
+            recorder.addSamples(samples);
+            std::_Exit(3);
+        },
+        ::testing::ExitedWithCode(3), "");
+
+    ASSERT_TRUE(Recorder::recover("logfile_killed.lscb"));
+    Logfile logfile;
+    logfile.setPath("logfile_killed.lscb");
+    ASSERT_EQ(logfile.load(), 0);
+    EXPECT_EQ(logfile.getMetadata().unit, UnitValue::KGF);
+    EXPECT_EQ(logfile.getMetadata().mode, MeasureMode::REL_ZERO);
+    EXPECT_EQ(logfile.getMetadata().speed, 640);
+    EXPECT_EQ(logfile.getTime()[1], 1.0 / 640);
+    ASSERT_GE(logfile.getSampleCount(), 4);
+    EXPECT_LE(logfile.getSampleCount(), 12);
+    for (int i = 0; i < logfile.getForce().size(); ++i) {
+        EXPECT_EQ(logfile.getForce()[i], float(samples[i].measuredFixed.toCenti() / 100.0));
+    }
+    QFile::remove(logfile.getPath());
+}
+
+TEST(RecorderTest, recoverLowFrequency) {
+    QVector<Sample> samples;
+    for (int i = 0; i < 35; ++i) {
+        Sample sample{};
+        sample.unitValue = UnitValue::KN;
+        sample.measureMode = MeasureMode::ABS_ZERO;
+        sample.frequency = 10;
+        sample.measuredFixed = FixedPoint{i * 7, 2};
+        sample.measuredValue = sample.measuredFixed.toDouble();
+        samples << sample;
+    }
+
+    // At 10 Hz a block holds the forces of one sync interval, i.e. 10 forces
+    EXPECT_EXIT(
+        {
+            Recorder recorder;
+            recorder.start("logfile_slow.lscb", Metadata{});
+            recorder.addSamples(samples);
+            std::_Exit(3);
+        },
+        ::testing::ExitedWithCode(3), "");
+
+    ASSERT_TRUE(Recorder::recover("logfile_slow.lscb"));
+    Logfile logfile;
+    logfile.setPath("logfile_slow.lscb");
+    ASSERT_EQ(logfile.load(), 0);
+    EXPECT_EQ(logfile.getMetadata().speed, 10);
+    EXPECT_EQ(logfile.getSampleCount() % 10, 0);
+    ASSERT_GE(logfile.getSampleCount(), 10);
+    EXPECT_LE(logfile.getSampleCount(), 30);
+    for (int i = 0; i < logfile.getForce().size(); ++i) {
+        EXPECT_EQ(logfile.getForce()[i], float(samples[i].measuredFixed.toCenti() / 100.0));
+    }
+    QFile::remove(logfile.getPath());
+}
+
 // *****************************************************************************
 // Test the tests
 // *****************************************************************************
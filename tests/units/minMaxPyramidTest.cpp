@@ -0,0 +1,169 @@
+/******************************************************************************
+ * Copyright (C) 2023 by Gschwind, Weber, Schoch, Niederberger                *
+ *                                                                            *
+ * This file is part of linescaleGUI.                                         *
+ *                                                                            *
+ * LinescaleGUI is free software: you can redistribute it and/or modify       *
+ * it under the terms of the GNU General Public License as published by       *
+ * the Free Software Foundation, either version 3 of the License, or          *
+ * (at your option) any later version.                                        *
+ *                                                                            *
+ * LinescaleGUI is distributed in the hope that it will be useful,            *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of             *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the               *
+ * GNU General Public License for more details.                               *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License          *
+ * along with linescaleGUI. If not, see <http://www.gnu.org/licenses/>.       *
+ ******************************************************************************/
+/**
+ * @file minMaxPyramidTest.cpp
+ * @authors Gschwind, Weber, Schoch, Niederberger
+ *
+ * @brief Test class for the min/max pyramid of the plot
+ *
+ */
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include "../../src/gui/minMaxPyramid.h"
+
+namespace {
+
+/**
+ * @brief Fill a pyramid with a saw tooth, one point per millisecond
+ *
+ * @param pyramid Pyramid to fill
+ * @param count Number of points
+ */
+void fillSawTooth(MinMaxPyramid& pyramid, int count) {
+    for (int i = 0; i < count; ++i) {
+        pyramid.append(i / 1000.0, double(i % 100));
+    }
+}
+
+TEST(MinMaxPyramidTest, buildLevels) {
+    MinMaxPyramid pyramid;
+    EXPECT_EQ(pyramid.levelCount(), 1);
+    fillSawTooth(pyramid, MinMaxPyramid::FANOUT * MinMaxPyramid::FANOUT * MinMaxPyramid::FANOUT - 1);
+    EXPECT_EQ(pyramid.levelCount(), 3);
+    pyramid.append(1000.0, 0.0);
+    EXPECT_EQ(pyramid.levelCount(), 4);
+    pyramid.clear();
+    EXPECT_TRUE(pyramid.isEmpty());
+    EXPECT_EQ(pyramid.levelCount(), 1);
+}
+
+TEST(MinMaxPyramidTest, fewPointsUnchanged) {
+    MinMaxPyramid pyramid;
+    fillSawTooth(pyramid, 100);
+    QVector<double> times, values;
+    EXPECT_EQ(pyramid.sample(0.010, 0.020, 500, times, values), 0);
+    ASSERT_EQ(times.size(), 13);  // One point more on each side
+    EXPECT_DOUBLE_EQ(times.first(), 0.009);
+    EXPECT_DOUBLE_EQ(times.last(), 0.021);
+    EXPECT_EQ(values[1], 10.0);
+}
+
+TEST(MinMaxPyramidTest, boundedByWidth) {
+    MinMaxPyramid pyramid;
+    fillSawTooth(pyramid, 1000000);
+    pyramid.append(1000.0, 5000.0);
+    pyramid.append(1000.001, -5000.0);
+
+    QVector<double> times, values;
+    int pixels = 800;
+    EXPECT_GT(pyramid.sample(0.0, 1000.001, pixels, times, values), 0);
+    EXPECT_LE(times.size(), 2 * MinMaxPyramid::BUCKETS_PER_PIXEL * pixels + 2 * MinMaxPyramid::FANOUT * 8);
+    EXPECT_EQ(times.size(), values.size());
+    EXPECT_TRUE(std::is_sorted(times.begin(), times.end()));
+    // Peaks are never lost
+    EXPECT_EQ(*std::max_element(values.begin(), values.end()), 5000.0);
+    EXPECT_EQ(*std::min_element(values.begin(), values.end()), -5000.0);
+    EXPECT_EQ(times.last(), 1000.001);
+
+    // Zoomed in far enough, the points themselves are returned
+    EXPECT_EQ(pyramid.sample(500.0, 500.1, pixels, times, values), 0);
+    EXPECT_EQ(times.size(), 103);
+}
+
+TEST(MinMaxPyramidTest, batches) {
+    MinMaxPyramid single, batched;
+    QVector<double> times, values;
+    for (int i = 0; i < 10000; ++i) {
+        times << i * 0.5;
+        values << double((i * 37) % 101);
+    }
+    batched.append(times.mid(0, 123), values.mid(0, 123));
+    batched.append(times.mid(123), values.mid(123));
+    single.append(times, values);
+
+    QVector<double> singleTimes, singleValues, batchedTimes, batchedValues;
+    EXPECT_EQ(single.sample(100.0, 4000.0, 100, singleTimes, singleValues),
+              batched.sample(100.0, 4000.0, 100, batchedTimes, batchedValues));
+    EXPECT_EQ(singleTimes, batchedTimes);
+    EXPECT_EQ(singleValues, batchedValues);
+}
+
+TEST(MinMaxPyramidTest, assignEvenlySpaced) {
+    TimeAxis axis(0.5, 1.0 / 640, 100000);
+    QVector<float> forces;
+    for (int i = 0; i < axis.size(); ++i) {
+        forces << float((i * 37) % 1001) / 100.0f - 5.0f;
+    }
+    MinMaxPyramid appended, assigned;
+    for (int i = 0; i < forces.size(); ++i) {
+        appended.append(axis[i], forces[i] * 0.5);
+    }
+    assigned.assign(axis, forces, 0.5);
+    EXPECT_EQ(assigned.size(), axis.size());
+    EXPECT_EQ(assigned.levelCount(), appended.levelCount());
+
+    QVector<double> appendedTimes, appendedValues, assignedTimes, assignedValues;
+    for (double lower : {0.0, 10.0, 100.0}) {
+        EXPECT_EQ(appended.sample(lower, lower + 20.0, 300, appendedTimes, appendedValues),
+                  assigned.sample(lower, lower + 20.0, 300, assignedTimes, assignedValues));
+        EXPECT_EQ(appendedTimes, assignedTimes);
+        EXPECT_EQ(appendedValues, assignedValues);
+    }
+    double appendedMin, appendedMax, assignedMin, assignedMax;
+    ASSERT_TRUE(appended.extremes(3.0, 77.7, appendedMin, appendedMax));
+    ASSERT_TRUE(assigned.extremes(3.0, 77.7, assignedMin, assignedMax));
+    EXPECT_EQ(appendedMin, assignedMin);
+    EXPECT_EQ(appendedMax, assignedMax);
+
+    // Appending copies the points first
+    appended.append(1000.0, 7.0);
+    assigned.append(1000.0, 7.0);
+    EXPECT_EQ(assigned.size(), axis.size() + 1);
+    EXPECT_EQ(appended.sample(0.0, 1000.0, 300, appendedTimes, appendedValues),
+              assigned.sample(0.0, 1000.0, 300, assignedTimes, assignedValues));
+    EXPECT_EQ(appendedTimes, assignedTimes);
+    EXPECT_EQ(appendedValues, assignedValues);
+}
+
+TEST(MinMaxPyramidTest, rangeExtremes) {
+    MinMaxPyramid pyramid;
+    QVector<double> values;
+    quint32 seed = 1;
+    for (int i = 0; i < 20000; ++i) {
+        seed = seed * 1664525u + 1013904223u;  // Linear congruential generator
+        values << double((seed >> 8) % 10000) - 5000.0;
+        pyramid.append(i, values.last());
+    }
+
+    for (int first = 0; first < 20000; first += 1237) {
+        for (int last = first; last < 20000; last += 3011) {
+            double min, max;
+            ASSERT_TRUE(pyramid.extremes(first - 0.5, last + 0.5, min, max));
+            EXPECT_EQ(min, *std::min_element(values.begin() + first, values.begin() + last + 1));
+            EXPECT_EQ(max, *std::max_element(values.begin() + first, values.begin() + last + 1));
+        }
+    }
+
+    double min, max;
+    EXPECT_FALSE(pyramid.extremes(0.2, 0.8, min, max));
+    EXPECT_FALSE(pyramid.extremes(30000.0, 40000.0, min, max));
+}
+
+}  // namespace
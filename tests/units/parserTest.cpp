@@ -200,4 +200,108 @@ TEST_F(ParserTest, ParseSpeedValue1280) {
     checkDataStruct(result, expectedResult);
 }
 
+// *****************************************************************************
+// Batch Tests
+// *****************************************************************************
+
+// Three packets back-to-back, the second one with an incorrect checksum
+TEST_F(ParserTest, ParseBatchMixed) {
+    QByteArray burst("R-00.01N000.00?NF41\rR000.63Z-32.84RNS11\rR000019Z000001RGS95\r");
+    Sample samples[3];
+    ParseStatus status[3];
+    size_t parsed = parser.parseBatch(burst.constData(), burst.length(), samples, status);
+    ASSERT_EQ(parsed, 2u);
+    EXPECT_EQ(status[0], ParseStatus::OK);
+    EXPECT_EQ(status[1], ParseStatus::INVALID_CHECKSUM);
+    EXPECT_EQ(status[2], ParseStatus::OK);
+
+    Sample expectedFirst = {WorkingMode::REALTIME, -00.01, MeasureMode::ABS_ZERO, 000.00, 62, UnitValue::KN, 40};
+    Sample expectedSecond = {WorkingMode::REALTIME, 19, MeasureMode::REL_ZERO, 1, 100, UnitValue::KGF, 10};
+    checkDataStruct(samples[0], expectedFirst);
+    checkDataStruct(samples[1], expectedSecond);
+}
+
+// A packet whose only defect is the terminator is rejected, also in a burst
+TEST_F(ParserTest, ParseBatchInvalidTerminator) {
+    QByteArray package("R-00.01N000.00?NF41\n");
+    EXPECT_EQ(parser.parseFrame(package.constData(), result), ParseStatus::INVALID_TERMINATOR);
+    EXPECT_FALSE(parser.parsePackage(package, result));
+
+    QByteArray burst("R-00.01N000.00?NF41\rR000019Z000001RGS95\nR000019Z000001RGS95\r");
+    Sample samples[3];
+    ParseStatus status[3];
+    size_t parsed = parser.parseBatch(burst.constData(), burst.length(), samples, status);
+    ASSERT_EQ(parsed, 2u);
+    EXPECT_EQ(status[0], ParseStatus::OK);
+    EXPECT_EQ(status[1], ParseStatus::INVALID_TERMINATOR);
+    EXPECT_EQ(status[2], ParseStatus::OK);
+}
+
+// Bytes which do not form a complete packet are ignored
+TEST_F(ParserTest, ParseBatchIncompleteTail) {
+    QByteArray burst("R-00.01N000.00?NF41\rR-00.01N");
+    Sample samples[1];
+    ParseStatus status[1];
+    size_t parsed = parser.parseBatch(burst.constData(), burst.length(), samples, status);
+    ASSERT_EQ(parsed, 1u);
+    EXPECT_EQ(status[0], ParseStatus::OK);
+}
+
+// Same result as `parsePackage` for a single packet
+TEST_F(ParserTest, ParseFrameMatchesParsePackage) {
+    QByteArray package("R000.63Z-32.84RNS10\r");
+    Sample batchResult;
+    ASSERT_EQ(parser.parseFrame(package.constData(), batchResult), ParseStatus::OK);
+    ASSERT_TRUE(parser.parsePackage(package, result));
+    checkDataStruct(result, batchResult);
+    EXPECT_EQ(batchResult.measuredFixed, (FixedPoint{63, 2}));
+    EXPECT_EQ(batchResult.referenceFixed, (FixedPoint{-3284, 2}));
+}
+
+// *****************************************************************************
+// Fixed point Tests
+// *****************************************************************************
+
+TEST(FixedPointTest, DecodeFields) {
+    FixedPoint value;
+    ASSERT_TRUE(Parser::decodeFixedPoint("-00.01", 6, value));
+    EXPECT_EQ(value.mantissa, -1);
+    EXPECT_EQ(value.decimals, 2);
+    EXPECT_EQ(value.toDouble(), -0.01);
+
+    ASSERT_TRUE(Parser::decodeFixedPoint("314.15", 6, value));
+    EXPECT_EQ(value.mantissa, 31415);
+    EXPECT_EQ(value.toCenti(), 31415);
+    EXPECT_EQ(value.toDouble(), 314.15);
+
+    ASSERT_TRUE(Parser::decodeFixedPoint("999999", 6, value));
+    EXPECT_EQ(value.decimals, 0);
+    EXPECT_EQ(value.toCenti(), 99999900);
+}
+
+TEST(FixedPointTest, RejectInvalidFields) {
+    FixedPoint value;
+    EXPECT_FALSE(Parser::decodeFixedPoint("00.0.1", 6, value));
+    EXPECT_FALSE(Parser::decodeFixedPoint("0-0.01", 6, value));
+    EXPECT_FALSE(Parser::decodeFixedPoint("?00.01", 6, value));
+    EXPECT_FALSE(Parser::decodeFixedPoint("-.", 2, value));
+}
+
+TEST(FixedPointTest, CompareDifferentDecimals) {
+    FixedPoint oneDecimal{15, 1};    // 1.5
+    FixedPoint twoDecimals{150, 2};  // 1.50
+    FixedPoint larger{151, 2};       // 1.51
+    EXPECT_EQ(oneDecimal, twoDecimals);
+    EXPECT_LT(twoDecimals, larger);
+    EXPECT_GT(larger, oneDecimal);
+    EXPECT_EQ((FixedPoint{-12345, 3}).toCenti(), -1235);
+}
+
+TEST(UnitTest, FactorFromKn) {
+    EXPECT_EQ(factorFromKn(UnitValue::KN), 1.0);
+    EXPECT_EQ(factorFromKn(UnitValue::NONE), 1.0);
+    EXPECT_NEAR(factorFromKn(UnitValue::KGF), 101.97, 0.01);
+    EXPECT_NEAR(factorFromKn(UnitValue::LBF), 224.81, 0.01);
+}
+
 }  // namespace
@@ -0,0 +1,101 @@
+/******************************************************************************
+ * Copyright (C) 2023 by Gschwind, Weber, Schoch, Niederberger                *
+ *                                                                            *
+ * This file is part of linescaleGUI.                                         *
+ *                                                                            *
+ * LinescaleGUI is free software: you can redistribute it and/or modify       *
+ * it under the terms of the GNU General Public License as published by       *
+ * the Free Software Foundation, either version 3 of the License, or          *
+ * (at your option) any later version.                                        *
+ *                                                                            *
+ * LinescaleGUI is distributed in the hope that it will be useful,            *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of             *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the               *
+ * GNU General Public License for more details.                               *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License          *
+ * along with linescaleGUI. If not, see <http://www.gnu.org/licenses/>.       *
+ ******************************************************************************/
+/**
+ * @file renderSchedulerTest.cpp
+ * @authors Gschwind, Weber, Schoch, Niederberger
+ *
+ * @brief Test class for the render scheduler of the plot
+ *
+ */
+
+#include <gtest/gtest.h>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include "../../src/gui/renderScheduler.h"
+
+namespace {
+
+/**
+ * @brief Process events for a while
+ *
+ * @param milliseconds Time to process events
+ */
+void processEvents(int milliseconds) {
+    QElapsedTimer elapsed;
+    elapsed.start();
+    while (elapsed.elapsed() < milliseconds) {
+        QCoreApplication::processEvents(QEventLoop::AllEvents, 5);
+    }
+}
+
+TEST(RenderSchedulerTest, coalesceRequests) {
+    RenderScheduler scheduler;
+    int frames = 0;
+    QObject::connect(&scheduler, &RenderScheduler::frame, [&frames] { ++frames; });
+
+    processEvents(50);
+    EXPECT_EQ(frames, 0);  // Nothing to draw
+
+    for (int i = 0; i < 100; ++i) {
+        scheduler.requestFrame();
+    }
+    EXPECT_TRUE(scheduler.isPending());
+    processEvents(100);
+    EXPECT_EQ(frames, 1);
+    EXPECT_FALSE(scheduler.isPending());
+}
+
+TEST(RenderSchedulerTest, pauseWhileHidden) {
+    RenderScheduler scheduler;
+    int frames = 0;
+    QObject::connect(&scheduler, &RenderScheduler::frame, [&frames] { ++frames; });
+
+    scheduler.setPaused(true);
+    scheduler.requestFrame();
+    processEvents(100);
+    EXPECT_EQ(frames, 0);
+    EXPECT_TRUE(scheduler.isPending());
+
+    scheduler.setPaused(false);
+    processEvents(100);
+    EXPECT_EQ(frames, 1);
+}
+
+TEST(RenderSchedulerTest, adaptInterval) {
+    RenderScheduler scheduler;
+    EXPECT_EQ(scheduler.getInterval(), RenderScheduler::MIN_INTERVAL);
+
+    scheduler.recordFrame(1000000);  // 1 ms fits into the shortest interval
+    EXPECT_EQ(scheduler.getInterval(), RenderScheduler::MIN_INTERVAL);
+
+    for (int i = 0; i < 50; ++i) {
+        scheduler.recordFrame(10000000);  // 10 ms
+    }
+    EXPECT_NEAR(scheduler.getInterval(), 10 / RenderScheduler::FRAME_BUDGET, 1);
+
+    for (int i = 0; i < 50; ++i) {
+        scheduler.recordFrame(1000000000);  // 1 s
+    }
+    EXPECT_EQ(scheduler.getInterval(), RenderScheduler::MAX_INTERVAL);
+
+    scheduler.recordFrame(0);  // A single fast frame barely changes it
+    EXPECT_EQ(scheduler.getInterval(), RenderScheduler::MAX_INTERVAL);
+}
+
+}  // namespace
@@ -0,0 +1,247 @@
+/******************************************************************************
+ * Copyright (C) 2023 by Gschwind, Weber, Schoch, Niederberger                *
+ *                                                                            *
+ * This file is part of linescaleGUI.                                         *
+ *                                                                            *
+ * LinescaleGUI is free software: you can redistribute it and/or modify       *
+ * it under the terms of the GNU General Public License as published by       *
+ * the Free Software Foundation, either version 3 of the License, or          *
+ * (at your option) any later version.                                        *
+ *                                                                            *
+ * LinescaleGUI is distributed in the hope that it will be useful,            *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of             *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the               *
+ * GNU General Public License for more details.                               *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License          *
+ * along with linescaleGUI. If not, see <http://www.gnu.org/licenses/>.       *
+ ******************************************************************************/
+/**
+ * @file replayDeviceTest.cpp
+ * @authors Gschwind, Weber, Schoch, Niederberger
+ *
+ * @brief Test class for the replay of logfiles through the live path
+ *
+ * Writes binary logfiles, plays them with `comm::ReplayDevice` and checks that
+ * every force arrives in order, as fast as possible and paced.
+ *
+ */
+
+#include <gtest/gtest.h>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QThread>
+#include <array>
+#include "../../src/deviceCommunication/command.h"
+#include "../../src/deviceCommunication/packetDecoder.h"
+#include "../../src/deviceCommunication/replayDevice.h"
+#include "../../src/deviceCommunication/sampleClock.h"
+#include "../../src/simulator/frameGenerator.h"
+
+namespace {
+
+/**
+ * @brief Write a binary logfile with forces of two decimals
+ *
+ * @param path Path of the logfile
+ * @param count Number of forces
+ * @param frequency Frequency of the logfile
+ * @return QVector<float> The written forces
+ */
+QVector<float> writeLogfile(const QString& path, int count, int frequency) {
+    QVector<float> forces;
+    for (int i = 0; i < count; ++i) {
+        forces << float((i % 200 - 100) / 100.0);
+    }
+    Logfile logfile;
+    logfile.setMetadata(
+        {"FF:6C:05", "15.05.22", "16:14:25", 2, UnitValue::KN, MeasureMode::ABS_ZERO, 0, frequency, 0, 0, 0, 0, 0});
+    logfile.setForce(forces);
+    logfile.setFormat(LogfileFormat::BINARY);
+    logfile.setPath(path);
+    EXPECT_TRUE(logfile.write());
+    return forces;
+}
+
+/**
+ * @brief Take the queued samples of a device until enough arrived
+ *
+ * @param device The replay
+ * @param samples Taken samples are appended
+ * @param count Number of samples to wait for
+ * @return true if `count` samples arrived within 10 s
+ */
+bool takeSamples(comm::ReplayDevice& device, QVector<Sample>& samples, int count) {
+    std::array<Sample, 256> buffer;
+    QElapsedTimer timer;
+    timer.start();
+    while (samples.size() < count && timer.elapsed() < 10000) {
+        size_t taken = device.takeSamples(buffer.data(), buffer.size());
+        for (size_t i = 0; i < taken; ++i) {
+            samples << buffer[i];
+        }
+        if (taken == 0) {
+            QThread::msleep(1);
+        }
+    }
+    return samples.size() == count;
+}
+
+/**
+ * @brief Process events until the replay reports its end
+ *
+ * @param device The replay
+ * @return true if the device disconnected within 10 s
+ */
+bool waitForEnd(comm::ReplayDevice& device) {
+    QElapsedTimer timer;
+    timer.start();
+    while (device.getStatus() && timer.elapsed() < 10000) {
+        QCoreApplication::processEvents();
+        QThread::msleep(1);
+    }
+    return !device.getStatus();
+}
+
+}  // namespace
+
+TEST(PacketDecoderTest, rejectedFrameLeavesGap) {
+    std::array<char, 3 * Parser::PACKET_EXPECTED_LEN> frames;
+    Sample sample{};
+    sample.workingMode = WorkingMode::REALTIME;
+    sample.measureMode = MeasureMode::ABS_ZERO;
+    sample.unitValue = UnitValue::KN;
+    sample.batteryPercent = 80;
+    sample.frequency = 640;
+    for (int i = 0; i < 3; ++i) {
+        sample.measuredValue = 0.25 * i;
+        sim::FrameGenerator::encodeFrame(sample, frames.data() + i * Parser::PACKET_EXPECTED_LEN);
+    }
+    frames[Parser::PACKET_EXPECTED_LEN + 17] ^= 1;  // Checksum of the second frame
+
+    comm::PacketDecoder decoder;
+    QVector<Sample> samples;
+    decoder.write(frames.data(), 2 * Parser::PACKET_EXPECTED_LEN + 7);
+    decoder.write(frames.data() + 2 * Parser::PACKET_EXPECTED_LEN + 7, Parser::PACKET_EXPECTED_LEN - 7);
+    decoder.decode(comm::SampleClock::now(), 5, [&samples](const Sample* parsed, size_t count) {
+        samples += QVector<Sample>(parsed, parsed + count);
+    });
+
+    ASSERT_EQ(samples.size(), 2);
+    EXPECT_EQ(samples[0].measuredValue, 0.0);
+    EXPECT_EQ(samples[1].measuredValue, 0.5);
+    EXPECT_EQ(samples[0].sequence, 1u);
+    EXPECT_EQ(samples[1].sequence, 3u);  // The rejected frame keeps its number
+    EXPECT_EQ(samples[1].deviceId, 5);
+    EXPECT_LT(samples[0].timestamp, samples[1].timestamp);
+    EXPECT_EQ(decoder.getStatistics().framesRejected, 1u);
+    EXPECT_EQ(decoder.getNextSequence(), 4u);
+}
+
+TEST(ReplayDeviceTest, asFastAsPossible) {
+    // More forces than the sample queue holds, the replay has to wait for the consumer
+    const QString path = "replay_fast.lscb";
+    QVector<float> forces = writeLogfile(path, 40000, 1280);
+
+    comm::DeviceInfo info{comm::ConnType::REPLAY, path, 0};
+    info.replaySpeed = 0.0;
+    comm::ReplayDevice device(info);
+    device.setDeviceNumber(2);
+    ASSERT_TRUE(device.connectDevice());
+    EXPECT_EQ(device.getStatistics().total, forces.size());
+
+    device.sendData(command::REQUESTONLINE);
+    QVector<Sample> samples;
+    ASSERT_TRUE(takeSamples(device, samples, forces.size()));
+    ASSERT_TRUE(waitForEnd(device));
+
+    for (int i = 0; i < samples.size(); ++i) {
+        ASSERT_EQ(float(samples[i].measuredValue), forces[i]) << i;
+        ASSERT_EQ(samples[i].sequence, quint64(i + 1));
+        ASSERT_EQ(samples[i].deviceId, 2);
+        ASSERT_EQ(samples[i].frequency, 1280);
+    }
+    comm::ReplayStatistics statistics = device.getStatistics();
+    EXPECT_TRUE(statistics.finished);
+    EXPECT_EQ(statistics.samples, quint64(forces.size()));
+    EXPECT_EQ(statistics.bytes, quint64(forces.size()) * Parser::PACKET_EXPECTED_LEN);
+    EXPECT_GT(statistics.sampleRate, 0.0);
+    EXPECT_EQ(device.getLostSamples(), 0u);
+    EXPECT_EQ(device.getFramerStatistics().framesRejected, 0u);
+    QFile::remove(path);
+}
+
+TEST(ReplayDeviceTest, pacedAndPaused) {
+    // 1280 forces at 1280 Hz take 0.5 s at twice the real time
+    const QString path = "replay_paced.lscb";
+    QVector<float> forces = writeLogfile(path, 1280, 1280);
+
+    comm::DeviceInfo info{comm::ConnType::REPLAY, path, 0};
+    info.replaySpeed = 2.0;
+    comm::ReplayDevice device(info);
+    ASSERT_TRUE(device.connectDevice());
+
+    device.sendData(command::REQUESTONLINE);
+    QVector<Sample> samples;
+    ASSERT_TRUE(takeSamples(device, samples, 1));
+    device.sendData(command::DISCONNECTONLINE);
+    EXPECT_LT(device.getStatistics().position, forces.size());
+    EXPECT_FALSE(device.getStatistics().finished);
+
+    device.sendData(command::REQUESTONLINE);  // Continues where it paused
+    ASSERT_TRUE(takeSamples(device, samples, forces.size()));
+    ASSERT_TRUE(waitForEnd(device));
+    for (int i = 0; i < samples.size(); ++i) {
+        ASSERT_EQ(float(samples[i].measuredValue), forces[i]) << i;
+        ASSERT_EQ(samples[i].sequence, quint64(i + 1));
+    }
+    comm::ReplayStatistics statistics = device.getStatistics();
+    EXPECT_TRUE(statistics.finished);
+    EXPECT_GE(statistics.elapsed, 0.45);
+    EXPECT_LT(statistics.speed, 2.5);
+    QFile::remove(path);
+}
+
+TEST(ReplayDeviceTest, unreadableBlock) {
+    const QString path = "replay_corrupt.lscb";
+    QVector<float> forces = writeLogfile(path, 3 * Logfile::BLOCK_SIZE, 1280);
+
+    // Number and count of the header of the second block, the forces are too small to match
+    QFile file(path);
+    ASSERT_TRUE(file.open(QIODevice::ReadWrite));
+    QByteArray data = file.readAll();
+    qint64 offset = data.indexOf(QByteArray::fromHex("0100000000100000"));
+    ASSERT_GT(offset, 0);
+    ASSERT_TRUE(file.seek(offset));
+    file.write(QByteArray::fromHex("07000000"));
+    file.close();
+
+    comm::DeviceInfo info{comm::ConnType::REPLAY, path, 0};
+    info.replaySpeed = 0.0;
+    comm::ReplayDevice device(info);
+    QStringList errors;
+    QObject::connect(&device, &comm::CommDevice::errorDevice, &device,
+                     [&errors](const QString& message) { errors << message; });
+    ASSERT_TRUE(device.connectDevice());
+
+    device.sendData(command::REQUESTONLINE);
+    QVector<Sample> samples;
+    ASSERT_TRUE(takeSamples(device, samples, Logfile::BLOCK_SIZE));
+    ASSERT_TRUE(waitForEnd(device));
+    ASSERT_EQ(errors.size(), 1);
+    EXPECT_TRUE(errors[0].contains(QString::number(Logfile::BLOCK_SIZE))) << errors[0].toStdString();
+    comm::ReplayStatistics statistics = device.getStatistics();
+    EXPECT_FALSE(statistics.finished);
+    EXPECT_EQ(statistics.position, qint64(Logfile::BLOCK_SIZE));
+    EXPECT_EQ(device.takeSamples(samples.data(), 1), 0u);
+    QFile::remove(path);
+}
+
+TEST(ReplayDeviceTest, invalidLogfile) {
+    comm::DeviceInfo info{comm::ConnType::REPLAY, "replay_missing.lscb", 0};
+    comm::ReplayDevice device(info);
+    EXPECT_FALSE(device.connectDevice());
+    device.sendData(command::REQUESTONLINE);  // Ignored
+    EXPECT_EQ(device.getStatistics().samples, 0u);
+}
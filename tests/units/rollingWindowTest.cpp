@@ -0,0 +1,117 @@
+/******************************************************************************
+ * Copyright (C) 2023 by Gschwind, Weber, Schoch, Niederberger                *
+ *                                                                            *
+ * This file is part of linescaleGUI.                                         *
+ *                                                                            *
+ * LinescaleGUI is free software: you can redistribute it and/or modify       *
+ * it under the terms of the GNU General Public License as published by       *
+ * the Free Software Foundation, either version 3 of the License, or          *
+ * (at your option) any later version.                                        *
+ *                                                                            *
+ * LinescaleGUI is distributed in the hope that it will be useful,            *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of             *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the               *
+ * GNU General Public License for more details.                               *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License          *
+ * along with linescaleGUI. If not, see <http://www.gnu.org/licenses/>.       *
+ ******************************************************************************/
+/**
+ * @file rollingWindowTest.cpp
+ * @authors Gschwind, Weber, Schoch, Niederberger
+ *
+ * @brief Test class for the rolling window of the live plot
+ *
+ */
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include "../../src/gui/rollingWindow.h"
+
+namespace {
+
+TEST(RollingWindowTest, replaceOldest) {
+    RollingWindow window;
+    window.setCapacity(5);
+    for (int i = 0; i < 8; ++i) {
+        window.append(i, i * 10.0);
+    }
+    EXPECT_EQ(window.capacity(), 5);
+    EXPECT_EQ(window.size(), 5);
+    EXPECT_EQ(window.appended(), 8);
+    EXPECT_EQ(window.timeAt(0), 3.0);
+    EXPECT_EQ(window.valueAt(4), 70.0);
+
+    QVector<double> times, values;
+    window.sample(4.5, 5.5, 100, times, values);
+    EXPECT_EQ(times, QVector<double>({4.0, 5.0, 6.0}));
+    window.sample(0.0, 100.0, 100, times, values);
+    EXPECT_EQ(values, QVector<double>({30.0, 40.0, 50.0, 60.0, 70.0}));
+
+    window.clear();
+    EXPECT_TRUE(window.isEmpty());
+    EXPECT_EQ(window.capacity(), 5);
+}
+
+TEST(RollingWindowTest, boundedByWidth) {
+    RollingWindow window;
+    window.setCapacity(10000);
+    for (int i = 0; i < 25000; ++i) {
+        window.append(i * 0.001, i == 24000 ? 500.0 : double(i % 100));
+    }
+    QVector<double> times, values;
+    window.sample(0.0, 100.0, 100, times, values);
+    EXPECT_LE(times.size(), 2 * 2 * RollingWindow::BUCKETS_PER_PIXEL * 100);
+    EXPECT_TRUE(std::is_sorted(times.begin(), times.end()));
+    EXPECT_EQ(times.first(), window.timeAt(0));
+    EXPECT_EQ(*std::max_element(values.begin(), values.end()), 500.0);
+}
+
+TEST(RollingWindowTest, stableWhileScrolling) {
+    RollingWindow window;
+    window.setCapacity(10000);
+    for (int i = 0; i < 12345; ++i) {
+        window.append(i * 0.001, double(i % 100));
+    }
+    QVector<double> before, beforeValues;
+    window.sample(0.0, 100.0, 100, before, beforeValues);
+
+    // One bucket of 10000 / 200 points later
+    for (int i = 12345; i < 12395; ++i) {
+        window.append(i * 0.001, double(i % 100));
+    }
+    QVector<double> after, afterValues;
+    window.sample(0.0, 100.0, 100, after, afterValues);
+
+    // Apart from the cut oldest and the incomplete newest bucket, the buckets did not change
+    int shared = before.size() - 6;
+    EXPECT_EQ(before.mid(4, shared), after.mid(2, shared));
+    EXPECT_EQ(beforeValues.mid(4, shared), afterValues.mid(2, shared));
+}
+
+TEST(RollingWindowTest, slidingExtremes) {
+    RollingWindow window;
+    window.setCapacity(500);
+    quint32 seed = 1;
+    for (int i = 0; i < 3000; ++i) {
+        seed = seed * 1664525u + 1013904223u;  // Linear congruential generator
+        window.append(i * 0.01, double((seed >> 8) % 1000) - 500.0);
+
+        // The range scrolls with the newest point, except for every 97th query
+        double lower = i % 97 == 0 ? (i - 450) * 0.01 : (i - 300) * 0.01;
+        double min, max;
+        ASSERT_TRUE(window.extremes(lower, min, max));
+        double scanMin, scanMax;
+        ASSERT_TRUE(window.extremes(lower, i * 0.01, scanMin, scanMax));
+        ASSERT_EQ(min, scanMin) << i;
+        ASSERT_EQ(max, scanMax) << i;
+    }
+
+    double min, max;
+    EXPECT_FALSE(window.extremes(100.0, min, max));
+    EXPECT_FALSE(window.extremes(1.0, 2.0, min, max));
+    window.clear();
+    EXPECT_FALSE(window.extremes(0.0, min, max));
+}
+
+}  // namespace
@@ -0,0 +1,116 @@
+/******************************************************************************
+ * Copyright (C) 2023 by Gschwind, Weber, Schoch, Niederberger                *
+ *                                                                            *
+ * This file is part of linescaleGUI.                                         *
+ *                                                                            *
+ * LinescaleGUI is free software: you can redistribute it and/or modify       *
+ * it under the terms of the GNU General Public License as published by       *
+ * the Free Software Foundation, either version 3 of the License, or          *
+ * (at your option) any later version.                                        *
+ *                                                                            *
+ * LinescaleGUI is distributed in the hope that it will be useful,            *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of             *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the               *
+ * GNU General Public License for more details.                               *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License          *
+ * along with linescaleGUI. If not, see <http://www.gnu.org/licenses/>.       *
+ ******************************************************************************/
+/**
+ * @file sampleClockTest.cpp
+ * @authors Gschwind, Weber, Schoch, Niederberger
+ *
+ * @brief Test class for the arrival timestamps and the gap detection
+ *
+ */
+
+#include <gtest/gtest.h>
+#include "../../src/deviceCommunication/gapDetector.h"
+#include "../../src/deviceCommunication/sampleClock.h"
+
+namespace {
+
+constexpr int64_t MS = 1000000;
+
+TEST(SampleClockTest, InterpolateBurst) {
+    comm::SampleClock clock;
+    int64_t timestamps[4];
+    clock.stamp(timestamps, 4, 1000 * MS, 0, 1000);
+    EXPECT_EQ(timestamps[0], 997 * MS);
+    EXPECT_EQ(timestamps[3], 1000 * MS);
+
+    // Frames still buffered are newer than the current chunk
+    clock.stamp(timestamps, 2, 1010 * MS, 3, 1000);
+    EXPECT_EQ(timestamps[0], 1006 * MS);
+    EXPECT_EQ(timestamps[1], 1007 * MS);
+}
+
+TEST(SampleClockTest, Monotonic) {
+    comm::SampleClock clock;
+    int64_t timestamps[10];
+    clock.stamp(timestamps, 2, 1000 * MS, 0, 1000);
+    // The interpolation would reach back to 993 ms, before the previous burst
+    clock.stamp(timestamps, 10, 1002 * MS, 0, 1000);
+    EXPECT_GT(timestamps[0], 1000 * MS);
+    for (int i = 1; i < 10; ++i) {
+        EXPECT_GT(timestamps[i], timestamps[i - 1]);
+    }
+    EXPECT_LE(timestamps[9], 1002 * MS);
+}
+
+/**
+ * @brief Create a sample at 1280 Hz
+ *
+ * @param sequence Sequence number
+ * @param timestamp Arrival time in ns
+ * @return Sample
+ */
+Sample makeSample(uint64_t sequence, int64_t timestamp) {
+    Sample sample{};
+    sample.frequency = 1280;
+    sample.sequence = sequence;
+    sample.timestamp = timestamp;
+    return sample;
+}
+
+TEST(GapDetectorTest, NoGap) {
+    comm::GapDetector detector;
+    int64_t period = comm::SampleClock::NS_PER_SECOND / 1280;
+    Sample samples[100];
+    for (int i = 0; i < 100; ++i) {
+        samples[i] = makeSample(i + 1, 1000 * MS + i * period + (i % 2) * 100000);
+    }
+    EXPECT_EQ(detector.check(samples, 100), 0u);
+    EXPECT_EQ(detector.getStatistics().samples, 100u);
+    EXPECT_EQ(detector.getStatistics().maxJitter, 100000);
+}
+
+TEST(GapDetectorTest, SequenceAndTimingGaps) {
+    comm::GapDetector detector;
+    int64_t period = comm::SampleClock::NS_PER_SECOND / 1280;
+    Sample samples[] = {
+        makeSample(1, 1000 * MS),
+        makeSample(2, 1000 * MS + period),
+        makeSample(5, 1000 * MS + 4 * period),            // 2 rejected
+        makeSample(6, 1000 * MS + 5 * period + 10 * MS),  // about 13 never received
+    };
+    EXPECT_EQ(detector.check(samples, 4), 2u + 13u);
+    EXPECT_EQ(detector.getStatistics().gaps, 2u);
+    EXPECT_EQ(detector.getStatistics().missingSamples, 15u);
+}
+
+TEST(GapDetectorTest, LateLimitAtLowFrequency) {
+    int64_t period = comm::SampleClock::NS_PER_SECOND / 10;
+    EXPECT_EQ(comm::GapDetector::lateLimit(period), period / 2);
+    EXPECT_EQ(comm::GapDetector::lateLimit(comm::SampleClock::NS_PER_SECOND / 1280),
+              comm::GapDetector::DEFAULT_TOLERANCE);
+
+    // 10 ms late at 10 Hz is jitter, not a gap
+    comm::GapDetector detector;
+    Sample samples[] = {makeSample(1, 1000 * MS), makeSample(2, 1000 * MS + period + 10 * MS)};
+    samples[0].frequency = 10;
+    samples[1].frequency = 10;
+    EXPECT_EQ(detector.check(samples, 2), 0u);
+}
+
+}  // namespace
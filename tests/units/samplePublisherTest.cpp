@@ -0,0 +1,166 @@
+/******************************************************************************
+ * Copyright (C) 2023 by Gschwind, Weber, Schoch, Niederberger                *
+ *                                                                            *
+ * This file is part of linescaleGUI.                                         *
+ *                                                                            *
+ * LinescaleGUI is free software: you can redistribute it and/or modify       *
+ * it under the terms of the GNU General Public License as published by       *
+ * the Free Software Foundation, either version 3 of the License, or          *
+ * (at your option) any later version.                                        *
+ *                                                                            *
+ * LinescaleGUI is distributed in the hope that it will be useful,            *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of             *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the               *
+ * GNU General Public License for more details.                               *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License          *
+ * along with linescaleGUI. If not, see <http://www.gnu.org/licenses/>.       *
+ ******************************************************************************/
+/**
+ * @file samplePublisherTest.cpp
+ * @authors Gschwind, Weber, Schoch, Niederberger
+ *
+ * @brief Test class for the shared memory publisher
+ *
+ */
+
+#include <gtest/gtest.h>
+#include <QCoreApplication>
+#include <thread>
+#include "../../src/streaming/samplePublisher.h"
+#include "../../src/streaming/sampleSubscriber.h"
+
+#if defined(Q_OS_UNIX)
+
+namespace {
+
+/**
+ * @brief Name of a ring only used by this test process
+ *
+ */
+QString testRingName() {
+    return QString("/linescale-test-%1").arg(QCoreApplication::applicationPid());
+}
+
+/**
+ * @brief Samples whose force equals their position in the stream
+ *
+ * @param first Force of the first sample
+ * @param count Number of samples
+ */
+QVector<Sample> makeSamples(int first, int count) {
+    QVector<Sample> samples;
+    for (int i = first; i < first + count; ++i) {
+        Sample sample{};
+        sample.measuredValue = i;
+        sample.unitValue = UnitValue::KGF;
+        sample.measureMode = MeasureMode::REL_ZERO;
+        sample.frequency = 1280;
+        sample.timestamp = 1000 * i;
+        sample.sequence = quint64(i) + 1;
+        sample.deviceId = 2;
+        samples.append(sample);
+    }
+    return samples;
+}
+
+TEST(SamplePublisherTest, publishAndRead) {
+    stream::SamplePublisher publisher;
+    ASSERT_TRUE(publisher.open(testRingName(), 100));
+    stream::SampleSubscriber subscriber;
+    ASSERT_TRUE(subscriber.open(testRingName()));
+
+    QVector<stream::SharedSample> samples;
+    EXPECT_EQ(subscriber.read(samples), 0);
+    publisher.publish(makeSamples(0, 3));
+    EXPECT_EQ(subscriber.available(), 3u);
+    ASSERT_EQ(subscriber.read(samples), 3);
+    EXPECT_EQ(samples[2].index, 2u);
+    EXPECT_EQ(samples[2].force, 2.0);
+    EXPECT_EQ(samples[2].timestamp, 2000);
+    EXPECT_EQ(samples[2].sequence, 3u);
+    EXPECT_EQ(samples[2].deviceId, 2);
+    EXPECT_EQ(UnitValue(samples[2].unit), UnitValue::KGF);
+    EXPECT_EQ(MeasureMode(samples[2].mode), MeasureMode::REL_ZERO);
+    EXPECT_EQ(samples[2].frequency, 1280);
+    EXPECT_EQ(subscriber.read(samples), 0);
+    EXPECT_EQ(publisher.getPublished(), 3u);
+
+    EXPECT_FALSE(subscriber.isClosed());
+    publisher.close();
+    EXPECT_TRUE(subscriber.isClosed());
+    EXPECT_FALSE(subscriber.open(testRingName()));
+}
+
+TEST(SamplePublisherTest, keepRingOfRunningPublisher) {
+    stream::SamplePublisher publisher;
+    ASSERT_TRUE(publisher.open(testRingName(), 16));
+    EXPECT_TRUE(stream::SamplePublisher::isPublished(testRingName()));
+
+    stream::SamplePublisher second;
+    EXPECT_FALSE(second.open(testRingName(), 16));
+    stream::SampleSubscriber subscriber;
+    ASSERT_TRUE(subscriber.open(testRingName()));
+    EXPECT_FALSE(subscriber.isClosed());
+
+    publisher.close();
+    EXPECT_FALSE(stream::SamplePublisher::isPublished(testRingName()));
+    EXPECT_TRUE(second.open(testRingName(), 16));
+}
+
+TEST(SamplePublisherTest, lappedReader) {
+    stream::SamplePublisher publisher;
+    ASSERT_TRUE(publisher.open(testRingName(), 6));  // Rounded up to 8
+    stream::SampleSubscriber subscriber;
+    ASSERT_TRUE(subscriber.open(testRingName()));
+
+    publisher.publish(makeSamples(0, 20));
+    QVector<stream::SharedSample> samples;
+    ASSERT_EQ(subscriber.read(samples), 8);
+    EXPECT_EQ(samples.first().index, 12u);
+    EXPECT_EQ(samples.last().force, 19.0);
+    EXPECT_EQ(subscriber.getLost(), 12u);
+
+    // A late reader starts with the samples still in the ring
+    stream::SampleSubscriber late;
+    ASSERT_TRUE(late.open(testRingName(), true));
+    ASSERT_EQ(late.read(samples, 5), 5);
+    EXPECT_EQ(samples.first().index, 12u);
+    EXPECT_EQ(late.getLost(), 0u);
+}
+
+TEST(SamplePublisherTest, concurrentReader) {
+    stream::SamplePublisher publisher;
+    ASSERT_TRUE(publisher.open(testRingName(), 256));
+    stream::SampleSubscriber subscriber;
+    ASSERT_TRUE(subscriber.open(testRingName()));
+
+    constexpr int total = 200000;
+    std::thread writer([&] {
+        for (int i = 0; i < total; i += 16) {
+            publisher.publish(makeSamples(i, 16));
+        }
+    });
+
+    quint64 received = 0;
+    quint64 expected = 0;
+    bool consistent = true;
+    QVector<stream::SharedSample> samples;
+    while (received + subscriber.getLost() < quint64(total)) {
+        subscriber.read(samples);
+        for (const stream::SharedSample& sample : samples) {
+            // Never torn and never out of order
+            consistent = consistent && sample.index >= expected && sample.force == double(sample.index) &&
+                         sample.timestamp == qint64(sample.index) * 1000;
+            expected = sample.index + 1;
+        }
+        received += quint64(samples.size());
+    }
+    writer.join();
+    EXPECT_TRUE(consistent);
+    EXPECT_EQ(received + subscriber.getLost(), quint64(total));
+}
+
+}  // namespace
+
+#endif
@@ -0,0 +1,188 @@
+/******************************************************************************
+ * Copyright (C) 2023 by Gschwind, Weber, Schoch, Niederberger                *
+ *                                                                            *
+ * This file is part of linescaleGUI.                                         *
+ *                                                                            *
+ * LinescaleGUI is free software: you can redistribute it and/or modify       *
+ * it under the terms of the GNU General Public License as published by       *
+ * the Free Software Foundation, either version 3 of the License, or          *
+ * (at your option) any later version.                                        *
+ *                                                                            *
+ * LinescaleGUI is distributed in the hope that it will be useful,            *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of             *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the               *
+ * GNU General Public License for more details.                               *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License          *
+ * along with linescaleGUI. If not, see <http://www.gnu.org/licenses/>.       *
+ ******************************************************************************/
+/**
+ * @file sampleServerTest.cpp
+ * @authors Gschwind, Weber, Schoch, Niederberger
+ *
+ * @brief Test class for the socket server of the live samples
+ *
+ */
+
+#include <gtest/gtest.h>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QLocalSocket>
+#include <QtEndian>
+#include <cstring>
+#include "../../src/deviceCommunication/command.h"
+#include "../../src/streaming/sampleServer.h"
+
+namespace {
+
+/**
+ * @brief Process events until a condition holds or a second passed
+ *
+ * @param condition Condition to wait for
+ * @return true if the condition holds
+ */
+template <typename Condition>
+bool processEventsUntil(Condition condition) {
+    QElapsedTimer elapsed;
+    elapsed.start();
+    while (!condition() && elapsed.elapsed() < 1000) {
+        QCoreApplication::processEvents(QEventLoop::AllEvents, 5);
+    }
+    return condition();
+}
+
+/**
+ * @brief Samples whose force equals their number
+ *
+ * @param count Number of samples
+ */
+QVector<Sample> makeSamples(int count) {
+    QVector<Sample> samples;
+    for (int i = 0; i < count; ++i) {
+        Sample sample{};
+        sample.measuredValue = i + 0.25;
+        sample.unitValue = UnitValue::KN;
+        sample.measureMode = MeasureMode::ABS_ZERO;
+        sample.frequency = 640;
+        sample.timestamp = 1000 + i;
+        sample.sequence = quint64(i) + 1;
+        sample.deviceId = 1;
+        samples.append(sample);
+    }
+    return samples;
+}
+
+TEST(SampleServerTest, encodeBinary) {
+    QByteArray frame;
+    stream::SampleServer::encodeBinary(makeSamples(2), 7, frame);
+    ASSERT_EQ(frame.size(), stream::SampleServer::FRAME_HEADER_SIZE + 2 * stream::SampleServer::RECORD_SIZE);
+    const uchar* data = reinterpret_cast<const uchar*>(frame.constData());
+    EXPECT_EQ(qFromLittleEndian<quint32>(data), stream::SampleServer::FRAME_MAGIC);
+    EXPECT_EQ(qFromLittleEndian<quint32>(data + 4), 2u);
+    EXPECT_EQ(qFromLittleEndian<quint64>(data + 8), 7u);
+
+    const uchar* record = data + stream::SampleServer::FRAME_HEADER_SIZE + stream::SampleServer::RECORD_SIZE;
+    EXPECT_EQ(qFromLittleEndian<qint64>(record), 1001);
+    EXPECT_EQ(qFromLittleEndian<quint64>(record + 8), 2u);
+    quint64 bits = qFromLittleEndian<quint64>(record + 16);
+    double force;
+    std::memcpy(&force, &bits, sizeof(force));
+    EXPECT_EQ(force, 1.25);
+    EXPECT_EQ(qFromLittleEndian<quint16>(record + 24), 1);
+    EXPECT_EQ(UnitValue(record[26]), UnitValue::KN);
+    EXPECT_EQ(MeasureMode(record[27]), MeasureMode::ABS_ZERO);
+    EXPECT_EQ(qFromLittleEndian<quint16>(record + 28), 640);
+}
+
+TEST(SampleServerTest, encodeText) {
+    QByteArray frame;
+    stream::SampleServer::encodeText(makeSamples(2), 7, frame);
+    EXPECT_EQ(frame, QByteArray("7 1000 1 0.25 kN ABS 1\n8 1001 1 1.25 kN ABS 2\n"));
+}
+
+TEST(SampleServerTest, parseCommand) {
+    QByteArray bytes;
+    quint16 device = 5;
+    EXPECT_TRUE(stream::SampleServer::parseCommand("SETZERO", bytes, device));
+    EXPECT_EQ(bytes, command::SETZERO);
+    EXPECT_EQ(device, 0);
+    EXPECT_TRUE(stream::SampleServer::parseCommand(" setspeed1280  2 ", bytes, device));
+    EXPECT_EQ(bytes, command::SETSPEED1280);
+    EXPECT_EQ(device, 2);
+    EXPECT_FALSE(stream::SampleServer::parseCommand("SETZERO x", bytes, device));
+    EXPECT_FALSE(stream::SampleServer::parseCommand("FORMAT C:", bytes, device));
+    EXPECT_FALSE(stream::SampleServer::parseCommand("", bytes, device));
+}
+
+TEST(SampleServerTest, streamToClients) {
+    QString name = QString("linescale-test-%1").arg(QCoreApplication::applicationPid());
+    stream::SampleServer server;
+    ASSERT_TRUE(server.listen(name));
+    quint16 commandDevice = 0;
+    QByteArray commandBytes;
+    QObject::connect(&server, &stream::SampleServer::commandReceived,
+                     [&](quint16 device, const QByteArray& bytes) {
+                         commandDevice = device;
+                         commandBytes = bytes;
+                     });
+
+    QLocalSocket text, binary;
+    text.connectToServer(name);
+    binary.connectToServer(name);
+    ASSERT_TRUE(processEventsUntil([&] { return server.getClientCount() == 2; }));
+    binary.write("binary\nSETSPEED640 1\n");
+    ASSERT_TRUE(processEventsUntil([&] { return !commandBytes.isEmpty(); }));
+    EXPECT_EQ(commandBytes, command::SETSPEED640);
+    EXPECT_EQ(commandDevice, 1);
+
+    server.publish(makeSamples(3));
+    ASSERT_TRUE(processEventsUntil([&] { return text.bytesAvailable() > 0 && binary.bytesAvailable() > 0; }));
+    EXPECT_EQ(text.readLine(), QByteArray("0 1000 1 0.25 kN ABS 1\n"));
+    int frameSize = stream::SampleServer::FRAME_HEADER_SIZE + 3 * stream::SampleServer::RECORD_SIZE;
+    ASSERT_TRUE(processEventsUntil([&] { return binary.bytesAvailable() >= frameSize; }));
+    QByteArray expected;
+    stream::SampleServer::encodeBinary(makeSamples(3), 0, expected);
+    EXPECT_EQ(binary.readAll(), expected);
+
+    text.disconnectFromServer();
+    EXPECT_TRUE(processEventsUntil([&] { return server.getClientCount() == 1; }));
+}
+
+TEST(SampleServerTest, disconnectOnLongLine) {
+    QString name = QString("linescale-test-%1").arg(QCoreApplication::applicationPid());
+    stream::SampleServer server;
+    ASSERT_TRUE(server.listen(name));
+    int commands = 0;
+    QObject::connect(&server, &stream::SampleServer::commandReceived, [&](quint16, const QByteArray&) { ++commands; });
+
+    // The tail of the line must not be taken for a command
+    QLocalSocket client;
+    client.connectToServer(name);
+    ASSERT_TRUE(processEventsUntil([&] { return server.getClientCount() == 1; }));
+    client.write(QByteArray(300, ' ') + "SETZERO\n");
+    EXPECT_TRUE(processEventsUntil([&] { return server.getClientCount() == 0; }));
+    EXPECT_EQ(commands, 0);
+}
+
+TEST(SampleServerTest, dropOldestForSlowClient) {
+    QString name = QString("linescale-test-%1").arg(QCoreApplication::applicationPid());
+    stream::SampleServer server;
+    server.setQueueLimit(64 * 1024);
+    ASSERT_TRUE(server.listen(name));
+
+    // Never reads, so the buffers of the system and the socket fill up first
+    QLocalSocket slow;
+    slow.setReadBufferSize(1024);
+    slow.connectToServer(name);
+    slow.write("binary\n");
+    ASSERT_TRUE(processEventsUntil([&] { return server.getClientCount() == 1; }));
+    QVector<Sample> batch = makeSamples(1000);
+    for (int i = 0; i < 200; ++i) {
+        server.publish(batch);
+        QCoreApplication::processEvents();
+    }
+    EXPECT_GT(server.getDropped(), 0u);
+    EXPECT_EQ(server.getClientCount(), 1);
+}
+
+}  // namespace
@@ -0,0 +1,100 @@
+/******************************************************************************
+ * Copyright (C) 2023 by Gschwind, Weber, Schoch, Niederberger                *
+ *                                                                            *
+ * This file is part of linescaleGUI.                                         *
+ *                                                                            *
+ * LinescaleGUI is free software: you can redistribute it and/or modify       *
+ * it under the terms of the GNU General Public License as published by       *
+ * the Free Software Foundation, either version 3 of the License, or          *
+ * (at your option) any later version.                                        *
+ *                                                                            *
+ * LinescaleGUI is distributed in the hope that it will be useful,            *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of             *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the               *
+ * GNU General Public License for more details.                               *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License          *
+ * along with linescaleGUI. If not, see <http://www.gnu.org/licenses/>.       *
+ ******************************************************************************/
+/**
+ * @file spscQueueTest.cpp
+ * @authors Gschwind, Weber, Schoch, Niederberger
+ *
+ * @brief Test class for the single producer single consumer queue
+ *
+ */
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <thread>
+#include <vector>
+#include "../../src/deviceCommunication/spscQueue.h"
+
+namespace {
+
+TEST(SpscQueueTest, PushPop) {
+    comm::SpscQueue<int> queue(5);
+    EXPECT_EQ(queue.capacity(), 8u);
+
+    int input[] = {1, 2, 3};
+    int output[8];
+    EXPECT_EQ(queue.push(input, 3), 3u);
+    EXPECT_EQ(queue.size(), 3u);
+    EXPECT_EQ(queue.pop(output, 2), 2u);
+    EXPECT_EQ(output[0], 1);
+    EXPECT_EQ(output[1], 2);
+    EXPECT_EQ(queue.pop(output, 8), 1u);
+    EXPECT_EQ(output[0], 3);
+    EXPECT_EQ(queue.pop(output, 8), 0u);
+}
+
+TEST(SpscQueueTest, FullQueueDrops) {
+    comm::SpscQueue<int> queue(4);
+    int input[] = {1, 2, 3, 4, 5, 6};
+    int output[4];
+    EXPECT_EQ(queue.push(input, 6), 4u);
+    EXPECT_EQ(queue.dropped(), 2u);
+    EXPECT_EQ(queue.pop(output, 4), 4u);
+    EXPECT_EQ(output[3], 4);
+}
+
+TEST(SpscQueueTest, TwoThreadsKeepOrder) {
+    constexpr int COUNT = 50000;
+    comm::SpscQueue<int> queue(256);
+
+    std::thread producer([&queue] {
+        int next = 0;
+        int batch[16];
+        while (next < COUNT) {
+            int count = 0;
+            for (; count < 16 && next + count < COUNT; ++count) {
+                batch[count] = next + count;
+            }
+            size_t offset = 0;
+            while (offset < static_cast<size_t>(count)) {
+                size_t free = queue.capacity() - queue.size();
+                size_t chunk = std::min(free, count - offset);
+                offset += queue.push(batch + offset, chunk);
+                if (chunk == 0) {
+                    std::this_thread::yield();
+                }
+            }
+            next += count;
+        }
+    });
+
+    std::vector<int> received;
+    int output[64];
+    while (received.size() < static_cast<size_t>(COUNT)) {
+        size_t count = queue.pop(output, 64);
+        received.insert(received.end(), output, output + count);
+    }
+    producer.join();
+
+    EXPECT_EQ(queue.dropped(), 0u);
+    for (int i = 0; i < COUNT; ++i) {
+        ASSERT_EQ(received[i], i);
+    }
+}
+
+}  // namespace
@@ -0,0 +1,109 @@
+/******************************************************************************
+ * Copyright (C) 2023 by Gschwind, Weber, Schoch, Niederberger                *
+ *                                                                            *
+ * This file is part of linescaleGUI.                                         *
+ *                                                                            *
+ * LinescaleGUI is free software: you can redistribute it and/or modify       *
+ * it under the terms of the GNU General Public License as published by       *
+ * the Free Software Foundation, either version 3 of the License, or          *
+ * (at your option) any later version.                                        *
+ *                                                                            *
+ * LinescaleGUI is distributed in the hope that it will be useful,            *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of             *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the               *
+ * GNU General Public License for more details.                               *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License          *
+ * along with linescaleGUI. If not, see <http://www.gnu.org/licenses/>.       *
+ ******************************************************************************/
+/**
+ * @file streamMergerTest.cpp
+ * @authors Gschwind, Weber, Schoch, Niederberger
+ *
+ * @brief Test class for the time-aligned merge of several devices
+ *
+ */
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <vector>
+#include "../../src/deviceCommunication/streamMerger.h"
+
+namespace {
+
+constexpr int64_t MS = 1000000;
+
+/**
+ * @brief Create a timestamped sample in kN
+ *
+ * @param deviceId Device number
+ * @param timestamp Arrival time in ns
+ * @param force Measured force in kN
+ * @return Sample
+ */
+Sample makeSample(uint16_t deviceId, int64_t timestamp, double force) {
+    Sample sample{};
+    sample.unitValue = UnitValue::KN;
+    sample.measuredValue = force;
+    sample.timestamp = timestamp;
+    sample.deviceId = deviceId;
+    return sample;
+}
+
+TEST(StreamMergerTest, MergeInTimestampOrder) {
+    comm::StreamMerger merger;
+    std::vector<Sample> first = {makeSample(1, 10 * MS, 1), makeSample(1, 30 * MS, 1), makeSample(1, 50 * MS, 1)};
+    std::vector<Sample> second = {makeSample(2, 20 * MS, 2), makeSample(2, 40 * MS, 2)};
+    merger.push(first.data(), first.size());
+    merger.push(second.data(), second.size());
+    EXPECT_EQ(merger.getWatermark(), 40 * MS);
+
+    Sample output[8];
+    ASSERT_EQ(merger.takeMerged(output, 8), 4u);
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_EQ(output[i].timestamp, (i + 1) * 10 * MS);
+    }
+
+    // Older than the released watermark
+    Sample late = makeSample(2, 35 * MS, 2);
+    merger.push(&late, 1);
+    EXPECT_EQ(merger.getLateSamples(), 1u);
+}
+
+TEST(StreamMergerTest, StalledDeviceBoundsLatency) {
+    comm::StreamMerger merger(20 * MS);
+    std::vector<Sample> samples = {makeSample(1, 10 * MS, 1), makeSample(2, 10 * MS, 2), makeSample(2, 100 * MS, 2)};
+    merger.push(samples.data(), samples.size());
+    EXPECT_EQ(merger.getWatermark(), 80 * MS);
+}
+
+TEST(StreamMergerTest, ResampleLinearAndZeroOrderHold) {
+    std::vector<Sample> samples = {makeSample(1, 10 * MS, 0.0), makeSample(1, 30 * MS, 2.0),
+                                   makeSample(2, 10 * MS, 1.0), makeSample(2, 35 * MS, 1.0)};
+    comm::AlignedFrame frames[4];
+    double forces[8];
+
+    comm::StreamMerger linear;
+    linear.setResampling(comm::Interpolation::LINEAR, 100);
+    linear.push(samples.data(), samples.size());
+    ASSERT_EQ(linear.takeAligned(frames, forces, 4), 3u);  // 10, 20 and 30 ms
+    EXPECT_EQ(frames[1].timestamp, 20 * MS);
+    EXPECT_DOUBLE_EQ(forces[2], 1.0);
+    EXPECT_DOUBLE_EQ(frames[1].total, 2.0);
+    EXPECT_EQ(frames[1].devices, 2u);
+
+    comm::StreamMerger hold;
+    hold.setResampling(comm::Interpolation::ZERO_ORDER_HOLD, 100);
+    hold.push(samples.data(), samples.size());
+    ASSERT_EQ(hold.takeAligned(frames, forces, 4), 3u);
+    EXPECT_DOUBLE_EQ(forces[2], 0.0);
+    EXPECT_DOUBLE_EQ(forces[4], 2.0);
+}
+
+TEST(StreamMergerTest, CombineDifferentUnits) {
+    Sample sample = makeSample(1, MS, 101.9716213);
+    sample.unitValue = UnitValue::KGF;
+    EXPECT_NEAR(comm::StreamMerger::toKiloNewton(sample), 1.0, 1e-9);
+}
+
+}  // namespace